@@ -0,0 +1,159 @@
+#include "bench_provider.h"
+#include <rbus.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static struct {
+    rbusHandle_t handle;
+    rbusDataElement_t* elements;
+    int element_count;
+    int groups;
+    int params;
+    int latency_us;
+    char** values;              /* groups * params, guarded by mutex */
+    pthread_mutex_t mutex;
+    uint64_t get_calls;
+    uint64_t set_calls;
+} g_provider = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+void bench_provider_param_name(int group, int param, char* buf, size_t len) {
+    snprintf(buf, len, BENCH_PROVIDER_ROOT "Group%d.Param%d", group, param);
+}
+
+void bench_provider_group_prefix(int group, char* buf, size_t len) {
+    snprintf(buf, len, BENCH_PROVIDER_ROOT "Group%d.", group);
+}
+
+/* Value slot for a registered name, or -1 */
+static int provider_index(const char* name) {
+    size_t root_len = strlen(BENCH_PROVIDER_ROOT);
+    if (!name || strncmp(name, BENCH_PROVIDER_ROOT, root_len) != 0) return -1;
+
+    int group = -1, param = -1;
+    if (sscanf(name + root_len, "Group%d.Param%d", &group, &param) != 2) return -1;
+    if (group < 0 || group >= g_provider.groups || param < 0 || param >= g_provider.params) return -1;
+    return group * g_provider.params + param;
+}
+
+static void provider_delay(void) {
+    if (g_provider.latency_us > 0) usleep((useconds_t)g_provider.latency_us);
+}
+
+static rbusError_t provider_get(rbusHandle_t handle, rbusProperty_t property, rbusGetHandlerOptions_t* options) {
+    (void)handle; (void)options;
+    int index = provider_index(rbusProperty_GetName(property));
+    if (index < 0) return RBUS_ERROR_ELEMENT_DOES_NOT_EXIST;
+
+    __atomic_add_fetch(&g_provider.get_calls, 1, __ATOMIC_RELAXED);
+    provider_delay();
+
+    rbusValue_t value;
+    rbusValue_Init(&value);
+    pthread_mutex_lock(&g_provider.mutex);
+    rbusValue_SetString(value, g_provider.values[index]);
+    pthread_mutex_unlock(&g_provider.mutex);
+    rbusProperty_SetValue(property, value);
+    rbusValue_Release(value);
+    return RBUS_ERROR_SUCCESS;
+}
+
+static rbusError_t provider_set(rbusHandle_t handle, rbusProperty_t property, rbusSetHandlerOptions_t* options) {
+    (void)handle; (void)options;
+    int index = provider_index(rbusProperty_GetName(property));
+    if (index < 0) return RBUS_ERROR_ELEMENT_DOES_NOT_EXIST;
+
+    __atomic_add_fetch(&g_provider.set_calls, 1, __ATOMIC_RELAXED);
+    provider_delay();
+
+    char* str = rbusValue_ToString(rbusProperty_GetValue(property), NULL, 0);
+    if (!str) return RBUS_ERROR_INVALID_INPUT;
+    pthread_mutex_lock(&g_provider.mutex);
+    char* old = g_provider.values[index];
+    g_provider.values[index] = str;
+    pthread_mutex_unlock(&g_provider.mutex);
+    free(old);
+    return RBUS_ERROR_SUCCESS;
+}
+
+static void provider_free_tables(void) {
+    for (int i = 0; i < g_provider.element_count; i++) {
+        if (g_provider.elements) free(g_provider.elements[i].name);
+        if (g_provider.values) free(g_provider.values[i]);
+    }
+    free(g_provider.elements);
+    free(g_provider.values);
+    g_provider.elements = NULL;
+    g_provider.values = NULL;
+    g_provider.element_count = 0;
+}
+
+int bench_provider_start(const char* component_name, int groups, int params, int latency_us) {
+    if (g_provider.handle || groups <= 0 || params <= 0) return -1;
+
+    int count = groups * params;
+    g_provider.groups = groups;
+    g_provider.params = params;
+    g_provider.latency_us = latency_us;
+    g_provider.get_calls = 0;
+    g_provider.set_calls = 0;
+    g_provider.elements = calloc((size_t)count, sizeof(rbusDataElement_t));
+    g_provider.values = calloc((size_t)count, sizeof(char*));
+    if (!g_provider.elements || !g_provider.values) {
+        provider_free_tables();
+        return -1;
+    }
+    g_provider.element_count = count;
+
+    char name[128];
+    for (int g = 0; g < groups; g++) {
+        for (int p = 0; p < params; p++) {
+            rbusDataElement_t* element = &g_provider.elements[g * params + p];
+            bench_provider_param_name(g, p, name, sizeof(name));
+            element->name = strdup(name);
+            element->type = RBUS_ELEMENT_TYPE_PROPERTY;
+            element->cbTable.getHandler = provider_get;
+            element->cbTable.setHandler = provider_set;
+            g_provider.values[g * params + p] = strdup(BENCH_PROVIDER_INITIAL_VALUE);
+            if (!element->name || !g_provider.values[g * params + p]) {
+                provider_free_tables();
+                return -1;
+            }
+        }
+    }
+
+    rbusError_t rc = rbus_open(&g_provider.handle, component_name);
+    if (rc != RBUS_ERROR_SUCCESS) {
+        fprintf(stderr, "bench provider: rbus_open(%s) failed: %d\n", component_name, rc);
+        g_provider.handle = NULL;
+        provider_free_tables();
+        return -2;
+    }
+    rc = rbus_regDataElements(g_provider.handle, count, g_provider.elements);
+    if (rc != RBUS_ERROR_SUCCESS) {
+        fprintf(stderr, "bench provider: rbus_regDataElements failed: %d\n", rc);
+        rbus_close(g_provider.handle);
+        g_provider.handle = NULL;
+        provider_free_tables();
+        return -3;
+    }
+    return 0;
+}
+
+void bench_provider_stop(void) {
+    if (!g_provider.handle) return;
+    rbus_unregDataElements(g_provider.handle, g_provider.element_count, g_provider.elements);
+    rbus_close(g_provider.handle);
+    g_provider.handle = NULL;
+    provider_free_tables();
+}
+
+uint64_t bench_provider_get_calls(void) {
+    return __atomic_load_n(&g_provider.get_calls, __ATOMIC_RELAXED);
+}
+
+uint64_t bench_provider_set_calls(void) {
+    return __atomic_load_n(&g_provider.set_calls, __ATOMIC_RELAXED);
+}
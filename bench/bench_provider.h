@@ -0,0 +1,26 @@
+#ifndef PARODUS2RBUS_BENCH_PROVIDER_H
+#define PARODUS2RBUS_BENCH_PROVIDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* In-process RBUS provider for the benchmark. It registers groups x params string
+ * properties named Device.X_P2R_Bench.Group<g>.Param<p> on its own RBUS handle; the
+ * get and set handlers sleep for latency_us before answering, standing in for a real
+ * component's round trip.
+ */
+
+#define BENCH_PROVIDER_ROOT "Device.X_P2R_Bench."
+#define BENCH_PROVIDER_INITIAL_VALUE "init"
+
+int bench_provider_start(const char* component_name, int groups, int params, int latency_us);
+void bench_provider_stop(void);
+
+void bench_provider_param_name(int group, int param, char* buf, size_t len);
+void bench_provider_group_prefix(int group, char* buf, size_t len);   /* Trailing '.' */
+
+/* Handler invocations since start */
+uint64_t bench_provider_get_calls(void);
+uint64_t bench_provider_set_calls(void);
+
+#endif /* PARODUS2RBUS_BENCH_PROVIDER_H */
@@ -0,0 +1,566 @@
+/* parodus2rbus_bench: drives request mixes through protocol_handle_request() and the
+ * WRP decode/execute/encode path against an in-process RBUS provider, and reports
+ * throughput, latency percentiles, allocations per request and cache hit rate.
+ */
+#include "bench_provider.h"
+#include "protocol.h"
+#include "parodus_iface.h"
+#include "rbus_adapter.h"
+#include "cache.h"
+#include "webconfig.h"
+#include "performance.h"
+#include "auth.h"
+#include "config.h"
+#include "log.h"
+#include "arena.h"
+#include <cJSON.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_REQUEST_MAX (32 * 1024)
+#define BENCH_FANOUT_MAX 256
+#define BENCH_VALUE_MAX 32
+
+/* Per-thread allocation count. glibc lets the executable replace malloc; forwarding to
+ * the __libc_ entry points counts every allocation made on the calling thread, including
+ * those inside cJSON and libc. Sanitizer builds keep their own allocator and report 0.
+ */
+static __thread uint64_t t_allocs = 0;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define BENCH_COUNT_ALLOCS 1
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+void* malloc(size_t size) { t_allocs++; return __libc_malloc(size); }
+void* calloc(size_t count, size_t size) { t_allocs++; return __libc_calloc(count, size); }
+void* realloc(void* ptr, size_t size) { t_allocs++; return __libc_realloc(ptr, size); }
+void free(void* ptr) { __libc_free(ptr); }
+#else
+#define BENCH_COUNT_ALLOCS 0
+#endif
+
+typedef enum {
+    BENCH_GET = 0,          /* GET of fanout concrete names */
+    BENCH_WILDCARD,         /* GET of one group prefix */
+    BENCH_SET,
+    BENCH_TAS,
+    BENCH_WEBCONFIG,        /* WEBCONFIG_TRANSACTION setting fanout names */
+    BENCH_OP_COUNT
+} bench_op_t;
+
+typedef enum {
+    BENCH_PATH_PROTOCOL = 0,    /* cJSON request straight into protocol_handle_request() */
+    BENCH_PATH_WRP,             /* WebPA payload through parodus_iface_handle_payload() */
+    BENCH_PATH_COUNT
+} bench_path_t;
+
+static const char* g_op_names[BENCH_OP_COUNT] = { "get", "wildcard", "set", "tas", "webconfig" };
+static const char* g_path_names[BENCH_PATH_COUNT] = { "protocol", "wrp" };
+
+static struct {
+    int threads;
+    int requests;           /* Measured requests per thread */
+    int warmup;             /* Unmeasured requests per thread before each path */
+    int fanout;
+    int groups;
+    int params;
+    int latency_us;
+    int use_cache;
+    int log_level;
+    int weights[BENCH_OP_COUNT];
+    int weight_total;
+    int paths[BENCH_PATH_COUNT];
+} g_opts = {
+    .threads = 1,
+    .requests = 10000,
+    .warmup = 1000,
+    .fanout = 8,
+    .groups = 16,
+    .params = 16,
+    .latency_us = 100,
+    .use_cache = 1,
+    .log_level = P2R_LEVEL_ERROR,
+    .weights = { 60, 10, 15, 10, 5 },
+    .paths = { 1, 1 }
+};
+
+typedef struct {
+    uint64_t requests;
+    uint64_t errors;        /* No response or a status other than 200 */
+    uint64_t allocs;
+} bench_op_stats_t;
+
+typedef struct {
+    int index;
+    bench_path_t path;
+    uint32_t rng;
+    uint64_t seq;
+    char** shadow;          /* Last value this worker wrote to each param of its write group */
+    bench_op_stats_t ops[BENCH_OP_COUNT];
+    char* request;
+    pthread_t thread;
+} bench_worker_t;
+
+/* Timer ids per path: one per op plus an "all" timer */
+static perf_metric_id_t g_timers[BENCH_PATH_COUNT][BENCH_OP_COUNT + 1];
+static char g_timer_names[BENCH_PATH_COUNT][BENCH_OP_COUNT + 1][48];
+
+/* Workers warm up, report ready, then wait for everyone to start the measured run together */
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int ready;
+    int go;
+} g_start = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0 };
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--threads N] [--requests N] [--warmup N] [--fanout N] [--groups N] [--params N]\n"
+        "       [--latency-us N] [--mix get=W,wildcard=W,set=W,tas=W,webconfig=W] [--path protocol|wrp|both]\n"
+        "       [--cache 0|1] [--log N]\n", prog);
+    fprintf(stderr, "Defaults: --threads %d --requests %d --warmup %d --fanout %d --groups %d --params %d --latency-us %d\n"
+        "          --mix get=%d,wildcard=%d,set=%d,tas=%d,webconfig=%d --path both --cache %d --log %d\n",
+        g_opts.threads, g_opts.requests, g_opts.warmup, g_opts.fanout, g_opts.groups, g_opts.params,
+        g_opts.latency_us, g_opts.weights[BENCH_GET], g_opts.weights[BENCH_WILDCARD], g_opts.weights[BENCH_SET],
+        g_opts.weights[BENCH_TAS], g_opts.weights[BENCH_WEBCONFIG], g_opts.use_cache, g_opts.log_level);
+    fprintf(stderr, "Requests per thread are measured after the warmup; writes go to group (thread %% groups), and\n"
+        "WebConfig transactions set --fanout params of that group.\n");
+}
+
+/* Parse "get=60,set=20,..."; ops left out get weight 0 */
+static int parse_mix(const char* spec) {
+    int weights[BENCH_OP_COUNT] = { 0 };
+    char* copy = strdup(spec);
+    if (!copy) return -1;
+
+    int rc = 0;
+    char* save = NULL;
+    for (char* tok = strtok_r(copy, ",", &save); tok && rc == 0; tok = strtok_r(NULL, ",", &save)) {
+        char* eq = strchr(tok, '=');
+        if (!eq) { rc = -1; break; }
+        *eq = '\0';
+        rc = -1;
+        for (int op = 0; op < BENCH_OP_COUNT; op++) {
+            if (strcmp(tok, g_op_names[op]) == 0) {
+                weights[op] = atoi(eq + 1);
+                rc = weights[op] >= 0 ? 0 : -1;
+            }
+        }
+    }
+    free(copy);
+    if (rc != 0) return -1;
+    memcpy(g_opts.weights, weights, sizeof(weights));
+    return 0;
+}
+
+static int parse_args(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            g_opts.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+            g_opts.requests = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            g_opts.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fanout") == 0 && i + 1 < argc) {
+            g_opts.fanout = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--groups") == 0 && i + 1 < argc) {
+            g_opts.groups = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc) {
+            g_opts.params = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--latency-us") == 0 && i + 1 < argc) {
+            g_opts.latency_us = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mix") == 0 && i + 1 < argc) {
+            if (parse_mix(argv[++i]) != 0) {
+                fprintf(stderr, "Invalid --mix: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--path") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            g_opts.paths[BENCH_PATH_PROTOCOL] = strcmp(path, "protocol") == 0 || strcmp(path, "both") == 0;
+            g_opts.paths[BENCH_PATH_WRP] = strcmp(path, "wrp") == 0 || strcmp(path, "both") == 0;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            g_opts.use_cache = atoi(argv[++i]) ? 1 : 0;
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            g_opts.log_level = atoi(argv[++i]);
+        } else {
+            return -1;
+        }
+    }
+
+    g_opts.weight_total = 0;
+    for (int op = 0; op < BENCH_OP_COUNT; op++) g_opts.weight_total += g_opts.weights[op];
+    if (g_opts.threads < 1 || g_opts.requests < 1 || g_opts.warmup < 0 || g_opts.groups < 1 ||
+        g_opts.params < 1 || g_opts.fanout < 1 || g_opts.fanout > BENCH_FANOUT_MAX ||
+        g_opts.latency_us < 0 || g_opts.weight_total <= 0 ||
+        (!g_opts.paths[BENCH_PATH_PROTOCOL] && !g_opts.paths[BENCH_PATH_WRP])) {
+        return -1;
+    }
+    return 0;
+}
+
+static uint32_t bench_rand(bench_worker_t* w) {
+    /* xorshift32: cheap and per-thread, so request generation adds no contention */
+    uint32_t x = w->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    w->rng = x;
+    return x;
+}
+
+static bench_op_t pick_op(bench_worker_t* w) {
+    int r = (int)(bench_rand(w) % (uint32_t)g_opts.weight_total);
+    for (int op = 0; op < BENCH_OP_COUNT; op++) {
+        if (r < g_opts.weights[op]) return (bench_op_t)op;
+        r -= g_opts.weights[op];
+    }
+    return BENCH_GET;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+/* Append to the request buffer; output past the end is dropped and caught by the caller */
+static size_t put(char* buf, size_t off, const char* fmt, const char* a, const char* b) {
+    if (off >= BENCH_REQUEST_MAX) return off;
+    int n = snprintf(buf + off, BENCH_REQUEST_MAX - off, fmt, a ? a : "", b ? b : "");
+    return n < 0 ? BENCH_REQUEST_MAX : off + (size_t)n;
+}
+
+/* Build one request in w->request. Writes record the params and values they use in
+ * targets/values so a successful reply can update the shadow copy.
+ */
+static size_t build_request(bench_worker_t* w, bench_op_t op, int* targets, char values[][BENCH_VALUE_MAX], int* target_count) {
+    char* buf = w->request;
+    char id[48], name[128];
+    int write_group = w->index % g_opts.groups;
+    int wrp = w->path == BENCH_PATH_WRP;
+    size_t off = 0;
+
+    snprintf(id, sizeof(id), "bench-%s-%d-%llu", g_path_names[w->path], w->index, (unsigned long long)w->seq++);
+    *target_count = 0;
+
+    switch (op) {
+        case BENCH_GET:
+        case BENCH_WILDCARD:
+            off = put(buf, off, wrp ? "{\"id\":\"%s\",\"command\":\"GET\",\"names\":[" : "{\"id\":\"%s\",\"op\":\"GET\",\"params\":[", id, NULL);
+            if (op == BENCH_WILDCARD) {
+                bench_provider_group_prefix((int)(bench_rand(w) % (uint32_t)g_opts.groups), name, sizeof(name));
+                off = put(buf, off, "\"%s\"", name, NULL);
+            } else {
+                for (int i = 0; i < g_opts.fanout; i++) {
+                    bench_provider_param_name((int)(bench_rand(w) % (uint32_t)g_opts.groups),
+                                              (int)(bench_rand(w) % (uint32_t)g_opts.params), name, sizeof(name));
+                    off = put(buf, off, i ? ",\"%s\"" : "\"%s\"", name, NULL);
+                }
+            }
+            off = put(buf, off, "]}", NULL, NULL);
+            break;
+
+        case BENCH_SET:
+        case BENCH_TAS: {
+            int param = (int)(bench_rand(w) % (uint32_t)g_opts.params);
+            bench_provider_param_name(write_group, param, name, sizeof(name));
+            targets[0] = param;
+            snprintf(values[0], BENCH_VALUE_MAX, "v%d-%llu", w->index, (unsigned long long)w->seq);
+            *target_count = 1;
+            if (op == BENCH_SET && wrp) {
+                off = put(buf, off, "{\"id\":\"%s\",\"command\":\"SET\",\"parameters\":[{\"name\":\"%s\",", id, name);
+                off = put(buf, off, "\"value\":\"%s\",\"dataType\":0}]}", values[0], NULL);
+            } else if (op == BENCH_SET) {
+                off = put(buf, off, "{\"id\":\"%s\",\"op\":\"SET\",\"param\":\"%s\",", id, name);
+                off = put(buf, off, "\"value\":\"%s\"}", values[0], NULL);
+            } else {
+                /* The WebPA schema has no TEST_AND_SET; both paths send the internal form */
+                off = put(buf, off, "{\"id\":\"%s\",\"op\":\"TEST_AND_SET\",\"param\":\"%s\",", id, name);
+                off = put(buf, off, "\"oldValue\":\"%s\",\"newValue\":\"%s\",\"dataType\":0}", w->shadow[param], values[0]);
+            }
+            break;
+        }
+
+        case BENCH_WEBCONFIG: {
+            int count = g_opts.fanout < g_opts.params ? g_opts.fanout : g_opts.params;
+            int first = (int)(bench_rand(w) % (uint32_t)g_opts.params);
+            off = put(buf, off, "{\"id\":\"%s\",\"op\":\"WEBCONFIG_TRANSACTION\",\"transaction\":{\"transaction_id\":\"%s\",", id, id);
+            off = put(buf, off, "\"atomic\":true,\"source\":\"bench\",\"parameters\":[", NULL, NULL);
+            for (int i = 0; i < count; i++) {
+                int param = (first + i) % g_opts.params;
+                bench_provider_param_name(write_group, param, name, sizeof(name));
+                targets[i] = param;
+                snprintf(values[i], BENCH_VALUE_MAX, "c%d-%llu", w->index, (unsigned long long)w->seq);
+                off = put(buf, off, i ? ",{\"name\":\"%s\",\"value\":\"%s\",\"dataType\":0,\"operation\":\"SET\"}"
+                                      : "{\"name\":\"%s\",\"value\":\"%s\",\"dataType\":0,\"operation\":\"SET\"}", name, values[i]);
+            }
+            off = put(buf, off, "]}}", NULL, NULL);
+            *target_count = count;
+            break;
+        }
+
+        default:
+            break;
+    }
+    return off < BENCH_REQUEST_MAX ? off : 0;
+}
+
+/* Status of a reply: "status" for internal responses, "statusCode" for WebPA ones */
+static int reply_status(const cJSON* reply) {
+    const cJSON* status = cJSON_GetObjectItem(reply, "status");
+    if (!cJSON_IsNumber(status)) status = cJSON_GetObjectItem(reply, "statusCode");
+    return cJSON_IsNumber(status) ? status->valueint : -1;
+}
+
+/* Run one request; returns its status (-1 without a usable reply) */
+static int run_request(bench_worker_t* w, bench_op_t op, int measured) {
+    int targets[BENCH_FANOUT_MAX];
+    char values[BENCH_FANOUT_MAX][BENCH_VALUE_MAX];
+    int target_count = 0;
+    size_t len = build_request(w, op, targets, values, &target_count);
+    if (len == 0) return -1;
+
+    int status = -1;
+    uint64_t allocs = 0;
+    double elapsed = 0.0;
+
+    if (w->path == BENCH_PATH_PROTOCOL) {
+        cJSON* root = cJSON_ParseWithLength(w->request, len);
+        uint64_t before = t_allocs;
+        double start = now_ms();
+        cJSON* resp = protocol_handle_request(root);
+        elapsed = now_ms() - start;
+        allocs = t_allocs - before;
+        if (resp) status = reply_status(resp);
+        cJSON_Delete(resp);
+        cJSON_Delete(root);
+    } else {
+        uint64_t before = t_allocs;
+        double start = now_ms();
+        char* reply = parodus_iface_handle_payload(w->request, len, NULL);
+        elapsed = now_ms() - start;
+        allocs = t_allocs - before;
+        cJSON* parsed = reply ? cJSON_Parse(reply) : NULL;
+        if (parsed) status = reply_status(parsed);
+        cJSON_Delete(parsed);
+        free(reply);
+    }
+
+    if (status == 200) {
+        for (int i = 0; i < target_count; i++) {
+            free(w->shadow[targets[i]]);
+            w->shadow[targets[i]] = strdup(values[i]);
+        }
+    }
+
+    if (measured) {
+        bench_op_stats_t* stats = &w->ops[op];
+        stats->requests++;
+        stats->allocs += allocs;
+        if (status != 200) stats->errors++;
+        perf_latency_record_id(g_timers[w->path][op], elapsed);
+        perf_latency_record_id(g_timers[w->path][BENCH_OP_COUNT], elapsed);
+    }
+    return status;
+}
+
+static void* worker_main(void* arg) {
+    bench_worker_t* w = (bench_worker_t*)arg;
+    for (int i = 0; i < g_opts.warmup; i++) run_request(w, pick_op(w), 0);
+    pthread_mutex_lock(&g_start.mutex);
+    g_start.ready++;
+    pthread_cond_broadcast(&g_start.cond);
+    while (!g_start.go) pthread_cond_wait(&g_start.cond, &g_start.mutex);
+    pthread_mutex_unlock(&g_start.mutex);
+    for (int i = 0; i < g_opts.requests; i++) run_request(w, pick_op(w), 1);
+    return NULL;
+}
+
+static void print_row(const char* path, const char* op, const bench_op_stats_t* stats, const char* timer) {
+    perf_percentiles_t pct = { 0 };
+    perf_get_percentiles(timer, PERF_WINDOW_ALL, &pct);
+    double allocs = stats->requests ? (double)stats->allocs / (double)stats->requests : 0.0;
+    printf("%-9s %-10s %10llu %8llu %9.3f %9.3f %9.3f %9.3f %10.1f\n", path, op,
+           (unsigned long long)stats->requests, (unsigned long long)stats->errors,
+           pct.p50_ms, pct.p90_ms, pct.p99_ms, pct.p999_ms, allocs);
+}
+
+static int run_path(bench_path_t path) {
+    bench_worker_t* workers = calloc((size_t)g_opts.threads, sizeof(bench_worker_t));
+    if (!workers) return -1;
+
+    if (g_opts.use_cache) cache_clear();
+    uint64_t rbus_gets = 0, rbus_sets = 0;
+    g_start.ready = 0;
+    g_start.go = 0;
+
+    int started = 0;
+    for (int i = 0; i < g_opts.threads; i++) {
+        bench_worker_t* w = &workers[i];
+        w->index = i;
+        w->path = path;
+        w->rng = 0x9e3779b9u ^ (uint32_t)(i * 2654435761u) ^ (uint32_t)path;
+        if (w->rng == 0) w->rng = 1;
+        w->request = malloc(BENCH_REQUEST_MAX);
+        w->shadow = calloc((size_t)g_opts.params, sizeof(char*));
+        if (!w->request || !w->shadow) break;
+        int write_group = i % g_opts.groups;
+        /* Seed the shadow from the provider so TEST_AND_SET starts with the right old values */
+        for (int p = 0; p < g_opts.params; p++) {
+            char name[128];
+            bench_provider_param_name(write_group, p, name, sizeof(name));
+            char* value = NULL;
+            if (rbus_adapter_get(name, &value) != 0 || !value) value = strdup(BENCH_PROVIDER_INITIAL_VALUE);
+            w->shadow[p] = value;
+        }
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) break;
+        started++;
+    }
+    if (started < g_opts.threads) fprintf(stderr, "Started %d of %d workers\n", started, g_opts.threads);
+
+    pthread_mutex_lock(&g_start.mutex);
+    while (g_start.ready < started) pthread_cond_wait(&g_start.cond, &g_start.mutex);
+    g_start.go = 1;
+    pthread_cond_broadcast(&g_start.cond);
+    /* Reset under the start lock so no worker has begun its measured run yet */
+    if (g_opts.use_cache) cache_reset_stats();
+    uint64_t gets_before = bench_provider_get_calls(), sets_before = bench_provider_set_calls();
+    double start = now_ms();
+    pthread_mutex_unlock(&g_start.mutex);
+    for (int i = 0; i < started; i++) pthread_join(workers[i].thread, NULL);
+    double wall_ms = now_ms() - start;
+    rbus_gets = bench_provider_get_calls() - gets_before;
+    rbus_sets = bench_provider_set_calls() - sets_before;
+
+    bench_op_stats_t total = { 0 };
+    bench_op_stats_t per_op[BENCH_OP_COUNT];
+    memset(per_op, 0, sizeof(per_op));
+    for (int i = 0; i < started; i++) {
+        for (int op = 0; op < BENCH_OP_COUNT; op++) {
+            per_op[op].requests += workers[i].ops[op].requests;
+            per_op[op].errors += workers[i].ops[op].errors;
+            per_op[op].allocs += workers[i].ops[op].allocs;
+        }
+    }
+    for (int op = 0; op < BENCH_OP_COUNT; op++) {
+        if (per_op[op].requests == 0) continue;
+        print_row(g_path_names[path], g_op_names[op], &per_op[op], g_timer_names[path][op]);
+        total.requests += per_op[op].requests;
+        total.errors += per_op[op].errors;
+        total.allocs += per_op[op].allocs;
+    }
+    print_row(g_path_names[path], "all", &total, g_timer_names[path][BENCH_OP_COUNT]);
+
+    double seconds = wall_ms / 1000.0;
+    printf("%-9s throughput %.0f req/s over %.2f s; provider calls per request: get %.2f set %.2f\n",
+           g_path_names[path], seconds > 0 ? (double)total.requests / seconds : 0.0, seconds,
+           total.requests ? (double)rbus_gets / (double)total.requests : 0.0,
+           total.requests ? (double)rbus_sets / (double)total.requests : 0.0);
+
+    cache_stats_t* cs = g_opts.use_cache ? cache_get_stats() : NULL;
+    if (cs) {
+        uint64_t hits = (uint64_t)cs->cache_hits + cs->subtree_hits;
+        uint64_t lookups = hits + cs->cache_misses + cs->subtree_misses;
+        printf("%-9s cache hit rate %.1f%% (%llu of %llu lookups, %u entries)\n", g_path_names[path],
+               lookups ? 100.0 * (double)hits / (double)lookups : 0.0,
+               (unsigned long long)hits, (unsigned long long)lookups, cs->total_entries);
+    }
+
+    for (int i = 0; i < g_opts.threads; i++) {
+        if (workers[i].shadow) {
+            for (int p = 0; p < g_opts.params; p++) free(workers[i].shadow[p]);
+        }
+        free(workers[i].shadow);
+        free(workers[i].request);
+    }
+    free(workers);
+    return started == g_opts.threads ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    if (parse_args(argc, argv) != 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    g_p2r_config.log_level = g_opts.log_level;
+    g_p2r_log_level = g_opts.log_level;
+
+    /* Same start-up order as the daemon, minus libparodus */
+    arena_json_install();
+
+    perf_config_t perf_config = {
+        .enable_collection = 1,
+        .history_retention_sec = 3600,
+        .enable_detailed_timers = 1,
+        .max_metrics = 1000
+    };
+    if (perf_init(&perf_config) != 0) {
+        fprintf(stderr, "perf_init failed\n");
+        return 1;
+    }
+    for (int path = 0; path < BENCH_PATH_COUNT; path++) {
+        for (int op = 0; op <= BENCH_OP_COUNT; op++) {
+            char* name = g_timer_names[path][op];
+            snprintf(name, sizeof(g_timer_names[path][op]), "bench.%s.%s", g_path_names[path],
+                     op < BENCH_OP_COUNT ? g_op_names[op] : "all");
+            g_timers[path][op] = perf_metric_id(name, PERF_METRIC_TIMER, PERF_CAT_PROTOCOL);
+        }
+    }
+
+    cache_config_t cache_config = {
+        .max_entries = (uint32_t)g_p2r_config.cache_max_entries,
+        .max_memory_bytes = (uint64_t)g_p2r_config.cache_max_memory_mb * 1024 * 1024,
+        .default_ttl = 300,
+        .cleanup_interval = 60,
+        .enable_stats = 1
+    };
+    if (g_opts.use_cache && cache_init(&cache_config) != 0) {
+        fprintf(stderr, "cache_init failed\n");
+        perf_cleanup();
+        return 1;
+    }
+
+    webconfig_config_t webconfig_config = {
+        .max_transaction_size = BENCH_FANOUT_MAX,
+        .transaction_timeout = 300,
+        .enable_rollback = 1,
+        .enable_validation = 1,
+        .backup_directory = "/tmp/webconfig_backups"
+    };
+    auth_config_t auth_config = { .enable_authentication = 0 };
+    int rc = 1;
+    if (webconfig_init(&webconfig_config) != 0) {
+        fprintf(stderr, "webconfig_init failed\n");
+    } else if (auth_init(&auth_config) != 0) {
+        fprintf(stderr, "auth_init failed\n");
+    } else if (bench_provider_start("parodus2rbus.bench.provider", g_opts.groups, g_opts.params, g_opts.latency_us) != 0) {
+        fprintf(stderr, "Failed to register the bench provider\n");
+    } else if (rbus_adapter_open("parodus2rbus.bench") != 0) {
+        fprintf(stderr, "Failed to open RBUS\n");
+        bench_provider_stop();
+    } else {
+        printf("threads=%d requests=%d/thread warmup=%d fanout=%d params=%dx%d latency=%dus cache=%s allocs=%s\n",
+               g_opts.threads, g_opts.requests, g_opts.warmup, g_opts.fanout, g_opts.groups, g_opts.params,
+               g_opts.latency_us, g_opts.use_cache ? "on" : "off", BENCH_COUNT_ALLOCS ? "counted" : "not counted");
+        printf("%-9s %-10s %10s %8s %9s %9s %9s %9s %10s\n", "path", "op", "requests", "errors",
+               "p50_ms", "p90_ms", "p99_ms", "p99.9_ms", "allocs/req");
+        rc = 0;
+        for (int path = 0; path < BENCH_PATH_COUNT; path++) {
+            if (g_opts.paths[path] && run_path((bench_path_t)path) != 0) rc = 1;
+        }
+        rbus_adapter_close();
+        bench_provider_stop();
+    }
+
+    auth_cleanup();
+    webconfig_cleanup();
+    if (g_opts.use_cache) cache_cleanup();
+    perf_cleanup();
+    return rc;
+}
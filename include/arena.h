@@ -0,0 +1,40 @@
+#ifndef PARODUS2RBUS_ARENA_H
+#define PARODUS2RBUS_ARENA_H
+
+#include <stddef.h>
+
+/* Bump allocator for per-request scratch memory. Individual allocations are never
+ * freed; arena_reset drops them all at once and keeps the first chunk, so a steady
+ * stream of requests reuses the same memory instead of churning the heap.
+ * An arena is not locked: one request uses it at a time, possibly handed from thread
+ * to thread.
+ */
+
+typedef struct arena arena_t;
+
+arena_t* arena_create(size_t chunk_size);
+void arena_destroy(arena_t* arena);
+
+void* arena_alloc(arena_t* arena, size_t size);
+void arena_reset(arena_t* arena);
+int arena_contains(const arena_t* arena, const void* ptr);
+
+/* Request arenas come from a shared pool; release resets the arena and returns it */
+arena_t* arena_acquire(void);
+void arena_release(arena_t* arena);
+
+/* cJSON integration. arena_json_install registers cJSON_InitHooks once at startup.
+ * Between arena_json_begin and arena_json_end, cJSON nodes and strings allocated on
+ * the calling thread come from the arena. Freeing arena memory (cJSON_Delete) is a
+ * no-op on a thread bound to that arena: begin binds it, and a thread that only
+ * touches a tree built elsewhere binds it with arena_json_bind (NULL unbinds).
+ * Everything else uses malloc/free as before. Only bracket code whose cJSON output
+ * stays inside the tree (parsing, building a request): printed strings released with
+ * free() must not come from the arena.
+ */
+void arena_json_install(void);
+void arena_json_begin(arena_t* arena);
+void arena_json_end(void);
+void arena_json_bind(arena_t* arena);
+
+#endif /* PARODUS2RBUS_ARENA_H */
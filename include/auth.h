@@ -136,13 +136,17 @@ typedef struct {
 int auth_init(const auth_config_t* config);
 void auth_cleanup(void);
 
-/* Token management */
+/* Token management. Returned tokens are caller-owned copies: free them with
+ * auth_free_token_info. Revoking or expiring the stored token does not affect them.
+ */
 auth_token_info_t* auth_create_token(const char* user_id, auth_role_t role, auth_token_type_t type);
 auth_token_info_t* auth_validate_token(const char* token, auth_token_type_t type);
 int auth_revoke_token(const char* token);
 void auth_free_token_info(auth_token_info_t* token_info);
 
-/* Session management */
+/* Session management. Returned sessions are caller-owned copies: free them with
+ * auth_free_session.
+ */
 auth_session_t* auth_create_session(const char* user_id, auth_role_t role, const char* client_ip, const char* user_agent);
 auth_session_t* auth_get_session(const char* session_id);
 int auth_update_session_activity(const char* session_id);
@@ -4,15 +4,30 @@
 #include <stdint.h>
 #include <time.h>
 
+/* Immutable, refcounted cached value. The cache entry holds one reference and
+ * every reader obtained through cache_acquire holds another, so a hit can be
+ * serialized straight from data without copying it. Replacing or evicting the
+ * entry never frees a buffer a reader still holds.
+ */
+typedef struct cache_value {
+    int refcount;               /* Updated atomically */
+    int dataType;               /* WebPA data type */
+    size_t length;              /* strlen(data) */
+    char data[];                /* NUL-terminated value string */
+} cache_value_t;
+
 /* Cache entry structure */
 typedef struct cache_entry {
     char* key;                  /* Parameter name or cache key */
-    char* value;                /* Cached value as string */
-    int dataType;               /* WebPA data type */
+    cache_value_t* value;       /* Cached value and its WebPA data type */
     time_t timestamp;           /* When the entry was cached */
     time_t ttl;                 /* Time-to-live in seconds */
     int access_count;           /* Number of times accessed */
+    int coherent;               /* Kept fresh by RBUS value-change events */
+    uint32_t hash;              /* Full key hash (shard and bucket selection) */
     struct cache_entry* next;   /* Linked list for hash collision */
+    struct cache_entry* lru_prev; /* Recency list, most recently used at the head */
+    struct cache_entry* lru_next;
 } cache_entry_t;
 
 /* Cache statistics */
@@ -20,45 +35,81 @@ typedef struct {
     uint32_t total_entries;     /* Total entries in cache */
     uint32_t cache_hits;        /* Number of cache hits */
     uint32_t cache_misses;      /* Number of cache misses */
-    uint32_t cache_evictions;   /* Number of entries evicted */
+    uint32_t cache_evictions;   /* Number of entries evicted (all causes) */
+    uint32_t memory_evictions;  /* Evictions forced by max_memory_bytes */
     uint32_t cache_timeouts;    /* Number of entries that expired */
     uint64_t memory_used;       /* Approximate memory usage in bytes */
+    uint32_t coherent_entries;  /* Entries currently kept fresh by events */
+    uint32_t coherent_updates;  /* Entries updated in place from events */
+    uint32_t subtree_hits;      /* Wildcard GETs answered by cache_get_subtree */
+    uint32_t subtree_misses;
 } cache_stats_t;
 
-/* Cache configuration */
+/* Cache configuration. Entries are spread over hash shards with their own lock and
+ * LRU list; the entry and memory limits are split evenly between the shards.
+ */
 typedef struct {
     uint32_t max_entries;       /* Maximum number of cache entries */
+    uint64_t max_memory_bytes;  /* Approximate memory limit (0 = unlimited) */
     time_t default_ttl;         /* Default TTL for entries (seconds) */
     time_t cleanup_interval;    /* How often to run cleanup (seconds) */
     int enable_stats;           /* Whether to collect statistics */
     int enable_persistence;     /* Whether to persist cache to disk */
-    char* persistence_file;     /* File to persist cache data */
+    char* persistence_file;     /* Binary snapshot loaded at init and saved at cleanup */
+    time_t snapshot_interval;   /* Also save the snapshot this often (seconds, 0 = only at cleanup) */
+    int enable_coherence;       /* Keep entries fresh via RBUS value-change events */
+    time_t coherent_ttl;        /* TTL for entries kept coherent by events (seconds) */
+    char* coherence_prefixes;   /* Comma-separated prefixes to keep coherent (NULL = all) */
 } cache_config_t;
 
 /* Cache initialization and cleanup */
 int cache_init(const cache_config_t* config);
 void cache_cleanup(void);
 
-/* Cache operations */
+/* Cache operations. cache_get returns a copy (caller frees); cache_acquire returns a
+ * reference to the cached buffer, or NULL on a miss, that must be passed to cache_release.
+ */
 int cache_get(const char* key, char** value, int* dataType);
+cache_value_t* cache_acquire(const char* key);
+void cache_release(cache_value_t* value);
+cache_value_t* cache_value_retain(cache_value_t* value);   /* Another reference; returns value */
 int cache_set(const char* key, const char* value, int dataType, time_t ttl);
+/* Store a value the caller already holds; the cache takes its own reference */
+int cache_set_value(const char* key, cache_value_t* value, time_t ttl);
+/* New value with refcount 1 (release with cache_release) */
+cache_value_t* cache_value_create(const char* data, int dataType);
 int cache_delete(const char* key);
 int cache_exists(const char* key);
 void cache_clear(void);
 
 /* Cache management */
 int cache_expire_entries(void);     /* Remove expired entries */
-int cache_evict_lru(int count);     /* Evict least recently used entries */
+int cache_evict_lru(int count);     /* Evict up to count least recently used entries */
 cache_stats_t* cache_get_stats(void);
 void cache_reset_stats(void);
 
-/* Cache persistence */
+/* Cache persistence. The JSON files are a readable export; snapshots are the binary
+ * warm-start format (mmap-loaded, checksummed). Loads and cache_save_snapshot return
+ * the entry count; every call returns -1 on failure.
+ */
 int cache_save_to_file(const char* filename);
 int cache_load_from_file(const char* filename);
+int cache_save_snapshot(const char* filename);
+int cache_load_snapshot(const char* filename);
 
-/* Wildcard cache operations */
+/* Wildcard cache operations. A pattern ending in '*' matches every key with that prefix
+ * (resolved through the prefix index in cache_index.h); otherwise it names one key.
+ */
 int cache_get_wildcard(const char* prefix, char*** keys, char*** values, int** dataTypes, int* count);
 int cache_invalidate_wildcard(const char* prefix);
+void cache_free_wildcard_results(char** keys, char** values, int* dataTypes, int count);
+/* Complete subtrees: after a wildcard GET has cached every child of prefix (ending in '.'),
+ * mark it so later GETs of the same prefix are answered from the cache for default_ttl.
+ * cache_get_subtree returns 0 only if the subtree is marked and every key is still fresh;
+ * removing or invalidating any key below the prefix drops the mark.
+ */
+int cache_mark_subtree_complete(const char* prefix);
+int cache_get_subtree(const char* prefix, char*** keys, char*** values, int** dataTypes, int* count);
 
 /* Cache configuration at runtime */
 int cache_configure(const cache_config_t* config);
@@ -67,20 +118,60 @@ cache_config_t* cache_get_config(void);
 /* Specialized operations for parodus2rbus */
 int cache_get_parameter(const char* paramName, char** value, int* dataType);
 int cache_set_parameter(const char* paramName, const char* value, int dataType);
+int cache_set_parameter_value(const char* paramName, cache_value_t* value);
 int cache_invalidate_parameter(const char* paramName);
 
-/* Component discovery caching */
+/* Coherent cache mode: parameters in scope are subscribed for value-change events
+ * (see notification_watch_parameter) and then live for coherent_ttl instead of default_ttl.
+ */
+int cache_coherence_wanted(const char* paramName);   /* 1 if paramName should be kept coherent */
+int cache_mark_coherent(const char* paramName);      /* Entry is now backed by a subscription */
+/* Called with the parameter name when a coherent entry is evicted, expires or is cleared
+ * (not when it is invalidated). Runs under a shard lock: it must not block or call back
+ * into the cache. NULL unregisters.
+ */
+typedef void (*cache_coherent_drop_fn)(const char* paramName);
+void cache_set_coherent_drop_callback(cache_coherent_drop_fn fn);
+/* Apply a value-change event in place: updates a cached entry (dataType < 0 keeps the
+ * cached type) or invalidates it when newValue is NULL. Returns 0 if an entry was touched.
+ */
+int cache_apply_value_change(const char* paramName, const char* newValue, int dataType);
+
+/* Component discovery caching. Object paths (instance numbers folded to "{i}", e.g.
+ * "Device.WiFi.AccessPoint.{i}.") map to the RBUS component that provides them, as
+ * learned from rbus_discoverComponentName and the component's element list. Names RBUS
+ * reported as nonexistent are remembered briefly so repeats fail without a round trip.
+ * Component ids are small integers that stay valid until cache_component_cleanup.
+ */
+#define CACHE_COMPONENT_UNKNOWN -1      /* No cached route; discover it */
+#define CACHE_COMPONENT_MISSING -2      /* Recently reported nonexistent */
+
 typedef struct {
     char* component_name;
     char* dbus_path;
-    char** supported_params;
+    char** supported_params;    /* Object paths routed to the component */
     int param_count;
     time_t last_discovered;
 } component_info_t;
 
+/* Component id owning paramName, or CACHE_COMPONENT_UNKNOWN / CACHE_COMPONENT_MISSING */
+int cache_component_lookup(const char* paramName);
+/* Route paramName's object to componentName; returns the component id or -1 */
+int cache_component_learn(const char* paramName, const char* componentName);
+/* Returns 1 exactly once per discovery of a component: the caller loads its element list */
+int cache_component_claim_elements(int componentId);
+const char* cache_component_name(int componentId);
+int cache_component_learn_missing(const char* paramName);
+/* Drop nonexistent-name entries under prefix (NULL = all), e.g. after a table row is added */
+void cache_component_forget_missing(const char* prefix);
+
+/* 0 with a copy of the owner's routes, else CACHE_COMPONENT_UNKNOWN / CACHE_COMPONENT_MISSING */
 int cache_get_component_info(const char* paramName, component_info_t** info);
 int cache_set_component_info(const char* paramName, const component_info_t* info);
 void cache_free_component_info(component_info_t* info);
+/* Forget every route to componentName (NULL = all components), e.g. once it stops answering */
+int cache_invalidate_component_info(const char* componentName);
+void cache_component_cleanup(void);
 
 /* Bulk operations for performance */
 typedef struct {
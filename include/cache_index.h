@@ -0,0 +1,38 @@
+#ifndef PARODUS2RBUS_CACHE_INDEX_H
+#define PARODUS2RBUS_CACHE_INDEX_H
+
+#include <time.h>
+
+/* Prefix index over the cached keys, used by the parameter cache for wildcard
+ * lookups and invalidation. Keys are split into TR-181 path segments ("Device.",
+ * "WiFi.", "SSID.", "1.", "Name"), so a prefix query only walks the matching subtree.
+ * A subtree can also be marked complete: every key under it is known to be cached,
+ * which lets wildcard GETs be answered without RBUS. Removing any key under a
+ * complete subtree clears the mark. Internally locked per subtree (keys are sharded
+ * on their first two segments, e.g. "Device.WiFi."), so only a prefix shorter than
+ * that touches every shard. Safe to call while holding a cache shard lock.
+ */
+
+int cache_index_init(void);
+void cache_index_cleanup(void);
+void cache_index_clear(void);
+
+int cache_index_insert(const char* key);
+void cache_index_remove(const char* key);
+
+/* Collect the keys starting with prefix (a plain string prefix; a partial last
+ * segment matches every sibling that begins with it). *keys is a newly allocated
+ * array of strdup'd names (free with cache_free_wildcard_results style cleanup).
+ * When require_complete is set, returns -1 unless prefix names a subtree marked
+ * complete (itself or an ancestor) whose mark is still valid at now.
+ * Returns 0 on success (possibly *count=0), negative on failure.
+ */
+int cache_index_collect(const char* prefix, int require_complete, time_t now, char*** keys, int* count);
+
+/* Mark the subtree at prefix (ending in '.') complete until the given time */
+int cache_index_mark_complete(const char* prefix, time_t until);
+
+/* Drop complete marks on prefix, its ancestors and everything below it */
+void cache_index_clear_complete(const char* prefix);
+
+#endif /* PARODUS2RBUS_CACHE_INDEX_H */
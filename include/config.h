@@ -3,11 +3,42 @@
 
 #include <stdbool.h>
 
+/* Where OP_SET gets the old value reported in change notifications */
+typedef enum {
+    P2R_SET_PREREAD_AUTO = 0,     /* Fresh cache entry, else read RBUS only if the parameter is notified */
+    P2R_SET_PREREAD_ALWAYS,       /* Always read before writing */
+    P2R_SET_PREREAD_NEVER         /* Fresh cache entry or "unknown"; never an extra RBUS read */
+} p2r_set_preread_t;
+
 typedef struct {
     const char* rbus_component;   /* RBUS component name */
     const char* service_name;     /* Parodus service registration name */
-    const char* mode;             /* "mock" or "parodus" */
+    const char* mode;             /* "mock", "stream" or "parodus" */
     int log_level;                /* 0=ERROR 1=WARN 2=INFO 3=DEBUG */
+    int worker_threads;           /* WRP worker pool size (0 = handle inline) */
+    int queue_depth;              /* Max queued WRP requests before receive blocks */
+    int reply_batch_ms;           /* Pipeline: collect replies this long before sending (0 = send as ready) */
+    int wildcard_cache_fill;      /* Cache values returned by wildcard GETs (0/1) */
+    int cache_coherence;          /* Keep cached params fresh via value-change events (0/1) */
+    const char* coherent_prefixes; /* Comma-separated prefixes for coherence (NULL = all) */
+    int cache_max_entries;        /* Parameter cache capacity before LRU eviction */
+    int cache_max_memory_mb;      /* Parameter cache memory limit in MiB (0 = unlimited) */
+    int notify_coalesce_ms;       /* Fold repeated changes of a parameter within this window (0 = only while queued) */
+    p2r_set_preread_t set_preread; /* Old-value source for SET notifications */
+    int webconfig_spill;          /* Write WebConfig rollback snapshots to disk in the background */
+    const char* cache_snapshot;   /* Binary cache snapshot for warm starts (NULL = none) */
+    int cache_snapshot_interval;  /* Seconds between snapshot saves (0 = at shutdown only) */
+    int metrics_port;             /* Loopback HTTP port serving metrics snapshots (0 = off) */
+    int metrics_interval;         /* Seconds between metrics collections */
+    int stream_flush_ms;          /* Stream mode: longest a reply waits in the output buffer (0 = flush each reply) */
+    int stream_buffer_kb;         /* Stream mode: output buffered before it is written regardless of the timer */
+    int event_batch_ms;           /* Longest an RBUS event waits to be forwarded in a batch (0 = as soon as seen) */
+    int event_batch_max;          /* RBUS events per forwarded batch */
+    int event_ring_size;          /* Events queued for forwarding before new ones are dropped */
+    int trace_sample;             /* Trace 1 in N requests (0 = no sampling) */
+    int trace_slow_ms;            /* Keep the trace of any request taking at least this long (0 = off) */
+    int trace_ring;               /* Finished traces kept in memory */
+    const char* trace_output;     /* Also append kept traces to this file as JSON lines (NULL = none) */
 } p2r_config_t;
 
 extern p2r_config_t g_p2r_config;
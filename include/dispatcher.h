@@ -0,0 +1,50 @@
+#ifndef PARODUS2RBUS_DISPATCHER_H
+#define PARODUS2RBUS_DISPATCHER_H
+
+#include <stdint.h>
+
+/* Bounded work queue drained by a fixed pool of worker threads.
+ * Producers push opaque jobs; every job is handed to the dispatcher's
+ * job function on one of the workers, which owns (and frees) the job.
+ */
+
+typedef void (*dispatcher_job_fn)(void* job);
+/* Batch variant: receives up to batch_max jobs, in queue order, and owns them all */
+typedef void (*dispatcher_batch_fn)(void** jobs, int count);
+
+/* Dispatcher configuration */
+typedef struct {
+    const char* name;           /* Metric prefix, e.g. "dispatcher" */
+    int worker_count;           /* Number of worker threads (>= 1) */
+    int queue_capacity;         /* Maximum queued jobs before submit blocks */
+    int batch_max;              /* Batch dispatchers: most jobs per call (default 32) */
+    int batch_window_ms;        /* Batch dispatchers: wait this long for a batch to fill (0 = take what is queued) */
+} dispatcher_config_t;
+
+/* Dispatcher statistics */
+typedef struct {
+    uint64_t submitted;         /* Jobs accepted into the queue */
+    uint64_t completed;         /* Jobs finished by a worker */
+    uint64_t rejected;          /* Jobs refused because of shutdown */
+    uint32_t queue_depth;       /* Jobs currently waiting */
+    uint32_t max_queue_depth;   /* High-water mark of queue_depth */
+    double last_wait_ms;        /* Queue wait of the most recently started job */
+    double avg_wait_ms;         /* Mean queue wait across completed jobs */
+} dispatcher_stats_t;
+
+typedef struct dispatcher dispatcher_t;
+
+/* Create/destroy. Destroy drains queued jobs before joining the workers. */
+dispatcher_t* dispatcher_create(const dispatcher_config_t* config, dispatcher_job_fn fn);
+dispatcher_t* dispatcher_create_batch(const dispatcher_config_t* config, dispatcher_batch_fn fn);
+void dispatcher_destroy(dispatcher_t* d);
+
+/* Queue a job. Blocks while the queue is full.
+ * Returns 0 on success, -1 if the dispatcher is shutting down (job not taken).
+ */
+int dispatcher_submit(dispatcher_t* d, void* job);
+
+/* Snapshot of the dispatcher counters */
+int dispatcher_get_stats(dispatcher_t* d, dispatcher_stats_t* stats);
+
+#endif /* PARODUS2RBUS_DISPATCHER_H */
@@ -0,0 +1,40 @@
+#ifndef PARODUS2RBUS_EVENT_FORWARDER_H
+#define PARODUS2RBUS_EVENT_FORWARDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* RBUS event forwarding stage. Subscription callbacks copy each event into a bounded
+ * lock-free ring and return; a forwarder thread drains the ring and hands batches of
+ * events, rendered as one JSON document, to the emit function. A full ring drops the
+ * new event instead of blocking the callback thread.
+ */
+
+typedef void (*event_forwarder_emit_fn)(const char* payload_json, size_t len);
+
+typedef struct {
+    int batch_ms;               /* Longest an event waits for its batch to fill */
+    int batch_max;              /* Events per batch; a full batch is sent at once */
+    int ring_size;              /* Ring capacity, rounded up to a power of two */
+    event_forwarder_emit_fn emit;
+} event_forwarder_config_t;
+
+typedef struct {
+    uint64_t forwarded;         /* Events handed to emit */
+    uint64_t dropped;           /* Events lost to a full ring or a stopped forwarder */
+    uint64_t batches;
+} event_forwarder_stats_t;
+
+int event_forwarder_start(const event_forwarder_config_t* config);
+/* Forward what is queued, then stop; later pushes are dropped */
+void event_forwarder_stop(void);
+
+/* Callback side: never blocks. prop_names/prop_values hold prop_count strings that are
+ * copied. Returns 0 if queued, -1 if the event was dropped.
+ */
+int event_forwarder_push(const char* name, const char* type, int prop_count,
+                         const char* const* prop_names, const char* const* prop_values);
+
+int event_forwarder_get_stats(event_forwarder_stats_t* stats);
+
+#endif /* PARODUS2RBUS_EVENT_FORWARDER_H */
@@ -0,0 +1,15 @@
+#ifndef PARODUS2RBUS_METRICS_SERVER_H
+#define PARODUS2RBUS_METRICS_SERVER_H
+
+/* Loopback HTTP endpoint for scrapers. Responses are the collector's pre-rendered
+ * snapshots (see perf_acquire_snapshot), served from a thread of its own:
+ *   GET /metrics       Prometheus text format
+ *   GET /metrics.json  perf_export_json document
+ *   GET /traces        kept request traces (trace_dump_json), rendered per request
+ */
+
+/* Listen on 127.0.0.1:port; returns 0 or -1 if the port cannot be bound */
+int metrics_server_start(int port);
+void metrics_server_stop(void);
+
+#endif /* PARODUS2RBUS_METRICS_SERVER_H */
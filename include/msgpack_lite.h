@@ -0,0 +1,67 @@
+#ifndef PARODUS2RBUS_MSGPACK_LITE_H
+#define PARODUS2RBUS_MSGPACK_LITE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Minimal MessagePack reader/writer for WebConfig blobs. The reader walks a buffer
+ * in place: strings point into the input (not NUL-terminated) and containers only
+ * report their element count, so a document is decoded one value at a time without
+ * building a tree. Extension types are reported but not interpreted.
+ */
+
+typedef enum {
+    MP_NIL,
+    MP_BOOL,
+    MP_INT,     /* negative integers */
+    MP_UINT,    /* non-negative integers */
+    MP_FLOAT,
+    MP_STR,
+    MP_BIN,
+    MP_ARRAY,
+    MP_MAP,
+    MP_EXT
+} mp_type_t;
+
+typedef struct {
+    mp_type_t type;
+    union {
+        int b;
+        int64_t i;
+        uint64_t u;
+        double f;
+        struct { const char* ptr; uint32_t len; } str;  /* MP_STR, MP_BIN, MP_EXT */
+        uint32_t count;                                 /* MP_ARRAY elements, MP_MAP pairs */
+    } v;
+} mp_obj_t;
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    int error;          /* Set on truncated or malformed input; every later read fails */
+} mp_reader_t;
+
+void mp_reader_init(mp_reader_t* r, const void* data, size_t size);
+/* Read the next value (a container's header only). Returns 0 or -1 on error */
+int mp_read(mp_reader_t* r, mp_obj_t* out);
+/* Skip the next value including everything nested in it */
+int mp_skip(mp_reader_t* r);
+/* Compare an MP_STR object with a C string */
+int mp_str_eq(const mp_obj_t* obj, const char* s);
+
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    int failed;         /* Allocation failed; the buffer is incomplete */
+} mp_writer_t;
+
+void mp_write_map(mp_writer_t* w, uint32_t pairs);
+void mp_write_array(mp_writer_t* w, uint32_t count);
+void mp_write_str(mp_writer_t* w, const char* s, size_t len);
+void mp_write_cstr(mp_writer_t* w, const char* s);
+void mp_write_int(mp_writer_t* w, int64_t v);
+void mp_write_bool(mp_writer_t* w, int v);
+void mp_write_nil(mp_writer_t* w);
+
+#endif /* PARODUS2RBUS_MSGPACK_LITE_H */
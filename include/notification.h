@@ -73,7 +73,11 @@ void notification_cleanup(void);
 int notification_register_callback(notification_type_t type, notification_callback_t callback);
 int notification_unregister_callback(notification_type_t type);
 
-/* Send notifications */
+/* Send notifications. These queue the notification for a background sender thread
+ * (registered callbacks still run on the caller) and return 0 once it is queued.
+ * A parameter change still waiting to be sent absorbs newer changes to the same
+ * paramName: the newest value wins and the original oldValue is kept.
+ */
 int notification_send_param_change(const char* paramName, const char* oldValue, 
                                   const char* newValue, int dataType, const char* writeID);
 int notification_send_connected_client(const char* macId, const char* status, 
@@ -83,10 +87,32 @@ int notification_send_device_status(int status, const char* reason, const char*
 int notification_send_factory_reset(const char* reason, const char* deviceId);
 int notification_send_firmware_upgrade(const char* oldVersion, const char* newVersion, const char* deviceId);
 
+/* Nonzero when parameter change notifications are being sent (initialized and enabled) */
+int notification_param_changes_enabled(void);
+
+/* Per-parameter notify attribute, as set through SET_ATTRIBUTES (default off).
+ * notification_param_notify_enabled is nonzero when changes of paramName are being
+ * notified: notifications are enabled and its notify attribute is on.
+ */
+int notification_set_param_notify(const char* paramName, int notify);
+int notification_param_notify_enabled(const char* paramName);
+
 /* Subscribe to RBUS events for automatic notification generation */
 int notification_subscribe_rbus_events(void);
 int notification_unsubscribe_rbus_events(void);
 
+/* Ask for value-change events for one parameter to keep its cache entry coherent.
+ * Events update the cache only; they do not generate parameter change notifications.
+ * Never blocks on RBUS: the subscribe happens in a batch on a background thread, which
+ * marks the entry coherent once it is live. Returns 1 if the subscription is already
+ * live (the caller may mark the entry now), 0 if it was queued, negative if the watch
+ * limit is reached or the parameter failed to subscribe recently.
+ */
+int notification_watch_parameter(const char* paramName);
+
+/* Release the watch when its cache entry goes away; the unsubscribe is also deferred */
+void notification_unwatch_parameter(const char* paramName);
+
 /* Utility functions */
 void notification_free(notification_t* notif);
 char* notification_to_json(const notification_t* notif);
@@ -99,8 +125,10 @@ typedef struct {
     int enable_param_notifications;
     int enable_client_notifications;
     int enable_device_notifications;
-    int notification_retry_count;
-    int notification_timeout_ms;
+    int notification_retry_count;   /* Resend attempts after a failed send */
+    int notification_timeout_ms;    /* Give up on a notification this long after it was queued (0 = no limit) */
+    int coalesce_window_ms;         /* Hold parameter changes this long, folding repeats of the same paramName */
+    int queue_capacity;             /* Queued notifications before new ones are dropped (0 = default) */
 } notification_config_t;
 
 int notification_configure(const notification_config_t* config);
@@ -1,7 +1,14 @@
 #ifndef PARODUS2RBUS_PARODUS_IFACE_H
 #define PARODUS2RBUS_PARODUS_IFACE_H
 
+#include <stddef.h>
+
 /* Start the interface loop (blocking). Returns 0 on clean shutdown. */
 int parodus_iface_run(void);
 
+/* Run one WebPA request payload through the same decode/execute/encode path as a WRP
+ * REQ message, without libparodus. Returns the reply payload (caller frees) or NULL.
+ */
+char* parodus_iface_handle_payload(const char* payload, size_t size, const char* transaction_uuid);
+
 #endif
@@ -35,6 +35,24 @@ typedef struct {
     uint64_t count;      /* Number of measurements in this bucket */
 } perf_histogram_bucket_t;
 
+/* Timer percentile windows: all samples, or those recorded in roughly the last 1 or 5
+ * minutes (windows advance in 20 second steps)
+ */
+typedef enum {
+    PERF_WINDOW_ALL = 0,
+    PERF_WINDOW_1M,
+    PERF_WINDOW_5M,
+    PERF_WINDOW_COUNT
+} perf_window_t;
+
+typedef struct {
+    uint64_t count;         /* Samples in the window */
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double p999_ms;
+} perf_percentiles_t;
+
 /* Performance metric structure */
 typedef struct {
     char name[64];
@@ -61,14 +79,30 @@ typedef struct {
     time_t last_updated;
 } perf_metric_t;
 
+/* Metric handle: an index into the registry, resolved once by name and then
+ * updated without name lookups or the registry lock. Valid until perf_cleanup().
+ */
+typedef int perf_metric_id_t;
+#define PERF_INVALID_METRIC (-1)
+
 /* Performance timer context for measuring operations */
 typedef struct {
     char operation[64];
     perf_category_t category;
-    struct timeval start_time;
+    perf_metric_id_t metric_id; /* "<operation>.latency" timer */
+    struct timespec start_time; /* CLOCK_MONOTONIC */
     int active;
 } perf_timer_t;
 
+/* Caller-owned timer for hot paths: no heap allocation, CLOCK_MONOTONIC based.
+ * Inactive (and all calls no-ops) when performance monitoring is not initialized.
+ */
+typedef struct {
+    perf_metric_id_t metric_id; /* "<operation>.latency" timer */
+    struct timespec start;
+    int active;
+} perf_scope_t;
+
 /* System resource metrics */
 typedef struct {
     double cpu_usage_percent;
@@ -81,7 +115,10 @@ typedef struct {
     double load_average[3];  /* 1, 5, 15 minute load averages */
 } perf_system_metrics_t;
 
-/* Performance configuration */
+/* Performance configuration. With collection enabled a background collector refreshes
+ * the system metrics and re-renders the export snapshot every collection_interval_sec,
+ * also writing it to export_file.
+ */
 typedef struct {
     int enable_collection;
     int collection_interval_sec;
@@ -98,8 +135,12 @@ typedef struct {
     uint64_t rbus_get_count;
     uint64_t rbus_set_count;
     uint64_t rbus_subscribe_count;
+    uint64_t rbus_get_coalesced;        /* Reads that shared another caller's in-flight rbus_get */
+    uint64_t rbus_get_negative_hits;    /* Reads answered from the nonexistent-name cache */
     double avg_rbus_get_latency_ms;
     double avg_rbus_set_latency_ms;
+    double p99_rbus_get_latency_ms;     /* Last 5 minutes */
+    double p99_rbus_set_latency_ms;
     
     /* Cache metrics */
     uint64_t cache_hits;
@@ -139,14 +180,27 @@ int perf_update_counter(const char* name, uint64_t increment);
 int perf_update_gauge(const char* name, double value);
 int perf_record_latency(const char* name, double latency_ms);
 
+/* Handle-based updates (lock-free; invalid ids are ignored) */
+perf_metric_id_t perf_metric_id(const char* name, perf_metric_type_t type, perf_category_t category); /* Registers if needed */
+perf_metric_id_t perf_find_metric_id(const char* name);
+void perf_counter_add_id(perf_metric_id_t id, uint64_t increment);
+void perf_gauge_set_id(perf_metric_id_t id, double value);
+void perf_latency_record_id(perf_metric_id_t id, double latency_ms);
+
 /* Timer operations */
 perf_timer_t* perf_timer_start(const char* operation, perf_category_t category);
 int perf_timer_stop(perf_timer_t* timer);
 double perf_timer_elapsed_ms(const perf_timer_t* timer);
 
+/* Stack timer operations */
+void perf_scope_begin(perf_scope_t* scope, const char* operation, perf_category_t category);
+double perf_scope_elapsed_ms(const perf_scope_t* scope);   /* 0.0 when inactive */
+double perf_scope_end(perf_scope_t* scope);                /* Records once; returns elapsed ms */
+
 /* Convenience macros for timing operations */
 #define PERF_TIMER_START(op, cat) perf_timer_t* _timer = perf_timer_start(op, cat)
 #define PERF_TIMER_STOP() do { if (_timer) perf_timer_stop(_timer); _timer = NULL; } while(0)
+#define PERF_SCOPE(var, op, cat) perf_scope_t var; perf_scope_begin(&var, op, cat)
 
 /* Bulk metric operations */
 int perf_increment_counter(const char* name);
@@ -161,16 +215,35 @@ int perf_enable_system_monitoring(int enable);
 perf_summary_t* perf_get_summary(void);
 char* perf_export_json(void);
 char* perf_export_prometheus(void);
-int perf_export_to_file(const char* filename, const char* format);
+int perf_export_to_file(const char* filename, const char* format);  /* "json" or "prometheus" */
+
+/* Exports pre-rendered by the collector, shared by reference like cache values so
+ * scrapers never build them on a request path
+ */
+typedef struct {
+    int refcount;               /* Updated atomically */
+    char* json;
+    size_t json_len;
+    char* prometheus;
+    size_t prometheus_len;
+    time_t rendered;
+} perf_snapshot_t;
+
+perf_snapshot_t* perf_acquire_snapshot(void);   /* NULL before the first collection */
+void perf_release_snapshot(perf_snapshot_t* snapshot);
 
 /* Metric queries */
 perf_metric_t* perf_get_metric(const char* name);
 perf_metric_t** perf_get_metrics_by_category(perf_category_t category, int* count);
 char** perf_list_metric_names(int* count);
 
-/* Statistics and analysis */
+/* Statistics and analysis (timers and histograms). perf_calculate_percentile returns the
+ * all-time value in ms, 0.0 without samples or -1.0 for an unknown metric. The latency
+ * distribution lists the non-empty buckets by upper bound; the caller frees *buckets.
+ */
 double perf_calculate_percentile(const char* timer_name, double percentile);
 int perf_get_latency_distribution(const char* timer_name, perf_histogram_bucket_t** buckets, int* count);
+int perf_get_percentiles(const char* timer_name, perf_window_t window, perf_percentiles_t* out);
 
 /* Performance alerts */
 typedef void (*perf_alert_callback_t)(const char* metric_name, double value, double threshold, const char* message);
@@ -184,6 +257,9 @@ double perf_get_timestamp_ms(void);
 
 /* Integration hooks for automatic instrumentation */
 void perf_hook_rbus_operation(const char* operation, const char* param, double latency_ms, int success);
+/* A read joined an outstanding rbus_get / was refused from the negative cache */
+void perf_hook_rbus_get_coalesced(void);
+void perf_hook_rbus_get_negative_hit(void);
 void perf_hook_cache_operation(const char* operation, int hit, double latency_ms);
 void perf_hook_webconfig_transaction(const char* transaction_id, int param_count, double latency_ms, int success);
 void perf_hook_notification_sent(const char* type, double latency_ms, int success);
@@ -2,6 +2,7 @@
 #define PARODUS2RBUS_PROTOCOL_H
 
 #include <cJSON.h>
+#include "cache.h"
 
 /* Operation types supported by the protocol */
 typedef enum {
@@ -55,6 +56,20 @@ cJSON* protocol_build_attributes_response(const char* id, int status, cJSON* att
 /* Process a request JSON object and return response (caller frees). */
 cJSON* protocol_handle_request(cJSON* root);
 
+/* Cached values a response borrows: GET results reference the cache buffers through
+ * cJSON string references instead of copies. Print the response, delete it, then
+ * call protocol_pins_release. Start from a zeroed protocol_pins_t.
+ */
+typedef struct {
+    cache_value_t** values;
+    int count;
+    int capacity;
+} protocol_pins_t;
+
+cJSON* protocol_handle_request_pinned(cJSON* root, protocol_pins_t* pins);
+int protocol_pins_add(protocol_pins_t* pins, cache_value_t* value);
+void protocol_pins_release(protocol_pins_t* pins);
+
 /* Helper functions */
 operation_type_t parse_operation_type(const char* op_string);
 void free_table_row(table_row_t* row);
@@ -11,7 +11,32 @@ int rbus_adapter_get(const char* param, char** outValue); /* Caller frees *outVa
  * Returns 0 on success; outValue must be freed by caller. outType set to webpa code.
  */
 int rbus_adapter_get_typed(const char* param, char** outValue, int* outType);
+/* Batched typed get: serves what it can from the cache and fetches all misses with a
+ * single rbus_getExt, caching the results. outValues/outTypes/outRcs must hold count
+ * entries; outRcs[i] uses the rbus_adapter_get_typed codes and outValues[i] (caller
+ * frees) is set only when outRcs[i] == 0. Returns the number of values fetched, or
+ * negative on invalid arguments.
+ */
+int rbus_adapter_get_typed_bulk(const char** params, int count, char** outValues, int* outTypes, int* outRcs);
+/* Same as rbus_adapter_get_typed_bulk, but returns references to the cached buffers
+ * (value and type in one cache_value_t) instead of copies; release each non-NULL
+ * outValues[i] with cache_release.
+ */
+int rbus_adapter_get_typed_bulk_ref(const char** params, int count, cache_value_t** outValues, int* outRcs);
 int rbus_adapter_set(const char* param, const char* value);
+/* Batched typed set: converts each value to the native RBUS type for its WebPA
+ * dataType and commits all of them with one rbus_setMulti. Entries with a NULL name
+ * or value are skipped. Returns 0 on success (and invalidates the cached values), -2
+ * if RBUS rejected the batch, -1 on invalid arguments. A batch spanning several
+ * providers is not all-or-nothing; see rbus_adapter_set_typed_bulk_committed.
+ */
+int rbus_adapter_set_typed_bulk(const table_param_t* params, int count);
+/* As rbus_adapter_set_typed_bulk, also reporting what was written: RBUS commits one
+ * rbus_setMulti per provider, so a rejected batch may still have changed the groups
+ * committed before it. committed[i] (count entries) is set to 1 for each params[i]
+ * that was written, 0 otherwise. committed may be NULL.
+ */
+int rbus_adapter_set_typed_bulk_committed(const table_param_t* params, int count, int* committed);
 
 /* Wildcard expansion: given a parameter ending with a '.', enumerate immediate children properties.
  * Returns a newly allocated NULL-terminated array of strdup'd parameter names in *list (caller frees each and the array),
@@ -19,6 +44,14 @@ int rbus_adapter_set(const char* param, const char* value);
  */
 int rbus_adapter_expand_wildcard(const char* prefix, char*** list, int* count);
 
+/* Wildcard get: like expand_wildcard but keeps the values from the same rbus_getExt result,
+ * returning name/value/dataType triples in *list (free with rbus_adapter_free_params).
+ * When fillCache is true every returned value is also stored in the parameter cache.
+ * Returns 0 on success (possibly *count=0), negative on failure.
+ */
+int rbus_adapter_get_wildcard(const char* prefix, table_param_t** list, int* count, bool fillCache);
+void rbus_adapter_free_params(table_param_t* list, int count);
+
 /* Table operations */
 int rbus_adapter_add_table_row(const char* tableName, table_row_t* rowData, char** newRowName);
 int rbus_adapter_delete_table_row(const char* rowName);
@@ -0,0 +1,78 @@
+#ifndef PARODUS2RBUS_TRACE_H
+#define PARODUS2RBUS_TRACE_H
+
+#include <stdint.h>
+
+/* Request-scoped tracing. A trace follows one request (keyed by the WRP transaction_uuid,
+ * or the request id outside Parodus mode) through the threads that handle it and collects
+ * timed spans: decode, auth, cache lookups, each RBUS call, WebConfig execution and encode.
+ * Finished traces that were sampled or ran slow are kept in a bounded ring, which can be
+ * dumped as JSON and, optionally, streamed to a file by a background writer.
+ *
+ * Span sites cost one thread-local load when the current request is not traced.
+ */
+
+#define TRACE_ID_MAX 64
+#define TRACE_OP_MAX 32
+#define TRACE_DETAIL_MAX 64
+#define TRACE_SPANS_MAX 32
+
+typedef struct {
+    const char* name;               /* Static string, e.g. "rbus_get" */
+    char detail[TRACE_DETAIL_MAX];  /* Parameter or operation, truncated */
+    uint32_t start_us;              /* Offset from the start of the trace */
+    uint32_t duration_us;
+    int code;                       /* RBUS error for RBUS spans, hits for cache spans, else status */
+} trace_span_t;
+
+typedef struct {
+    char id[TRACE_ID_MAX];
+    char op[TRACE_OP_MAX];
+    uint64_t start_ns;              /* CLOCK_MONOTONIC */
+    double start_wall;              /* Wall-clock seconds, for correlating with logs */
+    uint32_t duration_us;
+    int status;                     /* Response status, 0 if none */
+    int sampled;                    /* Chosen by 1-in-N sampling rather than for being slow */
+    int span_count;
+    int spans_dropped;              /* Spans beyond TRACE_SPANS_MAX */
+    trace_span_t spans[TRACE_SPANS_MAX];
+} trace_t;
+
+typedef struct {
+    int sample_every;               /* Keep 1 in N requests (0 = no sampling) */
+    int slow_ms;                    /* Keep any request that took at least this long (0 = off) */
+    int ring_size;                  /* Finished traces kept for dumping */
+    const char* output;             /* Append kept traces here as JSON lines (NULL = none) */
+} trace_config_t;
+
+/* Trace of the request the calling thread is working on, NULL if untraced */
+extern __thread trace_t* t_trace_current;
+
+/* Tracing stays off (every call a no-op) unless sample_every or slow_ms is set */
+int trace_init(const trace_config_t* config);
+void trace_cleanup(void);
+
+/* Start a trace for a new request; NULL when this request is not traced. id may be NULL
+ * and set later with trace_set_id.
+ */
+trace_t* trace_begin(const char* id);
+void trace_set_id(trace_t* trace, const char* id);
+void trace_set_result(trace_t* trace, const char* op, int status);
+/* Close the trace, keep it if it was sampled or slow, and free it otherwise */
+void trace_finish(trace_t* trace);
+
+/* Make trace the calling thread's current trace (NULL detaches) */
+static inline void trace_attach(trace_t* trace) { t_trace_current = trace; }
+
+uint64_t trace_now_ns(void);
+void trace_span_record(const char* name, const char* detail, uint64_t start_ns, int code);
+
+/* Span start: 0 (and no clock read) when the current request is not traced */
+#define TRACE_SPAN_START() (t_trace_current ? trace_now_ns() : 0)
+#define TRACE_SPAN_END(start, name, detail, code) \
+    do { if (start) trace_span_record(name, detail, start, code); } while (0)
+
+/* Kept traces as a JSON document (caller frees) */
+char* trace_dump_json(void);
+
+#endif /* PARODUS2RBUS_TRACE_H */
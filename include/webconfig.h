@@ -71,6 +71,7 @@ typedef struct {
     int enable_rollback;
     int enable_validation;
     char* backup_directory;
+    int spill_backups;        /* Also write rollback snapshots to backup_directory (asynchronously) */
 } webconfig_config_t;
 
 /* WebConfig statistics */
@@ -90,9 +91,26 @@ int webconfig_init(const webconfig_config_t* config);
 void webconfig_cleanup(void);
 
 /* Transaction management */
+/* Transactions only wait for running transactions whose parameter names overlap
+ * theirs (one name a prefix of the other); disjoint transactions run concurrently.
+ */
 int webconfig_execute_transaction(const webconfig_transaction_t* transaction, webconfig_result_t** result);
+/* Queue a copy of the transaction for a background worker and return its id in
+ * *transaction_id (caller frees) right away. Completion is reported through the
+ * notification callback, and the result can then be taken with
+ * webconfig_take_transaction_result. Returns 0 when queued, -2 if the id is already
+ * pending or too many transactions are pending, -1 on other errors.
+ */
+int webconfig_execute_transaction_async(const webconfig_transaction_t* transaction, char** transaction_id);
 int webconfig_rollback_transaction(const char* transaction_id);
+/* Status of a recent transaction (PENDING while queued or running). The table keeps
+ * the most recent 100 transactions. Returns -1 if id is unknown.
+ */
 int webconfig_get_transaction_status(const char* transaction_id, webconfig_status_t* status);
+/* Move the result of a finished async transaction to the caller (free with
+ * webconfig_free_result). Returns -2 while it is pending, -1 if there is none.
+ */
+int webconfig_take_transaction_result(const char* transaction_id, webconfig_result_t** result);
 
 /* Bulk operations */
 int webconfig_bulk_set(const webconfig_param_t* params, int count, int atomic, webconfig_result_t** result);
@@ -101,10 +119,24 @@ int webconfig_bulk_delete(const char** param_names, int count, int atomic, webco
 
 /* Validation and backup */
 int webconfig_validate_transaction(const webconfig_transaction_t* transaction);
-int webconfig_create_backup(const char* backup_name);
+/* Capture the current values of param_names and queue them for writing to
+ * backup_directory as <backup_name>.backup. Requires spill_backups; returns 0 once
+ * queued, without waiting for the file. Atomic transactions keep their own in-memory
+ * snapshot and do not need this.
+ */
+int webconfig_create_backup(const char* backup_name, const char** param_names, int count);
+/* Apply a spilled backup with one batched set */
 int webconfig_restore_backup(const char* backup_name);
 
-/* Configuration management */
+/* Configuration management. A blob is a list of parameter values applied as sets.
+ * JSON blobs use the transaction format and run as a transaction. With
+ * WEBCONFIG_BIN_SUPPORT, MessagePack blobs ({"transaction_id", "atomic",
+ * "parameters": [{"name", "value", "dataType"}]}) are streamed: decoded in place and
+ * applied in fixed-size rbus_setMulti chunks, run exclusively of other transactions,
+ * and not subject to max_transaction_size. Their result lists only the failed
+ * parameters. Export returns the current values of the last applied blob's
+ * parameters, as MessagePack when binary support is built in, else JSON.
+ */
 int webconfig_apply_config_blob(const char* blob_data, size_t blob_size, webconfig_result_t** result);
 int webconfig_export_config_blob(char** blob_data, size_t* blob_size);
 
@@ -0,0 +1,193 @@
+#include "arena.h"
+#include "log.h"
+#include <cJSON.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_DEFAULT_CHUNK (16 * 1024)
+#define ARENA_POOL_MAX 64
+
+typedef struct arena_chunk {
+    struct arena_chunk* next;
+    size_t size;
+    size_t used;
+    /* payload follows the (aligned) header */
+} arena_chunk_t;
+
+#define ARENA_CHUNK_HEADER ((sizeof(arena_chunk_t) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+struct arena {
+    arena_chunk_t* head;    /* Chunk currently being filled; newest first */
+    arena_chunk_t* first;   /* Oldest chunk, kept across resets */
+    size_t chunk_size;
+    struct arena* next_free; /* Pool link while idle */
+};
+
+/* Arena whose memory cJSON frees must ignore, and whether new cJSON allocations use it */
+static __thread arena_t* t_json_arena = NULL;
+static __thread int t_json_active = 0;
+
+/* Idle arenas kept for reuse, so a burst does not leave RSS behind */
+static struct {
+    pthread_mutex_t mutex;
+    arena_t* free_list;
+    int free_count;
+} g_pool = { PTHREAD_MUTEX_INITIALIZER, NULL, 0 };
+
+static char* chunk_data(arena_chunk_t* chunk) {
+    return (char*)chunk + ARENA_CHUNK_HEADER;
+}
+
+static arena_chunk_t* arena_new_chunk(size_t size) {
+    arena_chunk_t* chunk = malloc(ARENA_CHUNK_HEADER + size);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+arena_t* arena_create(size_t chunk_size) {
+    arena_t* arena = calloc(1, sizeof(arena_t));
+    if (!arena) return NULL;
+
+    arena->chunk_size = chunk_size > 0 ? chunk_size : ARENA_DEFAULT_CHUNK;
+    arena->first = arena_new_chunk(arena->chunk_size);
+    if (!arena->first) {
+        free(arena);
+        return NULL;
+    }
+    arena->head = arena->first;
+    return arena;
+}
+
+void arena_destroy(arena_t* arena) {
+    if (!arena) return;
+
+    arena_chunk_t* chunk = arena->head;
+    while (chunk) {
+        arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    if (t_json_arena == arena) {
+        t_json_arena = NULL;
+        t_json_active = 0;
+    }
+    free(arena);
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    if (!arena) return NULL;
+
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size == 0) size = ARENA_ALIGN;
+
+    arena_chunk_t* chunk = arena->head;
+    if (chunk->size - chunk->used < size) {
+        /* Oversized requests get a dedicated chunk; it is released on reset */
+        chunk = arena_new_chunk(size > arena->chunk_size ? size : arena->chunk_size);
+        if (!chunk) return NULL;
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
+
+    void* ptr = chunk_data(chunk) + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+void arena_reset(arena_t* arena) {
+    if (!arena) return;
+
+    arena_chunk_t* chunk = arena->head;
+    while (chunk != arena->first) {
+        arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->first->used = 0;
+    arena->head = arena->first;
+}
+
+int arena_contains(const arena_t* arena, const void* ptr) {
+    if (!arena || !ptr) return 0;
+
+    const char* p = (const char*)ptr;
+    for (arena_chunk_t* chunk = arena->head; chunk; chunk = chunk->next) {
+        const char* base = chunk_data(chunk);
+        if (p >= base && p < base + chunk->size) return 1;
+    }
+    return 0;
+}
+
+arena_t* arena_acquire(void) {
+    pthread_mutex_lock(&g_pool.mutex);
+    arena_t* arena = g_pool.free_list;
+    if (arena) {
+        g_pool.free_list = arena->next_free;
+        g_pool.free_count--;
+    }
+    pthread_mutex_unlock(&g_pool.mutex);
+
+    if (!arena) arena = arena_create(ARENA_DEFAULT_CHUNK);
+    if (arena) arena->next_free = NULL;
+    return arena;
+}
+
+void arena_release(arena_t* arena) {
+    if (!arena) return;
+
+    arena_reset(arena);
+    if (t_json_arena == arena) {
+        t_json_arena = NULL;
+        t_json_active = 0;
+    }
+    pthread_mutex_lock(&g_pool.mutex);
+    if (g_pool.free_count < ARENA_POOL_MAX) {
+        arena->next_free = g_pool.free_list;
+        g_pool.free_list = arena;
+        g_pool.free_count++;
+        arena = NULL;
+    }
+    pthread_mutex_unlock(&g_pool.mutex);
+    /* Pool already holds enough idle arenas */
+    arena_destroy(arena);
+}
+
+static void* arena_json_malloc(size_t size) {
+    if (t_json_active) {
+        void* ptr = arena_alloc(t_json_arena, size);
+        if (ptr) return ptr;
+    }
+    return malloc(size);
+}
+
+static void arena_json_free(void* ptr) {
+    if (!ptr) return;
+    /* Arena memory is released by arena_reset */
+    if (t_json_arena && arena_contains(t_json_arena, ptr)) return;
+    free(ptr);
+}
+
+void arena_json_install(void) {
+    cJSON_Hooks hooks = { arena_json_malloc, arena_json_free };
+    cJSON_InitHooks(&hooks);
+    LOGD("cJSON allocation hooks installed (arena chunk %d bytes)", ARENA_DEFAULT_CHUNK);
+}
+
+void arena_json_begin(arena_t* arena) {
+    t_json_arena = arena;
+    t_json_active = arena != NULL;
+}
+
+void arena_json_end(void) {
+    t_json_active = 0;
+}
+
+void arena_json_bind(arena_t* arena) {
+    t_json_arena = arena;
+    t_json_active = 0;
+}
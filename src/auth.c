@@ -16,21 +16,120 @@
 #include <arpa/inet.h>
 
 /* Maximum storage limits */
-#define MAX_USERS 1000
-#define MAX_SESSIONS 500
 #define MAX_ACL_ENTRIES 100
-#define MAX_TOKENS 1000
+
+#define AUTH_INDEX_MIN_BUCKETS 64
+
+/* String-keyed hash index over one of the stores. Keys point into the items */
+typedef struct auth_index_node {
+    const char* key;
+    uint32_t hash;
+    void* item;
+    struct auth_index_node* next;
+} auth_index_node_t;
+
+typedef struct {
+    auth_index_node_t** buckets;
+    uint32_t mask;                  /* Bucket count - 1 */
+    uint32_t count;
+} auth_index_t;
+
+#define AUTH_INDEX_FOREACH(idx, node) \
+    for (uint32_t b_ = 0; (idx)->buckets && b_ <= (idx)->mask; b_++) \
+        for (auth_index_node_t* node = (idx)->buckets[b_]; node; node = node->next)
+
+/* Min-heap of expiry deadlines; each queued record knows its slot so it can leave early */
+typedef struct {
+    time_t deadline;
+    int heap_pos;                   /* -1 while not queued */
+} auth_expiry_t;
+
+typedef struct {
+    auth_expiry_t** items;
+    int count;
+    int capacity;
+} auth_expiry_heap_t;
+
+typedef struct {
+    auth_expiry_t expiry;           /* First member: heap entries cast back to the record */
+    auth_token_info_t* info;
+} auth_token_rec_t;
+
+typedef struct {
+    auth_expiry_t expiry;
+    auth_session_t* session;
+} auth_session_rec_t;
+
+/* Compiled ACL: a character trie over the entry patterns. Each node records the
+ * earliest entry whose pattern ends there, so one walk along a name finds the same
+ * entry as the original first-match scan.
+ */
+typedef struct {
+    int child;              /* First child node, -1 if none */
+    int sibling;            /* Next child of the same parent, -1 if none */
+    int prefix_rule;        /* Earliest "pattern*" entry ending here, -1 if none */
+    int exact_rule;         /* Earliest exact pattern ending here, -1 if none */
+    char ch;
+} acl_node_t;
+
+typedef struct {
+    auth_permission_t required_permission;
+    auth_role_t minimum_role;
+    int require_authentication;
+} acl_rule_t;
+
+typedef struct acl_trie {
+    acl_node_t* nodes;      /* nodes[0] is the root */
+    int node_count;
+    int node_capacity;
+    acl_rule_t* rules;      /* Copies of the entries, by ACL position */
+    struct acl_trie* retired_next;
+} acl_trie_t;
+
+/* Outcome of an ACL check, including which counter a denial bumps */
+typedef enum {
+    ACL_ALLOW,
+    ACL_DENY,
+    ACL_DENY_UNAUTHORIZED,
+    ACL_DENY_PERMISSION,
+    ACL_DENY_UNMATCHED
+} acl_decision_t;
+
+/* Per-thread decision cache keyed by (role, credentials, object path). A slot is
+ * only valid for the ACL generation it was filled under.
+ */
+#define ACL_CACHE_SLOTS 64
+#define ACL_CACHE_PREFIX_MAX 128
+
+typedef struct {
+    uint64_t generation;    /* 0 = empty */
+    uint32_t hash;
+    auth_role_t role;
+    auth_permission_t permissions;
+    int authenticated;
+    acl_decision_t decision;
+    char prefix[ACL_CACHE_PREFIX_MAX];
+} acl_cache_slot_t;
+
+static __thread acl_cache_slot_t t_acl_cache[ACL_CACHE_SLOTS];
+/* Bumped on every ACL change; never reset, so stale slots cannot match after reinit */
+static uint64_t g_acl_generation = 1;
 
 /* Token and session storage */
 static struct {
-    auth_user_t* users[MAX_USERS];
-    auth_session_t* sessions[MAX_SESSIONS];
+    auth_index_t users;             /* user_id -> auth_user_t */
+    auth_index_t users_by_name;     /* username -> auth_user_t */
+    auth_index_t sessions;          /* session_id -> auth_session_rec_t */
+    auth_index_t tokens;            /* token string -> auth_token_rec_t (API keys included) */
+    auth_expiry_heap_t session_expiry;
+    auth_expiry_heap_t token_expiry;
     auth_acl_entry_t* acl_entries[MAX_ACL_ENTRIES];
-    auth_token_info_t* active_tokens[MAX_TOKENS];
     int user_count;
     int session_count;
     int acl_count;
     int token_count;
+    acl_trie_t* acl_trie;           /* Published for lock-free reads; NULL until compiled */
+    acl_trie_t* acl_retired;        /* Replaced tries, kept until cleanup for late readers */
     
     auth_config_t config;
     auth_stats_t stats;
@@ -38,6 +137,9 @@ static struct {
     int initialized;
 } g_auth = {0};
 
+static void acl_trie_free(acl_trie_t* trie);
+static void acl_invalidate_locked(void);
+
 /* Helper functions */
 static char* generate_random_string(int length) {
     const char charset[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
@@ -68,31 +170,267 @@ static int is_session_expired(const auth_session_t* session) {
             (now - session->last_activity) > g_auth.config.session_timeout_sec);
 }
 
-static int find_user_index(const char* user_id) {
-    for (int i = 0; i < g_auth.user_count; i++) {
-        if (g_auth.users[i] && strcmp(g_auth.users[i]->user_id, user_id) == 0) {
-            return i;
+static uint32_t auth_hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void* auth_index_find(const auth_index_t* idx, const char* key) {
+    if (!idx->buckets || !key) return NULL;
+    uint32_t hash = auth_hash(key);
+    for (auth_index_node_t* node = idx->buckets[hash & idx->mask]; node; node = node->next) {
+        if (node->hash == hash && strcmp(node->key, key) == 0) return node->item;
+    }
+    return NULL;
+}
+
+static int auth_index_grow(auth_index_t* idx) {
+    uint32_t count = idx->buckets ? (idx->mask + 1) * 2 : AUTH_INDEX_MIN_BUCKETS;
+    auth_index_node_t** buckets = calloc(count, sizeof(auth_index_node_t*));
+    if (!buckets) return -1;
+    for (uint32_t b = 0; idx->buckets && b <= idx->mask; b++) {
+        auth_index_node_t* node = idx->buckets[b];
+        while (node) {
+            auth_index_node_t* next = node->next;
+            node->next = buckets[node->hash & (count - 1)];
+            buckets[node->hash & (count - 1)] = node;
+            node = next;
         }
     }
-    return -1;
+    free(idx->buckets);
+    idx->buckets = buckets;
+    idx->mask = count - 1;
+    return 0;
 }
 
-static int find_session_index(const char* session_id) {
-    for (int i = 0; i < g_auth.session_count; i++) {
-        if (g_auth.sessions[i] && strcmp(g_auth.sessions[i]->session_id, session_id) == 0) {
-            return i;
+static int auth_index_add(auth_index_t* idx, const char* key, void* item) {
+    if (!key) return -1;
+    /* Keep chains about one node long; a failed resize only makes them longer */
+    if (!idx->buckets || idx->count > idx->mask) {
+        if (auth_index_grow(idx) != 0 && !idx->buckets) return -1;
+    }
+    auth_index_node_t* node = malloc(sizeof(auth_index_node_t));
+    if (!node) return -1;
+    node->key = key;
+    node->hash = auth_hash(key);
+    node->item = item;
+    node->next = idx->buckets[node->hash & idx->mask];
+    idx->buckets[node->hash & idx->mask] = node;
+    idx->count++;
+    return 0;
+}
+
+static void auth_index_remove(auth_index_t* idx, const char* key, const void* item) {
+    if (!idx->buckets || !key) return;
+    uint32_t hash = auth_hash(key);
+    auth_index_node_t** link = &idx->buckets[hash & idx->mask];
+    while (*link) {
+        auth_index_node_t* node = *link;
+        if (node->item == item) {
+            *link = node->next;
+            free(node);
+            idx->count--;
+            return;
         }
+        link = &node->next;
     }
-    return -1;
 }
 
-static int find_token_index(const char* token) {
-    for (int i = 0; i < g_auth.token_count; i++) {
-        if (g_auth.active_tokens[i] && strcmp(g_auth.active_tokens[i]->token, token) == 0) {
-            return i;
+static void auth_index_free(auth_index_t* idx) {
+    for (uint32_t b = 0; idx->buckets && b <= idx->mask; b++) {
+        auth_index_node_t* node = idx->buckets[b];
+        while (node) {
+            auth_index_node_t* next = node->next;
+            free(node);
+            node = next;
         }
     }
-    return -1;
+    free(idx->buckets);
+    memset(idx, 0, sizeof(*idx));
+}
+
+static void expiry_swap(auth_expiry_heap_t* heap, int a, int b) {
+    auth_expiry_t* tmp = heap->items[a];
+    heap->items[a] = heap->items[b];
+    heap->items[b] = tmp;
+    heap->items[a]->heap_pos = a;
+    heap->items[b]->heap_pos = b;
+}
+
+static void expiry_sift(auth_expiry_heap_t* heap, int pos) {
+    while (pos > 0 && heap->items[(pos - 1) / 2]->deadline > heap->items[pos]->deadline) {
+        expiry_swap(heap, pos, (pos - 1) / 2);
+        pos = (pos - 1) / 2;
+    }
+    for (;;) {
+        int smallest = pos;
+        int left = 2 * pos + 1;
+        int right = left + 1;
+        if (left < heap->count && heap->items[left]->deadline < heap->items[smallest]->deadline) smallest = left;
+        if (right < heap->count && heap->items[right]->deadline < heap->items[smallest]->deadline) smallest = right;
+        if (smallest == pos) return;
+        expiry_swap(heap, pos, smallest);
+        pos = smallest;
+    }
+}
+
+/* Queue entry at deadline (0 = never expires, not queued) */
+static void expiry_push(auth_expiry_heap_t* heap, auth_expiry_t* entry, time_t deadline) {
+    entry->deadline = deadline;
+    entry->heap_pos = -1;
+    if (deadline <= 0) return;
+    if (heap->count == heap->capacity) {
+        int capacity = heap->capacity ? heap->capacity * 2 : 64;
+        auth_expiry_t** items = realloc(heap->items, capacity * sizeof(auth_expiry_t*));
+        if (!items) return; /* Still valid; just never purged early */
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+    entry->heap_pos = heap->count;
+    heap->items[heap->count++] = entry;
+    expiry_sift(heap, entry->heap_pos);
+}
+
+static void expiry_remove(auth_expiry_heap_t* heap, auth_expiry_t* entry) {
+    int pos = entry->heap_pos;
+    if (pos < 0 || pos >= heap->count || heap->items[pos] != entry) return;
+    heap->count--;
+    if (pos != heap->count) {
+        heap->items[pos] = heap->items[heap->count];
+        heap->items[pos]->heap_pos = pos;
+        expiry_sift(heap, pos);
+    }
+    entry->heap_pos = -1;
+}
+
+/* Earliest entry whose deadline has passed, dequeued. Records can be freed as soon as
+ * they are due: callers only ever get copies of them. Like is_token_expired and
+ * is_session_expired, a record is still valid during its deadline second.
+ */
+static auth_expiry_t* expiry_pop_due(auth_expiry_heap_t* heap, time_t now) {
+    if (heap->count == 0 || heap->items[0]->deadline >= now) return NULL;
+    auth_expiry_t* entry = heap->items[0];
+    expiry_remove(heap, entry);
+    return entry;
+}
+
+static time_t session_deadline(const auth_session_t* session) {
+    time_t deadline = session->expires_at;
+    if (g_auth.config.session_timeout_sec > 0) {
+        time_t idle = session->last_activity + g_auth.config.session_timeout_sec;
+        if (deadline <= 0 || idle < deadline) deadline = idle;
+    }
+    return deadline;
+}
+
+static void token_rec_free(auth_token_rec_t* rec) {
+    auth_free_token_info(rec->info);
+    free(rec);
+}
+
+static void session_rec_free(auth_session_rec_t* rec) {
+    auth_free_session(rec->session);
+    free(rec);
+}
+
+static int copy_optional(char** dst, const char* src) {
+    *dst = src ? strdup(src) : NULL;
+    return !src || *dst;
+}
+
+/* Caller-owned copies of stored records (free with auth_free_token_info/auth_free_session) */
+static auth_token_info_t* token_info_copy(const auth_token_info_t* src) {
+    auth_token_info_t* copy = malloc(sizeof(auth_token_info_t));
+    if (!copy) return NULL;
+    *copy = *src;
+    copy->token = copy->user_id = copy->issuer = copy->audience = copy->permissions = NULL;
+    if (!copy_optional(&copy->token, src->token) || !copy_optional(&copy->user_id, src->user_id) ||
+        !copy_optional(&copy->issuer, src->issuer) || !copy_optional(&copy->audience, src->audience) ||
+        !copy_optional(&copy->permissions, src->permissions)) {
+        auth_free_token_info(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+static auth_session_t* session_copy(const auth_session_t* src) {
+    auth_session_t* copy = malloc(sizeof(auth_session_t));
+    if (!copy) return NULL;
+    *copy = *src;
+    copy->session_id = copy->user_id = copy->client_ip = copy->user_agent = NULL;
+    if (!copy_optional(&copy->session_id, src->session_id) || !copy_optional(&copy->user_id, src->user_id) ||
+        !copy_optional(&copy->client_ip, src->client_ip) || !copy_optional(&copy->user_agent, src->user_agent)) {
+        auth_free_session(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+/* Free tokens and sessions whose expiry has passed. Each costs O(log n); nothing is
+ * scanned. Caller holds g_auth.mutex. Returns how many sessions were purged.
+ */
+static int auth_purge_expired_locked(time_t now) {
+    auth_expiry_t* entry;
+    while ((entry = expiry_pop_due(&g_auth.token_expiry, now)) != NULL) {
+        auth_token_rec_t* rec = (auth_token_rec_t*)entry;
+        if (rec->info->valid) {
+            rec->info->valid = 0;
+            g_auth.stats.revoked_tokens++;
+        }
+        auth_index_remove(&g_auth.tokens, rec->info->token, rec);
+        g_auth.token_count--;
+        token_rec_free(rec);
+    }
+    
+    int purged = 0;
+    while ((entry = expiry_pop_due(&g_auth.session_expiry, now)) != NULL) {
+        auth_session_rec_t* rec = (auth_session_rec_t*)entry;
+        if (!is_session_expired(rec->session)) {
+            /* Activity moved the idle deadline; queue it again */
+            expiry_push(&g_auth.session_expiry, entry, session_deadline(rec->session));
+            continue;
+        }
+        if (rec->session->active) {
+            rec->session->active = 0;
+            g_auth.stats.active_sessions--;
+            g_auth.stats.expired_sessions++;
+            auth_log_session_expired(rec->session->session_id);
+        }
+        auth_index_remove(&g_auth.sessions, rec->session->session_id, rec);
+        g_auth.session_count--;
+        session_rec_free(rec);
+        purged++;
+    }
+    return purged;
+}
+
+static int auth_add_user_locked(auth_user_t* user) {
+    if (auth_index_add(&g_auth.users, user->user_id, user) != 0) return -1;
+    if (auth_index_add(&g_auth.users_by_name, user->username, user) != 0) {
+        auth_index_remove(&g_auth.users, user->user_id, user);
+        return -1;
+    }
+    g_auth.user_count++;
+    return 0;
+}
+
+/* auth_validate_token with g_auth.mutex held */
+static auth_token_info_t* validate_token_locked(const char* token, auth_token_type_t type) {
+    auth_purge_expired_locked(get_current_time());
+    
+    auth_token_rec_t* rec = auth_index_find(&g_auth.tokens, token);
+    auth_token_info_t* token_info = rec ? rec->info : NULL;
+    
+    if (token_info && token_info->type == type && token_info->valid) {
+        if (!is_token_expired(token_info)) return token_info;
+        token_info->valid = 0;
+        g_auth.stats.revoked_tokens++;
+    }
+    return NULL;
 }
 
 /* Core API Implementation */
@@ -169,19 +507,25 @@ void auth_cleanup(void) {
     auth_save_sessions_to_file(g_auth.config.session_database_file);
     
     /* Clean up users */
-    for (int i = 0; i < g_auth.user_count; i++) {
-        auth_free_user(g_auth.users[i]);
+    AUTH_INDEX_FOREACH(&g_auth.users, node) {
+        auth_free_user(node->item);
     }
+    auth_index_free(&g_auth.users);
+    auth_index_free(&g_auth.users_by_name);
     
     /* Clean up sessions */
-    for (int i = 0; i < g_auth.session_count; i++) {
-        auth_free_session(g_auth.sessions[i]);
+    AUTH_INDEX_FOREACH(&g_auth.sessions, node) {
+        session_rec_free(node->item);
     }
+    auth_index_free(&g_auth.sessions);
+    free(g_auth.session_expiry.items);
     
     /* Clean up tokens */
-    for (int i = 0; i < g_auth.token_count; i++) {
-        auth_free_token_info(g_auth.active_tokens[i]);
+    AUTH_INDEX_FOREACH(&g_auth.tokens, node) {
+        token_rec_free(node->item);
     }
+    auth_index_free(&g_auth.tokens);
+    free(g_auth.token_expiry.items);
     
     /* Clean up ACL entries */
     for (int i = 0; i < g_auth.acl_count; i++) {
@@ -190,6 +534,12 @@ void auth_cleanup(void) {
             free(g_auth.acl_entries[i]);
         }
     }
+    acl_invalidate_locked();
+    while (g_auth.acl_retired) {
+        acl_trie_t* next = g_auth.acl_retired->retired_next;
+        acl_trie_free(g_auth.acl_retired);
+        g_auth.acl_retired = next;
+    }
     
     free(g_auth.config.jwt_secret);
     free(g_auth.config.jwt_issuer);
@@ -260,16 +610,14 @@ char* auth_generate_session_id(void) {
 
 /* User management */
 auth_user_t* auth_create_user(const char* username, const char* email, const char* password, auth_role_t role) {
-    if (!g_auth.initialized || !username || !email || !password || g_auth.user_count >= MAX_USERS) return NULL;
+    if (!g_auth.initialized || !username || !email || !password) return NULL;
     
     pthread_mutex_lock(&g_auth.mutex);
     
     /* Check if username already exists */
-    for (int i = 0; i < g_auth.user_count; i++) {
-        if (g_auth.users[i] && strcmp(g_auth.users[i]->username, username) == 0) {
-            pthread_mutex_unlock(&g_auth.mutex);
-            return NULL; /* Username already exists */
-        }
+    if (auth_index_find(&g_auth.users_by_name, username)) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        return NULL;
     }
     
     auth_user_t* user = calloc(1, sizeof(auth_user_t));
@@ -324,7 +672,11 @@ auth_user_t* auth_create_user(const char* username, const char* email, const cha
     /* Generate API key */
     user->api_key = generate_random_string(32);
     
-    g_auth.users[g_auth.user_count++] = user;
+    if (auth_add_user_locked(user) != 0) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        auth_free_user(user);
+        return NULL;
+    }
     
     pthread_mutex_unlock(&g_auth.mutex);
     
@@ -337,13 +689,7 @@ auth_user_t* auth_authenticate_user(const char* username, const char* password)
     
     pthread_mutex_lock(&g_auth.mutex);
     
-    auth_user_t* user = NULL;
-    for (int i = 0; i < g_auth.user_count; i++) {
-        if (g_auth.users[i] && strcmp(g_auth.users[i]->username, username) == 0) {
-            user = g_auth.users[i];
-            break;
-        }
-    }
+    auth_user_t* user = auth_index_find(&g_auth.users_by_name, username);
     
     if (!user) {
         g_auth.stats.failed_logins++;
@@ -398,13 +744,17 @@ auth_user_t* auth_authenticate_user(const char* username, const char* password)
 
 /* Session management */
 auth_session_t* auth_create_session(const char* user_id, auth_role_t role, const char* client_ip, const char* user_agent) {
-    if (!g_auth.initialized || !user_id || g_auth.session_count >= MAX_SESSIONS) return NULL;
+    if (!g_auth.initialized || !user_id) return NULL;
     
     pthread_mutex_lock(&g_auth.mutex);
+    auth_purge_expired_locked(get_current_time());
     
     auth_session_t* session = calloc(1, sizeof(auth_session_t));
-    if (!session) {
+    auth_session_rec_t* rec = calloc(1, sizeof(auth_session_rec_t));
+    if (!session || !rec) {
         pthread_mutex_unlock(&g_auth.mutex);
+        free(session);
+        free(rec);
         return NULL;
     }
     
@@ -437,35 +787,48 @@ auth_session_t* auth_create_session(const char* user_id, auth_role_t role, const
             break;
     }
     
-    g_auth.sessions[g_auth.session_count++] = session;
+    rec->session = session;
+    if (!session->session_id || auth_index_add(&g_auth.sessions, session->session_id, rec) != 0) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        session_rec_free(rec);
+        return NULL;
+    }
+    expiry_push(&g_auth.session_expiry, &rec->expiry, session_deadline(session));
+    g_auth.session_count++;
     g_auth.stats.active_sessions++;
+    auth_session_t* copy = session_copy(session);
     
     pthread_mutex_unlock(&g_auth.mutex);
     
-    auth_log_session_created(session->session_id, user_id);
-    LOGI("Created session %s for user %s", session->session_id, user_id);
+    if (!copy) return NULL;
+    auth_log_session_created(copy->session_id, user_id);
+    LOGI("Created session %s for user %s", copy->session_id, user_id);
     
-    return session;
+    return copy;
 }
 
 auth_session_t* auth_get_session(const char* session_id) {
     if (!g_auth.initialized || !session_id) return NULL;
     
     pthread_mutex_lock(&g_auth.mutex);
+    auth_purge_expired_locked(get_current_time());
     
-    int index = find_session_index(session_id);
-    auth_session_t* session = (index >= 0) ? g_auth.sessions[index] : NULL;
+    auth_session_rec_t* rec = auth_index_find(&g_auth.sessions, session_id);
+    auth_session_t* session = rec ? rec->session : NULL;
     
-    if (session && is_session_expired(session)) {
+    if (session && session->active && is_session_expired(session)) {
         session->active = 0;
         g_auth.stats.active_sessions--;
         g_auth.stats.expired_sessions++;
         auth_log_session_expired(session_id);
         session = NULL;
+    } else if (session && !session->active) {
+        session = NULL;
     }
     
+    auth_session_t* copy = session ? session_copy(session) : NULL;
     pthread_mutex_unlock(&g_auth.mutex);
-    return session;
+    return copy;
 }
 
 int auth_update_session_activity(const char* session_id) {
@@ -473,9 +836,10 @@ int auth_update_session_activity(const char* session_id) {
     
     pthread_mutex_lock(&g_auth.mutex);
     
-    int index = find_session_index(session_id);
-    if (index >= 0 && g_auth.sessions[index]->active) {
-        g_auth.sessions[index]->last_activity = get_current_time();
+    auth_session_rec_t* rec = auth_index_find(&g_auth.sessions, session_id);
+    if (rec && rec->session->active) {
+        /* The queued deadline is rechecked when it comes due, so it can stay where it is */
+        rec->session->last_activity = get_current_time();
         pthread_mutex_unlock(&g_auth.mutex);
         return 0;
     }
@@ -484,19 +848,54 @@ int auth_update_session_activity(const char* session_id) {
     return -1;
 }
 
+int auth_revoke_session(const char* session_id) {
+    if (!g_auth.initialized || !session_id) return -1;
+    
+    pthread_mutex_lock(&g_auth.mutex);
+    auth_session_rec_t* rec = auth_index_find(&g_auth.sessions, session_id);
+    if (!rec) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        return -1;
+    }
+    if (rec->session->active) {
+        rec->session->active = 0;
+        g_auth.stats.active_sessions--;
+    }
+    expiry_remove(&g_auth.session_expiry, &rec->expiry);
+    auth_index_remove(&g_auth.sessions, rec->session->session_id, rec);
+    g_auth.session_count--;
+    session_rec_free(rec);
+    pthread_mutex_unlock(&g_auth.mutex);
+    return 0;
+}
+
+int auth_cleanup_expired_sessions(void) {
+    if (!g_auth.initialized) return -1;
+    
+    pthread_mutex_lock(&g_auth.mutex);
+    int purged = auth_purge_expired_locked(get_current_time());
+    pthread_mutex_unlock(&g_auth.mutex);
+    return purged;
+}
+
 /* Token management */
 auth_token_info_t* auth_create_token(const char* user_id, auth_role_t role, auth_token_type_t type) {
-    if (!g_auth.initialized || !user_id || g_auth.token_count >= MAX_TOKENS) return NULL;
+    if (!g_auth.initialized || !user_id) return NULL;
     
     pthread_mutex_lock(&g_auth.mutex);
     
+    time_t now = get_current_time();
+    auth_purge_expired_locked(now);
+    
     auth_token_info_t* token_info = calloc(1, sizeof(auth_token_info_t));
-    if (!token_info) {
+    auth_token_rec_t* rec = calloc(1, sizeof(auth_token_rec_t));
+    if (!token_info || !rec) {
         pthread_mutex_unlock(&g_auth.mutex);
+        free(token_info);
+        free(rec);
         return NULL;
     }
     
-    time_t now = get_current_time();
     token_info->type = type;
     token_info->user_id = strdup(user_id);
     token_info->role = role;
@@ -531,21 +930,23 @@ auth_token_info_t* auth_create_token(const char* user_id, auth_role_t role, auth
             break;
     }
     
-    if (token_info->token) {
-        g_auth.active_tokens[g_auth.token_count++] = token_info;
+    rec->info = token_info;
+    if (token_info->token && auth_index_add(&g_auth.tokens, token_info->token, rec) == 0) {
+        /* API keys (expires_at 0) are never queued */
+        expiry_push(&g_auth.token_expiry, &rec->expiry, token_info->expires_at);
+        g_auth.token_count++;
+        auth_token_info_t* copy = token_info_copy(token_info);
         pthread_mutex_unlock(&g_auth.mutex);
+        if (!copy) return NULL;
         
         LOGI("Created %s token for user %s", 
              (type == AUTH_TOKEN_JWT) ? "JWT" : 
              (type == AUTH_TOKEN_API_KEY) ? "API_KEY" : "BEARER", 
              user_id);
         
-        return token_info;
+        return copy;
     } else {
-        free(token_info->user_id);
-        free(token_info->issuer);
-        free(token_info->audience);
-        free(token_info);
+        token_rec_free(rec);
         pthread_mutex_unlock(&g_auth.mutex);
         return NULL;
     }
@@ -555,22 +956,31 @@ auth_token_info_t* auth_validate_token(const char* token, auth_token_type_t type
     if (!g_auth.initialized || !token) return NULL;
     
     pthread_mutex_lock(&g_auth.mutex);
+    auth_token_info_t* token_info = validate_token_locked(token, type);
+    auth_token_info_t* copy = token_info ? token_info_copy(token_info) : NULL;
+    pthread_mutex_unlock(&g_auth.mutex);
+    return copy;
+}
+
+int auth_revoke_token(const char* token) {
+    if (!g_auth.initialized || !token) return -1;
     
-    int index = find_token_index(token);
-    auth_token_info_t* token_info = (index >= 0) ? g_auth.active_tokens[index] : NULL;
-    
-    if (token_info && token_info->type == type && token_info->valid) {
-        if (!is_token_expired(token_info)) {
-            pthread_mutex_unlock(&g_auth.mutex);
-            return token_info;
-        } else {
-            token_info->valid = 0;
-            g_auth.stats.revoked_tokens++;
-        }
+    pthread_mutex_lock(&g_auth.mutex);
+    auth_token_rec_t* rec = auth_index_find(&g_auth.tokens, token);
+    if (!rec) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        return -1;
     }
-    
+    if (rec->info->valid) {
+        rec->info->valid = 0;
+        g_auth.stats.revoked_tokens++;
+    }
+    expiry_remove(&g_auth.token_expiry, &rec->expiry);
+    auth_index_remove(&g_auth.tokens, rec->info->token, rec);
+    g_auth.token_count--;
+    token_rec_free(rec);
     pthread_mutex_unlock(&g_auth.mutex);
-    return NULL;
+    return 0;
 }
 
 /* Access Control */
@@ -590,60 +1000,221 @@ int auth_check_permission(const auth_context_t* context, const char* resource, a
     return 1;
 }
 
-int auth_check_acl(const char* resource, const auth_context_t* context) {
-    if (!g_auth.initialized || !resource) return 0;
-    
-    pthread_mutex_lock(&g_auth.mutex);
+static int acl_trie_node(acl_trie_t* trie, char ch) {
+    if (trie->node_count == trie->node_capacity) {
+        int capacity = trie->node_capacity ? trie->node_capacity * 2 : 64;
+        acl_node_t* nodes = realloc(trie->nodes, capacity * sizeof(acl_node_t));
+        if (!nodes) return -1;
+        trie->nodes = nodes;
+        trie->node_capacity = capacity;
+    }
+    acl_node_t* node = &trie->nodes[trie->node_count];
+    node->child = node->sibling = node->prefix_rule = node->exact_rule = -1;
+    node->ch = ch;
+    return trie->node_count++;
+}
+
+static int acl_trie_child(const acl_trie_t* trie, int node, char ch) {
+    for (int c = trie->nodes[node].child; c >= 0; c = trie->nodes[c].sibling) {
+        if (trie->nodes[c].ch == ch) return c;
+    }
+    return -1;
+}
+
+static void acl_trie_free(acl_trie_t* trie) {
+    if (!trie) return;
+    free(trie->nodes);
+    free(trie->rules);
+    free(trie);
+}
+
+/* Build the trie for the current entries. Caller holds g_auth.mutex */
+static acl_trie_t* acl_trie_compile(void) {
+    acl_trie_t* trie = calloc(1, sizeof(acl_trie_t));
+    if (!trie) return NULL;
+    trie->rules = calloc(g_auth.acl_count > 0 ? g_auth.acl_count : 1, sizeof(acl_rule_t));
+    if (!trie->rules || acl_trie_node(trie, '\0') != 0) {
+        acl_trie_free(trie);
+        return NULL;
+    }
     
-    /* Check ACL entries */
     for (int i = 0; i < g_auth.acl_count; i++) {
         auth_acl_entry_t* entry = g_auth.acl_entries[i];
-        if (!entry) continue;
+        if (!entry || !entry->resource_pattern) continue;
+        trie->rules[i].required_permission = entry->required_permission;
+        trie->rules[i].minimum_role = entry->minimum_role;
+        trie->rules[i].require_authentication = entry->require_authentication;
         
-        /* Simple pattern matching (supports * wildcard at end) */
-        size_t pattern_len = strlen(entry->resource_pattern);
-        if (pattern_len > 0 && entry->resource_pattern[pattern_len - 1] == '*') {
-            if (strncmp(resource, entry->resource_pattern, pattern_len - 1) == 0) {
-                /* Pattern matches */
-                pthread_mutex_unlock(&g_auth.mutex);
-                
-                if (entry->require_authentication && !context->authenticated) {
-                    return 0;
-                }
-                
-                if (context->role < entry->minimum_role) {
-                    return 0;
-                }
-                
-                return auth_check_permission(context, resource, entry->required_permission);
-            }
-        } else {
-            if (strcmp(resource, entry->resource_pattern) == 0) {
-                /* Exact match */
-                pthread_mutex_unlock(&g_auth.mutex);
-                
-                if (entry->require_authentication && !context->authenticated) {
-                    return 0;
-                }
-                
-                if (context->role < entry->minimum_role) {
-                    return 0;
+        /* Same pattern syntax as before: a trailing '*' matches any suffix */
+        size_t len = strlen(entry->resource_pattern);
+        int is_prefix = len > 0 && entry->resource_pattern[len - 1] == '*';
+        if (is_prefix) len--;
+        
+        int node = 0;
+        for (size_t k = 0; k < len && node >= 0; k++) {
+            char ch = entry->resource_pattern[k];
+            int next = acl_trie_child(trie, node, ch);
+            if (next < 0) {
+                next = acl_trie_node(trie, ch);
+                if (next >= 0) {
+                    trie->nodes[next].sibling = trie->nodes[node].child;
+                    trie->nodes[node].child = next;
                 }
-                
-                return auth_check_permission(context, resource, entry->required_permission);
             }
+            node = next;
+        }
+        if (node < 0) {
+            acl_trie_free(trie);
+            return NULL;
+        }
+        /* Entries are visited in ACL order, so the first one to claim a node wins */
+        int* rule = is_prefix ? &trie->nodes[node].prefix_rule : &trie->nodes[node].exact_rule;
+        if (*rule < 0) *rule = i;
+    }
+    return trie;
+}
+
+/* Earliest entry matching resource, or -1. *stable is set when every name under the
+ * same object path (resource up to its last '.', prefix_len bytes) gets the same answer.
+ */
+static int acl_trie_match(const acl_trie_t* trie, const char* resource, size_t prefix_len, int* stable) {
+    int best = trie->nodes[0].prefix_rule;
+    int node = 0;
+    size_t k = 0;
+    *stable = 0;
+    for (; resource[k]; k++) {
+        if (k == prefix_len) {
+            *stable = trie->nodes[node].child < 0 && trie->nodes[node].exact_rule < 0;
+        }
+        node = acl_trie_child(trie, node, resource[k]);
+        if (node < 0) {
+            /* Nothing deeper can match; names sharing the walked part agree */
+            if (k < prefix_len) *stable = 1;
+            return best;
         }
+        int rule = trie->nodes[node].prefix_rule;
+        if (rule >= 0 && (best < 0 || rule < best)) best = rule;
     }
+    int exact = trie->nodes[node].exact_rule;
+    if (exact >= 0 && (best < 0 || exact < best)) best = exact;
+    return best;
+}
+
+/* Current compiled ACL, compiling it after a change. Readers never take the mutex
+ * once it is published.
+ */
+static acl_trie_t* acl_current_trie(void) {
+    acl_trie_t* trie = __atomic_load_n(&g_auth.acl_trie, __ATOMIC_ACQUIRE);
+    if (trie) return trie;
     
+    pthread_mutex_lock(&g_auth.mutex);
+    trie = g_auth.acl_trie;
+    if (!trie) {
+        trie = acl_trie_compile();
+        if (trie) __atomic_store_n(&g_auth.acl_trie, trie, __ATOMIC_RELEASE);
+    }
     pthread_mutex_unlock(&g_auth.mutex);
+    return trie;
+}
+
+/* Drop the compiled ACL and every cached decision. Caller holds g_auth.mutex */
+static void acl_invalidate_locked(void) {
+    acl_trie_t* old = g_auth.acl_trie;
+    __atomic_store_n(&g_auth.acl_trie, NULL, __ATOMIC_RELEASE);
+    if (old) {
+        /* A reader may still be walking it */
+        old->retired_next = g_auth.acl_retired;
+        g_auth.acl_retired = old;
+    }
+    __atomic_add_fetch(&g_acl_generation, 1, __ATOMIC_RELEASE);
+}
+
+static acl_decision_t acl_decide(const acl_rule_t* rule, const auth_context_t* context) {
+    int authenticated = context && context->authenticated;
+    if (!rule) return authenticated ? ACL_ALLOW : ACL_DENY_UNMATCHED;
+    
+    if (rule->require_authentication && !authenticated) return ACL_DENY;
+    if ((context ? context->role : AUTH_ROLE_GUEST) < rule->minimum_role) return ACL_DENY;
+    /* auth_check_permission */
+    if (!authenticated) return ACL_DENY_UNAUTHORIZED;
+    if ((context->permissions & rule->required_permission) != rule->required_permission) {
+        return ACL_DENY_PERMISSION;
+    }
+    return ACL_ALLOW;
+}
+
+/* Apply a decision's side effects (counters, audit log) and return allow/deny */
+static int acl_apply(acl_decision_t decision, const auth_context_t* context, const char* resource) {
+    switch (decision) {
+        case ACL_ALLOW:
+            return 1;
+        case ACL_DENY_UNMATCHED:
+            g_auth.stats.blocked_requests++;
+            return 0;
+        case ACL_DENY_PERMISSION:
+            auth_log_permission_denied(context->user_id, resource, "insufficient_permissions");
+            /* fallthrough */
+        case ACL_DENY_UNAUTHORIZED:
+            g_auth.stats.unauthorized_attempts++;
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+static uint32_t acl_prefix_hash(const char* s, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int auth_check_acl(const char* resource, const auth_context_t* context) {
+    if (!g_auth.initialized || !resource) return 0;
     
-    /* No ACL entry found - default to requiring authentication for write operations */
-    if (!context || !context->authenticated) {
-        g_auth.stats.blocked_requests++;
-        return 0;
+    uint64_t generation = __atomic_load_n(&g_acl_generation, __ATOMIC_ACQUIRE);
+    const char* last_dot = strrchr(resource, '.');
+    size_t prefix_len = last_dot ? (size_t)(last_dot - resource) + 1 : 0;
+    int cacheable = prefix_len > 0 && prefix_len < ACL_CACHE_PREFIX_MAX;
+    
+    auth_role_t role = context ? context->role : AUTH_ROLE_GUEST;
+    auth_permission_t permissions = context ? context->permissions : AUTH_PERM_NONE;
+    int authenticated = context && context->authenticated;
+    uint32_t hash = 0;
+    acl_cache_slot_t* slot = NULL;
+    if (cacheable) {
+        hash = acl_prefix_hash(resource, prefix_len);
+        hash ^= (uint32_t)role * 0x9e3779b1u ^ (uint32_t)permissions * 0x85ebca6bu ^ (uint32_t)authenticated;
+        slot = &t_acl_cache[hash & (ACL_CACHE_SLOTS - 1)];
+        if (slot->generation == generation && slot->hash == hash && slot->role == role &&
+            slot->permissions == permissions && slot->authenticated == authenticated &&
+            strncmp(slot->prefix, resource, prefix_len) == 0 && slot->prefix[prefix_len] == '\0') {
+            return acl_apply(slot->decision, context, resource);
+        }
     }
     
-    return 1;
+    acl_trie_t* trie = acl_current_trie();
+    if (!trie) {
+        LOGE("ACL check failed for %s: could not compile ACL", resource);
+        return 0;
+    }
+    int stable = 0;
+    int rule = acl_trie_match(trie, resource, prefix_len, &stable);
+    acl_decision_t decision = acl_decide(rule >= 0 ? &trie->rules[rule] : NULL, context);
+    
+    if (slot && stable) {
+        slot->generation = generation;
+        slot->hash = hash;
+        slot->role = role;
+        slot->permissions = permissions;
+        slot->authenticated = authenticated;
+        slot->decision = decision;
+        memcpy(slot->prefix, resource, prefix_len);
+        slot->prefix[prefix_len] = '\0';
+    }
+    return acl_apply(decision, context, resource);
 }
 
 /* Setup default ACL for WebPA compatibility */
@@ -684,11 +1255,41 @@ int auth_add_acl_entry(const char* resource_pattern, auth_permission_t permissio
     entry->require_authentication = 1;
     
     g_auth.acl_entries[g_auth.acl_count++] = entry;
+    acl_invalidate_locked();
     
     pthread_mutex_unlock(&g_auth.mutex);
     return 0;
 }
 
+int auth_remove_acl_entry(const char* resource_pattern) {
+    if (!g_auth.initialized || !resource_pattern) return -1;
+    
+    pthread_mutex_lock(&g_auth.mutex);
+    
+    int removed = -1;
+    for (int i = 0; i < g_auth.acl_count; i++) {
+        auth_acl_entry_t* entry = g_auth.acl_entries[i];
+        if (!entry || strcmp(entry->resource_pattern, resource_pattern) != 0) continue;
+        free(entry->resource_pattern);
+        free(entry);
+        /* Keep the remaining entries in order; matching is first-match */
+        memmove(&g_auth.acl_entries[i], &g_auth.acl_entries[i + 1],
+                (g_auth.acl_count - i - 1) * sizeof(auth_acl_entry_t*));
+        g_auth.acl_count--;
+        acl_invalidate_locked();
+        removed = 0;
+        break;
+    }
+    
+    pthread_mutex_unlock(&g_auth.mutex);
+    return removed;
+}
+
+auth_acl_entry_t** auth_get_acl_entries(int* count) {
+    if (count) *count = g_auth.acl_count;
+    return g_auth.acl_entries;
+}
+
 /* Authentication request processing */
 auth_context_t* auth_authenticate_request(const char* token, auth_token_type_t token_type, const char* client_ip, const char* user_agent) {
     if (!g_auth.initialized) return NULL;
@@ -711,14 +1312,15 @@ auth_context_t* auth_authenticate_request(const char* token, auth_token_type_t t
     
     if (!token) return NULL;
     
-    auth_token_info_t* token_info = auth_validate_token(token, token_type);
-    if (!token_info) return NULL;
-    
-    auth_user_t* user = auth_get_user(token_info->user_id);
-    if (!user) return NULL;
-    
-    auth_context_t* context = calloc(1, sizeof(auth_context_t));
-    if (!context) return NULL;
+    /* Two hash lookups under one lock hold; the context copies what it needs */
+    pthread_mutex_lock(&g_auth.mutex);
+    auth_token_info_t* token_info = validate_token_locked(token, token_type);
+    auth_user_t* user = token_info ? auth_index_find(&g_auth.users, token_info->user_id) : NULL;
+    auth_context_t* context = user ? calloc(1, sizeof(auth_context_t)) : NULL;
+    if (!context) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        return NULL;
+    }
     
     context->user_id = strdup(user->user_id);
     context->role = user->role;
@@ -730,6 +1332,7 @@ auth_context_t* auth_authenticate_request(const char* token, auth_token_type_t t
     context->last_activity = get_current_time();
     context->token = strdup(token);
     context->token_type = token_type;
+    pthread_mutex_unlock(&g_auth.mutex);
     
     return context;
 }
@@ -755,41 +1358,43 @@ static auth_permission_t auth_role_to_permissions(auth_role_t role) {
 auth_context_t* auth_authenticate_session(const char* session_id, const char* client_ip) {
     if (!session_id) return NULL;
     
+    pthread_mutex_lock(&g_auth.mutex);
+    
     /* Find session */
-    auth_session_t* session = NULL;
-    for (int i = 0; i < g_auth.session_count; i++) {
-        if (g_auth.sessions[i] && strcmp(g_auth.sessions[i]->session_id, session_id) == 0) {
-            session = g_auth.sessions[i];
-            break;
-        }
-    }
+    time_t current_time = get_current_time();
+    auth_purge_expired_locked(current_time);
+    auth_session_rec_t* rec = auth_index_find(&g_auth.sessions, session_id);
+    auth_session_t* session = rec && rec->session->active ? rec->session : NULL;
     
-    if (!session) return NULL;
+    if (!session) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        return NULL;
+    }
     
     /* Check if session is expired */
-    time_t current_time = get_current_time();
     if (current_time > session->expires_at) {
+        pthread_mutex_unlock(&g_auth.mutex);
         LOGI("Session expired: session=%s", session_id);
         return NULL;
     }
     
     /* Find user */
-    auth_user_t* user = NULL;
-    for (int i = 0; i < g_auth.user_count; i++) {
-        if (g_auth.users[i] && strcmp(g_auth.users[i]->user_id, session->user_id) == 0) {
-            user = g_auth.users[i];
-            break;
-        }
-    }
+    auth_user_t* user = auth_index_find(&g_auth.users, session->user_id);
     
-    if (!user || user->account_locked) return NULL;
+    if (!user || user->account_locked) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        return NULL;
+    }
     
     /* Update session activity */
     session->last_activity = current_time;
     
     /* Create authentication context */
     auth_context_t* context = calloc(1, sizeof(auth_context_t));
-    if (!context) return NULL;
+    if (!context) {
+        pthread_mutex_unlock(&g_auth.mutex);
+        return NULL;
+    }
     
     context->user_id = strdup(user->user_id);
     context->session_id = strdup(session->session_id);
@@ -798,6 +1403,7 @@ auth_context_t* auth_authenticate_session(const char* session_id, const char* cl
     context->permissions = auth_role_to_permissions(user->role);
     context->last_activity = current_time;
     context->token_type = AUTH_TOKEN_SESSION;
+    pthread_mutex_unlock(&g_auth.mutex);
     
     return context;
 }
@@ -879,8 +1485,9 @@ void auth_reset_stats(void) {
     memset(&g_auth.stats, 0, sizeof(g_auth.stats));
     
     /* Recalculate active sessions */
-    for (int i = 0; i < g_auth.session_count; i++) {
-        if (g_auth.sessions[i] && g_auth.sessions[i]->active && !is_session_expired(g_auth.sessions[i])) {
+    AUTH_INDEX_FOREACH(&g_auth.sessions, node) {
+        auth_session_t* session = ((auth_session_rec_t*)node->item)->session;
+        if (session->active && !is_session_expired(session)) {
             g_auth.stats.active_sessions++;
         }
     }
@@ -958,8 +1565,6 @@ int auth_load_users_from_file(const char* filename) {
     if (cJSON_IsArray(users_array)) {
         cJSON* user_obj = NULL;
         cJSON_ArrayForEach(user_obj, users_array) {
-            if (g_auth.user_count >= MAX_USERS) break;
-            
             cJSON* user_id = cJSON_GetObjectItem(user_obj, "user_id");
             cJSON* username = cJSON_GetObjectItem(user_obj, "username");
             cJSON* email = cJSON_GetObjectItem(user_obj, "email");
@@ -974,7 +1579,12 @@ int auth_load_users_from_file(const char* filename) {
                     user->role = cJSON_IsNumber(role) ? role->valueint : AUTH_ROLE_USER;
                     user->created_at = get_current_time();
                     
-                    g_auth.users[g_auth.user_count++] = user;
+                    /* Duplicate ids or names in the file: the first one wins */
+                    if (auth_index_find(&g_auth.users, user->user_id) ||
+                        auth_index_find(&g_auth.users_by_name, user->username) ||
+                        auth_add_user_locked(user) != 0) {
+                        auth_free_user(user);
+                    }
                 }
             }
         }
@@ -991,8 +1601,8 @@ int auth_save_users_to_file(const char* filename) {
     cJSON* root = cJSON_CreateObject();
     cJSON* users_array = cJSON_CreateArray();
     
-    for (int i = 0; i < g_auth.user_count; i++) {
-        auth_user_t* user = g_auth.users[i];
+    AUTH_INDEX_FOREACH(&g_auth.users, node) {
+        auth_user_t* user = node->item;
         if (user) {
             cJSON* user_obj = cJSON_CreateObject();
             cJSON_AddStringToObject(user_obj, "user_id", user->user_id);
@@ -1028,8 +1638,19 @@ int auth_save_users_to_file(const char* filename) {
 auth_user_t* auth_get_user(const char* user_id) {
     if (!g_auth.initialized || !user_id) return NULL;
     
-    int index = find_user_index(user_id);
-    return (index >= 0) ? g_auth.users[index] : NULL;
+    pthread_mutex_lock(&g_auth.mutex);
+    auth_user_t* user = auth_index_find(&g_auth.users, user_id);
+    pthread_mutex_unlock(&g_auth.mutex);
+    return user;
+}
+
+auth_user_t* auth_get_user_by_username(const char* username) {
+    if (!g_auth.initialized || !username) return NULL;
+    
+    pthread_mutex_lock(&g_auth.mutex);
+    auth_user_t* user = auth_index_find(&g_auth.users_by_name, username);
+    pthread_mutex_unlock(&g_auth.mutex);
+    return user;
 }
 
 int auth_save_sessions_to_file(const char* filename) {
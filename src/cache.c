@@ -1,4 +1,5 @@
 #include "cache.h"
+#include "cache_index.h"
 #include "log.h"
 #include <rbus.h>
 #include <stdlib.h>
@@ -7,63 +8,136 @@
 #include <time.h>
 #include <pthread.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 #include <cJSON.h>
 
-/* Hash table size - prime number for better distribution */
-#define CACHE_HASH_SIZE 1009
+/* The key space is split into independently locked shards by the low hash bits */
+#define CACHE_SHARD_BITS 4
+#define CACHE_SHARD_COUNT (1u << CACHE_SHARD_BITS)
+
+/* Per-shard bucket arrays start small (power of two) and double under load */
+#define CACHE_SHARD_MIN_BUCKETS 64
+#define CACHE_MAX_LOAD_FACTOR 2     /* Average chain length that triggers a resize */
+#define CACHE_REHASH_STEP 8         /* Old buckets migrated per shard operation while resizing */
+
+/* One shard: its own hash table, recency list, limits and counters */
+typedef struct {
+    pthread_mutex_t mutex;
+    cache_entry_t** buckets;
+    uint32_t bucket_mask;         /* Bucket count - 1 */
+    cache_entry_t** old_buckets;  /* Table being drained while an incremental resize runs */
+    uint32_t old_bucket_mask;
+    uint32_t rehash_pos;          /* Next old bucket to migrate */
+    cache_entry_t* lru_head;      /* Most recently used */
+    cache_entry_t* lru_tail;      /* Next eviction victim */
+    uint32_t max_entries;         /* Share of config.max_entries */
+    uint64_t max_memory_bytes;    /* Share of config.max_memory_bytes */
+    cache_stats_t stats;
+} cache_shard_t;
 
 /* Global cache state */
 static struct {
-    cache_entry_t* hash_table[CACHE_HASH_SIZE];
+    cache_shard_t shards[CACHE_SHARD_COUNT];
     cache_config_t config;
-    cache_stats_t stats;
-    pthread_mutex_t mutex;
+    cache_stats_t stats;        /* Aggregated from the shards by cache_get_stats */
+    pthread_mutex_t mutex;      /* Guards stats aggregation and last_cleanup */
+    uint32_t subtree_hits;      /* Atomic; see cache_get_subtree */
+    uint32_t subtree_misses;
     time_t last_cleanup;
+    char** coherence_prefixes;  /* Parsed from config.coherence_prefixes */
+    int coherence_prefix_count;
+    pthread_t snapshot_thread;  /* Runs while config.snapshot_interval > 0 */
+    pthread_cond_t snapshot_cond;
+    int snapshot_running;
+    int snapshot_stop;          /* Guarded by mutex */
     int initialized;
 } g_cache = {0};
 
-/* Hash function - djb2 algorithm */
+/* Told when a coherent entry is evicted or expires; outside g_cache so it survives reinit */
+static cache_coherent_drop_fn g_coherent_drop_fn;
+
+/* Hash function - 32-bit FNV-1a; low bits pick the shard, the rest pick the bucket */
 static uint32_t cache_hash(const char* key) {
-    uint32_t hash = 5381;
-    int c;
-    while ((c = *key++)) {
-        hash = ((hash << 5) + hash) + c;
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
     }
-    return hash % CACHE_HASH_SIZE;
+    return hash;
+}
+
+static cache_shard_t* cache_shard_of(uint32_t hash) {
+    return &g_cache.shards[hash & (CACHE_SHARD_COUNT - 1)];
 }
 
+static uint32_t cache_bucket_of(uint32_t hash, uint32_t mask) {
+    return (hash >> CACHE_SHARD_BITS) & mask;
+}
+
+static void* cache_snapshot_thread(void* arg);
+
 /* Get current time */
 static time_t get_current_time(void) {
     return time(NULL);
 }
 
+/* Refcounted values */
+cache_value_t* cache_value_create(const char* data, int dataType) {
+    if (!data) return NULL;
+    size_t length = strlen(data);
+    cache_value_t* value = malloc(sizeof(cache_value_t) + length + 1);
+    if (!value) return NULL;
+    value->refcount = 1;
+    value->dataType = dataType;
+    value->length = length;
+    memcpy(value->data, data, length + 1);
+    return value;
+}
+
+cache_value_t* cache_value_retain(cache_value_t* value) {
+    __atomic_add_fetch(&value->refcount, 1, __ATOMIC_RELAXED);
+    return value;
+}
+
+void cache_release(cache_value_t* value) {
+    if (value && __atomic_sub_fetch(&value->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(value);
+    }
+}
+
 /* Calculate memory usage of an entry */
 static size_t cache_entry_memory(const cache_entry_t* entry) {
     if (!entry) return 0;
-    return sizeof(cache_entry_t) + 
+    return sizeof(cache_entry_t) +
            (entry->key ? strlen(entry->key) + 1 : 0) +
-           (entry->value ? strlen(entry->value) + 1 : 0);
+           (entry->value ? sizeof(cache_value_t) + entry->value->length + 1 : 0);
 }
 
-/* Free a cache entry */
+/* Free a cache entry; readers still holding its value keep the buffer alive */
 static void cache_free_entry(cache_entry_t* entry) {
     if (!entry) return;
     free(entry->key);
-    free(entry->value);
+    cache_release(entry->value);
     free(entry);
 }
 
-/* Create a new cache entry */
-static cache_entry_t* cache_create_entry(const char* key, const char* value, int dataType, time_t ttl) {
+/* Create a new cache entry, adopting the caller's reference to value */
+static cache_entry_t* cache_create_entry(const char* key, cache_value_t* value, time_t ttl) {
     cache_entry_t* entry = calloc(1, sizeof(cache_entry_t));
-    if (!entry) return NULL;
+    if (!entry) {
+        cache_release(value);
+        return NULL;
+    }
     
     entry->key = strdup(key);
-    entry->value = strdup(value);
-    entry->dataType = dataType;
+    entry->value = value;
     entry->timestamp = get_current_time();
     entry->ttl = ttl;
     entry->access_count = 0;
+    entry->hash = cache_hash(key);
     entry->next = NULL;
     
     if (!entry->key || !entry->value) {
@@ -80,6 +154,239 @@ static int cache_entry_expired(const cache_entry_t* entry) {
     return (get_current_time() - entry->timestamp) > entry->ttl;
 }
 
+/* Move up to CACHE_REHASH_STEP buckets of an in-progress resize; caller holds shard->mutex */
+static void cache_shard_rehash_step(cache_shard_t* shard) {
+    if (!shard->old_buckets) return;
+    
+    for (int step = 0; step < CACHE_REHASH_STEP && shard->rehash_pos <= shard->old_bucket_mask; step++) {
+        cache_entry_t* entry = shard->old_buckets[shard->rehash_pos];
+        while (entry) {
+            cache_entry_t* next = entry->next;
+            uint32_t b = cache_bucket_of(entry->hash, shard->bucket_mask);
+            entry->next = shard->buckets[b];
+            shard->buckets[b] = entry;
+            entry = next;
+        }
+        shard->old_buckets[shard->rehash_pos++] = NULL;
+    }
+    
+    if (shard->rehash_pos > shard->old_bucket_mask) {
+        free(shard->old_buckets);
+        shard->old_buckets = NULL;
+        shard->old_bucket_mask = 0;
+        shard->rehash_pos = 0;
+    }
+}
+
+/* Start doubling the shard's table once chains get long; caller holds shard->mutex */
+static void cache_shard_maybe_grow(cache_shard_t* shard) {
+    if (shard->old_buckets) return;
+    if (shard->stats.total_entries <= (uint64_t)(shard->bucket_mask + 1) * CACHE_MAX_LOAD_FACTOR) return;
+    
+    uint32_t new_count = (shard->bucket_mask + 1) * 2;
+    cache_entry_t** buckets = calloc(new_count, sizeof(cache_entry_t*));
+    if (!buckets) {
+        LOGW("Cache shard resize to %u buckets failed: %s", new_count, "out of memory");
+        return;
+    }
+    
+    shard->old_buckets = shard->buckets;
+    shard->old_bucket_mask = shard->bucket_mask;
+    shard->rehash_pos = 0;
+    shard->buckets = buckets;
+    shard->bucket_mask = new_count - 1;
+}
+
+/* Find an entry in its shard; caller holds shard->mutex */
+static cache_entry_t* cache_shard_find(cache_shard_t* shard, const char* key, uint32_t hash) {
+    cache_shard_rehash_step(shard);
+    
+    cache_entry_t* entry = shard->buckets[cache_bucket_of(hash, shard->bucket_mask)];
+    while (entry && (entry->hash != hash || strcmp(entry->key, key) != 0)) {
+        entry = entry->next;
+    }
+    if (!entry && shard->old_buckets) {
+        entry = shard->old_buckets[cache_bucket_of(hash, shard->old_bucket_mask)];
+        while (entry && (entry->hash != hash || strcmp(entry->key, key) != 0)) {
+            entry = entry->next;
+        }
+    }
+    return entry;
+}
+
+/* Recency list maintenance; caller holds shard->mutex */
+static void cache_lru_unlink(cache_shard_t* shard, cache_entry_t* entry) {
+    if (entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        shard->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        shard->lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void cache_lru_push_front(cache_shard_t* shard, cache_entry_t* entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = shard->lru_head;
+    if (shard->lru_head) {
+        shard->lru_head->lru_prev = entry;
+    } else {
+        shard->lru_tail = entry;
+    }
+    shard->lru_head = entry;
+}
+
+static void cache_lru_touch(cache_shard_t* shard, cache_entry_t* entry) {
+    if (shard->lru_head == entry) return;
+    cache_lru_unlink(shard, entry);
+    cache_lru_push_front(shard, entry);
+}
+
+/* Unlink the entry from whichever table holds it */
+static void cache_shard_unlink_bucket(cache_shard_t* shard, cache_entry_t* entry) {
+    cache_entry_t** link = &shard->buckets[cache_bucket_of(entry->hash, shard->bucket_mask)];
+    while (*link && *link != entry) {
+        link = &(*link)->next;
+    }
+    if (!*link && shard->old_buckets) {
+        link = &shard->old_buckets[cache_bucket_of(entry->hash, shard->old_bucket_mask)];
+        while (*link && *link != entry) {
+            link = &(*link)->next;
+        }
+    }
+    if (*link) *link = entry->next;
+}
+
+static void cache_drop_coherent(const cache_entry_t* entry) {
+    if (!entry->coherent) return;
+    cache_coherent_drop_fn fn = __atomic_load_n(&g_coherent_drop_fn, __ATOMIC_ACQUIRE);
+    if (fn) fn(entry->key);
+}
+
+/* Remove an entry from its bucket and the recency list, then free it, keeping any coherence
+ * watch (an invalidated parameter is usually refetched); caller holds shard->mutex
+ */
+static void cache_unlink_entry(cache_shard_t* shard, cache_entry_t* entry) {
+    cache_shard_unlink_bucket(shard, entry);
+    cache_lru_unlink(shard, entry);
+    cache_index_remove(entry->key);
+    
+    shard->stats.memory_used -= cache_entry_memory(entry);
+    shard->stats.total_entries--;
+    if (entry->coherent) shard->stats.coherent_entries--;
+    cache_free_entry(entry);
+}
+
+/* As cache_unlink_entry, for evictions and expiry: also releases the coherence watch */
+static void cache_remove_entry(cache_shard_t* shard, cache_entry_t* entry) {
+    cache_drop_coherent(entry);
+    cache_unlink_entry(shard, entry);
+}
+
+/* Call fn for every entry in the shard (both tables while resizing). fn may remove the
+ * entry it is given. Caller holds shard->mutex.
+ */
+typedef void (*cache_visit_fn)(cache_shard_t* shard, cache_entry_t* entry, void* ctx);
+
+static void cache_shard_visit(cache_shard_t* shard, cache_visit_fn fn, void* ctx) {
+    for (int t = 0; t < 2; t++) {
+        cache_entry_t** table = t == 0 ? shard->buckets : shard->old_buckets;
+        uint32_t mask = t == 0 ? shard->bucket_mask : shard->old_bucket_mask;
+        if (!table) continue;
+    
+        for (uint32_t i = 0; i <= mask; i++) {
+            cache_entry_t* entry = table[i];
+            while (entry) {
+                cache_entry_t* next = entry->next;
+                fn(shard, entry, ctx);
+                entry = next;
+            }
+        }
+    }
+}
+
+/* Evict from the shard's LRU tail until its limits allow new_entries more entries and needed
+ * more bytes. keep (if set) is never evicted. Caller holds shard->mutex. Returns entries removed.
+ */
+static int cache_make_room(cache_shard_t* shard, int new_entries, size_t needed, const cache_entry_t* keep) {
+    int evicted = 0;
+    
+    while (shard->lru_tail && shard->lru_tail != keep) {
+        int entries_full = new_entries > 0 && shard->max_entries > 0 &&
+                           shard->stats.total_entries + new_entries > shard->max_entries;
+        int memory_full = shard->max_memory_bytes > 0 &&
+                          shard->stats.memory_used + needed > shard->max_memory_bytes;
+        if (!entries_full && !memory_full) break;
+    
+        cache_entry_t* victim = shard->lru_tail;
+        if (cache_entry_expired(victim)) {
+            shard->stats.cache_timeouts++;
+        } else {
+            shard->stats.cache_evictions++;
+            if (!entries_full) shard->stats.memory_evictions++;
+        }
+        cache_remove_entry(shard, victim);
+        evicted++;
+    }
+    
+    return evicted;
+}
+
+/* Split the comma-separated coherence prefix list into g_cache.coherence_prefixes */
+static void cache_parse_coherence_prefixes(const char* list) {
+    if (!list || !*list) return;
+    
+    int n = 1;
+    for (const char* c = list; *c; c++) {
+        if (*c == ',') n++;
+    }
+    g_cache.coherence_prefixes = calloc(n, sizeof(char*));
+    if (!g_cache.coherence_prefixes) return;
+    
+    const char* start = list;
+    while (*start) {
+        const char* end = strchr(start, ',');
+        size_t len = end ? (size_t)(end - start) : strlen(start);
+        if (len > 0) {
+            char* prefix = malloc(len + 1);
+            if (prefix) {
+                memcpy(prefix, start, len);
+                prefix[len] = '\0';
+                g_cache.coherence_prefixes[g_cache.coherence_prefix_count++] = prefix;
+            }
+        }
+        if (!end) break;
+        start = end + 1;
+    }
+}
+
+/* Free every entry and bucket array of a shard; caller holds shard->mutex */
+static void cache_shard_free_entry_cb(cache_shard_t* shard, cache_entry_t* entry, void* ctx) {
+    (void)shard;
+    (void)ctx;
+    cache_drop_coherent(entry);
+    cache_free_entry(entry);
+}
+
+static void cache_shard_reset(cache_shard_t* shard) {
+    cache_shard_visit(shard, cache_shard_free_entry_cb, NULL);
+    free(shard->old_buckets);
+    shard->old_buckets = NULL;
+    shard->old_bucket_mask = 0;
+    shard->rehash_pos = 0;
+    memset(shard->buckets, 0, (shard->bucket_mask + 1) * sizeof(cache_entry_t*));
+    shard->lru_head = NULL;
+    shard->lru_tail = NULL;
+    shard->stats.total_entries = 0;
+    shard->stats.coherent_entries = 0;
+    shard->stats.memory_used = 0;
+}
+
 /* API Implementation */
 int cache_init(const cache_config_t* config) {
     if (g_cache.initialized) {
@@ -93,27 +400,85 @@ int cache_init(const cache_config_t* config) {
         LOGE("Failed to initialize cache mutex: %s", "pthread_mutex_init failed");
         return -1;
     }
+    if (cache_index_init() != 0) {
+        pthread_mutex_destroy(&g_cache.mutex);
+        return -1;
+    }
     
     /* Set default configuration */
     g_cache.config.max_entries = config ? config->max_entries : 1000;
+    g_cache.config.max_memory_bytes = config ? config->max_memory_bytes : 0;
     g_cache.config.default_ttl = config ? config->default_ttl : 300; /* 5 minutes */
     g_cache.config.cleanup_interval = config ? config->cleanup_interval : 60; /* 1 minute */
     g_cache.config.enable_stats = config ? config->enable_stats : 1;
     g_cache.config.enable_persistence = config ? config->enable_persistence : 0;
-    g_cache.config.persistence_file = config && config->persistence_file ? 
-                                     strdup(config->persistence_file) : 
-                                     strdup("/tmp/parodus2rbus_cache.json");
+    g_cache.config.persistence_file = config && config->persistence_file ?
+                                     strdup(config->persistence_file) :
+                                     strdup("/tmp/parodus2rbus_cache.snap");
+    g_cache.config.snapshot_interval = config && config->snapshot_interval > 0 ? config->snapshot_interval : 0;
+    g_cache.config.enable_coherence = config ? config->enable_coherence : 0;
+    g_cache.config.coherent_ttl = config && config->coherent_ttl > 0 ? config->coherent_ttl : 3600;
+    g_cache.config.coherence_prefixes = NULL;
+    if (config && config->coherence_prefixes) {
+        g_cache.config.coherence_prefixes = strdup(config->coherence_prefixes);
+        cache_parse_coherence_prefixes(config->coherence_prefixes);
+    }
+    
+    /* Limits are enforced per shard, each holding an equal share */
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard_t* shard = &g_cache.shards[i];
+        pthread_mutex_init(&shard->mutex, NULL);
+        shard->buckets = calloc(CACHE_SHARD_MIN_BUCKETS, sizeof(cache_entry_t*));
+        if (!shard->buckets) {
+            LOGE("Failed to allocate cache shard: %s", "out of memory");
+            for (uint32_t j = 0; j <= i; j++) {
+                free(g_cache.shards[j].buckets);
+                pthread_mutex_destroy(&g_cache.shards[j].mutex);
+            }
+            free(g_cache.config.persistence_file);
+            free(g_cache.config.coherence_prefixes);
+            for (int p = 0; p < g_cache.coherence_prefix_count; p++) {
+                free(g_cache.coherence_prefixes[p]);
+            }
+            free(g_cache.coherence_prefixes);
+            cache_index_cleanup();
+            pthread_mutex_destroy(&g_cache.mutex);
+            memset(&g_cache, 0, sizeof(g_cache));
+            return -1;
+        }
+        shard->bucket_mask = CACHE_SHARD_MIN_BUCKETS - 1;
+        shard->max_entries = (g_cache.config.max_entries + CACHE_SHARD_COUNT - 1) / CACHE_SHARD_COUNT;
+        shard->max_memory_bytes = (g_cache.config.max_memory_bytes + CACHE_SHARD_COUNT - 1) / CACHE_SHARD_COUNT;
+    }
     
     g_cache.last_cleanup = get_current_time();
     g_cache.initialized = 1;
     
-    /* Load persisted cache if enabled */
+    /* Warm-start from the last snapshot, then keep it current */
     if (g_cache.config.enable_persistence) {
-        cache_load_from_file(g_cache.config.persistence_file);
+        cache_load_snapshot(g_cache.config.persistence_file);
+        if (g_cache.config.snapshot_interval > 0) {
+            pthread_condattr_t cond_attr;
+            pthread_condattr_init(&cond_attr);
+            pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+            pthread_cond_init(&g_cache.snapshot_cond, &cond_attr);
+            pthread_condattr_destroy(&cond_attr);
+            if (pthread_create(&g_cache.snapshot_thread, NULL, cache_snapshot_thread, NULL) == 0) {
+                g_cache.snapshot_running = 1;
+            } else {
+                LOGW("Failed to start cache snapshot thread: %s", "saving at shutdown only");
+                pthread_cond_destroy(&g_cache.snapshot_cond);
+            }
+        }
     }
     
-    LOGI("Cache initialized: max_entries=%u, default_ttl=%ld, cleanup_interval=%ld", 
-         g_cache.config.max_entries, g_cache.config.default_ttl, g_cache.config.cleanup_interval);
+    LOGI("Cache initialized: max_entries=%u, max_memory=%llu, default_ttl=%ld, cleanup_interval=%ld, shards=%u",
+         g_cache.config.max_entries, (unsigned long long)g_cache.config.max_memory_bytes,
+         g_cache.config.default_ttl, g_cache.config.cleanup_interval, CACHE_SHARD_COUNT);
+    if (g_cache.config.enable_coherence) {
+        LOGI("Cache coherence enabled: coherent_ttl=%ld, prefixes=%s", g_cache.config.coherent_ttl,
+             g_cache.config.coherence_prefixes ? g_cache.config.coherence_prefixes : "all");
+    }
     
     return 0;
 }
@@ -122,167 +487,204 @@ void cache_cleanup(void) {
     if (!g_cache.initialized) return;
     
     /* Save cache if persistence is enabled */
+    if (g_cache.snapshot_running) {
+        pthread_mutex_lock(&g_cache.mutex);
+        g_cache.snapshot_stop = 1;
+        pthread_cond_signal(&g_cache.snapshot_cond);
+        pthread_mutex_unlock(&g_cache.mutex);
+        pthread_join(g_cache.snapshot_thread, NULL);
+        pthread_cond_destroy(&g_cache.snapshot_cond);
+        g_cache.snapshot_running = 0;
+    }
     if (g_cache.config.enable_persistence) {
-        cache_save_to_file(g_cache.config.persistence_file);
+        cache_save_snapshot(g_cache.config.persistence_file);
     }
     
-    pthread_mutex_lock(&g_cache.mutex);
-    
     /* Clear all entries */
-    for (int i = 0; i < CACHE_HASH_SIZE; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        while (entry) {
-            cache_entry_t* next = entry->next;
-            cache_free_entry(entry);
-            entry = next;
-        }
-        g_cache.hash_table[i] = NULL;
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard_t* shard = &g_cache.shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        cache_shard_reset(shard);
+        free(shard->buckets);
+        shard->buckets = NULL;
+        pthread_mutex_unlock(&shard->mutex);
+        pthread_mutex_destroy(&shard->mutex);
     }
+    cache_index_cleanup();
+    cache_component_cleanup();
     
+    pthread_mutex_lock(&g_cache.mutex);
     free(g_cache.config.persistence_file);
-    memset(&g_cache, 0, sizeof(g_cache));
-    
+    free(g_cache.config.coherence_prefixes);
+    for (int i = 0; i < g_cache.coherence_prefix_count; i++) {
+        free(g_cache.coherence_prefixes[i]);
+    }
+    free(g_cache.coherence_prefixes);
     pthread_mutex_unlock(&g_cache.mutex);
     pthread_mutex_destroy(&g_cache.mutex);
+    memset(&g_cache, 0, sizeof(g_cache));
     
     LOGI("Cache cleaned up: %s", "shutdown complete");
 }
 
-int cache_get(const char* key, char** value, int* dataType) {
-    if (!g_cache.initialized || !key || !value) return -1;
-    
-    pthread_mutex_lock(&g_cache.mutex);
+/* Hash lookup shared by cache_get and the wildcard paths (which leave hit/miss stats alone) */
+static int cache_lookup(const char* key, char** value, int* dataType, int record_stats) {
+    if (!key || !value) return -1;
     
     uint32_t hash = cache_hash(key);
-    cache_entry_t* entry = g_cache.hash_table[hash];
-    
-    /* Search in hash bucket */
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            /* Check if expired */
-            if (cache_entry_expired(entry)) {
-                if (g_cache.config.enable_stats) g_cache.stats.cache_timeouts++;
-                /* Remove expired entry */
-                cache_entry_t* prev = NULL;
-                cache_entry_t* curr = g_cache.hash_table[hash];
-                while (curr && curr != entry) {
-                    prev = curr;
-                    curr = curr->next;
-                }
-                if (prev) {
-                    prev->next = entry->next;
-                } else {
-                    g_cache.hash_table[hash] = entry->next;
-                }
-                g_cache.stats.memory_used -= cache_entry_memory(entry);
-                g_cache.stats.total_entries--;
-                cache_free_entry(entry);
-                
-                if (g_cache.config.enable_stats) g_cache.stats.cache_misses++;
-                pthread_mutex_unlock(&g_cache.mutex);
-                return -1; /* Cache miss due to expiration */
-            }
-            
-            /* Cache hit */
-            *value = strdup(entry->value);
-            if (dataType) *dataType = entry->dataType;
-            entry->access_count++;
-            
-            if (g_cache.config.enable_stats) g_cache.stats.cache_hits++;
-            pthread_mutex_unlock(&g_cache.mutex);
-            return 0;
+    cache_shard_t* shard = cache_shard_of(hash);
+    pthread_mutex_lock(&shard->mutex);
+    
+    cache_entry_t* entry = cache_shard_find(shard, key, hash);
+    if (entry) {
+        /* Check if expired */
+        if (cache_entry_expired(entry)) {
+            if (record_stats && g_cache.config.enable_stats) shard->stats.cache_timeouts++;
+            /* Remove expired entry */
+            cache_remove_entry(shard, entry);
+    
+            if (record_stats && g_cache.config.enable_stats) shard->stats.cache_misses++;
+            pthread_mutex_unlock(&shard->mutex);
+            return -1; /* Cache miss due to expiration */
         }
-        entry = entry->next;
+    
+        /* Cache hit */
+        *value = strdup(entry->value->data);
+        if (dataType) *dataType = entry->value->dataType;
+        entry->access_count++;
+        cache_lru_touch(shard, entry);
+    
+        if (record_stats && g_cache.config.enable_stats) shard->stats.cache_hits++;
+        pthread_mutex_unlock(&shard->mutex);
+        return 0;
     }
     
     /* Cache miss */
-    if (g_cache.config.enable_stats) g_cache.stats.cache_misses++;
-    pthread_mutex_unlock(&g_cache.mutex);
+    if (record_stats && g_cache.config.enable_stats) shard->stats.cache_misses++;
+    pthread_mutex_unlock(&shard->mutex);
     return -1;
 }
 
-int cache_set(const char* key, const char* value, int dataType, time_t ttl) {
-    if (!g_cache.initialized || !key || !value) return -1;
+int cache_get(const char* key, char** value, int* dataType) {
+    if (!g_cache.initialized) return -1;
+    return cache_lookup(key, value, dataType, 1);
+}
+
+cache_value_t* cache_acquire(const char* key) {
+    if (!g_cache.initialized || !key) return NULL;
     
-    pthread_mutex_lock(&g_cache.mutex);
+    uint32_t hash = cache_hash(key);
+    cache_shard_t* shard = cache_shard_of(hash);
+    pthread_mutex_lock(&shard->mutex);
+    
+    cache_entry_t* entry = cache_shard_find(shard, key, hash);
+    if (entry && cache_entry_expired(entry)) {
+        if (g_cache.config.enable_stats) shard->stats.cache_timeouts++;
+        cache_remove_entry(shard, entry);
+        entry = NULL;
+    }
+    if (!entry) {
+        if (g_cache.config.enable_stats) shard->stats.cache_misses++;
+        pthread_mutex_unlock(&shard->mutex);
+        return NULL;
+    }
     
+    /* Cache hit: hand out a reference instead of a copy */
+    cache_value_t* value = cache_value_retain(entry->value);
+    entry->access_count++;
+    cache_lru_touch(shard, entry);
+    if (g_cache.config.enable_stats) shard->stats.cache_hits++;
+    pthread_mutex_unlock(&shard->mutex);
+    return value;
+}
+
+/* Insert or replace key, adopting the caller's reference to value */
+static int cache_store(const char* key, cache_value_t* value, time_t ttl) {
     uint32_t hash = cache_hash(key);
-    cache_entry_t* entry = g_cache.hash_table[hash];
+    cache_shard_t* shard = cache_shard_of(hash);
+    pthread_mutex_lock(&shard->mutex);
     
     /* Check if key already exists */
-    cache_entry_t* prev = NULL;
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            /* Update existing entry */
-            g_cache.stats.memory_used -= cache_entry_memory(entry);
-            free(entry->value);
-            entry->value = strdup(value);
-            entry->dataType = dataType;
-            entry->timestamp = get_current_time();
+    cache_entry_t* entry = cache_shard_find(shard, key, hash);
+    if (entry) {
+        /* Update existing entry */
+        shard->stats.memory_used -= cache_entry_memory(entry);
+        cache_release(entry->value);
+        entry->value = value;
+        entry->timestamp = get_current_time();
+        if (entry->coherent) {
+            entry->ttl = g_cache.config.coherent_ttl;
+        } else {
             entry->ttl = ttl > 0 ? ttl : g_cache.config.default_ttl;
-            g_cache.stats.memory_used += cache_entry_memory(entry);
-            pthread_mutex_unlock(&g_cache.mutex);
-            return 0;
         }
-        prev = entry;
-        entry = entry->next;
-    }
-    
-    /* Check cache limits */
-    if (g_cache.stats.total_entries >= g_cache.config.max_entries) {
-        /* Evict least recently used entries */
-        cache_evict_lru(g_cache.config.max_entries / 10); /* Evict 10% */
+        shard->stats.memory_used += cache_entry_memory(entry);
+        cache_lru_touch(shard, entry);
+        /* A larger value may push the shard over its memory limit */
+        cache_make_room(shard, 0, 0, entry);
+        pthread_mutex_unlock(&shard->mutex);
+        return 0;
     }
     
     /* Create new entry */
-    cache_entry_t* new_entry = cache_create_entry(key, value, dataType, 
+    cache_entry_t* new_entry = cache_create_entry(key, value,
                                                  ttl > 0 ? ttl : g_cache.config.default_ttl);
     if (!new_entry) {
-        pthread_mutex_unlock(&g_cache.mutex);
+        pthread_mutex_unlock(&shard->mutex);
+        return -1;
+    }
+    
+    /* A key missing from the index would break wildcard lookups and complete subtrees */
+    if (cache_index_insert(key) != 0) {
+        cache_free_entry(new_entry);
+        pthread_mutex_unlock(&shard->mutex);
         return -1;
     }
     
-    /* Add to hash table */
-    new_entry->next = g_cache.hash_table[hash];
-    g_cache.hash_table[hash] = new_entry;
+    /* Enforce max_entries/max_memory_bytes by evicting least recently used entries */
+    cache_make_room(shard, 1, cache_entry_memory(new_entry), NULL);
     
-    g_cache.stats.total_entries++;
-    g_cache.stats.memory_used += cache_entry_memory(new_entry);
+    /* Add to hash table (the new table while a resize is in progress) */
+    uint32_t b = cache_bucket_of(hash, shard->bucket_mask);
+    new_entry->next = shard->buckets[b];
+    shard->buckets[b] = new_entry;
+    cache_lru_push_front(shard, new_entry);
     
-    pthread_mutex_unlock(&g_cache.mutex);
+    shard->stats.total_entries++;
+    shard->stats.memory_used += cache_entry_memory(new_entry);
+    cache_shard_maybe_grow(shard);
+    
+    pthread_mutex_unlock(&shard->mutex);
     return 0;
 }
 
+int cache_set(const char* key, const char* value, int dataType, time_t ttl) {
+    if (!g_cache.initialized || !key || !value) return -1;
+    
+    cache_value_t* stored = cache_value_create(value, dataType);
+    if (!stored) return -1;
+    return cache_store(key, stored, ttl);
+}
+
+int cache_set_value(const char* key, cache_value_t* value, time_t ttl) {
+    if (!g_cache.initialized || !key || !value) return -1;
+    return cache_store(key, cache_value_retain(value), ttl);
+}
+
 int cache_delete(const char* key) {
     if (!g_cache.initialized || !key) return -1;
     
-    pthread_mutex_lock(&g_cache.mutex);
-    
     uint32_t hash = cache_hash(key);
-    cache_entry_t* entry = g_cache.hash_table[hash];
-    cache_entry_t* prev = NULL;
-    
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            /* Remove entry */
-            if (prev) {
-                prev->next = entry->next;
-            } else {
-                g_cache.hash_table[hash] = entry->next;
-            }
-            
-            g_cache.stats.memory_used -= cache_entry_memory(entry);
-            g_cache.stats.total_entries--;
-            cache_free_entry(entry);
-            
-            pthread_mutex_unlock(&g_cache.mutex);
-            return 0;
-        }
-        prev = entry;
-        entry = entry->next;
+    cache_shard_t* shard = cache_shard_of(hash);
+    pthread_mutex_lock(&shard->mutex);
+    
+    cache_entry_t* entry = cache_shard_find(shard, key, hash);
+    if (entry) {
+        cache_unlink_entry(shard, entry);
+        pthread_mutex_unlock(&shard->mutex);
+        return 0;
     }
     
-    pthread_mutex_unlock(&g_cache.mutex);
+    pthread_mutex_unlock(&shard->mutex);
     return -1; /* Key not found */
 }
 
@@ -296,71 +698,57 @@ int cache_exists(const char* key) {
 void cache_clear(void) {
     if (!g_cache.initialized) return;
     
-    pthread_mutex_lock(&g_cache.mutex);
-    
-    for (int i = 0; i < CACHE_HASH_SIZE; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        while (entry) {
-            cache_entry_t* next = entry->next;
-            cache_free_entry(entry);
-            entry = next;
-        }
-        g_cache.hash_table[i] = NULL;
+    /* Hold every shard so no insert lands between the shard and index resets */
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        pthread_mutex_lock(&g_cache.shards[i].mutex);
+    }
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard_reset(&g_cache.shards[i]);
+    }
+    cache_index_clear();
+    for (uint32_t i = CACHE_SHARD_COUNT; i > 0; i--) {
+        pthread_mutex_unlock(&g_cache.shards[i - 1].mutex);
     }
-    
-    g_cache.stats.total_entries = 0;
-    g_cache.stats.memory_used = 0;
-    
-    pthread_mutex_unlock(&g_cache.mutex);
     
     LOGI("Cache cleared: %s", "all entries removed");
 }
 
+typedef struct {
+    time_t now;
+    int expired;
+} cache_expire_ctx_t;
+
+static void cache_expire_cb(cache_shard_t* shard, cache_entry_t* entry, void* ctx) {
+    cache_expire_ctx_t* ec = (cache_expire_ctx_t*)ctx;
+    if (entry->ttl > 0 && (ec->now - entry->timestamp) > entry->ttl) {
+        /* Remove expired entry */
+        cache_remove_entry(shard, entry);
+        shard->stats.cache_timeouts++;
+        ec->expired++;
+    }
+}
+
 int cache_expire_entries(void) {
     if (!g_cache.initialized) return 0;
     
-    pthread_mutex_lock(&g_cache.mutex);
+    cache_expire_ctx_t ctx = { .now = get_current_time(), .expired = 0 };
     
-    int expired_count = 0;
-    time_t now = get_current_time();
-    
-    for (int i = 0; i < CACHE_HASH_SIZE; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        cache_entry_t* prev = NULL;
-        
-        while (entry) {
-            if (entry->ttl > 0 && (now - entry->timestamp) > entry->ttl) {
-                /* Remove expired entry */
-                cache_entry_t* next = entry->next;
-                
-                if (prev) {
-                    prev->next = next;
-                } else {
-                    g_cache.hash_table[i] = next;
-                }
-                
-                g_cache.stats.memory_used -= cache_entry_memory(entry);
-                g_cache.stats.total_entries--;
-                g_cache.stats.cache_timeouts++;
-                cache_free_entry(entry);
-                expired_count++;
-                
-                entry = next;
-            } else {
-                prev = entry;
-                entry = entry->next;
-            }
-        }
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard_t* shard = &g_cache.shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        cache_shard_visit(shard, cache_expire_cb, &ctx);
+        pthread_mutex_unlock(&shard->mutex);
     }
     
-    g_cache.last_cleanup = now;
+    pthread_mutex_lock(&g_cache.mutex);
+    g_cache.last_cleanup = ctx.now;
     pthread_mutex_unlock(&g_cache.mutex);
     
-    if (expired_count > 0) {
-        LOGI("Cache cleanup: expired %d entries", expired_count);
+    if (ctx.expired > 0) {
+        LOGI("Cache cleanup: expired %d entries", ctx.expired);
     }
     
-    return expired_count;
+    return ctx.expired;
 }
 
 /* Specialized parodus2rbus operations */
@@ -372,37 +760,138 @@ int cache_set_parameter(const char* paramName, const char* value, int dataType)
     return cache_set(paramName, value, dataType, g_cache.config.default_ttl);
 }
 
+int cache_set_parameter_value(const char* paramName, cache_value_t* value) {
+    return cache_set_value(paramName, value, g_cache.config.default_ttl);
+}
+
 int cache_invalidate_parameter(const char* paramName) {
     return cache_delete(paramName);
 }
 
+int cache_coherence_wanted(const char* paramName) {
+    if (!g_cache.initialized || !g_cache.config.enable_coherence || !paramName) return 0;
+    if (g_cache.coherence_prefix_count == 0) return 1;
+    
+    for (int i = 0; i < g_cache.coherence_prefix_count; i++) {
+        const char* prefix = g_cache.coherence_prefixes[i];
+        if (strncmp(paramName, prefix, strlen(prefix)) == 0) return 1;
+    }
+    return 0;
+}
+
+void cache_set_coherent_drop_callback(cache_coherent_drop_fn fn) {
+    __atomic_store_n(&g_coherent_drop_fn, fn, __ATOMIC_RELEASE);
+}
+
+int cache_mark_coherent(const char* paramName) {
+    if (!g_cache.initialized || !paramName) return -1;
+    
+    uint32_t hash = cache_hash(paramName);
+    cache_shard_t* shard = cache_shard_of(hash);
+    pthread_mutex_lock(&shard->mutex);
+    cache_entry_t* entry = cache_shard_find(shard, paramName, hash);
+    if (!entry) {
+        pthread_mutex_unlock(&shard->mutex);
+        return -1;
+    }
+    if (!entry->coherent) {
+        entry->coherent = 1;
+        shard->stats.coherent_entries++;
+    }
+    entry->ttl = g_cache.config.coherent_ttl;
+    pthread_mutex_unlock(&shard->mutex);
+    return 0;
+}
+
+int cache_apply_value_change(const char* paramName, const char* newValue, int dataType) {
+    if (!g_cache.initialized || !paramName) return -1;
+    
+    if (!newValue) {
+        return cache_delete(paramName);
+    }
+    
+    uint32_t hash = cache_hash(paramName);
+    cache_shard_t* shard = cache_shard_of(hash);
+    pthread_mutex_lock(&shard->mutex);
+    cache_entry_t* entry = cache_shard_find(shard, paramName, hash);
+    if (!entry) {
+        pthread_mutex_unlock(&shard->mutex);
+        return -1;
+    }
+    
+    /* Readers holding the old value keep it; the entry moves to a new buffer */
+    cache_value_t* value = cache_value_create(newValue, dataType >= 0 ? dataType : entry->value->dataType);
+    if (!value) {
+        cache_remove_entry(shard, entry);
+        pthread_mutex_unlock(&shard->mutex);
+        return 0;
+    }
+    shard->stats.memory_used -= cache_entry_memory(entry);
+    cache_release(entry->value);
+    entry->value = value;
+    entry->timestamp = get_current_time();
+    if (entry->coherent) entry->ttl = g_cache.config.coherent_ttl;
+    shard->stats.memory_used += cache_entry_memory(entry);
+    shard->stats.coherent_updates++;
+    cache_make_room(shard, 0, 0, entry);
+    pthread_mutex_unlock(&shard->mutex);
+    
+    LOGD("Cache updated from value-change event: %s", paramName);
+    return 0;
+}
+
 cache_stats_t* cache_get_stats(void) {
     if (!g_cache.initialized) return NULL;
     
     /* Run cleanup if it's time */
     time_t now = get_current_time();
-    if ((now - g_cache.last_cleanup) > g_cache.config.cleanup_interval) {
+    pthread_mutex_lock(&g_cache.mutex);
+    int cleanup_due = (now - g_cache.last_cleanup) > g_cache.config.cleanup_interval;
+    pthread_mutex_unlock(&g_cache.mutex);
+    if (cleanup_due) {
         cache_expire_entries();
     }
     
+    /* Sum the per-shard counters */
+    pthread_mutex_lock(&g_cache.mutex);
+    memset(&g_cache.stats, 0, sizeof(g_cache.stats));
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard_t* shard = &g_cache.shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        g_cache.stats.total_entries += shard->stats.total_entries;
+        g_cache.stats.cache_hits += shard->stats.cache_hits;
+        g_cache.stats.cache_misses += shard->stats.cache_misses;
+        g_cache.stats.cache_evictions += shard->stats.cache_evictions;
+        g_cache.stats.memory_evictions += shard->stats.memory_evictions;
+        g_cache.stats.cache_timeouts += shard->stats.cache_timeouts;
+        g_cache.stats.memory_used += shard->stats.memory_used;
+        g_cache.stats.coherent_entries += shard->stats.coherent_entries;
+        g_cache.stats.coherent_updates += shard->stats.coherent_updates;
+        pthread_mutex_unlock(&shard->mutex);
+    }
+    g_cache.stats.subtree_hits = __atomic_load_n(&g_cache.subtree_hits, __ATOMIC_RELAXED);
+    g_cache.stats.subtree_misses = __atomic_load_n(&g_cache.subtree_misses, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_cache.mutex);
+    
     return &g_cache.stats;
 }
 
 void cache_reset_stats(void) {
     if (!g_cache.initialized) return;
     
-    pthread_mutex_lock(&g_cache.mutex);
-    memset(&g_cache.stats, 0, sizeof(g_cache.stats));
-    /* Recalculate current stats */
-    for (int i = 0; i < CACHE_HASH_SIZE; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        while (entry) {
-            g_cache.stats.total_entries++;
-            g_cache.stats.memory_used += cache_entry_memory(entry);
-            entry = entry->next;
-        }
+    /* Zero the counters; entry, memory and coherence gauges describe current contents */
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard_t* shard = &g_cache.shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        cache_stats_t kept = {0};
+        kept.total_entries = shard->stats.total_entries;
+        kept.memory_used = shard->stats.memory_used;
+        kept.coherent_entries = shard->stats.coherent_entries;
+        shard->stats = kept;
+        pthread_mutex_unlock(&shard->mutex);
     }
-    pthread_mutex_unlock(&g_cache.mutex);
+    __atomic_store_n(&g_cache.subtree_hits, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_cache.subtree_misses, 0, __ATOMIC_RELAXED);
 }
 
 void cache_print_stats(void) {
@@ -413,7 +902,7 @@ void cache_print_stats(void) {
     printf("  Total entries: %u\n", stats->total_entries);
     printf("  Cache hits: %u\n", stats->cache_hits);
     printf("  Cache misses: %u\n", stats->cache_misses);
-    printf("  Cache evictions: %u\n", stats->cache_evictions);
+    printf("  Cache evictions: %u (memory limit: %u)\n", stats->cache_evictions, stats->memory_evictions);
     printf("  Cache timeouts: %u\n", stats->cache_timeouts);
     printf("  Memory used: %lu bytes\n", stats->memory_used);
     
@@ -424,33 +913,41 @@ void cache_print_stats(void) {
 }
 
 /* Cache persistence */
+typedef struct {
+    cJSON* entries;
+    time_t now;
+} cache_save_ctx_t;
+
+static void cache_save_cb(cache_shard_t* shard, cache_entry_t* entry, void* ctx) {
+    (void)shard;
+    cache_save_ctx_t* sc = (cache_save_ctx_t*)ctx;
+    /* Only save non-expired entries */
+    if (entry->ttl <= 0 || (sc->now - entry->timestamp) <= entry->ttl) {
+        cJSON* entryObj = cJSON_CreateObject();
+        cJSON_AddStringToObject(entryObj, "key", entry->key);
+        cJSON_AddStringToObject(entryObj, "value", entry->value->data);
+        cJSON_AddNumberToObject(entryObj, "dataType", entry->value->dataType);
+        cJSON_AddNumberToObject(entryObj, "timestamp", entry->timestamp);
+        cJSON_AddNumberToObject(entryObj, "ttl", entry->ttl);
+        cJSON_AddNumberToObject(entryObj, "access_count", entry->access_count);
+        cJSON_AddItemToArray(sc->entries, entryObj);
+    }
+}
+
 int cache_save_to_file(const char* filename) {
     if (!g_cache.initialized || !filename) return -1;
     
-    pthread_mutex_lock(&g_cache.mutex);
-    
     cJSON* root = cJSON_CreateObject();
     cJSON* entries = cJSON_CreateArray();
     cJSON_AddItemToObject(root, "entries", entries);
     
-    time_t now = get_current_time();
+    cache_save_ctx_t ctx = { .entries = entries, .now = get_current_time() };
     
-    for (int i = 0; i < CACHE_HASH_SIZE; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        while (entry) {
-            /* Only save non-expired entries */
-            if (entry->ttl <= 0 || (now - entry->timestamp) <= entry->ttl) {
-                cJSON* entryObj = cJSON_CreateObject();
-                cJSON_AddStringToObject(entryObj, "key", entry->key);
-                cJSON_AddStringToObject(entryObj, "value", entry->value);
-                cJSON_AddNumberToObject(entryObj, "dataType", entry->dataType);
-                cJSON_AddNumberToObject(entryObj, "timestamp", entry->timestamp);
-                cJSON_AddNumberToObject(entryObj, "ttl", entry->ttl);
-                cJSON_AddNumberToObject(entryObj, "access_count", entry->access_count);
-                cJSON_AddItemToArray(entries, entryObj);
-            }
-            entry = entry->next;
-        }
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard_t* shard = &g_cache.shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        cache_shard_visit(shard, cache_save_cb, &ctx);
+        pthread_mutex_unlock(&shard->mutex);
     }
     
     char* json_str = cJSON_Print(root);
@@ -462,14 +959,12 @@ int cache_save_to_file(const char* filename) {
             fprintf(fp, "%s", json_str);
             fclose(fp);
             free(json_str);
-            pthread_mutex_unlock(&g_cache.mutex);
             LOGI("Cache saved to file: %s", filename);
             return 0;
         }
         free(json_str);
     }
     
-    pthread_mutex_unlock(&g_cache.mutex);
     LOGW("Failed to save cache to file: %s", filename);
     return -1;
 }
@@ -512,7 +1007,7 @@ int cache_load_from_file(const char* filename) {
         cJSON* value = cJSON_GetObjectItem(entry, "value");
         cJSON* dataType = cJSON_GetObjectItem(entry, "dataType");
         cJSON* ttl = cJSON_GetObjectItem(entry, "ttl");
-        
+    
         if (cJSON_IsString(key) && cJSON_IsString(value) && cJSON_IsNumber(dataType)) {
             time_t entry_ttl = cJSON_IsNumber(ttl) ? ttl->valueint : g_cache.config.default_ttl;
             if (cache_set(key->valuestring, value->valuestring, dataType->valueint, entry_ttl) == 0) {
@@ -527,165 +1022,414 @@ int cache_load_from_file(const char* filename) {
     return loaded_count;
 }
 
-/* Additional utility functions */
-int cache_evict_lru(int max_evictions) {
-    if (!g_cache.initialized || max_evictions <= 0) return 0;
+/* Binary snapshot: a fixed header followed by length-prefixed records, all in host byte
+ * order and 8-byte aligned so the file can be walked in place after mmap. The payload
+ * checksum is CRC-32. Only the same build on the same device reads a snapshot back.
+ */
+#define CACHE_SNAPSHOT_MAGIC "P2RSNAP"
+#define CACHE_SNAPSHOT_VERSION 1
+#define CACHE_SNAPSHOT_ALIGN 8
+#define CACHE_SNAPSHOT_COHERENT 0x1   /* Entry was kept fresh by events when saved */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t payload_size;      /* Bytes of records after the header */
+    uint32_t record_count;
+    uint32_t checksum;          /* CRC-32 of the payload */
+    int64_t created;
+} cache_snapshot_header_t;
+
+typedef struct {
+    uint32_t length;            /* Whole record including padding */
+    uint32_t key_len;
+    uint32_t value_len;
+    int32_t data_type;
+    int64_t expires;            /* Wall-clock expiry, 0 = never */
+    uint32_t flags;
+    uint32_t reserved;
+    /* key NUL value NUL, padded to CACHE_SNAPSHOT_ALIGN */
+} cache_snapshot_record_t;
+
+static uint32_t cache_crc32(uint32_t crc, const void* data, size_t len) {
+    static const uint32_t nibble[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+    const unsigned char* p = (const unsigned char*)data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ nibble[crc & 15];
+        crc = (crc >> 4) ^ nibble[crc & 15];
+    }
+    return ~crc;
+}
+
+/* Entry captured under its shard lock; the value is a reference, not a copy */
+typedef struct {
+    char* key;
+    cache_value_t* value;
+    int64_t expires;
+    uint32_t flags;
+} cache_snapshot_item_t;
+
+typedef struct {
+    cache_snapshot_item_t* items;
+    int count;
+    int capacity;
+    time_t now;
+    int failed;
+} cache_snapshot_ctx_t;
+
+static void cache_snapshot_cb(cache_shard_t* shard, cache_entry_t* entry, void* ctx) {
+    (void)shard;
+    cache_snapshot_ctx_t* sc = (cache_snapshot_ctx_t*)ctx;
+    if (sc->failed || (entry->ttl > 0 && (sc->now - entry->timestamp) > entry->ttl)) return;
+    
+    if (sc->count == sc->capacity) {
+        int capacity = sc->capacity ? sc->capacity * 2 : 256;
+        cache_snapshot_item_t* items = realloc(sc->items, capacity * sizeof(cache_snapshot_item_t));
+        if (!items) {
+            sc->failed = 1;
+            return;
+        }
+        sc->items = items;
+        sc->capacity = capacity;
+    }
+    cache_snapshot_item_t* item = &sc->items[sc->count];
+    item->key = strdup(entry->key);
+    if (!item->key) {
+        sc->failed = 1;
+        return;
+    }
+    item->value = cache_value_retain(entry->value);
+    item->expires = entry->ttl > 0 ? (int64_t)(entry->timestamp + entry->ttl) : 0;
+    item->flags = entry->coherent ? CACHE_SNAPSHOT_COHERENT : 0;
+    sc->count++;
+}
+
+static int cache_snapshot_write(FILE* fp, const cache_snapshot_ctx_t* sc) {
+    static const char pad[CACHE_SNAPSHOT_ALIGN] = {0};
+    cache_snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_SNAPSHOT_MAGIC, sizeof(CACHE_SNAPSHOT_MAGIC));
+    header.version = CACHE_SNAPSHOT_VERSION;
+    header.header_size = sizeof(header);
+    header.record_count = (uint32_t)sc->count;
+    header.created = (int64_t)sc->now;
+    
+    /* Header is rewritten with the final size and checksum once the records are out */
+    if (fwrite(&header, sizeof(header), 1, fp) != 1) return -1;
+    
+    uint32_t crc = 0;
+    for (int i = 0; i < sc->count; i++) {
+        const cache_snapshot_item_t* item = &sc->items[i];
+        size_t key_len = strlen(item->key);
+        size_t body = key_len + 1 + item->value->length + 1;
+        size_t padding = (CACHE_SNAPSHOT_ALIGN - body % CACHE_SNAPSHOT_ALIGN) % CACHE_SNAPSHOT_ALIGN;
+    
+        cache_snapshot_record_t rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.length = (uint32_t)(sizeof(rec) + body + padding);
+        rec.key_len = (uint32_t)key_len;
+        rec.value_len = (uint32_t)item->value->length;
+        rec.data_type = item->value->dataType;
+        rec.expires = item->expires;
+        rec.flags = item->flags;
+    
+        if (fwrite(&rec, sizeof(rec), 1, fp) != 1 ||
+            fwrite(item->key, key_len + 1, 1, fp) != 1 ||
+            fwrite(item->value->data, item->value->length + 1, 1, fp) != 1 ||
+            (padding && fwrite(pad, padding, 1, fp) != 1)) {
+            return -1;
+        }
+        crc = cache_crc32(crc, &rec, sizeof(rec));
+        crc = cache_crc32(crc, item->key, key_len + 1);
+        crc = cache_crc32(crc, item->value->data, item->value->length + 1);
+        crc = cache_crc32(crc, pad, padding);
+        header.payload_size += rec.length;
+    }
     
-    /* Simple LRU eviction based on access count and timestamp */
-    struct {
-        cache_entry_t* entry;
-        uint32_t hash_index;
-        cache_entry_t* prev;
-        uint32_t priority; /* Lower = higher priority for eviction */
-    } candidates[max_evictions];
+    header.checksum = crc;
+    if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, fp) != 1) return -1;
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) return -1;
+    return 0;
+}
+
+int cache_save_snapshot(const char* filename) {
+    if (!g_cache.initialized || !filename) return -1;
     
-    int candidate_count = 0;
-    time_t now = get_current_time();
+    /* Shard locks are held only long enough to take value references */
+    cache_snapshot_ctx_t ctx = { .now = get_current_time() };
+    for (uint32_t i = 0; i < CACHE_SHARD_COUNT && !ctx.failed; i++) {
+        cache_shard_t* shard = &g_cache.shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        cache_shard_visit(shard, cache_snapshot_cb, &ctx);
+        pthread_mutex_unlock(&shard->mutex);
+    }
     
-    /* Find candidates for eviction */
-    for (int i = 0; i < CACHE_HASH_SIZE && candidate_count < max_evictions; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        cache_entry_t* prev = NULL;
-        
-        while (entry && candidate_count < max_evictions) {
-            /* Calculate eviction priority */
-            uint32_t priority = entry->access_count + ((now - entry->timestamp) / 60); /* Age in minutes */
-            
-            /* Add to candidates list */
-            candidates[candidate_count].entry = entry;
-            candidates[candidate_count].hash_index = i;
-            candidates[candidate_count].prev = prev;
-            candidates[candidate_count].priority = priority;
-            candidate_count++;
-            
-            prev = entry;
-            entry = entry->next;
+    /* Written beside the target and renamed over it, so a crash never leaves a torn snapshot */
+    int rc = -1;
+    size_t path_len = strlen(filename) + sizeof(".tmp");
+    char* tmp_path = malloc(path_len);
+    if (!ctx.failed && tmp_path) {
+        snprintf(tmp_path, path_len, "%s.tmp", filename);
+        FILE* fp = fopen(tmp_path, "wb");
+        if (fp) {
+            rc = cache_snapshot_write(fp, &ctx);
+            if (fclose(fp) != 0) rc = -1;
+            if (rc == 0 && rename(tmp_path, filename) != 0) rc = -1;
+            if (rc != 0) unlink(tmp_path);
         }
     }
+    free(tmp_path);
     
-    /* Sort candidates by priority (lowest first) */
-    for (int i = 0; i < candidate_count - 1; i++) {
-        for (int j = i + 1; j < candidate_count; j++) {
-            if (candidates[i].priority > candidates[j].priority) {
-                /* Swap */
-                typeof(candidates[0]) temp = candidates[i];
-                candidates[i] = candidates[j];
-                candidates[j] = temp;
-            }
+    for (int i = 0; i < ctx.count; i++) {
+        free(ctx.items[i].key);
+        cache_release(ctx.items[i].value);
+    }
+    free(ctx.items);
+    
+    if (rc != 0) {
+        LOGW("Failed to save cache snapshot: %s", filename);
+        return -1;
+    }
+    LOGD("Cache snapshot saved: %s (%d entries)", filename, ctx.count);
+    return ctx.count;
+}
+
+/* Validate a mapped snapshot's header; returns the payload size or -1 */
+static int64_t cache_snapshot_check(const unsigned char* base, size_t size, const char* filename) {
+    const cache_snapshot_header_t* header = (const cache_snapshot_header_t*)base;
+    if (size < sizeof(*header) || memcmp(header->magic, CACHE_SNAPSHOT_MAGIC, sizeof(CACHE_SNAPSHOT_MAGIC)) != 0) {
+        LOGW("Not a cache snapshot: %s", filename);
+        return -1;
+    }
+    if (header->version != CACHE_SNAPSHOT_VERSION || header->header_size != sizeof(*header) ||
+        header->payload_size != size - sizeof(*header)) {
+        LOGW("Cache snapshot version or size mismatch: %s", filename);
+        return -1;
+    }
+    if (cache_crc32(0, base + sizeof(*header), header->payload_size) != header->checksum) {
+        LOGW("Cache snapshot checksum mismatch: %s", filename);
+        return -1;
+    }
+    return (int64_t)header->payload_size;
+}
+
+int cache_load_snapshot(const char* filename) {
+    if (!g_cache.initialized || !filename) return -1;
+    
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(cache_snapshot_header_t)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    unsigned char* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+    madvise(base, size, MADV_SEQUENTIAL);
+    
+    int64_t payload = cache_snapshot_check(base, size, filename);
+    if (payload < 0) {
+        munmap(base, size);
+        return -1;
+    }
+    
+    /* Records are inserted straight from the mapping */
+    time_t now = get_current_time();
+    uint32_t expected = ((const cache_snapshot_header_t*)base)->record_count;
+    const unsigned char* p = base + sizeof(cache_snapshot_header_t);
+    const unsigned char* end = p + payload;
+    uint32_t records = 0;
+    int loaded_count = 0;
+    while (p < end) {
+        const cache_snapshot_record_t* rec = (const cache_snapshot_record_t*)p;
+        if ((size_t)(end - p) < sizeof(*rec) || rec->length < sizeof(*rec) || rec->length > (size_t)(end - p) ||
+            rec->length % CACHE_SNAPSHOT_ALIGN != 0 ||
+            (uint64_t)rec->key_len + rec->value_len + 2 > rec->length - sizeof(*rec)) {
+            break;
+        }
+        const char* key = (const char*)(rec + 1);
+        const char* data = key + rec->key_len + 1;
+        if (key[rec->key_len] != '\0' || data[rec->value_len] != '\0') break;
+        p += rec->length;
+        records++;
+    
+        time_t ttl = 0;
+        if (rec->expires) {
+            if (rec->expires <= (int64_t)now) continue;
+            ttl = (time_t)(rec->expires - now);
+        }
+        /* No events keep an entry fresh until it is subscribed again */
+        if ((rec->flags & CACHE_SNAPSHOT_COHERENT) && (ttl <= 0 || ttl > g_cache.config.default_ttl)) {
+            ttl = g_cache.config.default_ttl;
         }
+        if (cache_set(key, data, rec->data_type, ttl) == 0) loaded_count++;
     }
+    munmap(base, size);
     
-    /* Evict candidates */
+    if (p != end || records != expected) {
+        LOGW("Cache snapshot truncated or malformed: %s (%u of %u records)", filename, records, expected);
+    }
+    LOGI("Cache snapshot loaded: %s (%d entries)", filename, loaded_count);
+    return loaded_count;
+}
+
+/* Periodic snapshot writer; stops when snapshot_stop is set under g_cache.mutex */
+static void* cache_snapshot_thread(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_cache.mutex);
+    while (!g_cache.snapshot_stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += g_cache.config.snapshot_interval;
+        int wait_rc = 0;
+        while (!g_cache.snapshot_stop && wait_rc != ETIMEDOUT) {
+            wait_rc = pthread_cond_timedwait(&g_cache.snapshot_cond, &g_cache.mutex, &deadline);
+        }
+        if (g_cache.snapshot_stop) break;
+        pthread_mutex_unlock(&g_cache.mutex);
+        cache_save_snapshot(g_cache.config.persistence_file);
+        pthread_mutex_lock(&g_cache.mutex);
+    }
+    pthread_mutex_unlock(&g_cache.mutex);
+    return NULL;
+}
+
+/* Additional utility functions */
+int cache_evict_lru(int max_evictions) {
+    if (!g_cache.initialized || max_evictions <= 0) return 0;
+    
+    /* Victims come straight off the shard tails, round-robin so no shard is drained first */
     int evicted = 0;
-    for (int i = 0; i < candidate_count; i++) {
-        cache_entry_t* entry = candidates[i].entry;
-        
-        /* Remove from hash table */
-        if (candidates[i].prev) {
-            candidates[i].prev->next = entry->next;
-        } else {
-            g_cache.hash_table[candidates[i].hash_index] = entry->next;
+    int progress = 1;
+    while (evicted < max_evictions && progress) {
+        progress = 0;
+        for (uint32_t i = 0; i < CACHE_SHARD_COUNT && evicted < max_evictions; i++) {
+            cache_shard_t* shard = &g_cache.shards[i];
+            pthread_mutex_lock(&shard->mutex);
+            if (shard->lru_tail) {
+                cache_remove_entry(shard, shard->lru_tail);
+                shard->stats.cache_evictions++;
+                evicted++;
+                progress = 1;
+            }
+            pthread_mutex_unlock(&shard->mutex);
         }
-        
-        g_cache.stats.memory_used -= cache_entry_memory(entry);
-        g_cache.stats.total_entries--;
-        g_cache.stats.cache_evictions++;
-        cache_free_entry(entry);
-        evicted++;
     }
     
     LOGI("Cache LRU eviction: removed %d entries", evicted);
     return evicted;
 }
 
-int cache_get_wildcard(const char* prefix, char*** keys, char*** values, int** dataTypes, int* count) {
-    if (!g_cache.initialized || !prefix || !keys || !values || !count) return -1;
-    
-    pthread_mutex_lock(&g_cache.mutex);
-    
-    /* Simple wildcard matching - supports * at end only */
-    int pattern_len = strlen(prefix);
-    int is_prefix = (pattern_len > 0 && prefix[pattern_len - 1] == '*');
-    int prefix_len = is_prefix ? pattern_len - 1 : pattern_len;
+/* Turn index names into key/value/type arrays. Keys that expired or were evicted since
+ * the index was read are dropped, or fail the lookup when require_all is set.
+ * Takes ownership of names.
+ */
+static int cache_resolve_keys(char** names, int n, int require_all,
+                              char*** keys, char*** values, int** dataTypes, int* count) {
+    char** value_array = n > 0 ? calloc(n, sizeof(char*)) : NULL;
+    int* type_array = (dataTypes && n > 0) ? calloc(n, sizeof(int)) : NULL;
+    if (n > 0 && (!value_array || (dataTypes && !type_array))) {
+        cache_free_wildcard_results(names, value_array, type_array, n);
+        return -1;
+    }
     
-    /* Count matching entries first */
-    int match_count = 0;
-    for (int i = 0; i < CACHE_HASH_SIZE; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        while (entry) {
-            if (!cache_entry_expired(entry)) {
-                if (is_prefix) {
-                    if (strncmp(entry->key, prefix, prefix_len) == 0) {
-                        match_count++;
-                    }
-                } else {
-                    if (strcmp(entry->key, prefix) == 0) {
-                        match_count++;
-                    }
-                }
-            }
-            entry = entry->next;
+    int kept = 0;
+    int missing = 0;
+    for (int i = 0; i < n; i++) {
+        char* value = NULL;
+        int type = 0;
+        if (cache_lookup(names[i], &value, &type, 0) == 0) {
+            names[kept] = names[i];
+            value_array[kept] = value;
+            if (type_array) type_array[kept] = type;
+            kept++;
+        } else {
+            free(names[i]);
+            missing = 1;
         }
     }
     
-    if (match_count == 0) {
+    if ((require_all && missing) || kept == 0) {
+        cache_free_wildcard_results(names, value_array, type_array, kept);
+        if (require_all && missing) return -1;
         *keys = NULL;
         *values = NULL;
         if (dataTypes) *dataTypes = NULL;
         *count = 0;
-        pthread_mutex_unlock(&g_cache.mutex);
         return 0;
     }
     
-    /* Allocate result arrays */
-    char** key_array = malloc(match_count * sizeof(char*));
-    char** value_array = malloc(match_count * sizeof(char*));
-    int* type_array = dataTypes ? malloc(match_count * sizeof(int)) : NULL;
-    
-    if (!key_array || !value_array || (dataTypes && !type_array)) {
-        free(key_array);
-        free(value_array);
-        free(type_array);
-        pthread_mutex_unlock(&g_cache.mutex);
-        return -1;
-    }
+    *keys = names;
+    *values = value_array;
+    if (dataTypes) *dataTypes = type_array;
+    *count = kept;
+    return 0;
+}
+
+/* Wildcard matching - supports * at end only; the prefix is resolved through the prefix index.
+ * Returns a malloc'd copy of the prefix, or NULL when pattern is an exact key.
+ */
+static char* cache_wildcard_stem(const char* pattern) {
+    size_t len = strlen(pattern);
+    if (len == 0 || pattern[len - 1] != '*') return NULL;
+    char* stem = malloc(len);
+    if (!stem) return NULL;
+    memcpy(stem, pattern, len - 1);
+    stem[len - 1] = '\0';
+    return stem;
+}
+
+int cache_get_wildcard(const char* prefix, char*** keys, char*** values, int** dataTypes, int* count) {
+    if (!g_cache.initialized || !prefix || !keys || !values || !count) return -1;
     
-    /* Collect matching entries */
-    int result_index = 0;
-    for (int i = 0; i < CACHE_HASH_SIZE && result_index < match_count; i++) {
-        cache_entry_t* entry = g_cache.hash_table[i];
-        while (entry && result_index < match_count) {
-            if (!cache_entry_expired(entry)) {
-                int matches = 0;
-                if (is_prefix) {
-                    if (strncmp(entry->key, prefix, prefix_len) == 0) {
-                        matches = 1;
-                    }
-                } else {
-                    if (strcmp(entry->key, prefix) == 0) {
-                        matches = 1;
-                    }
-                }
-                
-                if (matches) {
-                    key_array[result_index] = strdup(entry->key);
-                    value_array[result_index] = strdup(entry->value);
-                    if (type_array) type_array[result_index] = entry->dataType;
-                    entry->access_count++; /* Count access */
-                    result_index++;
-                }
-            }
-            entry = entry->next;
+    char** names = NULL;
+    int n = 0;
+    char* stem = cache_wildcard_stem(prefix);
+    if (stem) {
+        int rc = cache_index_collect(stem, 0, 0, &names, &n);
+        free(stem);
+        if (rc != 0) return -1;
+    } else {
+        names = malloc(sizeof(char*));
+        if (!names) return -1;
+        names[0] = strdup(prefix);
+        if (!names[0]) {
+            free(names);
+            return -1;
         }
+        n = 1;
     }
     
-    *keys = key_array;
-    *values = value_array;
-    if (dataTypes) *dataTypes = type_array;
-    *count = result_index;
+    return cache_resolve_keys(names, n, 0, keys, values, dataTypes, count);
+}
+
+int cache_get_subtree(const char* prefix, char*** keys, char*** values, int** dataTypes, int* count) {
+    if (!g_cache.initialized || !prefix || !keys || !values || !count) return -1;
     
-    pthread_mutex_unlock(&g_cache.mutex);
-    return 0;
+    char** names = NULL;
+    int n = 0;
+    int rc = cache_index_collect(prefix, 1, get_current_time(), &names, &n);
+    if (rc == 0) {
+        rc = cache_resolve_keys(names, n, 1, keys, values, dataTypes, count);
+    }
+    
+    if (g_cache.config.enable_stats) {
+        __atomic_fetch_add(rc == 0 ? &g_cache.subtree_hits : &g_cache.subtree_misses, 1, __ATOMIC_RELAXED);
+    }
+    return rc;
+}
+
+int cache_mark_subtree_complete(const char* prefix) {
+    if (!g_cache.initialized || !prefix) return -1;
+    return cache_index_mark_complete(prefix, get_current_time() + g_cache.config.default_ttl);
 }
 
 void cache_free_wildcard_results(char** keys, char** values, int* dataTypes, int count) {
@@ -724,49 +1468,26 @@ int cache_set_bulk(const cache_bulk_entry_t* entries, int count, time_t ttl) {
 int cache_invalidate_wildcard(const char* pattern) {
     if (!g_cache.initialized || !pattern) return -1;
     
-    char** keys = NULL;
-    char** values = NULL;
-    int count = 0;
+    char* stem = cache_wildcard_stem(pattern);
+    if (!stem) {
+        return cache_delete(pattern) == 0 ? 1 : 0;
+    }
     
-    if (cache_get_wildcard(pattern, &keys, &values, NULL, &count) == 0 && count > 0) {
-        int deleted = 0;
-        for (int i = 0; i < count; i++) {
-            if (cache_delete(keys[i]) == 0) {
+    char** names = NULL;
+    int n = 0;
+    int deleted = 0;
+    if (cache_index_collect(stem, 0, 0, &names, &n) == 0) {
+        for (int i = 0; i < n; i++) {
+            if (cache_delete(names[i]) == 0) {
                 deleted++;
             }
+            free(names[i]);
         }
-        cache_free_wildcard_results(keys, values, NULL, count);
-        return deleted;
+        free(names);
     }
+    /* Rows may have come or gone even where nothing was cached */
+    cache_index_clear_complete(stem);
+    free(stem);
     
-    return 0;
+    return deleted;
 }
-
-/* Component discovery caching */
-int cache_get_component(const char* componentName, char** info) {
-    if (!componentName || !info) return -1;
-    
-    char cache_key[256];
-    snprintf(cache_key, sizeof(cache_key), "component:%s", componentName);
-    
-    return cache_get(cache_key, info, NULL);
-}
-
-int cache_set_component(const char* componentName, const char* info) {
-    if (!componentName || !info) return -1;
-    
-    char cache_key[256];
-    snprintf(cache_key, sizeof(cache_key), "component:%s", componentName);
-    
-    /* Cache component info for longer (1 hour) */
-    return cache_set(cache_key, info, 0, 3600); /* 0 = WebPA string type */
-}
-
-int cache_invalidate_component(const char* componentName) {
-    if (!componentName) return -1;
-    
-    char cache_key[256];
-    snprintf(cache_key, sizeof(cache_key), "component:%s", componentName);
-    
-    return cache_delete(cache_key);
-}
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "cache.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define ROUTE_BUCKETS 512           /* Power of two */
+#define ROUTE_MAX_ENTRIES 8192
+#define ROUTE_TTL 3600              /* Components rarely move; an hour like the old stub */
+#define MISSING_MAX_ENTRIES 1024
+#define MISSING_TTL 30              /* Short: a provider may register the name later */
+#define ROUTE_KEY_MAX 512
+
+typedef struct {
+    char* name;
+    time_t last_discovered;
+    int elements_claimed;           /* Element list loaded (or being loaded) since discovery */
+} component_rec_t;
+
+typedef struct route {
+    char* key;                      /* Folded object path, or a full name in the missing table */
+    uint32_t hash;
+    int component;
+    time_t expires;
+    struct route* next;
+} route_t;
+
+typedef struct {
+    route_t* buckets[ROUTE_BUCKETS];
+    int count;
+} route_table_t;
+
+static struct {
+    pthread_mutex_t mutex;
+    route_table_t routes;
+    route_table_t missing;
+    component_rec_t* components;    /* Indexed by component id; never shrinks */
+    int component_count;
+    int component_capacity;
+} g_components = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static uint32_t route_hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int all_digits(const char* s, size_t len) {
+    if (len == 0) return 0;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') return 0;
+    }
+    return 1;
+}
+
+/* Object path that routes name: a leaf loses its last segment, a name ending in '.'
+ * is an object already, and instance numbers fold to "{i}" so every row of a table
+ * shares one route with the element templates. Returns -1 if it does not fit.
+ */
+static int route_key(const char* name, char* out, size_t out_size) {
+    size_t end = strlen(name);
+    if (end > 0 && name[end - 1] != '.') {
+        while (end > 0 && name[end - 1] != '.') end--;
+    }
+    if (end == 0) return -1;
+
+    size_t n = 0;
+    size_t pos = 0;
+    while (pos < end) {
+        const char* seg = name + pos;
+        const char* dot = memchr(seg, '.', end - pos);
+        size_t len = dot ? (size_t)(dot - seg) : end - pos;
+        int instance = all_digits(seg, len);
+        const char* src = instance ? "{i}" : seg;
+        size_t src_len = instance ? 3 : len;
+        if (n + src_len + 2 > out_size) return -1;
+        memcpy(out + n, src, src_len);
+        n += src_len;
+        if (dot) out[n++] = '.';
+        pos += len + (dot ? 1 : 0);
+    }
+    out[n] = '\0';
+    return 0;
+}
+
+static route_t* table_find(route_table_t* table, const char* key, uint32_t hash) {
+    for (route_t* r = table->buckets[hash & (ROUTE_BUCKETS - 1)]; r; r = r->next) {
+        if (r->hash == hash && strcmp(r->key, key) == 0) return r;
+    }
+    return NULL;
+}
+
+/* Remove entries that are expired (now > 0), belong to component (>= 0), start with
+ * prefix, or all of them when no filter is given. Returns how many were removed.
+ */
+static int table_purge(route_table_t* table, time_t now, int component, const char* prefix) {
+    int removed = 0;
+    size_t prefix_len = prefix ? strlen(prefix) : 0;
+    for (int b = 0; b < ROUTE_BUCKETS; b++) {
+        route_t** link = &table->buckets[b];
+        while (*link) {
+            route_t* r = *link;
+            int drop;
+            if (now > 0) drop = r->expires <= now;
+            else if (component >= 0) drop = r->component == component;
+            else if (prefix) drop = strncmp(r->key, prefix, prefix_len) == 0;
+            else drop = 1;
+            if (!drop) {
+                link = &r->next;
+                continue;
+            }
+            *link = r->next;
+            free(r->key);
+            free(r);
+            table->count--;
+            removed++;
+        }
+    }
+    return removed;
+}
+
+static void table_remove(route_table_t* table, const char* key, uint32_t hash) {
+    route_t** link = &table->buckets[hash & (ROUTE_BUCKETS - 1)];
+    while (*link) {
+        route_t* r = *link;
+        if (r->hash == hash && strcmp(r->key, key) == 0) {
+            *link = r->next;
+            free(r->key);
+            free(r);
+            table->count--;
+            return;
+        }
+        link = &r->next;
+    }
+}
+
+static int table_put(route_table_t* table, int max_entries, const char* key, int component, time_t expires) {
+    uint32_t hash = route_hash(key);
+    route_t* r = table_find(table, key, hash);
+    if (r) {
+        r->component = component;
+        r->expires = expires;
+        return 0;
+    }
+    if (table->count >= max_entries && table_purge(table, time(NULL), -1, NULL) == 0) {
+        return -1; /* Full of live routes; callers just discover again */
+    }
+    r = (route_t*)malloc(sizeof(route_t));
+    if (!r) return -1;
+    r->key = strdup(key);
+    if (!r->key) {
+        free(r);
+        return -1;
+    }
+    r->hash = hash;
+    r->component = component;
+    r->expires = expires;
+    route_t** bucket = &table->buckets[hash & (ROUTE_BUCKETS - 1)];
+    r->next = *bucket;
+    *bucket = r;
+    table->count++;
+    return 0;
+}
+
+/* Caller holds the mutex */
+static int component_id(const char* name, int create) {
+    for (int i = 0; i < g_components.component_count; i++) {
+        if (strcmp(g_components.components[i].name, name) == 0) return i;
+    }
+    if (!create) return -1;
+
+    if (g_components.component_count == g_components.component_capacity) {
+        int capacity = g_components.component_capacity ? g_components.component_capacity * 2 : 16;
+        component_rec_t* grown = realloc(g_components.components, capacity * sizeof(component_rec_t));
+        if (!grown) return -1;
+        g_components.components = grown;
+        g_components.component_capacity = capacity;
+    }
+    component_rec_t* rec = &g_components.components[g_components.component_count];
+    rec->name = strdup(name);
+    if (!rec->name) return -1;
+    rec->last_discovered = 0;
+    rec->elements_claimed = 0;
+    return g_components.component_count++;
+}
+
+int cache_component_lookup(const char* paramName) {
+    if (!paramName) return CACHE_COMPONENT_UNKNOWN;
+
+    char key[ROUTE_KEY_MAX];
+    int have_key = route_key(paramName, key, sizeof(key)) == 0;
+    time_t now = time(NULL);
+    int result = CACHE_COMPONENT_UNKNOWN;
+
+    pthread_mutex_lock(&g_components.mutex);
+    uint32_t hash = route_hash(paramName);
+    route_t* r = table_find(&g_components.missing, paramName, hash);
+    if (r && r->expires > now) {
+        result = CACHE_COMPONENT_MISSING;
+    } else {
+        if (r) table_remove(&g_components.missing, paramName, hash);
+        if (have_key) {
+            hash = route_hash(key);
+            r = table_find(&g_components.routes, key, hash);
+            if (r && r->expires > now) result = r->component;
+            else if (r) table_remove(&g_components.routes, key, hash);
+        }
+    }
+    pthread_mutex_unlock(&g_components.mutex);
+    return result;
+}
+
+int cache_component_learn(const char* paramName, const char* componentName) {
+    if (!paramName || !componentName || !*componentName) return -1;
+
+    char key[ROUTE_KEY_MAX];
+    int have_key = route_key(paramName, key, sizeof(key)) == 0;
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&g_components.mutex);
+    int id = component_id(componentName, 1);
+    if (id >= 0) {
+        g_components.components[id].last_discovered = now;
+        if (have_key) table_put(&g_components.routes, ROUTE_MAX_ENTRIES, key, id, now + ROUTE_TTL);
+        table_remove(&g_components.missing, paramName, route_hash(paramName));
+    }
+    pthread_mutex_unlock(&g_components.mutex);
+    return id;
+}
+
+int cache_component_claim_elements(int componentId) {
+    int claimed = 0;
+    pthread_mutex_lock(&g_components.mutex);
+    if (componentId >= 0 && componentId < g_components.component_count &&
+        !g_components.components[componentId].elements_claimed) {
+        g_components.components[componentId].elements_claimed = 1;
+        claimed = 1;
+    }
+    pthread_mutex_unlock(&g_components.mutex);
+    return claimed;
+}
+
+const char* cache_component_name(int componentId) {
+    const char* name = NULL;
+    pthread_mutex_lock(&g_components.mutex);
+    if (componentId >= 0 && componentId < g_components.component_count) {
+        /* The string itself is never moved or freed before cleanup */
+        name = g_components.components[componentId].name;
+    }
+    pthread_mutex_unlock(&g_components.mutex);
+    return name;
+}
+
+int cache_component_learn_missing(const char* paramName) {
+    if (!paramName) return -1;
+    pthread_mutex_lock(&g_components.mutex);
+    int rc = table_put(&g_components.missing, MISSING_MAX_ENTRIES, paramName,
+                       CACHE_COMPONENT_MISSING, time(NULL) + MISSING_TTL);
+    pthread_mutex_unlock(&g_components.mutex);
+    return rc;
+}
+
+void cache_component_forget_missing(const char* prefix) {
+    pthread_mutex_lock(&g_components.mutex);
+    if (g_components.missing.count > 0) table_purge(&g_components.missing, 0, -1, prefix);
+    pthread_mutex_unlock(&g_components.mutex);
+}
+
+int cache_get_component_info(const char* paramName, component_info_t** info) {
+    if (!paramName || !info) return -1;
+    *info = NULL;
+
+    int id = cache_component_lookup(paramName);
+    if (id < 0) return id;
+
+    component_info_t* out = (component_info_t*)calloc(1, sizeof(component_info_t));
+    if (!out) return -1;
+
+    pthread_mutex_lock(&g_components.mutex);
+    if (id >= g_components.component_count) {
+        pthread_mutex_unlock(&g_components.mutex);
+        free(out);
+        return CACHE_COMPONENT_UNKNOWN;
+    }
+    component_rec_t* rec = &g_components.components[id];
+    out->component_name = strdup(rec->name);
+    out->last_discovered = rec->last_discovered;
+    int total = 0;
+    for (int b = 0; b < ROUTE_BUCKETS; b++) {
+        for (route_t* r = g_components.routes.buckets[b]; r; r = r->next) {
+            if (r->component == id) total++;
+        }
+    }
+    out->supported_params = total > 0 ? (char**)calloc(total, sizeof(char*)) : NULL;
+    for (int b = 0; b < ROUTE_BUCKETS && out->supported_params; b++) {
+        for (route_t* r = g_components.routes.buckets[b]; r; r = r->next) {
+            if (r->component == id) out->supported_params[out->param_count++] = strdup(r->key);
+        }
+    }
+    pthread_mutex_unlock(&g_components.mutex);
+
+    if (!out->component_name) {
+        cache_free_component_info(out);
+        return -1;
+    }
+    *info = out;
+    return 0;
+}
+
+int cache_set_component_info(const char* paramName, const component_info_t* info) {
+    if (!info || !info->component_name) return -1;
+
+    int id = paramName ? cache_component_learn(paramName, info->component_name) : -1;
+    for (int i = 0; i < info->param_count; i++) {
+        if (info->supported_params && info->supported_params[i]) {
+            id = cache_component_learn(info->supported_params[i], info->component_name);
+        }
+    }
+    if (id < 0) return -1;
+    /* A full parameter list stands in for element discovery */
+    if (info->param_count > 0) cache_component_claim_elements(id);
+    return 0;
+}
+
+void cache_free_component_info(component_info_t* info) {
+    if (!info) return;
+    free(info->component_name);
+    free(info->dbus_path);
+    for (int i = 0; i < info->param_count; i++) free(info->supported_params[i]);
+    free(info->supported_params);
+    free(info);
+}
+
+int cache_invalidate_component_info(const char* componentName) {
+    int removed = 0;
+    pthread_mutex_lock(&g_components.mutex);
+    if (!componentName) {
+        removed = table_purge(&g_components.routes, 0, -1, NULL);
+        table_purge(&g_components.missing, 0, -1, NULL);
+        for (int i = 0; i < g_components.component_count; i++) {
+            g_components.components[i].elements_claimed = 0;
+        }
+    } else {
+        int id = component_id(componentName, 0);
+        if (id >= 0) {
+            removed = table_purge(&g_components.routes, 0, id, NULL);
+            g_components.components[id].elements_claimed = 0;
+        }
+    }
+    pthread_mutex_unlock(&g_components.mutex);
+
+    if (removed > 0) LOGI("Dropped %d component routes for %s", removed, componentName ? componentName : "all components");
+    return removed;
+}
+
+void cache_component_cleanup(void) {
+    pthread_mutex_lock(&g_components.mutex);
+    table_purge(&g_components.routes, 0, -1, NULL);
+    table_purge(&g_components.missing, 0, -1, NULL);
+    for (int i = 0; i < g_components.component_count; i++) {
+        free(g_components.components[i].name);
+    }
+    free(g_components.components);
+    g_components.components = NULL;
+    g_components.component_count = 0;
+    g_components.component_capacity = 0;
+    pthread_mutex_unlock(&g_components.mutex);
+}
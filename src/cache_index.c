@@ -0,0 +1,550 @@
+#include "cache_index.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/* Nodes with more children than this also index them by segment hash, so wide
+ * tables (thousands of instance rows) keep O(1) child lookup.
+ */
+#define CHILD_HASH_MIN 8
+
+/* The tree is split into independently locked shards by a key's first two path segments
+ * ("Device.WiFi."), so writers under different subtrees do not serialize. Prefixes
+ * shorter than that span every shard.
+ */
+#define INDEX_SHARD_COUNT 16
+#define INDEX_SHARD_DEPTH 2
+
+/* One path segment. Children live in an unordered array; each child knows its slot
+ * so it can be removed by swapping the last child into its place.
+ */
+typedef struct cache_index_node {
+    char* segment;                      /* Includes its trailing '.' when it has one */
+    uint32_t segment_hash;
+    struct cache_index_node* parent;
+    uint32_t slot;                      /* Position in parent->children */
+    struct cache_index_node** children;
+    uint32_t child_count;
+    uint32_t child_capacity;
+    struct cache_index_node** child_buckets; /* Chained by hash_next; NULL while small */
+    uint32_t child_bucket_mask;
+    struct cache_index_node* hash_next;
+    int is_key;                         /* A cached key ends at this node */
+    time_t complete_until;              /* Whole subtree cached until this time (0 = unknown) */
+} cache_index_node_t;
+
+typedef struct {
+    cache_index_node_t root;
+    pthread_rwlock_t lock;
+} cache_index_shard_t;
+
+static struct {
+    cache_index_shard_t shards[INDEX_SHARD_COUNT];
+    int initialized;
+} g_index = {0};
+
+/* Growable key list for collect */
+typedef struct {
+    char** keys;
+    int count;
+    int capacity;
+    int failed;
+    char* path;                         /* Name of the node being visited */
+    size_t path_len;
+    size_t path_capacity;
+} cache_index_collect_t;
+
+/* Length of the segment at s, including its trailing '.' */
+static size_t segment_len(const char* s) {
+    const char* dot = strchr(s, '.');
+    return dot ? (size_t)(dot - s) + 1 : strlen(s);
+}
+
+static uint32_t segment_hash(const char* seg, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)seg[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int segment_equal(const cache_index_node_t* node, const char* seg, size_t len) {
+    return strncmp(node->segment, seg, len) == 0 && node->segment[len] == '\0';
+}
+
+/* (Re)build the child hash of node at a size suited to its child count */
+static void child_hash_rebuild(cache_index_node_t* node) {
+    free(node->child_buckets);
+    node->child_buckets = NULL;
+    node->child_bucket_mask = 0;
+    if (node->child_count <= CHILD_HASH_MIN) return;
+
+    uint32_t buckets = 16;
+    while (buckets < node->child_count) buckets *= 2;
+    node->child_buckets = calloc(buckets, sizeof(cache_index_node_t*));
+    if (!node->child_buckets) return; /* lookups fall back to scanning */
+    node->child_bucket_mask = buckets - 1;
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        cache_index_node_t* child = node->children[i];
+        uint32_t b = child->segment_hash & node->child_bucket_mask;
+        child->hash_next = node->child_buckets[b];
+        node->child_buckets[b] = child;
+    }
+}
+
+static cache_index_node_t* child_find(const cache_index_node_t* node, const char* seg, size_t len) {
+    if (node->child_buckets) {
+        uint32_t hash = segment_hash(seg, len);
+        cache_index_node_t* child = node->child_buckets[hash & node->child_bucket_mask];
+        while (child && (child->segment_hash != hash || !segment_equal(child, seg, len))) {
+            child = child->hash_next;
+        }
+        return child;
+    }
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        if (segment_equal(node->children[i], seg, len)) return node->children[i];
+    }
+    return NULL;
+}
+
+static cache_index_node_t* child_get_or_create(cache_index_node_t* node, const char* seg, size_t len) {
+    cache_index_node_t* child = child_find(node, seg, len);
+    if (child) return child;
+
+    if (node->child_count == node->child_capacity) {
+        uint32_t capacity = node->child_capacity ? node->child_capacity * 2 : 4;
+        cache_index_node_t** children = realloc(node->children, capacity * sizeof(cache_index_node_t*));
+        if (!children) return NULL;
+        node->children = children;
+        node->child_capacity = capacity;
+    }
+
+    child = calloc(1, sizeof(cache_index_node_t));
+    if (!child) return NULL;
+    child->segment = malloc(len + 1);
+    if (!child->segment) {
+        free(child);
+        return NULL;
+    }
+    memcpy(child->segment, seg, len);
+    child->segment[len] = '\0';
+    child->segment_hash = segment_hash(seg, len);
+    child->parent = node;
+    child->slot = node->child_count;
+    node->children[node->child_count++] = child;
+
+    if (node->child_buckets && node->child_count <= (node->child_bucket_mask + 1) * 2) {
+        uint32_t b = child->segment_hash & node->child_bucket_mask;
+        child->hash_next = node->child_buckets[b];
+        node->child_buckets[b] = child;
+    } else if (node->child_count > CHILD_HASH_MIN) {
+        child_hash_rebuild(node);
+    }
+    return child;
+}
+
+static void node_free(cache_index_node_t* node) {
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        node_free(node->children[i]);
+    }
+    free(node->children);
+    free(node->child_buckets);
+    free(node->segment);
+    free(node);
+}
+
+static void node_detach(cache_index_node_t* node) {
+    cache_index_node_t* parent = node->parent;
+    if (parent->child_buckets) {
+        cache_index_node_t** link = &parent->child_buckets[node->segment_hash & parent->child_bucket_mask];
+        while (*link && *link != node) {
+            link = &(*link)->hash_next;
+        }
+        if (*link) *link = node->hash_next;
+    }
+    cache_index_node_t* last = parent->children[--parent->child_count];
+    parent->children[node->slot] = last;
+    last->slot = node->slot;
+    if (parent->child_count <= CHILD_HASH_MIN && parent->child_buckets) {
+        child_hash_rebuild(parent);
+    }
+}
+
+/* Free nodes that no longer carry a key, a mark or children, walking towards the root */
+static void node_prune(cache_index_node_t* node) {
+    while (node && node->parent && !node->is_key && node->child_count == 0 && node->complete_until == 0) {
+        cache_index_node_t* parent = node->parent;
+        node_detach(node);
+        node_free(node);
+        node = parent;
+    }
+}
+
+/* Walk the complete segments of prefix. Returns the deepest node reached (NULL if a
+ * segment is missing) and the unmatched remainder in *rest. *complete reports whether
+ * a node on the path holds a mark valid at now.
+ */
+static cache_index_node_t* walk_prefix(cache_index_node_t* root, const char* prefix, const char** rest, time_t now,
+                                       int* complete) {
+    cache_index_node_t* node = root;
+    int marked = node->complete_until > now;
+
+    while (*prefix) {
+        size_t len = segment_len(prefix);
+        if (prefix[len - 1] != '.') break;  /* partial last segment */
+        node = child_find(node, prefix, len);
+        if (!node) {
+            *rest = prefix;
+            if (complete) *complete = marked;
+            return NULL;
+        }
+        if (node->complete_until > now) marked = 1;
+        prefix += len;
+    }
+
+    *rest = prefix;
+    if (complete) *complete = marked;
+    return node;
+}
+
+static int collect_push_path(cache_index_collect_t* c, const char* seg) {
+    size_t len = strlen(seg);
+    if (c->path_len + len + 1 > c->path_capacity) {
+        size_t capacity = c->path_capacity ? c->path_capacity : 256;
+        while (c->path_len + len + 1 > capacity) capacity *= 2;
+        char* path = realloc(c->path, capacity);
+        if (!path) return -1;
+        c->path = path;
+        c->path_capacity = capacity;
+    }
+    memcpy(c->path + c->path_len, seg, len + 1);
+    c->path_len += len;
+    return 0;
+}
+
+static void collect_add(cache_index_collect_t* c) {
+    if (c->count == c->capacity) {
+        int capacity = c->capacity ? c->capacity * 2 : 16;
+        char** keys = realloc(c->keys, capacity * sizeof(char*));
+        if (!keys) {
+            c->failed = 1;
+            return;
+        }
+        c->keys = keys;
+        c->capacity = capacity;
+    }
+    char* key = strdup(c->path);
+    if (!key) {
+        c->failed = 1;
+        return;
+    }
+    c->keys[c->count++] = key;
+}
+
+/* Depth-first over node's subtree; c->path holds node's full name on entry */
+static void collect_subtree(cache_index_collect_t* c, const cache_index_node_t* node) {
+    if (c->failed) return;
+    if (node->is_key) collect_add(c);
+
+    for (uint32_t i = 0; i < node->child_count && !c->failed; i++) {
+        size_t saved = c->path_len;
+        if (collect_push_path(c, node->children[i]->segment) != 0) {
+            c->failed = 1;
+            return;
+        }
+        collect_subtree(c, node->children[i]);
+        c->path_len = saved;
+        c->path[saved] = '\0';
+    }
+}
+
+/* Shard holding every key under s when s starts with INDEX_SHARD_DEPTH whole segments,
+ * NULL when s is shorter (a prefix spanning shards). For keys, a short name is routed
+ * by the segments it has; nothing else can live under it.
+ */
+static cache_index_shard_t* shard_for(const char* s, int is_key) {
+    size_t len = 0;
+    int depth = 0;
+    while (depth < INDEX_SHARD_DEPTH && s[len]) {
+        size_t seg = segment_len(s + len);
+        if (!is_key && s[len + seg - 1] != '.') return NULL;  /* partial segment */
+        len += seg;
+        depth++;
+    }
+    if (len == 0 || (!is_key && depth < INDEX_SHARD_DEPTH)) return NULL;
+    return &g_index.shards[segment_hash(s, len) % INDEX_SHARD_COUNT];
+}
+
+int cache_index_init(void) {
+    if (g_index.initialized) return 0;
+    memset(&g_index, 0, sizeof(g_index));
+    for (int i = 0; i < INDEX_SHARD_COUNT; i++) {
+        if (pthread_rwlock_init(&g_index.shards[i].lock, NULL) != 0) {
+            LOGE("Failed to initialize cache index lock: %s", "pthread_rwlock_init failed");
+            while (--i >= 0) pthread_rwlock_destroy(&g_index.shards[i].lock);
+            return -1;
+        }
+    }
+    g_index.initialized = 1;
+    return 0;
+}
+
+static void cache_index_reset_locked(cache_index_shard_t* shard) {
+    for (uint32_t i = 0; i < shard->root.child_count; i++) {
+        node_free(shard->root.children[i]);
+    }
+    free(shard->root.children);
+    free(shard->root.child_buckets);
+    memset(&shard->root, 0, sizeof(shard->root));
+}
+
+void cache_index_cleanup(void) {
+    if (!g_index.initialized) return;
+    for (int i = 0; i < INDEX_SHARD_COUNT; i++) {
+        cache_index_shard_t* shard = &g_index.shards[i];
+        pthread_rwlock_wrlock(&shard->lock);
+        cache_index_reset_locked(shard);
+        pthread_rwlock_unlock(&shard->lock);
+        pthread_rwlock_destroy(&shard->lock);
+    }
+    memset(&g_index, 0, sizeof(g_index));
+}
+
+void cache_index_clear(void) {
+    if (!g_index.initialized) return;
+    for (int i = 0; i < INDEX_SHARD_COUNT; i++) {
+        cache_index_shard_t* shard = &g_index.shards[i];
+        pthread_rwlock_wrlock(&shard->lock);
+        cache_index_reset_locked(shard);
+        pthread_rwlock_unlock(&shard->lock);
+    }
+}
+
+int cache_index_insert(const char* key) {
+    if (!g_index.initialized || !key || !*key) return -1;
+
+    cache_index_shard_t* shard = shard_for(key, 1);
+    pthread_rwlock_wrlock(&shard->lock);
+    cache_index_node_t* node = &shard->root;
+    while (*key) {
+        size_t len = segment_len(key);
+        cache_index_node_t* child = child_get_or_create(node, key, len);
+        if (!child) {
+            node_prune(node);
+            pthread_rwlock_unlock(&shard->lock);
+            return -1;
+        }
+        node = child;
+        key += len;
+    }
+    node->is_key = 1;
+    pthread_rwlock_unlock(&shard->lock);
+    return 0;
+}
+
+void cache_index_remove(const char* key) {
+    if (!g_index.initialized || !key || !*key) return;
+
+    /* Marks on short prefixes are kept per shard, so clearing this shard's copies is
+     * enough for collect to see the prefix as incomplete.
+     */
+    cache_index_shard_t* shard = shard_for(key, 1);
+    pthread_rwlock_wrlock(&shard->lock);
+    cache_index_node_t* node = &shard->root;
+    node->complete_until = 0;
+    while (node && *key) {
+        size_t len = segment_len(key);
+        node = child_find(node, key, len);
+        if (node) node->complete_until = 0; /* a cached key is gone, the subtree is no longer complete */
+        key += len;
+    }
+    if (node && node->parent) {
+        node->is_key = 0;
+        node_prune(node);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+/* Collect matches for prefix from one shard into c. *complete reports whether a mark
+ * valid at now covers the prefix in this shard. Returns -1 on allocation failure.
+ */
+static int collect_shard(cache_index_shard_t* shard, const char* prefix, time_t now, cache_index_collect_t* c,
+                         int* complete) {
+    const char* rest = NULL;
+
+    pthread_rwlock_rdlock(&shard->lock);
+    cache_index_node_t* node = walk_prefix(&shard->root, prefix, &rest, now, complete);
+    if (!node) {
+        pthread_rwlock_unlock(&shard->lock);
+        return 0;
+    }
+
+    size_t matched = (size_t)(rest - prefix);
+    if (matched + 1 > c->path_capacity) {
+        char* path = realloc(c->path, matched + 1);
+        if (!path) {
+            pthread_rwlock_unlock(&shard->lock);
+            return -1;
+        }
+        c->path = path;
+        c->path_capacity = matched + 1;
+    }
+    memcpy(c->path, prefix, matched);
+    c->path[matched] = '\0';
+    c->path_len = matched;
+
+    if (*rest == '\0') {
+        collect_subtree(c, node);
+    } else {
+        /* Partial last segment: every child starting with it */
+        size_t rest_len = strlen(rest);
+        for (uint32_t i = 0; i < node->child_count && !c->failed; i++) {
+            if (strncmp(node->children[i]->segment, rest, rest_len) != 0) continue;
+            if (collect_push_path(c, node->children[i]->segment) != 0) {
+                c->failed = 1;
+                break;
+            }
+            collect_subtree(c, node->children[i]);
+            c->path_len = matched;
+            c->path[matched] = '\0';
+        }
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    return c->failed ? -1 : 0;
+}
+
+int cache_index_collect(const char* prefix, int require_complete, time_t now, char*** keys, int* count) {
+    if (!g_index.initialized || !prefix || !keys || !count) return -1;
+    *keys = NULL;
+    *count = 0;
+
+    cache_index_collect_t c = {0};
+    cache_index_shard_t* single = shard_for(prefix, 0);
+    int first = single ? (int)(single - g_index.shards) : 0;
+    int last = single ? first : INDEX_SHARD_COUNT - 1;
+
+    /* A prefix spanning shards is complete only if every shard holds a valid mark */
+    int rc = 0;
+    for (int i = first; i <= last && rc == 0; i++) {
+        int complete = 0;
+        rc = collect_shard(&g_index.shards[i], prefix, now, &c, &complete);
+        if (require_complete && !complete) rc = -1;
+    }
+    free(c.path);
+
+    if (rc != 0) {
+        for (int i = 0; i < c.count; i++) free(c.keys[i]);
+        free(c.keys);
+        return -1;
+    }
+
+    *keys = c.keys;
+    *count = c.count;
+    return 0;
+}
+
+static int mark_shard(cache_index_shard_t* shard, const char* prefix, time_t until) {
+    pthread_rwlock_wrlock(&shard->lock);
+    cache_index_node_t* node = &shard->root;
+    while (*prefix) {
+        size_t len = segment_len(prefix);
+        cache_index_node_t* child = child_get_or_create(node, prefix, len);
+        if (!child) {
+            node_prune(node);
+            pthread_rwlock_unlock(&shard->lock);
+            return -1;
+        }
+        node = child;
+        prefix += len;
+    }
+    node->complete_until = until;
+    pthread_rwlock_unlock(&shard->lock);
+    return 0;
+}
+
+int cache_index_mark_complete(const char* prefix, time_t until) {
+    if (!g_index.initialized || !prefix) return -1;
+    size_t plen = strlen(prefix);
+    if (plen == 0 || prefix[plen - 1] != '.') return -1;
+
+    cache_index_shard_t* single = shard_for(prefix, 0);
+    if (single) return mark_shard(single, prefix, until);
+    for (int i = 0; i < INDEX_SHARD_COUNT; i++) {
+        if (mark_shard(&g_index.shards[i], prefix, until) != 0) return -1;
+    }
+    return 0;
+}
+
+/* Clear marks below node and free descendants left empty; returns 1 if node itself is now empty */
+static int clear_subtree(cache_index_node_t* node) {
+    node->complete_until = 0;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        cache_index_node_t* child = node->children[i];
+        if (clear_subtree(child)) {
+            node_free(child);
+        } else {
+            child->slot = kept;
+            node->children[kept++] = child;
+        }
+    }
+    if (kept != node->child_count) {
+        node->child_count = kept;
+        child_hash_rebuild(node);
+    }
+    return !node->is_key && node->child_count == 0;
+}
+
+static void clear_complete_shard(cache_index_shard_t* shard, const char* prefix) {
+    pthread_rwlock_wrlock(&shard->lock);
+    /* Ancestors lose their marks too: part of their subtree changed */
+    cache_index_node_t* node = &shard->root;
+    node->complete_until = 0;
+    const char* rest = prefix;
+    while (*rest) {
+        size_t len = segment_len(rest);
+        if (rest[len - 1] != '.') break;
+        node = child_find(node, rest, len);
+        if (!node) break;
+        node->complete_until = 0;
+        rest += len;
+    }
+
+    if (node) {
+        if (*rest == '\0') {
+            if (clear_subtree(node) && node->parent) {
+                node_prune(node);
+            }
+        } else {
+            size_t rest_len = strlen(rest);
+            uint32_t i = 0;
+            while (i < node->child_count) {
+                cache_index_node_t* child = node->children[i];
+                if (strncmp(child->segment, rest, rest_len) == 0 && clear_subtree(child)) {
+                    node_detach(child);  /* moves the last child into slot i */
+                    node_free(child);
+                } else {
+                    i++;
+                }
+            }
+            node_prune(node);
+        }
+    }
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+void cache_index_clear_complete(const char* prefix) {
+    if (!g_index.initialized || !prefix) return;
+
+    cache_index_shard_t* single = shard_for(prefix, 0);
+    if (single) {
+        clear_complete_shard(single, prefix);
+        return;
+    }
+    for (int i = 0; i < INDEX_SHARD_COUNT; i++) {
+        clear_complete_shard(&g_index.shards[i], prefix);
+    }
+}
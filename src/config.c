@@ -7,15 +7,55 @@ p2r_config_t g_p2r_config = {
    .rbus_component = "parodus2rbus.client", /* default RBUS component */
    .service_name = "config",               /* default Parodus service */
    .mode = "parodus",                      /* default mode */
-   .log_level = 2
+   .log_level = 2,
+   .worker_threads = 0,                    /* inline handling */
+   .queue_depth = 64,
+   .reply_batch_ms = 0,                    /* send replies as soon as they are encoded */
+   .wildcard_cache_fill = 1,
+   .cache_coherence = 0,
+   .coherent_prefixes = NULL,
+   .cache_max_entries = 50000,
+   .cache_max_memory_mb = 0,               /* entry count is the only limit */
+   .notify_coalesce_ms = 0,                /* coalesce only changes still waiting in the queue */
+   .set_preread = P2R_SET_PREREAD_AUTO,
+   .webconfig_spill = 0,                   /* rollback snapshots stay in memory */
+   .cache_snapshot = NULL,                 /* no warm-start snapshot */
+   .cache_snapshot_interval = 0,           /* snapshot written at shutdown only */
+   .metrics_port = 0,                      /* no metrics endpoint */
+   .metrics_interval = 60,
+   .stream_flush_ms = 10,
+   .stream_buffer_kb = 64,
+   .event_batch_ms = 100,
+   .event_batch_max = 64,
+   .event_ring_size = 4096,
+   .trace_sample = 0,                      /* no sampled traces */
+   .trace_slow_ms = 0,                     /* no slow-request traces */
+   .trace_ring = 256,
+   .trace_output = NULL
 };
 
 int g_p2r_log_level = 2;
 
 static void usage(const char* prog) {
-   fprintf(stderr, "Usage: %s [--component RBUS_NAME] [--service-name PARODUS_NAME] [--mode mock|parodus] [--log N]\n", prog);
-   fprintf(stderr, "Defaults: --component %s --service-name %s --mode %s --log %d\n",
-      g_p2r_config.rbus_component, g_p2r_config.service_name, g_p2r_config.mode, g_p2r_config.log_level);
+   fprintf(stderr, "Usage: %s [--component RBUS_NAME] [--service-name PARODUS_NAME] [--mode mock|stream|parodus] [--log N] [--workers N] [--queue-depth N] [--wildcard-cache 0|1]\n"
+      "       [--reply-batch-ms N] [--cache-coherence 0|1] [--coherent-prefixes P1,P2,...] [--cache-size N] [--cache-memory-mb N]\n"
+      "       [--notify-coalesce-ms N] [--set-preread auto|always|never] [--webconfig-spill 0|1]\n"
+      "       [--cache-snapshot FILE] [--cache-snapshot-interval N] [--metrics-port N] [--metrics-interval N]\n"
+      "       [--stream-flush-ms N] [--stream-buffer-kb N] [--event-batch-ms N] [--event-batch-max N] [--event-ring N]\n"
+      "       [--trace-sample N] [--trace-slow-ms N] [--trace-ring N] [--trace-output FILE]\n", prog);
+   fprintf(stderr, "Defaults: --component %s --service-name %s --mode %s --log %d --workers %d --queue-depth %d --wildcard-cache %d --cache-coherence %d\n"
+      "          --reply-batch-ms %d --cache-size %d --cache-memory-mb %d --notify-coalesce-ms %d --set-preread auto\n"
+      "          --webconfig-spill %d --cache-snapshot-interval %d --metrics-port %d --metrics-interval %d\n"
+      "          --stream-flush-ms %d --stream-buffer-kb %d --event-batch-ms %d --event-batch-max %d --event-ring %d\n"
+      "          --trace-sample %d --trace-slow-ms %d --trace-ring %d\n",
+      g_p2r_config.rbus_component, g_p2r_config.service_name, g_p2r_config.mode, g_p2r_config.log_level,
+      g_p2r_config.worker_threads, g_p2r_config.queue_depth, g_p2r_config.wildcard_cache_fill,
+      g_p2r_config.cache_coherence, g_p2r_config.reply_batch_ms, g_p2r_config.cache_max_entries, g_p2r_config.cache_max_memory_mb,
+      g_p2r_config.notify_coalesce_ms, g_p2r_config.webconfig_spill, g_p2r_config.cache_snapshot_interval,
+      g_p2r_config.metrics_port, g_p2r_config.metrics_interval, g_p2r_config.stream_flush_ms,
+      g_p2r_config.stream_buffer_kb, g_p2r_config.event_batch_ms, g_p2r_config.event_batch_max,
+      g_p2r_config.event_ring_size, g_p2r_config.trace_sample, g_p2r_config.trace_slow_ms,
+      g_p2r_config.trace_ring);
 }
 
 void p2r_load_config(int argc, char** argv) {
@@ -28,6 +68,65 @@ void p2r_load_config(int argc, char** argv) {
          g_p2r_config.mode = argv[++i];
       } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
          g_p2r_config.log_level = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+         g_p2r_config.worker_threads = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--queue-depth") == 0 && i + 1 < argc) {
+         g_p2r_config.queue_depth = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--reply-batch-ms") == 0 && i + 1 < argc) {
+         g_p2r_config.reply_batch_ms = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--wildcard-cache") == 0 && i + 1 < argc) {
+         g_p2r_config.wildcard_cache_fill = atoi(argv[++i]) != 0;
+      } else if (strcmp(argv[i], "--cache-coherence") == 0 && i + 1 < argc) {
+         g_p2r_config.cache_coherence = atoi(argv[++i]) != 0;
+      } else if (strcmp(argv[i], "--coherent-prefixes") == 0 && i + 1 < argc) {
+         g_p2r_config.coherent_prefixes = argv[++i];
+      } else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+         g_p2r_config.cache_max_entries = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--cache-memory-mb") == 0 && i + 1 < argc) {
+         g_p2r_config.cache_max_memory_mb = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--notify-coalesce-ms") == 0 && i + 1 < argc) {
+         g_p2r_config.notify_coalesce_ms = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--set-preread") == 0 && i + 1 < argc) {
+         const char* preread = argv[++i];
+         if (strcmp(preread, "auto") == 0) {
+            g_p2r_config.set_preread = P2R_SET_PREREAD_AUTO;
+         } else if (strcmp(preread, "always") == 0) {
+            g_p2r_config.set_preread = P2R_SET_PREREAD_ALWAYS;
+         } else if (strcmp(preread, "never") == 0) {
+            g_p2r_config.set_preread = P2R_SET_PREREAD_NEVER;
+         } else {
+            fprintf(stderr, "Invalid --set-preread: %s\n", preread);
+            usage(argv[0]);
+            exit(1);
+         }
+      } else if (strcmp(argv[i], "--webconfig-spill") == 0 && i + 1 < argc) {
+         g_p2r_config.webconfig_spill = atoi(argv[++i]) ? 1 : 0;
+      } else if (strcmp(argv[i], "--cache-snapshot") == 0 && i + 1 < argc) {
+         g_p2r_config.cache_snapshot = argv[++i];
+      } else if (strcmp(argv[i], "--cache-snapshot-interval") == 0 && i + 1 < argc) {
+         g_p2r_config.cache_snapshot_interval = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+         g_p2r_config.metrics_port = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+         g_p2r_config.metrics_interval = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--stream-flush-ms") == 0 && i + 1 < argc) {
+         g_p2r_config.stream_flush_ms = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--stream-buffer-kb") == 0 && i + 1 < argc) {
+         g_p2r_config.stream_buffer_kb = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--event-batch-ms") == 0 && i + 1 < argc) {
+         g_p2r_config.event_batch_ms = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--event-batch-max") == 0 && i + 1 < argc) {
+         g_p2r_config.event_batch_max = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--event-ring") == 0 && i + 1 < argc) {
+         g_p2r_config.event_ring_size = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--trace-sample") == 0 && i + 1 < argc) {
+         g_p2r_config.trace_sample = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--trace-slow-ms") == 0 && i + 1 < argc) {
+         g_p2r_config.trace_slow_ms = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--trace-ring") == 0 && i + 1 < argc) {
+         g_p2r_config.trace_ring = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--trace-output") == 0 && i + 1 < argc) {
+         g_p2r_config.trace_output = argv[++i];
       } else if (strcmp(argv[i], "--help") == 0) {
          usage(argv[0]);
          exit(0);
@@ -39,6 +138,23 @@ void p2r_load_config(int argc, char** argv) {
    }
    if (g_p2r_config.log_level < 0) g_p2r_config.log_level = 0;
    if (g_p2r_config.log_level > 3) g_p2r_config.log_level = 3;
+   if (g_p2r_config.worker_threads < 0) g_p2r_config.worker_threads = 0;
+   if (g_p2r_config.queue_depth < 1) g_p2r_config.queue_depth = 1;
+   if (g_p2r_config.reply_batch_ms < 0) g_p2r_config.reply_batch_ms = 0;
+   if (g_p2r_config.cache_max_entries < 1) g_p2r_config.cache_max_entries = 1;
+   if (g_p2r_config.cache_max_memory_mb < 0) g_p2r_config.cache_max_memory_mb = 0;
+   if (g_p2r_config.notify_coalesce_ms < 0) g_p2r_config.notify_coalesce_ms = 0;
+   if (g_p2r_config.cache_snapshot_interval < 0) g_p2r_config.cache_snapshot_interval = 0;
+   if (g_p2r_config.metrics_port < 0 || g_p2r_config.metrics_port > 65535) g_p2r_config.metrics_port = 0;
+   if (g_p2r_config.metrics_interval < 1) g_p2r_config.metrics_interval = 1;
+   if (g_p2r_config.stream_flush_ms < 0) g_p2r_config.stream_flush_ms = 0;
+   if (g_p2r_config.stream_buffer_kb < 1) g_p2r_config.stream_buffer_kb = 1;
+   if (g_p2r_config.event_batch_ms < 0) g_p2r_config.event_batch_ms = 0;
+   if (g_p2r_config.event_batch_max < 1) g_p2r_config.event_batch_max = 1;
+   if (g_p2r_config.event_ring_size < 2) g_p2r_config.event_ring_size = 2;
+   if (g_p2r_config.trace_sample < 0) g_p2r_config.trace_sample = 0;
+   if (g_p2r_config.trace_slow_ms < 0) g_p2r_config.trace_slow_ms = 0;
+   if (g_p2r_config.trace_ring < 1) g_p2r_config.trace_ring = 1;
    g_p2r_log_level = g_p2r_config.log_level;
-   LOGI("Config: rbus_component=%s service_name=%s mode=%s log=%d", g_p2r_config.rbus_component, g_p2r_config.service_name, g_p2r_config.mode, g_p2r_config.log_level);
+   LOGI("Config: rbus_component=%s service_name=%s mode=%s log=%d workers=%d queue_depth=%d", g_p2r_config.rbus_component, g_p2r_config.service_name, g_p2r_config.mode, g_p2r_config.log_level, g_p2r_config.worker_threads, g_p2r_config.queue_depth);
 }
@@ -0,0 +1,265 @@
+#include "dispatcher.h"
+#include "performance.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#define DISPATCHER_MAX_WORKERS 64
+#define DISPATCHER_DEFAULT_BATCH 32
+
+/* Queued job with its enqueue time for wait-time accounting */
+typedef struct {
+    void* job;
+    double enqueued_ms;
+} dispatcher_slot_t;
+
+struct dispatcher {
+    char name[48];
+    dispatcher_job_fn fn;
+    dispatcher_batch_fn batch_fn;
+    int batch_max;
+    int batch_window_ms;
+    dispatcher_slot_t* ring;
+    int capacity;
+    int head;
+    int count;
+    int stopping;
+    int busy_workers;
+    pthread_t workers[DISPATCHER_MAX_WORKERS];
+    int worker_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    dispatcher_stats_t stats;
+    double total_wait_ms;
+    perf_metric_id_t depth_metric;
+    perf_metric_id_t wait_metric;
+    perf_metric_id_t busy_metric;
+};
+
+static double monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+/* Give producers up to batch_window_ms to fill the batch. Called with the mutex held. */
+static void dispatcher_wait_for_batch(dispatcher_t* d) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += d->batch_window_ms / 1000;
+    deadline.tv_nsec += (long)(d->batch_window_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    while (d->count < d->batch_max && !d->stopping) {
+        if (pthread_cond_timedwait(&d->not_empty, &d->mutex, &deadline) == ETIMEDOUT) break;
+    }
+}
+
+static void* dispatcher_worker(void* arg) {
+    dispatcher_t* d = (dispatcher_t*)arg;
+    void* single = NULL;
+    void** jobs = &single;
+    int max_take = 1;
+    if (d->batch_fn) {
+        jobs = calloc(d->batch_max, sizeof(void*));
+        if (jobs) {
+            max_take = d->batch_max;
+        } else {
+            jobs = &single;
+        }
+    }
+
+    pthread_mutex_lock(&d->mutex);
+    while (1) {
+        while (d->count == 0 && !d->stopping) {
+            pthread_cond_wait(&d->not_empty, &d->mutex);
+        }
+        /* Drain remaining jobs before honouring the stop request */
+        if (d->count == 0 && d->stopping) break;
+        if (max_take > 1 && d->batch_window_ms > 0) dispatcher_wait_for_batch(d);
+
+        int taken = d->count < max_take ? d->count : max_take;
+        double now_ms = monotonic_ms();
+        double wait_ms = now_ms - d->ring[d->head].enqueued_ms;
+        for (int i = 0; i < taken; i++) {
+            jobs[i] = d->ring[d->head].job;
+            d->total_wait_ms += now_ms - d->ring[d->head].enqueued_ms;
+            d->head = (d->head + 1) % d->capacity;
+        }
+        d->count -= taken;
+        d->busy_workers++;
+
+        d->stats.queue_depth = (uint32_t)d->count;
+        d->stats.last_wait_ms = wait_ms;
+        int depth = d->count;
+        int busy = d->busy_workers;
+        if (taken > 1) {
+            pthread_cond_broadcast(&d->not_full);
+        } else {
+            pthread_cond_signal(&d->not_full);
+        }
+        pthread_mutex_unlock(&d->mutex);
+
+        perf_gauge_set_id(d->depth_metric, depth);
+        perf_gauge_set_id(d->wait_metric, wait_ms);
+        perf_gauge_set_id(d->busy_metric, busy);
+
+        if (d->batch_fn) {
+            d->batch_fn(jobs, taken);
+        } else {
+            d->fn(jobs[0]);
+        }
+
+        pthread_mutex_lock(&d->mutex);
+        d->busy_workers--;
+        d->stats.completed += (uint64_t)taken;
+        d->stats.avg_wait_ms = d->total_wait_ms / d->stats.completed;
+    }
+    pthread_mutex_unlock(&d->mutex);
+    if (jobs != &single) free(jobs);
+    return NULL;
+}
+
+static dispatcher_t* dispatcher_start(const dispatcher_config_t* config, dispatcher_job_fn fn, dispatcher_batch_fn batch_fn) {
+    if (!config || (!fn && !batch_fn) || config->worker_count <= 0) return NULL;
+
+    dispatcher_t* d = calloc(1, sizeof(dispatcher_t));
+    if (!d) return NULL;
+
+    snprintf(d->name, sizeof(d->name), "%s", config->name ? config->name : "dispatcher");
+    d->fn = fn;
+    d->batch_fn = batch_fn;
+    d->capacity = config->queue_capacity > 0 ? config->queue_capacity : 64;
+    d->batch_max = config->batch_max > 0 ? config->batch_max : DISPATCHER_DEFAULT_BATCH;
+    /* A batch can never be larger than what the queue holds */
+    if (d->batch_max > d->capacity) d->batch_max = d->capacity;
+    d->batch_window_ms = config->batch_window_ms > 0 ? config->batch_window_ms : 0;
+    d->ring = calloc(d->capacity, sizeof(dispatcher_slot_t));
+    if (!d->ring) {
+        free(d);
+        return NULL;
+    }
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&d->mutex, NULL);
+    pthread_cond_init(&d->not_empty, &cond_attr);
+    pthread_cond_init(&d->not_full, NULL);
+    pthread_condattr_destroy(&cond_attr);
+
+    char metric_name[96];
+    snprintf(metric_name, sizeof(metric_name), "%s.queue_depth", d->name);
+    d->depth_metric = perf_metric_id(metric_name, PERF_METRIC_GAUGE, PERF_CAT_PARODUS);
+    snprintf(metric_name, sizeof(metric_name), "%s.queue_wait_ms", d->name);
+    d->wait_metric = perf_metric_id(metric_name, PERF_METRIC_GAUGE, PERF_CAT_PARODUS);
+    snprintf(metric_name, sizeof(metric_name), "%s.busy_workers", d->name);
+    d->busy_metric = perf_metric_id(metric_name, PERF_METRIC_GAUGE, PERF_CAT_PARODUS);
+
+    int requested = config->worker_count;
+    if (requested > DISPATCHER_MAX_WORKERS) requested = DISPATCHER_MAX_WORKERS;
+    for (int i = 0; i < requested; i++) {
+        if (pthread_create(&d->workers[i], NULL, dispatcher_worker, d) != 0) {
+            LOGW("Dispatcher %s: failed to start worker %d", d->name, i);
+            break;
+        }
+        d->worker_count++;
+    }
+
+    if (d->worker_count == 0) {
+        LOGE("Dispatcher %s: no workers started: %s", d->name, "pthread_create failed");
+        pthread_cond_destroy(&d->not_full);
+        pthread_cond_destroy(&d->not_empty);
+        pthread_mutex_destroy(&d->mutex);
+        free(d->ring);
+        free(d);
+        return NULL;
+    }
+
+    if (d->batch_fn) {
+        LOGI("Dispatcher %s started: workers=%d, queue_capacity=%d, batch_max=%d, batch_window=%dms", d->name,
+             d->worker_count, d->capacity, d->batch_max, d->batch_window_ms);
+    } else {
+        LOGI("Dispatcher %s started: workers=%d, queue_capacity=%d", d->name, d->worker_count, d->capacity);
+    }
+    return d;
+}
+
+dispatcher_t* dispatcher_create(const dispatcher_config_t* config, dispatcher_job_fn fn) {
+    if (!fn) return NULL;
+    return dispatcher_start(config, fn, NULL);
+}
+
+dispatcher_t* dispatcher_create_batch(const dispatcher_config_t* config, dispatcher_batch_fn fn) {
+    if (!fn) return NULL;
+    return dispatcher_start(config, NULL, fn);
+}
+
+void dispatcher_destroy(dispatcher_t* d) {
+    if (!d) return;
+
+    pthread_mutex_lock(&d->mutex);
+    d->stopping = 1;
+    pthread_cond_broadcast(&d->not_empty);
+    pthread_cond_broadcast(&d->not_full);
+    pthread_mutex_unlock(&d->mutex);
+
+    for (int i = 0; i < d->worker_count; i++) {
+        pthread_join(d->workers[i], NULL);
+    }
+
+    LOGI("Dispatcher %s stopped: completed=%llu, max_depth=%u, avg_wait=%.3fms", d->name,
+         (unsigned long long)d->stats.completed, d->stats.max_queue_depth, d->stats.avg_wait_ms);
+
+    pthread_cond_destroy(&d->not_full);
+    pthread_cond_destroy(&d->not_empty);
+    pthread_mutex_destroy(&d->mutex);
+    free(d->ring);
+    free(d);
+}
+
+int dispatcher_submit(dispatcher_t* d, void* job) {
+    if (!d) return -1;
+
+    pthread_mutex_lock(&d->mutex);
+    while (d->count == d->capacity && !d->stopping) {
+        pthread_cond_wait(&d->not_full, &d->mutex);
+    }
+    if (d->stopping) {
+        d->stats.rejected++;
+        pthread_mutex_unlock(&d->mutex);
+        return -1;
+    }
+
+    int tail = (d->head + d->count) % d->capacity;
+    d->ring[tail].job = job;
+    d->ring[tail].enqueued_ms = monotonic_ms();
+    d->count++;
+    d->stats.submitted++;
+    d->stats.queue_depth = (uint32_t)d->count;
+    if (d->stats.queue_depth > d->stats.max_queue_depth) {
+        d->stats.max_queue_depth = d->stats.queue_depth;
+    }
+    int depth = d->count;
+    pthread_cond_signal(&d->not_empty);
+    pthread_mutex_unlock(&d->mutex);
+
+    perf_gauge_set_id(d->depth_metric, depth);
+    return 0;
+}
+
+int dispatcher_get_stats(dispatcher_t* d, dispatcher_stats_t* stats) {
+    if (!d || !stats) return -1;
+
+    pthread_mutex_lock(&d->mutex);
+    *stats = d->stats;
+    pthread_mutex_unlock(&d->mutex);
+    return 0;
+}
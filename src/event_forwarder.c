@@ -0,0 +1,342 @@
+#include "event_forwarder.h"
+#include "performance.h"
+#include "log.h"
+#include <cJSON.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define EVENT_RING_DEFAULT 4096
+#define EVENT_RING_MAX (1 << 20)
+#define EVENT_BATCH_DEFAULT 64
+
+/* One copied event; the pointer arrays and strings live in the same allocation */
+typedef struct {
+    const char* name;
+    const char* type;
+    double ts;                  /* Wall-clock seconds when the callback ran */
+    int prop_count;
+    const char** prop_names;
+    const char** prop_values;
+} event_record_t;
+
+/* Bounded MPMC ring (sequence-numbered cells): producers claim a slot with one CAS on
+ * head and publish it by advancing the cell's sequence; the forwarder is the only consumer.
+ */
+typedef struct {
+    uint64_t seq;
+    event_record_t* record;
+} event_cell_t;
+
+static struct {
+    event_cell_t* cells;
+    uint64_t mask;
+    uint64_t head;              /* Next slot to claim (producers) */
+    uint64_t tail;              /* Next slot to read (forwarder only) */
+    uint64_t pending;           /* Queued but not yet forwarded */
+    uint64_t dropped_since;     /* Drops not yet reported in a batch */
+    int running;
+    int pushers;                /* Callbacks inside event_forwarder_push */
+    int stop;
+    int wake[2];                /* Non-blocking pipe: callbacks wake the forwarder */
+    pthread_t thread;
+    event_forwarder_config_t config;
+    event_forwarder_stats_t stats;
+    perf_metric_id_t forwarded_id;
+    perf_metric_id_t dropped_id;
+    perf_metric_id_t batches_id;
+} g_fwd = { .wake = { -1, -1 } };
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double)ts.tv_sec + (double)(ts.tv_nsec / 1000000) / 1000.0;
+}
+
+static event_record_t* record_create(const char* name, const char* type, int prop_count,
+                                     const char* const* prop_names, const char* const* prop_values) {
+    size_t name_len = strlen(name) + 1;
+    size_t type_len = strlen(type ? type : "") + 1;
+    size_t size = sizeof(event_record_t) + 2 * (size_t)prop_count * sizeof(char*) + name_len + type_len;
+    for (int i = 0; i < prop_count; i++) {
+        size += strlen(prop_names[i] ? prop_names[i] : "") + 1;
+        size += strlen(prop_values[i] ? prop_values[i] : "") + 1;
+    }
+
+    event_record_t* record = malloc(size);
+    if (!record) return NULL;
+    record->prop_count = prop_count;
+    record->prop_names = (const char**)(record + 1);
+    record->prop_values = record->prop_names + prop_count;
+    record->ts = wall_seconds();
+
+    char* p = (char*)(record->prop_values + prop_count);
+    memcpy(p, name, name_len);
+    record->name = p;
+    p += name_len;
+    memcpy(p, type ? type : "", type_len);
+    record->type = p;
+    p += type_len;
+    for (int i = 0; i < prop_count; i++) {
+        const char* pn = prop_names[i] ? prop_names[i] : "";
+        const char* pv = prop_values[i] ? prop_values[i] : "";
+        size_t len = strlen(pn) + 1;
+        memcpy(p, pn, len);
+        record->prop_names[i] = p;
+        p += len;
+        len = strlen(pv) + 1;
+        memcpy(p, pv, len);
+        record->prop_values[i] = p;
+        p += len;
+    }
+    return record;
+}
+
+static int ring_push(event_record_t* record) {
+    uint64_t pos = __atomic_load_n(&g_fwd.head, __ATOMIC_RELAXED);
+    for (;;) {
+        event_cell_t* cell = &g_fwd.cells[pos & g_fwd.mask];
+        uint64_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(seq - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&g_fwd.head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->record = record;
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1; /* Full */
+        } else {
+            pos = __atomic_load_n(&g_fwd.head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static event_record_t* ring_pop(void) {
+    event_cell_t* cell = &g_fwd.cells[g_fwd.tail & g_fwd.mask];
+    uint64_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    if (seq != g_fwd.tail + 1) return NULL; /* Empty, or the producer has not published yet */
+    event_record_t* record = cell->record;
+    __atomic_store_n(&cell->seq, g_fwd.tail + g_fwd.mask + 1, __ATOMIC_RELEASE);
+    g_fwd.tail++;
+    return record;
+}
+
+static void wake_forwarder(void) {
+    char byte = 1;
+    /* The pipe is non-blocking: when it is full a wake-up is already pending */
+    ssize_t n = write(g_fwd.wake[1], &byte, 1);
+    (void)n;
+}
+
+static void count_drop(void) {
+    __atomic_add_fetch(&g_fwd.dropped_since, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_fwd.stats.dropped, 1, __ATOMIC_RELAXED);
+    perf_counter_add_id(g_fwd.dropped_id, 1);
+}
+
+int event_forwarder_push(const char* name, const char* type, int prop_count,
+                         const char* const* prop_names, const char* const* prop_values) {
+    if (!name || prop_count < 0) return -1;
+
+    /* Registering as a pusher before checking running lets stop wait for us to leave */
+    __atomic_add_fetch(&g_fwd.pushers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&g_fwd.running, __ATOMIC_SEQ_CST)) {
+        __atomic_sub_fetch(&g_fwd.pushers, 1, __ATOMIC_SEQ_CST);
+        return -1;
+    }
+
+    int rc = -1;
+    event_record_t* record = record_create(name, type, prop_count, prop_names, prop_values);
+    if (record && ring_push(record) == 0) {
+        uint64_t pending = __atomic_add_fetch(&g_fwd.pending, 1, __ATOMIC_RELAXED);
+        /* Wake on the first event of a batch (starts its timer) and on each full batch */
+        if (pending == 1 || pending % (uint64_t)g_fwd.config.batch_max == 0) wake_forwarder();
+        rc = 0;
+    } else {
+        free(record);
+        count_drop();
+    }
+    __atomic_sub_fetch(&g_fwd.pushers, 1, __ATOMIC_SEQ_CST);
+    return rc;
+}
+
+static char* render_batch(event_record_t** records, int count, uint64_t dropped) {
+    cJSON* root = cJSON_CreateObject();
+    if (!root) return NULL;
+    cJSON_AddStringToObject(root, "type", "EVENT_BATCH");
+    cJSON_AddNumberToObject(root, "count", count);
+    cJSON_AddNumberToObject(root, "dropped", (double)dropped);
+    cJSON* events = cJSON_AddArrayToObject(root, "events");
+    for (int i = 0; i < count && events; i++) {
+        event_record_t* record = records[i];
+        cJSON* item = cJSON_CreateObject();
+        if (!item) break;
+        cJSON_AddStringToObject(item, "event", record->name);
+        if (record->type[0]) cJSON_AddStringToObject(item, "event_type", record->type);
+        cJSON_AddNumberToObject(item, "ts", record->ts);
+        /* "value" keeps the single-event field that carried the first property */
+        if (record->prop_count > 0) cJSON_AddStringToObject(item, "value", record->prop_values[0]);
+        cJSON* props = cJSON_AddObjectToObject(item, "properties");
+        for (int j = 0; j < record->prop_count && props; j++) {
+            cJSON_AddStringToObject(props, record->prop_names[j], record->prop_values[j]);
+        }
+        cJSON_AddItemToArray(events, item);
+    }
+    char* out = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return out;
+}
+
+/* Forward everything queued, batch_max events per emit */
+static void forward_all(void) {
+    int batch_max = g_fwd.config.batch_max;
+    event_record_t** batch = malloc(sizeof(event_record_t*) * (size_t)batch_max);
+    if (!batch) return;
+
+    int count;
+    do {
+        count = 0;
+        event_record_t* record;
+        while (count < batch_max && (record = ring_pop()) != NULL) batch[count++] = record;
+        if (count == 0) break;
+        __atomic_sub_fetch(&g_fwd.pending, (uint64_t)count, __ATOMIC_RELAXED);
+
+        uint64_t dropped = __atomic_exchange_n(&g_fwd.dropped_since, 0, __ATOMIC_RELAXED);
+        char* payload = render_batch(batch, count, dropped);
+        if (payload) {
+            g_fwd.config.emit(payload, strlen(payload));
+            free(payload);
+            __atomic_add_fetch(&g_fwd.stats.forwarded, (uint64_t)count, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&g_fwd.stats.batches, 1, __ATOMIC_RELAXED);
+            perf_counter_add_id(g_fwd.forwarded_id, (uint64_t)count);
+            perf_counter_add_id(g_fwd.batches_id, 1);
+        } else {
+            LOGW("Dropped a batch of %d events: %s", count, "render failed");
+            __atomic_add_fetch(&g_fwd.stats.dropped, (uint64_t)count, __ATOMIC_RELAXED);
+            perf_counter_add_id(g_fwd.dropped_id, (uint64_t)count);
+        }
+        for (int i = 0; i < count; i++) free(batch[i]);
+    } while (count == batch_max);
+    free(batch);
+}
+
+static void* forwarder_thread(void* arg) {
+    (void)arg;
+    double batch_started = 0.0;     /* When the forwarder first saw the oldest waiting event */
+    for (;;) {
+        int stop = __atomic_load_n(&g_fwd.stop, __ATOMIC_ACQUIRE);
+        uint64_t pending = __atomic_load_n(&g_fwd.pending, __ATOMIC_RELAXED);
+        if (stop) break;
+
+        int timeout = -1;
+        if (pending >= (uint64_t)g_fwd.config.batch_max) {
+            timeout = 0;
+        } else if (pending > 0) {
+            double now = now_ms();
+            if (batch_started == 0.0) batch_started = now;
+            double left = batch_started + g_fwd.config.batch_ms - now;
+            timeout = left > 0 ? (int)left + 1 : 0;
+        }
+        if (timeout == 0) {
+            forward_all();
+            batch_started = 0.0;
+            continue;
+        }
+
+        struct pollfd pfd = { .fd = g_fwd.wake[0], .events = POLLIN, .revents = 0 };
+        if (poll(&pfd, 1, timeout) > 0) {
+            char drain[64];
+            while (read(g_fwd.wake[0], drain, sizeof(drain)) > 0) {}
+        }
+    }
+    forward_all();
+    return NULL;
+}
+
+int event_forwarder_start(const event_forwarder_config_t* config) {
+    if (g_fwd.running || !config || !config->emit) return -1;
+
+    g_fwd.config = *config;
+    if (g_fwd.config.batch_max < 1) g_fwd.config.batch_max = EVENT_BATCH_DEFAULT;
+    if (g_fwd.config.batch_ms < 0) g_fwd.config.batch_ms = 0;
+    int requested = config->ring_size > 0 ? config->ring_size : EVENT_RING_DEFAULT;
+    if (requested > EVENT_RING_MAX) requested = EVENT_RING_MAX;
+    uint64_t size = 2;
+    while (size < (uint64_t)requested) size <<= 1;
+
+    g_fwd.cells = calloc(size, sizeof(event_cell_t));
+    if (!g_fwd.cells) return -1;
+    for (uint64_t i = 0; i < size; i++) g_fwd.cells[i].seq = i;
+    g_fwd.mask = size - 1;
+    g_fwd.head = g_fwd.tail = g_fwd.pending = g_fwd.dropped_since = 0;
+    memset(&g_fwd.stats, 0, sizeof(g_fwd.stats));
+
+    if (pipe(g_fwd.wake) != 0) {
+        LOGE("Event forwarder pipe failed: %s", strerror(errno));
+        free(g_fwd.cells);
+        g_fwd.cells = NULL;
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) fcntl(g_fwd.wake[i], F_SETFL, fcntl(g_fwd.wake[i], F_GETFL) | O_NONBLOCK);
+
+    g_fwd.forwarded_id = perf_metric_id("rbus.events.forwarded", PERF_METRIC_COUNTER, PERF_CAT_RBUS);
+    g_fwd.dropped_id = perf_metric_id("rbus.events.dropped", PERF_METRIC_COUNTER, PERF_CAT_RBUS);
+    g_fwd.batches_id = perf_metric_id("rbus.events.batches", PERF_METRIC_COUNTER, PERF_CAT_RBUS);
+
+    g_fwd.stop = 0;
+    if (pthread_create(&g_fwd.thread, NULL, forwarder_thread, NULL) != 0) {
+        LOGE("Failed to start event forwarder: %s", "pthread_create failed");
+        close(g_fwd.wake[0]);
+        close(g_fwd.wake[1]);
+        g_fwd.wake[0] = g_fwd.wake[1] = -1;
+        free(g_fwd.cells);
+        g_fwd.cells = NULL;
+        return -1;
+    }
+    __atomic_store_n(&g_fwd.running, 1, __ATOMIC_SEQ_CST);
+    LOGI("Event forwarder started: ring=%llu batch_max=%d batch_ms=%d",
+         (unsigned long long)size, g_fwd.config.batch_max, g_fwd.config.batch_ms);
+    return 0;
+}
+
+void event_forwarder_stop(void) {
+    if (!__atomic_load_n(&g_fwd.running, __ATOMIC_SEQ_CST)) return;
+
+    /* New callbacks now drop; wait out the ones already pushing */
+    __atomic_store_n(&g_fwd.running, 0, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&g_fwd.pushers, __ATOMIC_SEQ_CST) > 0) sched_yield();
+
+    __atomic_store_n(&g_fwd.stop, 1, __ATOMIC_RELEASE);
+    wake_forwarder();
+    pthread_join(g_fwd.thread, NULL);
+
+    close(g_fwd.wake[0]);
+    close(g_fwd.wake[1]);
+    g_fwd.wake[0] = g_fwd.wake[1] = -1;
+    free(g_fwd.cells);
+    g_fwd.cells = NULL;
+    LOGI("Event forwarder stopped: forwarded=%llu dropped=%llu batches=%llu",
+         (unsigned long long)g_fwd.stats.forwarded, (unsigned long long)g_fwd.stats.dropped,
+         (unsigned long long)g_fwd.stats.batches);
+}
+
+int event_forwarder_get_stats(event_forwarder_stats_t* stats) {
+    if (!stats) return -1;
+    stats->forwarded = __atomic_load_n(&g_fwd.stats.forwarded, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&g_fwd.stats.dropped, __ATOMIC_RELAXED);
+    stats->batches = __atomic_load_n(&g_fwd.stats.batches, __ATOMIC_RELAXED);
+    return 0;
+}
@@ -4,18 +4,24 @@
 #include "cache.h"
 #include "webconfig.h"
 #include "performance.h"
+#include "metrics_server.h"
+#include "trace.h"
 #include "auth_init.h"
 #include "log.h"
+#include "arena.h"
 #include <stdio.h>
 #include <stdlib.h>
 
 int main(int argc, char** argv){
     p2r_load_config(argc, argv);
     
+    /* Request parsing allocates from per-thread arenas; hooks must be set before any thread starts */
+    arena_json_install();
+    
     /* Initialize performance monitoring first */
     perf_config_t perf_config = {
         .enable_collection = 1,
-        .collection_interval_sec = 60,
+        .collection_interval_sec = g_p2r_config.metrics_interval,
         .history_retention_sec = 3600,
         .enable_system_metrics = 1,
         .enable_detailed_timers = 1,
@@ -23,21 +29,43 @@ int main(int argc, char** argv){
         .export_file = "/tmp/parodus2rbus_metrics.json"
     };
     
-    if (perf_init(&perf_config) != 0) {
+    int perf_ready = perf_init(&perf_config) == 0;
+    if (!perf_ready) {
         LOGW("Failed to initialize performance monitoring: %s", "continuing without metrics");
     } else {
         LOGI("Performance monitoring initialized: collection_interval=%d", 
              perf_config.collection_interval_sec);
     }
     
+    /* Request tracing; a no-op unless sampling or a slow threshold is configured */
+    trace_config_t trace_config = {
+        .sample_every = g_p2r_config.trace_sample,
+        .slow_ms = g_p2r_config.trace_slow_ms,
+        .ring_size = g_p2r_config.trace_ring,
+        .output = g_p2r_config.trace_output
+    };
+    if (trace_init(&trace_config) != 0) {
+        LOGW("Failed to initialize tracing: %s", "continuing without traces");
+    }
+    
+    /* Started after tracing so /traces never sees a half-initialized ring */
+    if (perf_ready && g_p2r_config.metrics_port > 0) {
+        metrics_server_start(g_p2r_config.metrics_port);
+    }
+    
     /* Initialize cache system */
     cache_config_t cache_config = {
-        .max_entries = 1000,
+        .max_entries = (uint32_t)g_p2r_config.cache_max_entries,
+        .max_memory_bytes = (uint64_t)g_p2r_config.cache_max_memory_mb * 1024 * 1024,
         .default_ttl = 300,  /* 5 minutes */
         .cleanup_interval = 60,  /* 1 minute */
         .enable_stats = 1,
-        .enable_persistence = 0,
-        .persistence_file = NULL
+        .enable_persistence = g_p2r_config.cache_snapshot != NULL,
+        .persistence_file = (char*)g_p2r_config.cache_snapshot,
+        .snapshot_interval = g_p2r_config.cache_snapshot_interval,
+        .enable_coherence = g_p2r_config.cache_coherence,
+        .coherent_ttl = 3600,  /* 1 hour; events keep coherent entries fresh */
+        .coherence_prefixes = (char*)g_p2r_config.coherent_prefixes
     };
     
     if (cache_init(&cache_config) != 0) {
@@ -53,7 +81,8 @@ int main(int argc, char** argv){
         .transaction_timeout = 300,
         .enable_rollback = 1,
         .enable_validation = 1,
-        .backup_directory = "/tmp/webconfig_backups"
+        .backup_directory = "/tmp/webconfig_backups",
+        .spill_backups = g_p2r_config.webconfig_spill
     };
     
     if (webconfig_init(&webconfig_config) != 0) {
@@ -76,6 +105,8 @@ int main(int argc, char** argv){
         auth_system_cleanup();
         webconfig_cleanup();
         cache_cleanup();
+        metrics_server_stop();
+        trace_cleanup();
         perf_cleanup();
         return 1;
     }
@@ -96,6 +127,8 @@ int main(int argc, char** argv){
         free(metrics_json);
     }
     
+    metrics_server_stop();
+    trace_cleanup();
     perf_cleanup();
     return rc;
 }
@@ -0,0 +1,170 @@
+#include "metrics_server.h"
+#include "performance.h"
+#include "trace.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define METRICS_REQUEST_MAX 2048
+#define METRICS_IO_TIMEOUT_SEC 2    /* A stalled client only delays the next scrape */
+
+static struct {
+    pthread_t thread;
+    int listen_fd;
+    int wake_pipe[2];           /* Written by metrics_server_stop to end the accept loop */
+    int running;
+} g_metrics = { .listen_fd = -1, .wake_pipe = { -1, -1 } };
+
+static int send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void send_response(int fd, const char* status, const char* content_type, const char* body, size_t len) {
+    char header[256];
+    int n = snprintf(header, sizeof(header),
+                     "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                     status, content_type, len);
+    if (send_all(fd, header, (size_t)n) == 0 && len > 0) send_all(fd, body, len);
+}
+
+/* Read up to the end of the request line; the rest of the request is ignored */
+static int read_request_line(int fd, char* buf, size_t size) {
+    size_t used = 0;
+    while (used < size - 1) {
+        ssize_t n = recv(fd, buf + used, size - 1 - used, 0);
+        if (n <= 0) return -1;
+        used += (size_t)n;
+        buf[used] = '\0';
+        if (strstr(buf, "\r\n") || strchr(buf, '\n')) return 0;
+    }
+    return -1;
+}
+
+static void handle_client(int fd) {
+    struct timeval tv = { METRICS_IO_TIMEOUT_SEC, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    
+    char request[METRICS_REQUEST_MAX];
+    if (read_request_line(fd, request, sizeof(request)) != 0) return;
+    
+    int prometheus = strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET /metrics?", 13) == 0;
+    int json = strncmp(request, "GET /metrics.json", 17) == 0;
+    if (strncmp(request, "GET /traces ", 12) == 0 || strncmp(request, "GET /traces?", 12) == 0) {
+        /* Rendered on demand: the trace ring is only locked while it is copied out */
+        char* traces = trace_dump_json();
+        if (traces) {
+            send_response(fd, "200 OK", "application/json", traces, strlen(traces));
+            free(traces);
+        } else {
+            static const char failed[] = "trace dump failed\n";
+            send_response(fd, "500 Internal Server Error", "text/plain", failed, sizeof(failed) - 1);
+        }
+        return;
+    }
+    if (!prometheus && !json) {
+        static const char not_found[] = "not found\n";
+        send_response(fd, "404 Not Found", "text/plain", not_found, sizeof(not_found) - 1);
+        return;
+    }
+    
+    perf_snapshot_t* snapshot = perf_acquire_snapshot();
+    if (!snapshot) {
+        static const char pending[] = "no metrics collected yet\n";
+        send_response(fd, "503 Service Unavailable", "text/plain", pending, sizeof(pending) - 1);
+        return;
+    }
+    if (prometheus) {
+        send_response(fd, "200 OK", "text/plain; version=0.0.4", snapshot->prometheus, snapshot->prometheus_len);
+    } else {
+        send_response(fd, "200 OK", "application/json", snapshot->json, snapshot->json_len);
+    }
+    perf_release_snapshot(snapshot);
+}
+
+static void* metrics_server_thread(void* arg) {
+    (void)arg;
+    struct pollfd fds[2] = {
+        { .fd = g_metrics.listen_fd, .events = POLLIN },
+        { .fd = g_metrics.wake_pipe[0], .events = POLLIN }
+    };
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) continue;
+        if (fds[1].revents) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+    
+        int client = accept(g_metrics.listen_fd, NULL, NULL);
+        if (client < 0) continue;
+        handle_client(client);
+        close(client);
+    }
+    return NULL;
+}
+
+int metrics_server_start(int port) {
+    if (g_metrics.running || port <= 0 || port > 65535) return -1;
+    
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        LOGW("Metrics endpoint cannot listen on port %d", port);
+        close(fd);
+        return -1;
+    }
+    if (pipe(g_metrics.wake_pipe) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    g_metrics.listen_fd = fd;
+    if (pthread_create(&g_metrics.thread, NULL, metrics_server_thread, NULL) != 0) {
+        close(fd);
+        close(g_metrics.wake_pipe[0]);
+        close(g_metrics.wake_pipe[1]);
+        g_metrics.listen_fd = -1;
+        g_metrics.wake_pipe[0] = g_metrics.wake_pipe[1] = -1;
+        return -1;
+    }
+    g_metrics.running = 1;
+    LOGI("Metrics endpoint listening: http://127.0.0.1:%d/metrics", port);
+    return 0;
+}
+
+void metrics_server_stop(void) {
+    if (!g_metrics.running) return;
+    
+    char wake = 1;
+    if (write(g_metrics.wake_pipe[1], &wake, 1) != 1) {
+        LOGW("Failed to wake metrics endpoint: %s", "write failed");
+    }
+    pthread_join(g_metrics.thread, NULL);
+    close(g_metrics.listen_fd);
+    close(g_metrics.wake_pipe[0]);
+    close(g_metrics.wake_pipe[1]);
+    g_metrics.listen_fd = -1;
+    g_metrics.wake_pipe[0] = g_metrics.wake_pipe[1] = -1;
+    g_metrics.running = 0;
+    LOGI("Metrics endpoint stopped: %s", "shutdown");
+}
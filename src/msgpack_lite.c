@@ -0,0 +1,218 @@
+#include "msgpack_lite.h"
+#include <stdlib.h>
+#include <string.h>
+
+void mp_reader_init(mp_reader_t* r, const void* data, size_t size) {
+    r->p = (const uint8_t*)data;
+    r->end = r->p + size;
+    r->error = 0;
+}
+
+static int mp_need(mp_reader_t* r, size_t n) {
+    if (r->error || (size_t)(r->end - r->p) < n) {
+        r->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+static uint64_t mp_be(const uint8_t* p, int n) {
+    uint64_t v = 0;
+    for (int i = 0; i < n; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+/* Fixed-width big-endian field following the type byte */
+static int mp_field(mp_reader_t* r, int n, uint64_t* out) {
+    if (mp_need(r, n) != 0) return -1;
+    *out = mp_be(r->p, n);
+    r->p += n;
+    return 0;
+}
+
+static int mp_payload(mp_reader_t* r, mp_obj_t* out, mp_type_t type, uint64_t len) {
+    if (mp_need(r, len) != 0) return -1;
+    out->type = type;
+    out->v.str.ptr = (const char*)r->p;
+    out->v.str.len = (uint32_t)len;
+    r->p += len;
+    return 0;
+}
+
+int mp_read(mp_reader_t* r, mp_obj_t* out) {
+    if (mp_need(r, 1) != 0) return -1;
+    uint8_t t = *r->p++;
+    uint64_t n = 0;
+
+    if (t <= 0x7f) { out->type = MP_UINT; out->v.u = t; return 0; }
+    if (t >= 0xe0) { out->type = MP_INT; out->v.i = (int8_t)t; return 0; }
+    if ((t & 0xf0) == 0x80) { out->type = MP_MAP; out->v.count = t & 0x0f; return 0; }
+    if ((t & 0xf0) == 0x90) { out->type = MP_ARRAY; out->v.count = t & 0x0f; return 0; }
+    if ((t & 0xe0) == 0xa0) return mp_payload(r, out, MP_STR, t & 0x1f);
+
+    switch (t) {
+        case 0xc0: out->type = MP_NIL; return 0;
+        case 0xc2: out->type = MP_BOOL; out->v.b = 0; return 0;
+        case 0xc3: out->type = MP_BOOL; out->v.b = 1; return 0;
+        case 0xc4: case 0xc5: case 0xc6:
+            if (mp_field(r, 1 << (t - 0xc4), &n) != 0) return -1;
+            return mp_payload(r, out, MP_BIN, n);
+        case 0xd9: case 0xda: case 0xdb:
+            if (mp_field(r, 1 << (t - 0xd9), &n) != 0) return -1;
+            return mp_payload(r, out, MP_STR, n);
+        case 0xca: {
+            if (mp_field(r, 4, &n) != 0) return -1;
+            uint32_t bits = (uint32_t)n;
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            out->type = MP_FLOAT;
+            out->v.f = f;
+            return 0;
+        }
+        case 0xcb: {
+            if (mp_field(r, 8, &n) != 0) return -1;
+            double d;
+            memcpy(&d, &n, sizeof(d));
+            out->type = MP_FLOAT;
+            out->v.f = d;
+            return 0;
+        }
+        case 0xcc: case 0xcd: case 0xce: case 0xcf:
+            if (mp_field(r, 1 << (t - 0xcc), &n) != 0) return -1;
+            out->type = MP_UINT;
+            out->v.u = n;
+            return 0;
+        case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+            int width = 1 << (t - 0xd0);
+            if (mp_field(r, width, &n) != 0) return -1;
+            /* Sign-extend from the field width */
+            int64_t v = width == 8 ? (int64_t)n : (int64_t)(n << (64 - 8 * width)) >> (64 - 8 * width);
+            out->type = v < 0 ? MP_INT : MP_UINT;
+            if (v < 0) out->v.i = v; else out->v.u = (uint64_t)v;
+            return 0;
+        }
+        case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+            /* fixext: type byte plus 1..16 bytes */
+            return mp_payload(r, out, MP_EXT, 1 + ((uint64_t)1 << (t - 0xd4)));
+        case 0xc7: case 0xc8: case 0xc9:
+            if (mp_field(r, 1 << (t - 0xc7), &n) != 0) return -1;
+            return mp_payload(r, out, MP_EXT, n + 1);
+        case 0xdc: case 0xdd:
+            if (mp_field(r, t == 0xdc ? 2 : 4, &n) != 0) return -1;
+            out->type = MP_ARRAY;
+            out->v.count = (uint32_t)n;
+            return 0;
+        case 0xde: case 0xdf:
+            if (mp_field(r, t == 0xde ? 2 : 4, &n) != 0) return -1;
+            out->type = MP_MAP;
+            out->v.count = (uint32_t)n;
+            return 0;
+        default:
+            r->error = 1; /* 0xc1 is never used */
+            return -1;
+    }
+}
+
+int mp_skip(mp_reader_t* r) {
+    /* Count pending values instead of recursing, so nesting depth costs nothing */
+    uint64_t pending = 1;
+    mp_obj_t obj;
+    while (pending > 0) {
+        if (mp_read(r, &obj) != 0) return -1;
+        pending--;
+        if (obj.type == MP_ARRAY) pending += obj.v.count;
+        else if (obj.type == MP_MAP) pending += 2 * (uint64_t)obj.v.count;
+    }
+    return 0;
+}
+
+int mp_str_eq(const mp_obj_t* obj, const char* s) {
+    size_t len = strlen(s);
+    return obj->type == MP_STR && obj->v.str.len == len && memcmp(obj->v.str.ptr, s, len) == 0;
+}
+
+static uint8_t* mp_reserve(mp_writer_t* w, size_t n) {
+    if (w->failed) return NULL;
+    if (w->len + n > w->cap) {
+        size_t cap = w->cap ? w->cap : 256;
+        while (cap < w->len + n) cap *= 2;
+        uint8_t* data = realloc(w->data, cap);
+        if (!data) {
+            w->failed = 1;
+            return NULL;
+        }
+        w->data = data;
+        w->cap = cap;
+    }
+    uint8_t* p = w->data + w->len;
+    w->len += n;
+    return p;
+}
+
+/* Type byte followed by a big-endian field of width bytes */
+static void mp_put(mp_writer_t* w, uint8_t type, uint64_t v, int width) {
+    uint8_t* p = mp_reserve(w, 1 + width);
+    if (!p) return;
+    p[0] = type;
+    for (int i = width; i > 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static void mp_write_container(mp_writer_t* w, uint32_t n, uint8_t fix, uint8_t t16, uint8_t t32) {
+    if (n <= 15) mp_put(w, fix | (uint8_t)n, 0, 0);
+    else if (n <= 0xffff) mp_put(w, t16, n, 2);
+    else mp_put(w, t32, n, 4);
+}
+
+void mp_write_map(mp_writer_t* w, uint32_t pairs) {
+    mp_write_container(w, pairs, 0x80, 0xde, 0xdf);
+}
+
+void mp_write_array(mp_writer_t* w, uint32_t count) {
+    mp_write_container(w, count, 0x90, 0xdc, 0xdd);
+}
+
+void mp_write_str(mp_writer_t* w, const char* s, size_t len) {
+    if (len <= 31) mp_put(w, 0xa0 | (uint8_t)len, 0, 0);
+    else if (len <= 0xff) mp_put(w, 0xd9, len, 1);
+    else if (len <= 0xffff) mp_put(w, 0xda, len, 2);
+    else mp_put(w, 0xdb, len, 4);
+
+    uint8_t* p = mp_reserve(w, len);
+    if (p && len) memcpy(p, s, len);
+}
+
+void mp_write_cstr(mp_writer_t* w, const char* s) {
+    mp_write_str(w, s ? s : "", s ? strlen(s) : 0);
+}
+
+void mp_write_int(mp_writer_t* w, int64_t v) {
+    if (v >= 0) {
+        uint64_t u = (uint64_t)v;
+        if (u <= 0x7f) mp_put(w, (uint8_t)u, 0, 0);
+        else if (u <= 0xff) mp_put(w, 0xcc, u, 1);
+        else if (u <= 0xffff) mp_put(w, 0xcd, u, 2);
+        else if (u <= 0xffffffffULL) mp_put(w, 0xce, u, 4);
+        else mp_put(w, 0xcf, u, 8);
+    } else if (v >= -32) {
+        mp_put(w, (uint8_t)(int8_t)v, 0, 0);
+    } else if (v >= INT8_MIN) {
+        mp_put(w, 0xd0, (uint64_t)v, 1);
+    } else if (v >= INT16_MIN) {
+        mp_put(w, 0xd1, (uint64_t)v, 2);
+    } else if (v >= INT32_MIN) {
+        mp_put(w, 0xd2, (uint64_t)v, 4);
+    } else {
+        mp_put(w, 0xd3, (uint64_t)v, 8);
+    }
+}
+
+void mp_write_bool(mp_writer_t* w, int v) {
+    mp_put(w, v ? 0xc3 : 0xc2, 0, 0);
+}
+
+void mp_write_nil(mp_writer_t* w) {
+    mp_put(w, 0xc0, 0, 0);
+}
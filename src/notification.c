@@ -1,4 +1,5 @@
 #include "notification.h"
+#include "cache.h"
 #include "log.h"
 #include <rbus.h>
 #include <stdlib.h>
@@ -7,9 +8,54 @@
 #include <time.h>
 #include <pthread.h>
 #include <sys/time.h>
+#include <errno.h>
 
-/* Forward declare weak hook for emitting notifications via parodus interface */
-__attribute__((weak)) void p2r_emit_notification(const char* dest, const char* payload_json);
+/* Forward declare weak hook for emitting notifications via parodus interface.
+ * Returns 0 once the message is handed to parodus.
+ */
+__attribute__((weak)) int p2r_emit_notification(const char* dest, const char* payload_json);
+
+/* Parameters subscribed for cache coherence (chained hash set). Subscribes and
+ * unsubscribes run in batches on a watcher thread, never on the request path.
+ */
+#define WATCH_HASH_SIZE 257
+#define MAX_WATCHED_PARAMS 1024
+#define MAX_FAILED_WATCHES 1024     /* Negative set: parameters whose subscribe failed */
+#define WATCH_BATCH_MAX 64
+#define WATCH_RETRY_SEC 300         /* A failed subscribe is not retried before this */
+
+typedef struct watched_param {
+    char* name;
+    int wanted;                     /* A coherent cache entry (or a pending fill) needs it */
+    int subscribed;                 /* Subscription is live in RBUS */
+    int queued;                     /* On the watcher's work list */
+    time_t failed_at;               /* Nonzero: in the negative set since then */
+    struct watched_param* next;
+    struct watched_param* work_next;
+} watched_param_t;
+
+/* Parameters whose notify attribute is on; a parameter never set is off */
+typedef struct notify_attr {
+    char* name;
+    struct notify_attr* next;
+} notify_attr_t;
+
+/* Outgoing notification queue */
+#define NOTIFY_QUEUE_DEFAULT_CAPACITY 1024
+#define NOTIFY_PENDING_HASH_SIZE WATCH_HASH_SIZE
+#define NOTIFY_RETRY_BASE_MS 100.0
+#define NOTIFY_RETRY_MAX_MS 5000.0
+
+typedef struct notify_entry {
+    notification_t notif;
+    double enqueued_ms;             /* Monotonic time the first version was queued */
+    double ready_ms;                /* Not sent before this (coalescing window) */
+    struct notify_entry* next;      /* Queue order */
+    struct notify_entry* hash_next; /* Pending parameter changes by paramName */
+} notify_entry_t;
+
+/* Subscription userData tag marking cache-coherence-only subscriptions */
+static int g_coherence_tag;
 
 /* Global notification state */
 static struct {
@@ -19,6 +65,42 @@ static struct {
     pthread_mutex_t mutex;
     notification_callback_t callbacks[8]; /* Index by notification_type_t */
     int initialized;
+    notify_attr_t* notify_attrs[WATCH_HASH_SIZE]; /* Guarded by mutex */
+
+    /* Coherence watches; fields below are guarded by watch_mutex */
+    pthread_mutex_t watch_mutex;
+    pthread_cond_t watch_cond;
+    pthread_t watch_thread;
+    int watch_running;
+    int watch_stopping;
+    int watch_limit_warned;
+    watched_param_t* watched[WATCH_HASH_SIZE];
+    int watched_count;
+    int failed_count;
+    watched_param_t* work_head;
+    watched_param_t* work_tail;
+
+    /* Send queue; fields below are guarded by queue_mutex */
+    pthread_mutex_t queue_mutex;
+    pthread_cond_t queue_cond;
+    pthread_t sender_thread;
+    int sender_running;
+    int stopping;
+    notify_entry_t* queue_head;
+    notify_entry_t* queue_tail;
+    int queue_len;
+    notify_entry_t* pending_params[NOTIFY_PENDING_HASH_SIZE];
+    int queue_capacity;
+    int coalesce_window_ms;
+    int retry_count;
+    int timeout_ms;
+    struct {
+        uint64_t sent;
+        uint64_t coalesced;
+        uint64_t retried;
+        uint64_t failed;
+        uint64_t dropped;
+    } stats;
 } g_notify = {0};
 
 /* Internal helper functions */
@@ -75,11 +157,241 @@ static void free_device_status_notify(device_status_notify_t* device) {
     }
 }
 
+static uint32_t watch_hash(const char* name);
+static void notification_watcher_start(void);
+static void notification_watcher_stop(void);
+static int notification_enqueue(notification_t* notif);
+
+/* Async delivery queue: send functions enqueue, one sender thread emits */
+static double monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+static void deadline_after_ms(struct timespec* ts, double delay_ms) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    long long ns = ts->tv_nsec + (long long)(delay_ms * 1000000.0);
+    ts->tv_sec += (time_t)(ns / 1000000000LL);
+    ts->tv_nsec = (long)(ns % 1000000000LL);
+}
+
+/* Emit one notification through the parodus hook; 0 when delivered (or no hook) */
+static int notification_emit(const notification_t* notif) {
+    if (!p2r_emit_notification) return 0;
+    char* json = notification_to_json(notif);
+    if (!json) return -1;
+    int rc = p2r_emit_notification(notif->destination, json);
+    free(json);
+    return rc;
+}
+
+/* Drop a pending parameter change from the coalescing index; caller holds queue_mutex */
+static void queue_unindex_locked(notify_entry_t* entry) {
+    notify_entry_t** link = &g_notify.pending_params[watch_hash(entry->notif.data.param.paramName)];
+    while (*link) {
+        if (*link == entry) {
+            *link = entry->hash_next;
+            return;
+        }
+        link = &(*link)->hash_next;
+    }
+}
+
+/* Fold a newer change into an already queued one for the same parameter.
+ * The queued oldValue is kept, so the notification still describes the net change.
+ */
+static void queue_coalesce_locked(notify_entry_t* pending, notification_t* notif) {
+    param_notify_t* dst = &pending->notif.data.param;
+    param_notify_t* src = &notif->data.param;
+    free(dst->newValue);
+    free(dst->writeID);
+    dst->newValue = src->newValue;
+    dst->writeID = src->writeID;
+    dst->dataType = src->dataType;
+    src->newValue = NULL;
+    src->writeID = NULL;
+    pending->notif.timestamp = notif->timestamp;
+    g_notify.stats.coalesced++;
+    notification_free(notif);
+}
+
+/* Queue a notification for the sender thread, taking ownership of its contents
+ * (notif is zeroed). Without a running sender it is emitted on the calling thread.
+ */
+static int notification_enqueue(notification_t* notif) {
+    pthread_mutex_lock(&g_notify.queue_mutex);
+    if (!g_notify.sender_running) {
+        pthread_mutex_unlock(&g_notify.queue_mutex);
+        int rc = notification_emit(notif);
+        notification_free(notif);
+        return rc == 0 ? 0 : -1;
+    }
+
+    if (notif->type == NOTIFY_PARAM_CHANGE) {
+        notify_entry_t* pending = g_notify.pending_params[watch_hash(notif->data.param.paramName)];
+        while (pending && strcmp(pending->notif.data.param.paramName, notif->data.param.paramName) != 0) {
+            pending = pending->hash_next;
+        }
+        if (pending) {
+            queue_coalesce_locked(pending, notif);
+            pthread_mutex_unlock(&g_notify.queue_mutex);
+            return 0;
+        }
+    }
+
+    if (g_notify.queue_len >= g_notify.queue_capacity) {
+        g_notify.stats.dropped++;
+        pthread_mutex_unlock(&g_notify.queue_mutex);
+        LOGW("Notification queue full (%d), dropping type %d", g_notify.queue_capacity, notif->type);
+        notification_free(notif);
+        return -1;
+    }
+
+    notify_entry_t* entry = calloc(1, sizeof(notify_entry_t));
+    if (!entry) {
+        pthread_mutex_unlock(&g_notify.queue_mutex);
+        notification_free(notif);
+        return -1;
+    }
+    entry->notif = *notif;
+    memset(notif, 0, sizeof(*notif));
+    entry->enqueued_ms = monotonic_ms();
+    entry->ready_ms = entry->enqueued_ms;
+    if (entry->notif.type == NOTIFY_PARAM_CHANGE) {
+        /* Hold parameter changes for the coalescing window */
+        entry->ready_ms += g_notify.coalesce_window_ms;
+        uint32_t bucket = watch_hash(entry->notif.data.param.paramName);
+        entry->hash_next = g_notify.pending_params[bucket];
+        g_notify.pending_params[bucket] = entry;
+    }
+    if (g_notify.queue_tail) {
+        g_notify.queue_tail->next = entry;
+    } else {
+        g_notify.queue_head = entry;
+    }
+    g_notify.queue_tail = entry;
+    g_notify.queue_len++;
+    pthread_cond_signal(&g_notify.queue_cond);
+    pthread_mutex_unlock(&g_notify.queue_mutex);
+    return 0;
+}
+
+/* Deliver one entry, retrying with backoff until notification_retry_count retries are
+ * used or notification_timeout_ms has passed since it was queued. Called unlocked.
+ */
+static void notification_deliver(notify_entry_t* entry) {
+    pthread_mutex_lock(&g_notify.queue_mutex);
+    int retries = g_notify.retry_count;
+    int timeout_ms = g_notify.timeout_ms;
+    pthread_mutex_unlock(&g_notify.queue_mutex);
+    double backoff_ms = NOTIFY_RETRY_BASE_MS;
+
+    for (int attempt = 0;; attempt++) {
+        int rc = notification_emit(&entry->notif);
+        if (rc == 0) {
+            pthread_mutex_lock(&g_notify.queue_mutex);
+            g_notify.stats.sent++;
+            pthread_mutex_unlock(&g_notify.queue_mutex);
+            return;
+        }
+
+        double elapsed_ms = monotonic_ms() - entry->enqueued_ms;
+        int timed_out = timeout_ms > 0 && elapsed_ms + backoff_ms > timeout_ms;
+        pthread_mutex_lock(&g_notify.queue_mutex);
+        if (attempt >= retries || timed_out || g_notify.stopping) {
+            g_notify.stats.failed++;
+            pthread_mutex_unlock(&g_notify.queue_mutex);
+            LOGW("Dropping notification type %d after %d attempt(s): rc=%d", entry->notif.type, attempt + 1, rc);
+            return;
+        }
+        g_notify.stats.retried++;
+        struct timespec deadline;
+        deadline_after_ms(&deadline, backoff_ms);
+        while (!g_notify.stopping &&
+               pthread_cond_timedwait(&g_notify.queue_cond, &g_notify.queue_mutex, &deadline) != ETIMEDOUT) {
+        }
+        pthread_mutex_unlock(&g_notify.queue_mutex);
+        if (backoff_ms < NOTIFY_RETRY_MAX_MS) backoff_ms *= 2;
+    }
+}
+
+static void* notification_sender(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_notify.queue_mutex);
+    while (1) {
+        notify_entry_t* entry = g_notify.queue_head;
+        if (!entry) {
+            if (g_notify.stopping) break;
+            pthread_cond_wait(&g_notify.queue_cond, &g_notify.queue_mutex);
+            continue;
+        }
+        /* Queue order is kept: wait out the head's coalescing hold (flushed on stop) */
+        double wait_ms = entry->ready_ms - monotonic_ms();
+        if (wait_ms > 0 && !g_notify.stopping) {
+            struct timespec deadline;
+            deadline_after_ms(&deadline, wait_ms);
+            pthread_cond_timedwait(&g_notify.queue_cond, &g_notify.queue_mutex, &deadline);
+            continue;
+        }
+
+        g_notify.queue_head = entry->next;
+        if (!g_notify.queue_head) g_notify.queue_tail = NULL;
+        g_notify.queue_len--;
+        if (entry->notif.type == NOTIFY_PARAM_CHANGE) queue_unindex_locked(entry);
+        pthread_mutex_unlock(&g_notify.queue_mutex);
+
+        notification_deliver(entry);
+        notification_free(&entry->notif);
+        free(entry);
+
+        pthread_mutex_lock(&g_notify.queue_mutex);
+    }
+    pthread_mutex_unlock(&g_notify.queue_mutex);
+    return NULL;
+}
+
+static void notification_queue_start(void) {
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&g_notify.queue_mutex, NULL);
+    pthread_cond_init(&g_notify.queue_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    g_notify.sender_running = 1;
+    if (pthread_create(&g_notify.sender_thread, NULL, notification_sender, NULL) != 0) {
+        g_notify.sender_running = 0;
+        LOGW("Failed to start notification sender: %s", "sending on the calling thread");
+    }
+}
+
+/* Stop the sender once everything queued has been attempted */
+static void notification_queue_stop(void) {
+    pthread_mutex_lock(&g_notify.queue_mutex);
+    int running = g_notify.sender_running;
+    g_notify.stopping = 1;
+    pthread_cond_broadcast(&g_notify.queue_cond);
+    pthread_mutex_unlock(&g_notify.queue_mutex);
+
+    if (running) pthread_join(g_notify.sender_thread, NULL);
+
+    pthread_mutex_lock(&g_notify.queue_mutex);
+    g_notify.sender_running = 0;
+    pthread_mutex_unlock(&g_notify.queue_mutex);
+
+    LOGI("Notification queue stopped: sent=%llu, coalesced=%llu, retried=%llu, failed=%llu, dropped=%llu",
+         (unsigned long long)g_notify.stats.sent, (unsigned long long)g_notify.stats.coalesced,
+         (unsigned long long)g_notify.stats.retried, (unsigned long long)g_notify.stats.failed,
+         (unsigned long long)g_notify.stats.dropped);
+    pthread_cond_destroy(&g_notify.queue_cond);
+    pthread_mutex_destroy(&g_notify.queue_mutex);
+}
+
 /* RBUS event handler for automatic notification generation */
 static void rbus_notification_event_handler(rbusHandle_t handle, rbusEvent_t const* event, 
                                            rbusEventSubscription_t* subscription) {
     (void)handle;
-    (void)subscription;
     
     if (!event || !event->name) {
         LOGW("Received null event or event name: %s", "invalid event");
@@ -88,18 +400,28 @@ static void rbus_notification_event_handler(rbusHandle_t handle, rbusEvent_t con
     
     LOGI("RBUS notification event: %s", event->name);
     
+    int coherence_only = subscription && subscription->userData == &g_coherence_tag;
+    
     /* Generate parameter change notification if this is a value change event */
     if (event->type == RBUS_EVENT_VALUE_CHANGED && event->data) {
-        rbusValue_t newValue = rbusObject_GetValue(event->data, NULL);
-        if (newValue) {
-            char* newValueStr = rbusValue_ToString(newValue, NULL, 0);
-            if (newValueStr) {
-                /* For simplicity, we don't have the old value in RBUS events,
-                 * so we use "unknown" as old value */
-                notification_send_param_change(event->name, "unknown", newValueStr, 0, NULL);
-                free(newValueStr);
-            }
+        rbusValue_t newValue = rbusObject_GetValue(event->data, "value");
+        if (!newValue) newValue = rbusObject_GetValue(event->data, NULL);
+        char* newValueStr = newValue ? rbusValue_ToString(newValue, NULL, 0) : NULL;
+        
+        /* Keep the cache coherent: update in place, or drop if the value is unreadable.
+         * No entry is normal right after a local SET invalidated it, and the next read
+         * refills it, so the watch stays; evicting or expiring an entry releases it.
+         */
+        cache_apply_value_change(event->name, newValueStr, -1);
+        
+        if (newValueStr && !coherence_only) {
+            /* Value-change events carry the previous value alongside the new one */
+            rbusValue_t oldValue = rbusObject_GetValue(event->data, "oldValue");
+            char* oldValueStr = oldValue ? rbusValue_ToString(oldValue, NULL, 0) : NULL;
+            notification_send_param_change(event->name, oldValueStr ? oldValueStr : "unknown", newValueStr, 0, NULL);
+            free(oldValueStr);
         }
+        free(newValueStr);
     }
     
     /* Handle connected client events for Device.Hosts.Host table */
@@ -155,7 +477,14 @@ int notification_init(const char* service_name) {
     g_notify.config.enable_device_notifications = 1;
     g_notify.config.notification_retry_count = 3;
     g_notify.config.notification_timeout_ms = 30000;
-    
+    g_notify.config.coalesce_window_ms = 0;
+    g_notify.config.queue_capacity = NOTIFY_QUEUE_DEFAULT_CAPACITY;
+    g_notify.retry_count = g_notify.config.notification_retry_count;
+    g_notify.timeout_ms = g_notify.config.notification_timeout_ms;
+    g_notify.queue_capacity = g_notify.config.queue_capacity;
+    
+    notification_queue_start();
+    notification_watcher_start();
     g_notify.initialized = 1;
     
     LOGI("Notification system initialized for service: %s", g_notify.service_name);
@@ -166,6 +495,8 @@ void notification_cleanup(void) {
     if (!g_notify.initialized) return;
     
     notification_unsubscribe_rbus_events();
+    notification_watcher_stop();
+    notification_queue_stop();
     
     pthread_mutex_lock(&g_notify.mutex);
     
@@ -174,6 +505,16 @@ void notification_cleanup(void) {
         g_notify.rbus_handle = NULL;
     }
     
+    for (int i = 0; i < WATCH_HASH_SIZE; i++) {
+        notify_attr_t* attr = g_notify.notify_attrs[i];
+        while (attr) {
+            notify_attr_t* next = attr->next;
+            free(attr->name);
+            free(attr);
+            attr = next;
+        }
+    }
+    
     free(g_notify.service_name);
     free(g_notify.config.device_id);
     free(g_notify.config.fw_version);
@@ -233,19 +574,10 @@ int notification_send_param_change(const char* paramName, const char* oldValue,
     }
     pthread_mutex_unlock(&g_notify.mutex);
     
-    /* Send via parodus if available */
-    if (p2r_emit_notification) {
-        char* json = notification_to_json(&notif);
-        if (json) {
-            p2r_emit_notification(notif.destination, json);
-            free(json);
-        }
-    }
-    
-    LOGI("Sent parameter change notification: %s = %s", paramName, newValue);
+    LOGI("Queued parameter change notification: %s = %s", paramName, newValue);
     
-    notification_free(&notif);
-    return 0;
+    /* Sender thread owns it from here */
+    return notification_enqueue(&notif);
 }
 
 int notification_send_connected_client(const char* macId, const char* status, 
@@ -272,19 +604,10 @@ int notification_send_connected_client(const char* macId, const char* status,
     }
     pthread_mutex_unlock(&g_notify.mutex);
     
-    /* Send via parodus if available */
-    if (p2r_emit_notification) {
-        char* json = notification_to_json(&notif);
-        if (json) {
-            p2r_emit_notification(notif.destination, json);
-            free(json);
-        }
-    }
+    LOGI("Queued connected client notification: %s %s", macId, status);
     
-    LOGI("Sent connected client notification: %s %s", macId, status);
-    
-    notification_free(&notif);
-    return 0;
+    /* Sender thread owns it from here */
+    return notification_enqueue(&notif);
 }
 
 int notification_send_transaction_status(const char* transactionId, const char* status, const char* errorMessage) {
@@ -308,19 +631,10 @@ int notification_send_transaction_status(const char* transactionId, const char*
     }
     pthread_mutex_unlock(&g_notify.mutex);
     
-    /* Send via parodus if available */
-    if (p2r_emit_notification) {
-        char* json = notification_to_json(&notif);
-        if (json) {
-            p2r_emit_notification(notif.destination, json);
-            free(json);
-        }
-    }
-    
-    LOGI("Sent transaction status notification: %s %s", transactionId, status);
+    LOGI("Queued transaction status notification: %s %s", transactionId, status);
     
-    notification_free(&notif);
-    return 0;
+    /* Sender thread owns it from here */
+    return notification_enqueue(&notif);
 }
 
 int notification_send_device_status(int status, const char* reason, const char* deviceId) {
@@ -343,19 +657,10 @@ int notification_send_device_status(int status, const char* reason, const char*
     }
     pthread_mutex_unlock(&g_notify.mutex);
     
-    /* Send via parodus if available */
-    if (p2r_emit_notification) {
-        char* json = notification_to_json(&notif);
-        if (json) {
-            p2r_emit_notification(notif.destination, json);
-            free(json);
-        }
-    }
+    LOGI("Queued device status notification: %d %s", status, notif.data.device.reason);
     
-    LOGI("Sent device status notification: %d %s", status, notif.data.device.reason);
-    
-    notification_free(&notif);
-    return 0;
+    /* Sender thread owns it from here */
+    return notification_enqueue(&notif);
 }
 
 int notification_send_factory_reset(const char* reason, const char* deviceId) {
@@ -378,19 +683,10 @@ int notification_send_factory_reset(const char* reason, const char* deviceId) {
     }
     pthread_mutex_unlock(&g_notify.mutex);
     
-    /* Send via parodus if available */
-    if (p2r_emit_notification) {
-        char* json = notification_to_json(&notif);
-        if (json) {
-            p2r_emit_notification(notif.destination, json);
-            free(json);
-        }
-    }
-    
-    LOGI("Sent factory reset notification: %s", notif.data.device.reason);
+    LOGI("Queued factory reset notification: %s", notif.data.device.reason);
     
-    notification_free(&notif);
-    return 0;
+    /* Sender thread owns it from here */
+    return notification_enqueue(&notif);
 }
 
 int notification_send_firmware_upgrade(const char* oldVersion, const char* newVersion, const char* deviceId) {
@@ -420,19 +716,49 @@ int notification_send_firmware_upgrade(const char* oldVersion, const char* newVe
     }
     pthread_mutex_unlock(&g_notify.mutex);
     
-    /* Send via parodus if available */
-    if (p2r_emit_notification) {
-        char* json = notification_to_json(&notif);
-        if (json) {
-            p2r_emit_notification(notif.destination, json);
-            free(json);
+    LOGI("Queued firmware upgrade notification: %s", newVersion);
+    
+    /* Sender thread owns it from here */
+    return notification_enqueue(&notif);
+}
+
+int notification_param_changes_enabled(void) {
+    return g_notify.initialized && g_notify.config.enable_param_notifications;
+}
+
+int notification_set_param_notify(const char* paramName, int notify) {
+    if (!g_notify.initialized || !paramName) return -1;
+    
+    int rc = 0;
+    pthread_mutex_lock(&g_notify.mutex);
+    notify_attr_t** link = &g_notify.notify_attrs[watch_hash(paramName)];
+    while (*link && strcmp((*link)->name, paramName) != 0) link = &(*link)->next;
+    if (*link && !notify) {
+        notify_attr_t* attr = *link;
+        *link = attr->next;
+        free(attr->name);
+        free(attr);
+    } else if (!*link && notify) {
+        notify_attr_t* attr = calloc(1, sizeof(notify_attr_t));
+        if (attr && (attr->name = strdup(paramName))) {
+            *link = attr;
+        } else {
+            free(attr);
+            rc = -1;
         }
     }
+    pthread_mutex_unlock(&g_notify.mutex);
+    return rc;
+}
+
+int notification_param_notify_enabled(const char* paramName) {
+    if (!notification_param_changes_enabled() || !paramName) return 0;
     
-    LOGI("Sent firmware upgrade notification: %s", newVersion);
-    
-    notification_free(&notif);
-    return 0;
+    pthread_mutex_lock(&g_notify.mutex);
+    notify_attr_t* attr = g_notify.notify_attrs[watch_hash(paramName)];
+    while (attr && strcmp(attr->name, paramName) != 0) attr = attr->next;
+    pthread_mutex_unlock(&g_notify.mutex);
+    return attr != NULL;
 }
 
 /* RBUS event subscription */
@@ -462,6 +788,279 @@ int notification_subscribe_rbus_events(void) {
     return 0;
 }
 
+static uint32_t watch_hash(const char* name) {
+    uint32_t hash = 5381;
+    int c;
+    while ((c = *name++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash % WATCH_HASH_SIZE;
+}
+
+/* Unlink and free a watch; caller holds watch_mutex and the watcher owns w (not queued) */
+static void watch_remove_locked(watched_param_t* target) {
+    watched_param_t** link = &g_notify.watched[watch_hash(target->name)];
+    while (*link) {
+        if (*link == target) {
+            *link = target->next;
+            if (target->failed_at) g_notify.failed_count--;
+            else g_notify.watched_count--;
+            free(target->name);
+            free(target);
+            return;
+        }
+        link = &(*link)->next;
+    }
+}
+
+static watched_param_t* watch_find_locked(const char* paramName, uint32_t hash) {
+    for (watched_param_t* w = g_notify.watched[hash]; w; w = w->next) {
+        if (strcmp(w->name, paramName) == 0) return w;
+    }
+    return NULL;
+}
+
+/* Hand a watch to the watcher thread; caller holds watch_mutex */
+static void watch_queue_locked(watched_param_t* w) {
+    if (w->queued) return;
+    w->queued = 1;
+    w->work_next = NULL;
+    if (g_notify.work_tail) g_notify.work_tail->work_next = w;
+    else g_notify.work_head = w;
+    g_notify.work_tail = w;
+    pthread_cond_signal(&g_notify.watch_cond);
+}
+
+/* Subscribe a batch in one RBUS call, falling back to one at a time so a single bad
+ * name does not fail the rest. results[i] is 0 on success.
+ */
+static void watch_subscribe_batch(watched_param_t** batch, int count, int* results) {
+    rbusEventSubscription_t subs[WATCH_BATCH_MAX];
+    memset(subs, 0, sizeof(subs));
+    rbusEventHandler_t handler = rbus_notification_event_handler;
+    for (int i = 0; i < count; i++) {
+        subs[i].eventName = batch[i]->name;
+        /* handler is declared void*; copy the function pointer bit for bit */
+        memcpy(&subs[i].handler, &handler, sizeof(handler));
+        subs[i].userData = &g_coherence_tag;
+    }
+    rbusError_t rc = count > 0 ? rbusEvent_SubscribeEx(g_notify.rbus_handle, subs, count, 0) : RBUS_ERROR_SUCCESS;
+    for (int i = 0; i < count; i++) {
+        if (rc == RBUS_ERROR_SUCCESS) {
+            results[i] = 0;
+        } else {
+            rbusError_t one = rbusEvent_Subscribe(g_notify.rbus_handle, batch[i]->name, rbus_notification_event_handler,
+                                                  &g_coherence_tag, 0);
+            if (one != RBUS_ERROR_SUCCESS) LOGD("Cache coherence subscribe(%s) failed: %d", batch[i]->name, one);
+            results[i] = one == RBUS_ERROR_SUCCESS ? 0 : -1;
+        }
+    }
+}
+
+static void watch_unsubscribe_batch(watched_param_t** batch, int count) {
+    if (count <= 0) return;
+    rbusEventSubscription_t subs[WATCH_BATCH_MAX];
+    memset(subs, 0, sizeof(subs));
+    for (int i = 0; i < count; i++) {
+        subs[i].eventName = batch[i]->name;
+    }
+    rbusError_t rc = rbusEvent_UnsubscribeEx(g_notify.rbus_handle, subs, count);
+    if (rc != RBUS_ERROR_SUCCESS) LOGD("Cache coherence unsubscribe of %d parameters failed: %d", count, rc);
+}
+
+/* Watcher thread: applies queued watch/unwatch requests in batches so no request
+ * thread ever waits on an RBUS subscribe.
+ */
+static void* notification_watcher(void* arg) {
+    (void)arg;
+    watched_param_t* subscribe[WATCH_BATCH_MAX];
+    watched_param_t* unsubscribe[WATCH_BATCH_MAX];
+    watched_param_t* mark[2 * WATCH_BATCH_MAX];
+    int results[WATCH_BATCH_MAX];
+
+    pthread_mutex_lock(&g_notify.watch_mutex);
+    for (;;) {
+        while (!g_notify.watch_stopping && !g_notify.work_head) {
+            pthread_cond_wait(&g_notify.watch_cond, &g_notify.watch_mutex);
+        }
+        if (g_notify.watch_stopping) break;
+
+        int nsub = 0, nunsub = 0, nmark = 0;
+        while (g_notify.work_head && nsub < WATCH_BATCH_MAX && nunsub < WATCH_BATCH_MAX) {
+            watched_param_t* w = g_notify.work_head;
+            g_notify.work_head = w->work_next;
+            if (!g_notify.work_head) g_notify.work_tail = NULL;
+            w->queued = 0;
+            if (w->wanted && !w->subscribed) subscribe[nsub++] = w;
+            else if (w->wanted) mark[nmark++] = w;
+            else if (w->subscribed) unsubscribe[nunsub++] = w;
+            else watch_remove_locked(w);
+        }
+        pthread_mutex_unlock(&g_notify.watch_mutex);
+
+        /* Entries are only freed on this thread, so the pointers stay valid unlocked */
+        watch_subscribe_batch(subscribe, nsub, results);
+        watch_unsubscribe_batch(unsubscribe, nunsub);
+
+        pthread_mutex_lock(&g_notify.watch_mutex);
+        time_t now = time(NULL);
+        for (int i = 0; i < nsub; i++) {
+            watched_param_t* w = subscribe[i];
+            if (results[i] == 0) {
+                w->subscribed = 1;
+                if (w->wanted) mark[nmark++] = w;
+                else watch_queue_locked(w);
+            } else if (w->wanted && g_notify.failed_count < MAX_FAILED_WATCHES) {
+                /* Remember the failure so refetches do not retry it until WATCH_RETRY_SEC */
+                w->wanted = 0;
+                w->failed_at = now;
+                g_notify.watched_count--;
+                g_notify.failed_count++;
+            } else {
+                watch_remove_locked(w);
+            }
+        }
+        for (int i = 0; i < nunsub; i++) {
+            watched_param_t* w = unsubscribe[i];
+            w->subscribed = 0;
+            if (w->wanted) watch_queue_locked(w);
+            else if (!w->queued) watch_remove_locked(w);
+        }
+        pthread_mutex_unlock(&g_notify.watch_mutex);
+
+        /* Mark outside watch_mutex: the cache calls back into notification_unwatch_parameter */
+        for (int i = 0; i < nmark; i++) {
+            if (cache_mark_coherent(mark[i]->name) != 0) {
+                /* Entry evicted before the subscription came up; release it */
+                pthread_mutex_lock(&g_notify.watch_mutex);
+                mark[i]->wanted = 0;
+                watch_queue_locked(mark[i]);
+                pthread_mutex_unlock(&g_notify.watch_mutex);
+            }
+        }
+        pthread_mutex_lock(&g_notify.watch_mutex);
+    }
+    pthread_mutex_unlock(&g_notify.watch_mutex);
+    return NULL;
+}
+
+static void notification_watcher_start(void) {
+    pthread_mutex_init(&g_notify.watch_mutex, NULL);
+    pthread_cond_init(&g_notify.watch_cond, NULL);
+    if (!g_notify.rbus_handle) return;
+    if (pthread_create(&g_notify.watch_thread, NULL, notification_watcher, NULL) != 0) {
+        LOGW("Failed to start cache coherence watcher: %s", "coherence disabled");
+        return;
+    }
+    g_notify.watch_running = 1;
+    cache_set_coherent_drop_callback(notification_unwatch_parameter);
+}
+
+/* Stop the watcher, then drop every live subscription and free the watch set */
+static void notification_watcher_stop(void) {
+    cache_set_coherent_drop_callback(NULL);
+
+    pthread_mutex_lock(&g_notify.watch_mutex);
+    int running = g_notify.watch_running;
+    g_notify.watch_running = 0;
+    g_notify.watch_stopping = 1;
+    pthread_cond_broadcast(&g_notify.watch_cond);
+    pthread_mutex_unlock(&g_notify.watch_mutex);
+    if (running) pthread_join(g_notify.watch_thread, NULL);
+
+    watched_param_t* batch[WATCH_BATCH_MAX];
+    int count = 0;
+    for (int i = 0; i < WATCH_HASH_SIZE; i++) {
+        for (watched_param_t* w = g_notify.watched[i]; w; w = w->next) {
+            if (!w->subscribed) continue;
+            batch[count++] = w;
+            if (count == WATCH_BATCH_MAX) {
+                watch_unsubscribe_batch(batch, count);
+                count = 0;
+            }
+        }
+    }
+    watch_unsubscribe_batch(batch, count);
+
+    for (int i = 0; i < WATCH_HASH_SIZE; i++) {
+        watched_param_t* w = g_notify.watched[i];
+        while (w) {
+            watched_param_t* next = w->next;
+            free(w->name);
+            free(w);
+            w = next;
+        }
+        g_notify.watched[i] = NULL;
+    }
+    pthread_cond_destroy(&g_notify.watch_cond);
+    pthread_mutex_destroy(&g_notify.watch_mutex);
+}
+
+int notification_watch_parameter(const char* paramName) {
+    if (!g_notify.initialized || !g_notify.rbus_handle || !paramName) return -1;
+    
+    uint32_t hash = watch_hash(paramName);
+    
+    pthread_mutex_lock(&g_notify.watch_mutex);
+    if (!g_notify.watch_running) {
+        pthread_mutex_unlock(&g_notify.watch_mutex);
+        return -1;
+    }
+    watched_param_t* w = watch_find_locked(paramName, hash);
+    if (w && w->failed_at) {
+        if (time(NULL) - w->failed_at < WATCH_RETRY_SEC) {
+            pthread_mutex_unlock(&g_notify.watch_mutex);
+            return -4;
+        }
+        w->failed_at = 0;
+        g_notify.failed_count--;
+        g_notify.watched_count++;
+    }
+    if (!w) {
+        if (g_notify.watched_count >= MAX_WATCHED_PARAMS) {
+            if (!g_notify.watch_limit_warned) {
+                LOGW("Cache coherence watch limit reached (%d); further entries use plain TTLs", MAX_WATCHED_PARAMS);
+                g_notify.watch_limit_warned = 1;
+            }
+            pthread_mutex_unlock(&g_notify.watch_mutex);
+            return -2;
+        }
+        w = calloc(1, sizeof(watched_param_t));
+        if (w) w->name = strdup(paramName);
+        if (!w || !w->name) {
+            free(w);
+            pthread_mutex_unlock(&g_notify.watch_mutex);
+            return -3;
+        }
+        w->next = g_notify.watched[hash];
+        g_notify.watched[hash] = w;
+        g_notify.watched_count++;
+    }
+    
+    int live = w->wanted && w->subscribed;
+    if (!live) {
+        /* The watcher subscribes and marks the cache entry coherent once that succeeds */
+        w->wanted = 1;
+        watch_queue_locked(w);
+    }
+    pthread_mutex_unlock(&g_notify.watch_mutex);
+    return live ? 1 : 0;
+}
+
+void notification_unwatch_parameter(const char* paramName) {
+    if (!paramName) return;
+    
+    pthread_mutex_lock(&g_notify.watch_mutex);
+    if (g_notify.watch_running) {
+        watched_param_t* w = watch_find_locked(paramName, watch_hash(paramName));
+        if (w && w->wanted) {
+            w->wanted = 0;
+            watch_queue_locked(w);
+        }
+    }
+    pthread_mutex_unlock(&g_notify.watch_mutex);
+}
+
 int notification_unsubscribe_rbus_events(void) {
     if (!g_notify.initialized) return -1;
     
@@ -568,6 +1167,15 @@ int notification_configure(const notification_config_t* config) {
     g_notify.config.enable_device_notifications = config->enable_device_notifications;
     g_notify.config.notification_retry_count = config->notification_retry_count;
     g_notify.config.notification_timeout_ms = config->notification_timeout_ms;
+    g_notify.config.coalesce_window_ms = config->coalesce_window_ms > 0 ? config->coalesce_window_ms : 0;
+    g_notify.config.queue_capacity = config->queue_capacity > 0 ? config->queue_capacity : NOTIFY_QUEUE_DEFAULT_CAPACITY;
+    
+    pthread_mutex_lock(&g_notify.queue_mutex);
+    g_notify.retry_count = g_notify.config.notification_retry_count;
+    g_notify.timeout_ms = g_notify.config.notification_timeout_ms;
+    g_notify.coalesce_window_ms = g_notify.config.coalesce_window_ms;
+    g_notify.queue_capacity = g_notify.config.queue_capacity;
+    pthread_mutex_unlock(&g_notify.queue_mutex);
     
     pthread_mutex_unlock(&g_notify.mutex);
     
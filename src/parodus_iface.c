@@ -4,12 +4,20 @@
 #include "log.h"
 #include "rbus_adapter.h"
 #include "notification.h"
+#include "webconfig.h"
+#include "dispatcher.h"
+#include "event_forwarder.h"
+#include "trace.h"
+#include "arena.h"
 #include <cJSON.h>
+#include <errno.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <libparodus.h>
@@ -20,15 +28,21 @@ static volatile sig_atomic_t g_run = 1;
 /* Global libparodus instance for notification delivery */
 static libpd_instance_t g_parodus_instance = NULL;
 
-/* Notification emission hook used by notification system */
-void p2r_emit_notification(const char* dest, const char* payload_json) {
-   if (!dest || !payload_json || !g_parodus_instance) return;
+/* Service name used as reply source; set once before any message is handled */
+static const char* g_service_name = NULL;
+
+/* Stream mode output; -1 (caller prints) when stream mode is not running */
+static int stream_emit(const char* record, size_t len);
+
+/* Notification emission hook used by notification system; returns the libparodus_send result */
+int p2r_emit_notification(const char* dest, const char* payload_json) {
+   if (!dest || !payload_json || !g_parodus_instance) return -1;
    
    LOGI("Emitting notification to %s: %s", dest, payload_json);
    
    /* Build WRP message for notification */
    wrp_msg_t* notif_msg = (wrp_msg_t*)malloc(sizeof(wrp_msg_t));
-   if (!notif_msg) return;
+   if (!notif_msg) return -1;
    
    memset(notif_msg, 0, sizeof(wrp_msg_t));
    notif_msg->msg_type = WRP_MSG_TYPE__EVENT;
@@ -44,22 +58,31 @@ void p2r_emit_notification(const char* dest, const char* payload_json) {
    }
    
    wrp_free_struct(notif_msg);
+   return rc;
+}
+
+#define RBUS_EVENTS_DEST "event:parodus2rbus.rbus-events"
+
+/* Event forwarder output: one WRP EVENT per batch over Parodus, one line otherwise */
+static void emit_event_batch(const char* payload_json, size_t len) {
+   if (g_parodus_instance) {
+      p2r_emit_notification(RBUS_EVENTS_DEST, payload_json);
+   } else if (stream_emit(payload_json, len) != 0) {
+      printf("%s\n", payload_json);
+      fflush(stdout);
+   }
 }
 
-/* Event emission hook used by rbus_adapter when RBUS delivers an event */
-void p2r_emit_event(const char* name, const char* payload_json) {
-   if (!name) return;
-   cJSON* obj = cJSON_CreateObject();
-   cJSON_AddStringToObject(obj, "event", name);
-   cJSON_AddStringToObject(obj, "type", "EVENT");
-   if (payload_json) {
-      /* payload_json is a serialized RBUS value string; wrap it */
-      cJSON_AddStringToObject(obj, "value", payload_json);
+static void start_event_forwarder(void) {
+   event_forwarder_config_t cfg = {
+      .batch_ms = g_p2r_config.event_batch_ms,
+      .batch_max = g_p2r_config.event_batch_max,
+      .ring_size = g_p2r_config.event_ring_size,
+      .emit = emit_event_batch
+   };
+   if (event_forwarder_start(&cfg) != 0) {
+      LOGW("Failed to start event forwarder: %s", "subscription events will be dropped");
    }
-   cJSON_AddNumberToObject(obj, "ts", (double)time(NULL));
-   char* out = cJSON_PrintUnformatted(obj);
-   if (out) { printf("%s\n", out); fflush(stdout); free(out); }
-   cJSON_Delete(obj);
 }
 
 static void handle_sig(int s) { (void)s; g_run = 0; }
@@ -217,140 +240,649 @@ static int is_wildcard_query_present(cJSON* originalRoot) {
    return 0;
 }
 
-static char* convert_internal_to_webpa_ext(const char* inJson, cJSON* originalRequest) {
-   if (!inJson) return NULL;
-   cJSON* root = cJSON_Parse(inJson);
-   if (!root) return NULL;
-   cJSON* status = cJSON_GetObjectItem(root, "status");
-   cJSON* results = cJSON_GetObjectItem(root, "results");
-   cJSON* message = cJSON_GetObjectItem(root, "message");
-   if (!cJSON_IsNumber(status)) { cJSON_Delete(root); return strdup(inJson); }
-   cJSON* out = cJSON_CreateObject();
-   cJSON_AddNumberToObject(out, "statusCode", status->valueint);
-   cJSON* arr = cJSON_CreateArray();
-   cJSON_AddItemToObject(out, "parameters", arr);
-   int wildcardMode = is_wildcard_query_present(originalRequest);
-   int topLevelCount = 0;
+/* Growable output buffer for building a reply payload in one pass */
+typedef struct {
+   char* data;
+   size_t len;
+   size_t cap;
+   int failed;
+} reply_buf_t;
+
+static void reply_buf_reserve(reply_buf_t* b, size_t extra) {
+   if (b->failed || b->len + extra + 1 <= b->cap) return;
+   size_t cap = b->cap ? b->cap : 256;
+   while (cap < b->len + extra + 1) cap *= 2;
+   char* data = (char*)realloc(b->data, cap);
+   if (!data) { b->failed = 1; return; }
+   b->data = data;
+   b->cap = cap;
+}
+
+static void reply_buf_append(reply_buf_t* b, const char* s, size_t n) {
+   reply_buf_reserve(b, n);
+   if (b->failed) return;
+   memcpy(b->data + b->len, s, n);
+   b->len += n;
+   b->data[b->len] = '\0';
+}
+
+static void reply_buf_puts(reply_buf_t* b, const char* s) {
+   reply_buf_append(b, s, strlen(s));
+}
+
+static void reply_buf_int(reply_buf_t* b, int v) {
+   char num[16];
+   int n = snprintf(num, sizeof(num), "%d", v);
+   reply_buf_append(b, num, (size_t)n);
+}
+
+/* Append the contents of s escaped the way cJSON prints strings, without quotes */
+static void reply_buf_escaped(reply_buf_t* b, const char* s) {
+   const char* run = s;
+   for (const char* p = s; *p; p++) {
+      unsigned char c = (unsigned char)*p;
+      if (c >= 32 && c != '"' && c != '\\') continue;
+      reply_buf_append(b, run, (size_t)(p - run));
+      char esc[8];
+      switch (c) {
+         case '"': reply_buf_append(b, "\\\"", 2); break;
+         case '\\': reply_buf_append(b, "\\\\", 2); break;
+         case '\b': reply_buf_append(b, "\\b", 2); break;
+         case '\f': reply_buf_append(b, "\\f", 2); break;
+         case '\n': reply_buf_append(b, "\\n", 2); break;
+         case '\r': reply_buf_append(b, "\\r", 2); break;
+         case '\t': reply_buf_append(b, "\\t", 2); break;
+         default:
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            reply_buf_append(b, esc, 6);
+            break;
+      }
+      run = p + 1;
+   }
+   reply_buf_puts(b, run);
+}
+
+static void reply_buf_string(reply_buf_t* b, const char* s) {
+   reply_buf_append(b, "\"", 1);
+   reply_buf_escaped(b, s);
+   reply_buf_append(b, "\"", 1);
+}
+
+/* Append one {"name":...,"value":...,"dataType":...} entry for an internal result */
+static void reply_buf_result(reply_buf_t* b, const cJSON* child) {
+   int dtype = 0; const char* vstr = ""; char numBuf[64];
+   if (cJSON_IsObject(child)) {
+      cJSON* v = cJSON_GetObjectItem(child, "v");
+      cJSON* t = cJSON_GetObjectItem(child, "t");
+      if (cJSON_IsString(v)) vstr = v->valuestring;
+      if (cJSON_IsNumber(t)) dtype = t->valueint;
+   } else if (cJSON_IsString(child)) {
+      vstr = child->valuestring; dtype = 0;
+   } else if (cJSON_IsNumber(child)) {
+      snprintf(numBuf, sizeof(numBuf), "%g", child->valuedouble); vstr = numBuf; dtype = 0;
+   } else if (cJSON_IsBool(child)) {
+      vstr = cJSON_IsTrue(child) ? "true" : "false"; dtype = 3; /* bool */
+   }
+   reply_buf_puts(b, "{\"name\":");
+   reply_buf_string(b, child->string ? child->string : "");
+   reply_buf_puts(b, ",\"value\":");
+   reply_buf_string(b, vstr);
+   reply_buf_puts(b, ",\"dataType\":");
+   reply_buf_int(b, dtype);
+   reply_buf_append(b, "}", 1);
+}
+
+/* Serialize the internal response tree straight to WebPA JSON text (caller frees).
+ * Values are copied once from the response (or the cache buffers it references) into
+ * a single growable buffer, which becomes the WRP payload; the internal response is
+ * never printed or re-parsed. Output matches the layout described above.
+ */
+static char* convert_internal_to_webpa_ext(const cJSON* resp, cJSON* originalRequest) {
+   if (!resp) return NULL;
+   cJSON* status = cJSON_GetObjectItem(resp, "status");
+   cJSON* results = cJSON_GetObjectItem(resp, "results");
+   cJSON* message = cJSON_GetObjectItem(resp, "message");
+   if (!cJSON_IsNumber(status)) return cJSON_PrintUnformatted(resp);
+   int ok = (status->valueint == 200 || status->valueint == 207);
+
+   reply_buf_t b = {0};
+   int resultCount = cJSON_IsObject(results) ? cJSON_GetArraySize(results) : 0;
+   reply_buf_reserve(&b, 128 + (size_t)resultCount * 96);
+   reply_buf_puts(&b, "{\"statusCode\":");
+   reply_buf_int(&b, status->valueint);
+   reply_buf_puts(&b, ",\"parameters\":[");
    if (cJSON_IsObject(results)) {
-      if (wildcardMode) {
-         /* Build a single grouped parameter */
-         cJSON* grouped = cJSON_CreateObject();
-         /* Collect all wildcard parameters and concatenate them */
-         char* wildcardName = NULL;
-         if (originalRequest) {
-            cJSON* paramsReq = cJSON_GetObjectItem(originalRequest, "params");
-            if (paramsReq && cJSON_IsArray(paramsReq)) {
-               size_t totalLen = 0;
-               int wildcardCount = 0;
-               /* First pass: calculate total length needed */
-               cJSON* e = NULL; cJSON_ArrayForEach(e, paramsReq) {
-                  if (cJSON_IsString(e)) {
-                     const char* s = e->valuestring; size_t l = strlen(s); 
-                     if (l > 0 && s[l - 1] == '.') { 
-                        totalLen += l + 1; /* +1 for comma */
-                        wildcardCount++;
-                     }
-                  }
-               }
-               /* Second pass: build concatenated string */
-               if (wildcardCount > 0) {
-                  wildcardName = (char*)malloc(totalLen + 1);
-                  if (wildcardName) {
-                     wildcardName[0] = '\0';
-                     int first = 1;
-                     cJSON_ArrayForEach(e, paramsReq) {
-                        if (cJSON_IsString(e)) {
-                           const char* s = e->valuestring; size_t l = strlen(s);
-                           if (l > 0 && s[l - 1] == '.') {
-                              if (!first) strcat(wildcardName, ",");
-                              strcat(wildcardName, s);
-                              first = 0;
-                           }
-                        }
-                     }
+      if (is_wildcard_query_present(originalRequest)) {
+         /* Single grouped parameter named after the trailing-dot queries, comma separated */
+         reply_buf_puts(&b, "{\"name\":\"");
+         int wildcardCount = 0;
+         cJSON* paramsReq = originalRequest ? cJSON_GetObjectItem(originalRequest, "params") : NULL;
+         if (paramsReq && cJSON_IsArray(paramsReq)) {
+            cJSON* e = NULL; cJSON_ArrayForEach(e, paramsReq) {
+               if (cJSON_IsString(e)) {
+                  const char* s = e->valuestring; size_t l = strlen(s);
+                  if (l > 0 && s[l - 1] == '.') {
+                     if (wildcardCount++) reply_buf_append(&b, ",", 1);
+                     reply_buf_escaped(&b, s);
                   }
                }
             }
          }
-         if (!wildcardName) wildcardName = strdup("wildcard");
-         cJSON_AddStringToObject(grouped, "name", wildcardName);
-         LOGI("wildcardName: %s", wildcardName);
-
-         cJSON* valArray = cJSON_CreateArray();
-         cJSON_AddItemToObject(grouped, "value", valArray);
+         if (wildcardCount == 0) reply_buf_puts(&b, "wildcard");
+         reply_buf_puts(&b, "\",\"value\":[");
          int paramCount = 0;
-         cJSON* child = results->child;
-         while (child) {
-            cJSON* item = cJSON_CreateObject();
-            cJSON_AddStringToObject(item, "name", child->string ? child->string : "");
-            int dtype = 0; const char* vstr = "";
-            if (cJSON_IsObject(child)) {
-               cJSON* v = cJSON_GetObjectItem(child, "v");
-               cJSON* t = cJSON_GetObjectItem(child, "t");
-               if (cJSON_IsString(v)) vstr = v->valuestring;
-               if (cJSON_IsNumber(t)) dtype = t->valueint;
-            } else if (cJSON_IsString(child)) {
-               vstr = child->valuestring; dtype = 0;
-            } else if (cJSON_IsNumber(child)) {
-               static char numBuf[64]; snprintf(numBuf, sizeof(numBuf), "%g", child->valuedouble); vstr = numBuf; dtype = 0;
-            } else if (cJSON_IsBool(child)) {
-               vstr = cJSON_IsTrue(child) ? "true" : "false"; dtype = 3; /* bool */
-            }
-            cJSON_AddStringToObject(item, "value", vstr);
-            cJSON_AddNumberToObject(item, "dataType", dtype);
-            cJSON_AddItemToArray(valArray, item);
-            paramCount++;
-            child = child->next;
+         for (cJSON* child = results->child; child; child = child->next) {
+            if (paramCount++) reply_buf_append(&b, ",", 1);
+            reply_buf_result(&b, child);
          }
-         topLevelCount = paramCount;
-         /* Also include legacy fields inside grouped object for compatibility */
-         cJSON_AddNumberToObject(grouped, "parameterCount", paramCount);
-         cJSON_AddStringToObject(grouped, "message", (status->valueint == 200 || status->valueint == 207) ? "Success" : "Failure");
-         /* Place grouped dataType after count & message for visibility */
-         cJSON_AddNumberToObject(grouped, "dataType", 11);
-         cJSON_AddItemToArray(arr, grouped);
-         if (wildcardName) free(wildcardName);
+         reply_buf_puts(&b, "],\"parameterCount\":");
+         reply_buf_int(&b, paramCount);
+         reply_buf_puts(&b, ",\"message\":");
+         reply_buf_string(&b, ok ? "Success" : "Failure");
+         reply_buf_puts(&b, ",\"dataType\":11}]}");
       } else {
-         cJSON* child = results->child;
-         while (child) {
-            cJSON* paramObj = cJSON_CreateObject();
-            cJSON_AddStringToObject(paramObj, "name", child->string ? child->string : "");
-            int dtype = 0; const char* vstr = "";
-            if (cJSON_IsObject(child)) {
-               cJSON* v = cJSON_GetObjectItem(child, "v");
-               cJSON* t = cJSON_GetObjectItem(child, "t");
-               if (cJSON_IsString(v)) vstr = v->valuestring;
-               if (cJSON_IsNumber(t)) dtype = t->valueint;
-            } else if (cJSON_IsString(child)) {
-               vstr = child->valuestring; dtype = 0;
-            } else if (cJSON_IsNumber(child)) {
-               static char numBuf[64]; snprintf(numBuf, sizeof(numBuf), "%g", child->valuedouble); vstr = numBuf; dtype = 0;
-            } else if (cJSON_IsBool(child)) {
-               vstr = cJSON_IsTrue(child) ? "true" : "false"; dtype = 3;
-            }
-            cJSON_AddStringToObject(paramObj, "value", vstr);
-            cJSON_AddNumberToObject(paramObj, "dataType", dtype);
-            cJSON_AddItemToArray(arr, paramObj);
-            child = child->next;
-            topLevelCount++;
+         int n = 0;
+         for (cJSON* child = results->child; child; child = child->next) {
+            if (n++) reply_buf_append(&b, ",", 1);
+            reply_buf_result(&b, child);
          }
-         /* top-level message for non-wildcard */
-         cJSON_AddStringToObject(out, "message", (status->valueint == 200 || status->valueint == 207) ? "Success" : "Failure");
+         reply_buf_puts(&b, "],\"message\":");
+         reply_buf_string(&b, ok ? "Success" : "Failure");
+         reply_buf_append(&b, "}", 1);
       }
    } else if (message && cJSON_IsString(message)) {
-      cJSON* paramObj = cJSON_CreateObject();
-      cJSON_AddStringToObject(paramObj, "name", "result");
-      cJSON_AddStringToObject(paramObj, "value", message->valuestring);
-      cJSON_AddNumberToObject(paramObj, "dataType", 0);
-      cJSON_AddItemToArray(arr, paramObj);
-      topLevelCount = 1;
-      cJSON_AddStringToObject(out, "message", (status->valueint == 200) ? "Success" : "Failure");
+      reply_buf_puts(&b, "{\"name\":\"result\",\"value\":");
+      reply_buf_string(&b, message->valuestring);
+      reply_buf_puts(&b, ",\"dataType\":0}],\"message\":");
+      reply_buf_string(&b, status->valueint == 200 ? "Success" : "Failure");
+      reply_buf_append(&b, "}", 1);
+   } else {
+      reply_buf_puts(&b, "]}");
+   }
+   if (b.failed) {
+      free(b.data);
+      return NULL;
+   }
+   return b.data;
+}
+
+/* One WRP message on its way through decode -> execute -> encode -> send.
+ * Each stage hands the job to the next; the request tree lives in the job's arena.
+ */
+typedef struct {
+   wrp_msg_t* msg;
+   arena_t* arena;
+   cJSON* root;
+   cJSON* resp;
+   protocol_pins_t pins;
+   wrp_msg_t* reply;
+   trace_t* trace;                 /* NULL unless this request is traced */
+} wrp_job_t;
+
+/* Pipeline stages (NULL when messages are handled inline on the receive thread) */
+static dispatcher_t* g_decode_stage = NULL;
+static dispatcher_t* g_execute_stage = NULL;
+static dispatcher_t* g_encode_stage = NULL;
+static dispatcher_t* g_send_stage = NULL;
+
+#define WRP_SEND_BATCH_MAX 32
+
+static const char* wrp_type_name(int msg_type) {
+   switch (msg_type) {
+      case WRP_MSG_TYPE__RETREIVE: return "RETREIVE";
+      case WRP_MSG_TYPE__REQ: return "REQ";
+      case WRP_MSG_TYPE__EVENT: return "EVENT";
+      default: return "unknown";
+   }
+}
+
+/* JSON request carried by a REQ, RETREIVE or EVENT message; 0 if there is one */
+static int wrp_request_payload(const wrp_msg_t* msg, const char** payload, size_t* size, const char** txn_id) {
+   switch (msg->msg_type) {
+      case WRP_MSG_TYPE__RETREIVE:
+         *payload = (const char*)msg->u.crud.payload; *size = msg->u.crud.payload_size;
+         *txn_id = msg->u.crud.transaction_uuid;
+         break;
+      case WRP_MSG_TYPE__REQ:
+         *payload = (const char*)msg->u.req.payload; *size = msg->u.req.payload_size;
+         *txn_id = msg->u.req.transaction_uuid;
+         break;
+      case WRP_MSG_TYPE__EVENT:
+         *payload = (const char*)msg->u.event.payload; *size = msg->u.event.payload_size;
+         *txn_id = msg->u.event.transaction_uuid;
+         break;
+      default:
+         return -1;
+   }
+   return (*payload && *size > 0) ? 0 : -1;
+}
+
+/* Record the request's op and response status on its trace */
+static void trace_note_result(trace_t* trace, cJSON* root, cJSON* resp) {
+   if (!trace) return;
+   cJSON* op = root ? cJSON_GetObjectItem(root, "op") : NULL;
+   cJSON* status = resp ? cJSON_GetObjectItem(resp, "status") : NULL;
+   trace_set_result(trace, cJSON_IsString(op) ? op->valuestring : NULL, cJSON_IsNumber(status) ? status->valueint : 0);
+}
+
+static void wrp_job_free(wrp_job_t* job) {
+   if (job->root || job->resp) {
+      arena_json_bind(job->arena);
+      if (job->root) cJSON_Delete(job->root);
+      if (job->resp) cJSON_Delete(job->resp);
+      arena_json_bind(NULL);
+   }
+   protocol_pins_release(&job->pins);
+   arena_release(job->arena);
+   if (job->reply) wrp_free_struct(job->reply);
+   trace_finish(job->trace);
+   wrp_free_struct(job->msg); /* proper free for libparodus-allocated message */
+   free(job);
+}
+
+/* Decode: parse the payload in place (no NUL-terminated copy) and translate it to the
+ * internal schema. Returns -1 if the message carries no request.
+ */
+static int wrp_decode(wrp_job_t* job) {
+   const char* payload = NULL; size_t size = 0; const char* txn_id = NULL;
+   if (wrp_request_payload(job->msg, &payload, &size, &txn_id) != 0) return -1;
+   job->trace = trace_begin(txn_id);
+   trace_attach(job->trace);
+   uint64_t span = TRACE_SPAN_START();
+   job->arena = arena_acquire();
+   arena_json_begin(job->arena);
+   job->root = cJSON_ParseWithLength(payload, size);
+   translate_webpa_request(job->root, txn_id);
+   arena_json_end();
+   arena_json_bind(NULL);
+   TRACE_SPAN_END(span, "decode", wrp_type_name(job->msg->msg_type), job->root ? 0 : 400);
+   trace_attach(NULL);
+   return 0;
+}
+
+static void wrp_execute(wrp_job_t* job) {
+   trace_attach(job->trace);
+   uint64_t span = TRACE_SPAN_START();
+   arena_json_bind(job->arena);
+   job->resp = protocol_handle_request_pinned(job->root, &job->pins);
+   arena_json_bind(NULL);
+   trace_note_result(job->trace, job->root, job->resp);
+   if (job->trace) TRACE_SPAN_END(span, "execute", job->trace->op, job->trace->status);
+   trace_attach(NULL);
+}
+
+/* Render the WebPA reply payload (caller frees) and drop the request, response and cache pins */
+static char* wrp_encode_payload(wrp_job_t* job) {
+   trace_attach(job->trace);
+   uint64_t span = TRACE_SPAN_START();
+   char* out = job->resp ? convert_internal_to_webpa_ext(job->resp, job->root) : NULL;
+   TRACE_SPAN_END(span, "encode", NULL, out ? 0 : 500);
+   trace_attach(NULL);
+   arena_json_bind(job->arena);
+   if (job->root) cJSON_Delete(job->root);
+   if (job->resp) cJSON_Delete(job->resp);
+   arena_json_bind(NULL);
+   job->root = job->resp = NULL;
+   protocol_pins_release(&job->pins);
+   arena_release(job->arena);
+   job->arena = NULL;
+   return out;
+}
+
+/* Encode: write the WebPA reply and drop the request, response and cache pins */
+static void wrp_encode(wrp_job_t* job) {
+   char* out = wrp_encode_payload(job);
+   if (!out) return;
+
+   switch (job->msg->msg_type) {
+      case WRP_MSG_TYPE__RETREIVE: job->reply = build_reply_retreive(job->msg, g_service_name, out); break;
+      case WRP_MSG_TYPE__REQ: job->reply = build_reply_req(job->msg, g_service_name, out); break;
+      default: job->reply = build_reply_event(job->msg, g_service_name, out); break;
+   }
+}
+
+char* parodus_iface_handle_payload(const char* payload, size_t size, const char* transaction_uuid) {
+   if (!payload || size == 0) return NULL;
+   wrp_msg_t msg;
+   memset(&msg, 0, sizeof(msg));
+   msg.msg_type = WRP_MSG_TYPE__REQ;
+   msg.u.req.transaction_uuid = (char*)transaction_uuid;
+   msg.u.req.payload = (void*)payload;
+   msg.u.req.payload_size = size;
+
+   wrp_job_t job;
+   memset(&job, 0, sizeof(job));
+   job.msg = &msg;
+   if (wrp_decode(&job) != 0) return NULL;
+   wrp_execute(&job);
+   char* out = wrp_encode_payload(&job);
+   trace_finish(job.trace);
+   return out;
+}
+
+static void wrp_send(wrp_job_t* job) {
+   if (job->reply) {
+      trace_attach(job->trace);
+      uint64_t span = TRACE_SPAN_START();
+      int s = libparodus_send(g_parodus_instance, job->reply);
+      TRACE_SPAN_END(span, "send", NULL, s);
+      trace_attach(NULL);
+      if (s != 0) {
+         LOGW("libparodus_send %s reply failed %d", wrp_type_name(job->msg->msg_type), s);
+      }
+   }
+   wrp_job_free(job);
+}
+
+/* Handle one message start to finish on the calling thread */
+static void wrp_handle_inline(wrp_job_t* job) {
+   if (wrp_decode(job) != 0) {
+      wrp_job_free(job);
+      return;
+   }
+   wrp_execute(job);
+   wrp_encode(job);
+   wrp_send(job);
+}
+
+static void wrp_forward(dispatcher_t* stage, wrp_job_t* job) {
+   if (dispatcher_submit(stage, job) != 0) {
+      LOGW("Pipeline dropped %s message: %s", wrp_type_name(job->msg->msg_type), "shutting down");
+      wrp_job_free(job);
+   }
+}
+
+static void decode_stage_fn(void* arg) {
+   wrp_job_t* job = (wrp_job_t*)arg;
+   if (wrp_decode(job) != 0) {
+      wrp_job_free(job);
+      return;
+   }
+   wrp_forward(g_execute_stage, job);
+}
+
+static void execute_stage_fn(void* arg) {
+   wrp_job_t* job = (wrp_job_t*)arg;
+   wrp_execute(job);
+   wrp_forward(g_encode_stage, job);
+}
+
+static void encode_stage_fn(void* arg) {
+   wrp_job_t* job = (wrp_job_t*)arg;
+   wrp_encode(job);
+   wrp_forward(g_send_stage, job);
+}
+
+/* Replies leave in the order they finished encoding */
+static void send_stage_fn(void** jobs, int count) {
+   for (int i = 0; i < count; i++) wrp_send((wrp_job_t*)jobs[i]);
+}
+
+static void pipeline_stop(void) {
+   /* Upstream first: each destroy drains its queue into the next stage */
+   dispatcher_destroy(g_decode_stage);
+   g_decode_stage = NULL;
+   dispatcher_destroy(g_execute_stage);
+   g_execute_stage = NULL;
+   dispatcher_destroy(g_encode_stage);
+   g_encode_stage = NULL;
+   dispatcher_destroy(g_send_stage);
+   g_send_stage = NULL;
+}
+
+/* Start the staged pipeline; on failure nothing is left running */
+static int pipeline_start(int execute_workers, int queue_depth, int batch_window_ms) {
+   dispatcher_config_t cfg = { .name = "wrp_send", .worker_count = 1, .queue_capacity = queue_depth,
+                               .batch_max = WRP_SEND_BATCH_MAX, .batch_window_ms = batch_window_ms };
+   g_send_stage = dispatcher_create_batch(&cfg, send_stage_fn);
+
+   cfg = (dispatcher_config_t){ .name = "wrp_encode", .worker_count = 1, .queue_capacity = queue_depth };
+   if (g_send_stage) g_encode_stage = dispatcher_create(&cfg, encode_stage_fn);
+
+   cfg = (dispatcher_config_t){ .name = "wrp_execute", .worker_count = execute_workers, .queue_capacity = queue_depth };
+   if (g_encode_stage) g_execute_stage = dispatcher_create(&cfg, execute_stage_fn);
+
+   cfg = (dispatcher_config_t){ .name = "wrp_decode", .worker_count = 1, .queue_capacity = queue_depth };
+   if (g_execute_stage) g_decode_stage = dispatcher_create(&cfg, decode_stage_fn);
+
+   if (!g_decode_stage) {
+      pipeline_stop();
+      return -1;
+   }
+   return 0;
+}
+
+static void webconfig_status_notify(const char* transaction_id, webconfig_status_t status, const char* details) {
+   const char* name;
+   switch (status) {
+      case WEBCONFIG_STATUS_SUCCESS: name = "success"; break;
+      case WEBCONFIG_STATUS_PARTIAL: name = "partial"; break;
+      case WEBCONFIG_STATUS_TIMEOUT: name = "timeout"; break;
+      case WEBCONFIG_STATUS_PENDING: name = "pending"; break;
+      default: name = "failure"; break;
+   }
+   notification_send_transaction_status(transaction_id, name,
+                                        status == WEBCONFIG_STATUS_SUCCESS ? NULL : details);
+}
+
+/* Stream mode (--mode stream): NDJSON lines of any length are read on the main thread and
+ * handled concurrently by a dispatcher pool. Replies carry the request id (or the input
+ * line number when the request has none) and are appended to a shared buffer that is
+ * written out at flush points: when it reaches --stream-buffer-kb, when its oldest reply
+ * has waited --stream-flush-ms, and at end of input.
+ */
+typedef struct {
+   char* line;
+   size_t len;
+   unsigned long long line_no;
+} stream_job_t;
+
+static struct {
+   pthread_mutex_t mutex;          /* Guards the fill buffer; never held across write() */
+   pthread_mutex_t write_mutex;    /* Serialises writes so buffers leave in append order */
+   pthread_cond_t cond;            /* Flusher: first reply buffered, or stop */
+   char* buf;                      /* Fill buffer */
+   size_t len;
+   size_t cap;
+   char* spare;                    /* Written-out buffer, reused by the next swap */
+   size_t spare_cap;
+   size_t limit;
+   int flush_ms;
+   int stop;
+   int active;
+   pthread_t flusher;
+} g_stream = { .mutex = PTHREAD_MUTEX_INITIALIZER, .write_mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static void stream_write_all(const char* data, size_t len) {
+   while (len > 0) {
+      ssize_t n = write(STDOUT_FILENO, data, len);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+         LOGW("Stream output write failed: %s", strerror(errno));
+         return;
+      }
+      data += n;
+      len -= (size_t)n;
+   }
+}
+
+/* Swap out the fill buffer and write it */
+static void stream_flush(void) {
+   pthread_mutex_lock(&g_stream.write_mutex);
+   pthread_mutex_lock(&g_stream.mutex);
+   char* out = g_stream.buf;
+   size_t out_len = g_stream.len, out_cap = g_stream.cap;
+   g_stream.buf = g_stream.spare;
+   g_stream.cap = g_stream.spare_cap;
+   g_stream.len = 0;
+   g_stream.spare = out;
+   g_stream.spare_cap = out_cap;
+   pthread_mutex_unlock(&g_stream.mutex);
+   if (out_len > 0) stream_write_all(out, out_len);
+   pthread_mutex_unlock(&g_stream.write_mutex);
+}
+
+static int stream_emit(const char* record, size_t len) {
+   if (!__atomic_load_n(&g_stream.active, __ATOMIC_ACQUIRE)) return -1;
+
+   pthread_mutex_lock(&g_stream.mutex);
+   if (g_stream.len + len + 1 > g_stream.cap) {
+      size_t cap = g_stream.cap ? g_stream.cap : g_stream.limit;
+      while (cap < g_stream.len + len + 1) cap *= 2;
+      char* buf = realloc(g_stream.buf, cap);
+      if (!buf) {
+         pthread_mutex_unlock(&g_stream.mutex);
+         LOGW("Stream output dropped a %zu byte reply: %s", len, "out of memory");
+         return 0;
+      }
+      g_stream.buf = buf;
+      g_stream.cap = cap;
+   }
+   if (g_stream.len == 0) pthread_cond_signal(&g_stream.cond);
+   memcpy(g_stream.buf + g_stream.len, record, len);
+   g_stream.len += len;
+   g_stream.buf[g_stream.len++] = '\n';
+   int full = g_stream.len >= g_stream.limit;
+   pthread_mutex_unlock(&g_stream.mutex);
+
+   if (full || g_stream.flush_ms == 0) stream_flush();
+   return 0;
+}
+
+/* Writes the buffer once its oldest reply has waited flush_ms */
+static void* stream_flusher_thread(void* arg) {
+   (void)arg;
+   pthread_mutex_lock(&g_stream.mutex);
+   while (!g_stream.stop) {
+      if (g_stream.len == 0) {
+         pthread_cond_wait(&g_stream.cond, &g_stream.mutex);
+         continue;
+      }
+      struct timespec deadline;
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      deadline.tv_sec += g_stream.flush_ms / 1000;
+      deadline.tv_nsec += (long)(g_stream.flush_ms % 1000) * 1000000L;
+      if (deadline.tv_nsec >= 1000000000L) {
+         deadline.tv_sec++;
+         deadline.tv_nsec -= 1000000000L;
+      }
+      int wait_rc = 0;
+      while (!g_stream.stop && g_stream.len > 0 && wait_rc != ETIMEDOUT) {
+         wait_rc = pthread_cond_timedwait(&g_stream.cond, &g_stream.mutex, &deadline);
+      }
+      if (g_stream.len > 0) {
+         pthread_mutex_unlock(&g_stream.mutex);
+         stream_flush();
+         pthread_mutex_lock(&g_stream.mutex);
+      }
+   }
+   pthread_mutex_unlock(&g_stream.mutex);
+   return NULL;
+}
+
+static void stream_job_fn(void* arg) {
+   stream_job_t* job = (stream_job_t*)arg;
+   trace_t* trace = trace_begin(NULL);
+   trace_attach(trace);
+   uint64_t span = TRACE_SPAN_START();
+   arena_t* arena = arena_acquire();
+   arena_json_begin(arena);
+   cJSON* root = cJSON_ParseWithLength(job->line, job->len);
+   arena_json_end();
+   TRACE_SPAN_END(span, "decode", NULL, root ? 0 : 400);
+   span = TRACE_SPAN_START();
+   protocol_pins_t pins = {0};
+   cJSON* resp = protocol_handle_request_pinned(root, &pins);
+   trace_note_result(trace, root, resp);
+   if (trace) TRACE_SPAN_END(span, "execute", trace->op, trace->status);
+   if (root) cJSON_Delete(root);
+   if (resp && !cJSON_GetObjectItem(resp, "id")) {
+      char line_id[24];
+      snprintf(line_id, sizeof(line_id), "%llu", job->line_no);
+      cJSON_AddStringToObject(resp, "id", line_id);
+   }
+   if (trace) trace_set_id(trace, cJSON_GetStringValue(cJSON_GetObjectItem(resp, "id")));
+   span = TRACE_SPAN_START();
+   char* out = cJSON_PrintUnformatted(resp);
+   TRACE_SPAN_END(span, "encode", NULL, out ? 0 : 500);
+   trace_finish(trace);
+   if (out) {
+      stream_emit(out, strlen(out));
+      free(out);
+   }
+   cJSON_Delete(resp);
+   protocol_pins_release(&pins);
+   arena_release(arena);
+   free(job->line);
+   free(job);
+}
+
+static int stream_run(void) {
+   long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   int workers = g_p2r_config.worker_threads > 0 ? g_p2r_config.worker_threads : (cpus > 0 ? (int)cpus : 1);
+   dispatcher_config_t cfg = { .name = "mock_stream", .worker_count = workers, .queue_capacity = g_p2r_config.queue_depth };
+   dispatcher_t* pool = dispatcher_create(&cfg, stream_job_fn);
+   if (!pool) {
+      LOGE("Failed to start %d stream workers", workers);
+      return 1;
    }
-   char* outStr = cJSON_PrintUnformatted(out);
-   cJSON_Delete(out);
-   cJSON_Delete(root);
-   if (!outStr) return strdup(inJson);
-   return outStr;
+
+   pthread_condattr_t cond_attr;
+   pthread_condattr_init(&cond_attr);
+   pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+   pthread_cond_init(&g_stream.cond, &cond_attr);
+   pthread_condattr_destroy(&cond_attr);
+   g_stream.limit = (size_t)g_p2r_config.stream_buffer_kb * 1024;
+   g_stream.flush_ms = g_p2r_config.stream_flush_ms;
+   g_stream.stop = 0;
+   int flusher = g_stream.flush_ms > 0 && pthread_create(&g_stream.flusher, NULL, stream_flusher_thread, NULL) == 0;
+   if (g_stream.flush_ms > 0 && !flusher) g_stream.flush_ms = 0; /* No timer: flush every reply */
+   __atomic_store_n(&g_stream.active, 1, __ATOMIC_RELEASE);
+   LOGI("Stream mode: workers=%d flush_ms=%d buffer_kb=%d", workers, g_stream.flush_ms, g_p2r_config.stream_buffer_kb);
+
+   /* Large stdio reads; getline hands each line's buffer over to its job */
+   setvbuf(stdin, NULL, _IOFBF, 64 * 1024);
+   unsigned long long line_no = 0;
+   char* line = NULL;
+   size_t line_cap = 0;
+   ssize_t n;
+   while (g_run && (n = getline(&line, &line_cap, stdin)) >= 0) {
+      line_no++;
+      size_t len = (size_t)n;
+      while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+      if (len == 0) continue;
+      stream_job_t* job = malloc(sizeof(stream_job_t));
+      if (!job) continue;
+      job->line = line;
+      job->len = len;
+      job->line_no = line_no;
+      line = NULL;
+      line_cap = 0;
+      if (dispatcher_submit(pool, job) != 0) {
+         free(job->line);
+         free(job);
+      }
+   }
+   free(line);
+
+   /* Replies and forwarded events still in flight land in the buffer before the final flush */
+   dispatcher_destroy(pool);
+   event_forwarder_stop();
+   pthread_mutex_lock(&g_stream.mutex);
+   g_stream.stop = 1;
+   pthread_cond_signal(&g_stream.cond);
+   pthread_mutex_unlock(&g_stream.mutex);
+   if (flusher) pthread_join(g_stream.flusher, NULL);
+   __atomic_store_n(&g_stream.active, 0, __ATOMIC_RELEASE);
+   stream_flush();
+
+   free(g_stream.buf);
+   free(g_stream.spare);
+   g_stream.buf = g_stream.spare = NULL;
+   g_stream.len = g_stream.cap = g_stream.spare_cap = 0;
+   pthread_cond_destroy(&g_stream.cond);
+   LOGI("Stream mode handled %llu input lines", line_no);
+   return 0;
 }
 
 int parodus_iface_run(void) {
@@ -376,6 +908,8 @@ int parodus_iface_run(void) {
       
       /* Store global parodus instance for notifications */
       g_parodus_instance = inst;
+      g_service_name = service_name;
+      start_event_forwarder();
       
       /* Initialize notification system */
       if (notification_init(service_name) == 0) {
@@ -390,16 +924,25 @@ int parodus_iface_run(void) {
          config.enable_device_notifications = 1;
          config.notification_retry_count = 3;
          config.notification_timeout_ms = 30000;
+         config.coalesce_window_ms = g_p2r_config.notify_coalesce_ms;
          notification_configure(&config);
          free(config.device_id);
          free(config.fw_version);
          
          /* Subscribe to RBUS events for automatic notifications */
          notification_subscribe_rbus_events();
+         
+         /* Report WebConfig completions, which is how async transactions finish */
+         webconfig_set_notification_callback(webconfig_status_notify);
       } else {
          LOGW("Failed to initialize notification system: %s", "continuing without notifications");
       }
       
+      if (g_p2r_config.worker_threads > 0 &&
+          pipeline_start(g_p2r_config.worker_threads, g_p2r_config.queue_depth, g_p2r_config.reply_batch_ms) != 0) {
+         LOGW("Failed to start request pipeline: %s", "handling requests inline");
+      }
+
       while (g_run) {
          wrp_msg_t* msg = NULL;
          int rcv = libparodus_receive(inst, &msg, 2000);
@@ -412,94 +955,23 @@ int parodus_iface_run(void) {
          if (!msg) {
             continue;
          }
-         if (msg->msg_type == WRP_MSG_TYPE__RETREIVE && msg->u.crud.payload && msg->u.crud.payload_size > 0) {
-            /* Treat RETREIVE payload as JSON request; generate JSON response and send back as RETREIVE */
-            char* jsonBuf = (char*)malloc(msg->u.crud.payload_size + 1);
-            if (jsonBuf) {
-               memcpy(jsonBuf, msg->u.crud.payload, msg->u.crud.payload_size);
-               jsonBuf[msg->u.crud.payload_size] = '\0';
-               cJSON* root = cJSON_Parse(jsonBuf);
-               free(jsonBuf);
-               translate_webpa_request(root, msg->u.crud.transaction_uuid);
-               cJSON* resp = protocol_handle_request(root);
-               if (resp) {
-                  char* outInternal = cJSON_PrintUnformatted(resp);
-                  char* out = convert_internal_to_webpa_ext(outInternal, root);
-               if (root) cJSON_Delete(root);
-                  if (outInternal) free(outInternal);
-                  if (out) {
-                     wrp_msg_t* reply = build_reply_retreive(msg, service_name, out);
-                     if (reply) {
-                        int s = libparodus_send(inst, reply);
-                        if (s != 0) {
-                           LOGW("libparodus_send RETREIVE reply failed %d", s);
-                        }
-                        wrp_free_struct(reply);
-                     }
-                  }
-                  cJSON_Delete(resp);
-               }
-            }
-         } else if (msg->msg_type == WRP_MSG_TYPE__REQ && msg->u.req.payload && msg->u.req.payload_size > 0) {
-            /* Treat REQ payload as JSON request; generate JSON response and send back as REQ */
-            char* jsonBuf = (char*)malloc(msg->u.req.payload_size + 1);
-            if (jsonBuf) {
-               memcpy(jsonBuf, msg->u.req.payload, msg->u.req.payload_size);
-               jsonBuf[msg->u.req.payload_size] = '\0';
-               cJSON* root = cJSON_Parse(jsonBuf);
-               free(jsonBuf);
-               translate_webpa_request(root, msg->u.req.transaction_uuid);
-               cJSON* resp = protocol_handle_request(root);
-               if (resp) {
-                  char* outInternal = cJSON_PrintUnformatted(resp);
-                  char* out = convert_internal_to_webpa_ext(outInternal, root);
-               if (root) cJSON_Delete(root);
-                  if (outInternal) free(outInternal);
-                  if (out) {
-                     wrp_msg_t* reply = build_reply_req(msg, service_name, out);
-                     if (reply) {
-                        int s = libparodus_send(inst, reply);
-                        if (s != 0) {
-                           LOGW("libparodus_send REQ reply failed %d", s);
-                        }
-                        wrp_free_struct(reply);
-                     }
-                  }
-                  cJSON_Delete(resp);
-               }
-            }
-         } else if (msg->msg_type == WRP_MSG_TYPE__EVENT && msg->u.event.payload && msg->u.event.payload_size > 0) {
-            /* Assume JSON request in payload */
-            char* jsonBuf = (char*)malloc(msg->u.event.payload_size + 1);
-            if (jsonBuf) {
-               memcpy(jsonBuf, msg->u.event.payload, msg->u.event.payload_size);
-               jsonBuf[msg->u.event.payload_size] = '\0';
-               cJSON* root = cJSON_Parse(jsonBuf);
-               free(jsonBuf);
-               translate_webpa_request(root, msg->u.event.transaction_uuid);
-               cJSON* resp = protocol_handle_request(root);
-               if (resp) {
-                  char* outInternal = cJSON_PrintUnformatted(resp);
-                  char* out = convert_internal_to_webpa_ext(outInternal, root);
-               if (root) cJSON_Delete(root);
-                  if (outInternal) free(outInternal);
-                  if (out) {
-                     wrp_msg_t* reply = build_reply_event(msg, service_name, out);
-                     if (reply) {
-                        int s = libparodus_send(inst, reply);
-                        if (s != 0) {
-                           LOGW("libparodus_send EVENT reply failed %d", s);
-                        }
-                        wrp_free_struct(reply);
-                     }
-                  }
-                  cJSON_Delete(resp);
-               }
-            }
+         wrp_job_t* job = calloc(1, sizeof(wrp_job_t));
+         if (!job) {
+            wrp_free_struct(msg);
+            continue;
+         }
+         job->msg = msg;
+         if (g_decode_stage) {
+            wrp_forward(g_decode_stage, job);
+         } else {
+            wrp_handle_inline(job);
          }
-         wrp_free_struct(msg); /* proper free for libparodus-allocated message */
       }
       
+      /* Drain in-flight requests before tearing down their dependencies */
+      pipeline_stop();
+      event_forwarder_stop();
+
       /* Cleanup notification system */
       notification_cleanup();
       g_parodus_instance = NULL;
@@ -509,23 +981,50 @@ int parodus_iface_run(void) {
       return 0;
    }
 
+   start_event_forwarder();
+   if (strcmp(g_p2r_config.mode, "stream") == 0) {
+      int rc = stream_run();
+      g_run = 0;
+      return rc;
+   }
+
    /* Fallback: mock/stdin mode */
    char line[8192];
    while (g_run && fgets(line, sizeof(line), stdin)) {
       size_t len = strlen(line);
       while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
       if (len == 0) continue;
-      cJSON* root = cJSON_Parse(line);
-      cJSON* resp = protocol_handle_request(root);
+      trace_t* trace = trace_begin(NULL);
+      trace_attach(trace);
+      uint64_t span = TRACE_SPAN_START();
+      arena_t* arena = arena_acquire();
+      arena_json_begin(arena);
+      cJSON* root = cJSON_ParseWithLength(line, len);
+      arena_json_end();
+      TRACE_SPAN_END(span, "decode", NULL, root ? 0 : 400);
+      span = TRACE_SPAN_START();
+      protocol_pins_t pins = {0};
+      cJSON* resp = protocol_handle_request_pinned(root, &pins);
+      trace_note_result(trace, root, resp);
+      if (trace) {
+         TRACE_SPAN_END(span, "execute", trace->op, trace->status);
+         trace_set_id(trace, cJSON_GetStringValue(cJSON_GetObjectItem(resp, "id")));
+      }
       if (root) cJSON_Delete(root);
+      span = TRACE_SPAN_START();
       char* out = cJSON_PrintUnformatted(resp);
+      TRACE_SPAN_END(span, "encode", NULL, out ? 0 : 500);
+      trace_finish(trace);
       if (out) {
          printf("%s\n", out);
          fflush(stdout);
          free(out);
       }
       cJSON_Delete(resp);
+      protocol_pins_release(&pins);
+      arena_release(arena);
    }
+   event_forwarder_stop();
    LOGI0("Interface loop exiting");
    g_run = 0;
    return 0;
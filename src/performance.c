@@ -10,24 +10,127 @@
 #include <sys/statvfs.h>
 #include <cJSON.h>
 #include <math.h>
+#include <errno.h>
 
 /* Performance metric storage */
 #define MAX_METRICS 1000
 #define HISTOGRAM_BUCKETS 10
+#define METRIC_INDEX_SIZE 2048  /* Power of two, > 2 * MAX_METRICS */
+
+/* Timer distributions (see slot_hdr) and their sliding windows */
+#define PERF_HDR_SUB_BITS 4
+#define PERF_HDR_SUB_COUNT (1 << PERF_HDR_SUB_BITS)
+#define PERF_HDR_MAX_BITS 40    /* Samples clamp at 2^40 ns, about 18 minutes */
+#define PERF_HDR_MAX_VALUE ((uint64_t)1 << PERF_HDR_MAX_BITS)
+#define PERF_HDR_BUCKETS ((PERF_HDR_MAX_BITS - PERF_HDR_SUB_BITS + 2) * (PERF_HDR_SUB_COUNT / 2))
+#define PERF_HDR_STRIPES 4
+#define PERF_WINDOW_STEP_SEC 20
+#define PERF_WINDOW_SLOTS 16    /* More than 300 / PERF_WINDOW_STEP_SEC */
 
 /* Latency buckets in milliseconds */
 static const double latency_thresholds[] = {
     0.1, 0.5, 1.0, 5.0, 10.0, 50.0, 100.0, 500.0, 1000.0, 5000.0
 };
 
+/* Distribution of one timer: striped all-time counts, plus the merged counts at each
+ * recent window step so a window is the difference between now and its first step.
+ */
+typedef struct {
+    uint64_t stripes[PERF_HDR_STRIPES][PERF_HDR_BUCKETS];
+    uint32_t ring[PERF_WINDOW_SLOTS][PERF_HDR_BUCKETS];   /* Guarded by g_perf.mutex */
+} perf_hdr_t;
+
+/* Registry slot. Slots are append-only and never move, so a metric id is a stable
+ * index; all value fields are updated with relaxed atomics and no lock.
+ */
+typedef struct {
+    char name[64];
+    perf_metric_type_t type;
+    perf_category_t category;
+    uint64_t value;                     /* Counter value, or gauge stored as double bits */
+    uint64_t count;                     /* Timer/histogram sample count */
+    uint64_t sum_ns;                    /* Timer/histogram sum in nanoseconds */
+    uint64_t min_bits;                  /* Minimum latency (ms) as double bits */
+    uint64_t max_bits;                  /* Maximum latency (ms) as double bits */
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    perf_hdr_t* hdr;                    /* Timer/histogram distribution, allocated on first sample */
+    time_t last_updated;
+} perf_slot_t;
+
+/* Core metrics, registered first and in this order so their ids equal the enum values */
+enum {
+    CORE_RBUS_GET_COUNT = 0,
+    CORE_RBUS_GET_LATENCY,
+    CORE_RBUS_SET_COUNT,
+    CORE_RBUS_SET_LATENCY,
+    CORE_RBUS_SUBSCRIBE_COUNT,
+    CORE_RBUS_GET_COALESCED,
+    CORE_RBUS_GET_NEGATIVE_HITS,
+    CORE_CACHE_HITS,
+    CORE_CACHE_MISSES,
+    CORE_CACHE_EVICTIONS,
+    CORE_CACHE_MEMORY_USED,
+    CORE_WEBCONFIG_TRANSACTIONS,
+    CORE_WEBCONFIG_ROLLBACKS,
+    CORE_WEBCONFIG_LATENCY,
+    CORE_NOTIFICATION_SENT,
+    CORE_NOTIFICATION_FAILED,
+    CORE_NOTIFICATION_LATENCY,
+    CORE_PROTOCOL_REQUESTS,
+    CORE_PROTOCOL_ERRORS,
+    CORE_PROTOCOL_LATENCY,
+    CORE_SYSTEM_CPU_USAGE,
+    CORE_SYSTEM_MEMORY_USED,
+    CORE_SYSTEM_ACTIVE_CONNECTIONS,
+    CORE_METRIC_COUNT
+};
+
+static const struct {
+    const char* name;
+    perf_metric_type_t type;
+    perf_category_t category;
+} core_metrics[CORE_METRIC_COUNT] = {
+    { "rbus.get.count", PERF_METRIC_COUNTER, PERF_CAT_RBUS },
+    { "rbus.get.latency", PERF_METRIC_TIMER, PERF_CAT_RBUS },
+    { "rbus.set.count", PERF_METRIC_COUNTER, PERF_CAT_RBUS },
+    { "rbus.set.latency", PERF_METRIC_TIMER, PERF_CAT_RBUS },
+    { "rbus.subscribe.count", PERF_METRIC_COUNTER, PERF_CAT_RBUS },
+    { "rbus.get.coalesced", PERF_METRIC_COUNTER, PERF_CAT_RBUS },
+    { "rbus.get.negative_hits", PERF_METRIC_COUNTER, PERF_CAT_RBUS },
+    { "cache.hits", PERF_METRIC_COUNTER, PERF_CAT_CACHE },
+    { "cache.misses", PERF_METRIC_COUNTER, PERF_CAT_CACHE },
+    { "cache.evictions", PERF_METRIC_COUNTER, PERF_CAT_CACHE },
+    { "cache.memory_used", PERF_METRIC_GAUGE, PERF_CAT_CACHE },
+    { "webconfig.transactions", PERF_METRIC_COUNTER, PERF_CAT_WEBCONFIG },
+    { "webconfig.rollbacks", PERF_METRIC_COUNTER, PERF_CAT_WEBCONFIG },
+    { "webconfig.latency", PERF_METRIC_TIMER, PERF_CAT_WEBCONFIG },
+    { "notification.sent", PERF_METRIC_COUNTER, PERF_CAT_NOTIFICATION },
+    { "notification.failed", PERF_METRIC_COUNTER, PERF_CAT_NOTIFICATION },
+    { "notification.latency", PERF_METRIC_TIMER, PERF_CAT_NOTIFICATION },
+    { "protocol.requests", PERF_METRIC_COUNTER, PERF_CAT_PROTOCOL },
+    { "protocol.errors", PERF_METRIC_COUNTER, PERF_CAT_PROTOCOL },
+    { "protocol.latency", PERF_METRIC_TIMER, PERF_CAT_PROTOCOL },
+    { "system.cpu_usage", PERF_METRIC_GAUGE, PERF_CAT_SYSTEM },
+    { "system.memory_used", PERF_METRIC_GAUGE, PERF_CAT_SYSTEM },
+    { "system.active_connections", PERF_METRIC_GAUGE, PERF_CAT_SYSTEM }
+};
+
 /* Global performance state */
 static struct {
     perf_config_t config;
-    perf_metric_t metrics[MAX_METRICS];
-    int metric_count;
-    pthread_mutex_t mutex;
+    perf_slot_t metrics[MAX_METRICS];
+    int metric_count;                   /* Published with release; read with acquire */
+    int index[METRIC_INDEX_SIZE];       /* Open-addressed name index: slot + 1, 0 = empty */
+    pthread_mutex_t mutex;              /* Serializes registration and summary/system updates */
     perf_system_metrics_t system_metrics;
     time_t last_system_update;
+    pthread_t collector;                /* Runs while collector_running */
+    pthread_cond_t collector_cond;      /* Signalled with mutex held to stop it */
+    int collector_running;
+    int collector_stop;
+    pthread_mutex_t snapshot_mutex;     /* Guards snapshot (the pointer swap only) */
+    perf_snapshot_t* snapshot;
+    int64_t window_epoch;               /* Window step the rings were last advanced to */
     int initialized;
 } g_perf = {0};
 
@@ -48,15 +151,149 @@ static double get_current_time_ms(void) {
     return (tv.tv_sec * 1000.0) + (tv.tv_usec / 1000.0);
 }
 
-static int find_metric_index(const char* name) {
-    for (int i = 0; i < g_perf.metric_count; i++) {
-        if (strcmp(g_perf.metrics[i].name, name) == 0) {
-            return i;
-        }
+static double monotonic_elapsed_ms(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static uint64_t double_to_bits(double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+static double bits_to_double(uint64_t bits) {
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+/* Metric names are looked up as prefix + name + suffix (prefix/suffix may be NULL)
+ * so callers like "<op>.latency" never have to format the joined string */
+static uint32_t metric_hash(const char* prefix, const char* name, const char* suffix) {
+    uint32_t hash = 5381;
+    const char* parts[3] = { prefix, name, suffix };
+    for (int i = 0; i < 3; i++) {
+        const char* p = parts[i];
+        int c;
+        if (!p) continue;
+        while ((c = *p++)) hash = ((hash << 5) + hash) + c;
+    }
+    return hash;
+}
+
+static int metric_name_equals(const char* stored, const char* prefix, const char* name, const char* suffix) {
+    const char* parts[3] = { prefix, name, suffix };
+    for (int i = 0; i < 3; i++) {
+        if (!parts[i]) continue;
+        size_t len = strlen(parts[i]);
+        if (strncmp(stored, parts[i], len) != 0) return 0;
+        stored += len;
+    }
+    return *stored == '\0';
+}
+
+/* Lock-free lookup; safe against concurrent registration */
+static int find_metric_index_parts(const char* prefix, const char* name, const char* suffix) {
+    uint32_t pos = metric_hash(prefix, name, suffix) & (METRIC_INDEX_SIZE - 1);
+    for (int probe = 0; probe < METRIC_INDEX_SIZE; probe++) {
+        int entry = __atomic_load_n(&g_perf.index[pos], __ATOMIC_ACQUIRE);
+        if (entry == 0) return -1;
+        if (metric_name_equals(g_perf.metrics[entry - 1].name, prefix, name, suffix)) return entry - 1;
+        pos = (pos + 1) & (METRIC_INDEX_SIZE - 1);
     }
     return -1;
 }
 
+static int find_metric_index(const char* name) {
+    return find_metric_index_parts(NULL, name, NULL);
+}
+
+/* Add a metric to the registry; caller holds g_perf.mutex. Returns the new id or -1. */
+static int register_metric_locked(const char* prefix, const char* name, const char* suffix,
+                                  perf_metric_type_t type, perf_category_t category) {
+    int existing = find_metric_index_parts(prefix, name, suffix);
+    if (existing >= 0) return existing;
+    if (g_perf.metric_count >= MAX_METRICS || g_perf.metric_count >= g_perf.config.max_metrics) return -1;
+    
+    int id = g_perf.metric_count;
+    perf_slot_t* metric = &g_perf.metrics[id];
+    memset(metric, 0, sizeof(*metric));
+    snprintf(metric->name, sizeof(metric->name), "%s%s%s", prefix ? prefix : "", name, suffix ? suffix : "");
+    metric->type = type;
+    metric->category = category;
+    metric->last_updated = time(NULL);
+    metric->min_bits = double_to_bits(INFINITY);
+    metric->max_bits = double_to_bits(0.0);
+    
+    /* Publish the slot before making it reachable through the index */
+    __atomic_store_n(&g_perf.metric_count, id + 1, __ATOMIC_RELEASE);
+    uint32_t pos = metric_hash(prefix, name, suffix) & (METRIC_INDEX_SIZE - 1);
+    while (g_perf.index[pos] != 0) {
+        pos = (pos + 1) & (METRIC_INDEX_SIZE - 1);
+    }
+    __atomic_store_n(&g_perf.index[pos], id + 1, __ATOMIC_RELEASE);
+    return id;
+}
+
+static int metric_count_acquire(void) {
+    return __atomic_load_n(&g_perf.metric_count, __ATOMIC_ACQUIRE);
+}
+
+static void atomic_min_bits(uint64_t* target, uint64_t bits) {
+    uint64_t cur = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (bits < cur && !__atomic_compare_exchange_n(target, &cur, bits, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void atomic_max_bits(uint64_t* target, uint64_t bits) {
+    uint64_t cur = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (bits > cur && !__atomic_compare_exchange_n(target, &cur, bits, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/* Copy a slot into the public perf_metric_t representation */
+static void snapshot_metric(const perf_slot_t* slot, perf_metric_t* out) {
+    memset(out, 0, sizeof(*out));
+    memcpy(out->name, slot->name, sizeof(out->name));
+    out->type = slot->type;
+    out->category = slot->category;
+    out->last_updated = __atomic_load_n(&slot->last_updated, __ATOMIC_RELAXED);
+    
+    uint64_t count = __atomic_load_n(&slot->count, __ATOMIC_RELAXED);
+    double sum_ms = __atomic_load_n(&slot->sum_ns, __ATOMIC_RELAXED) / 1e6;
+    /* Report 0 rather than the INFINITY sentinel until a sample exists (keeps JSON valid) */
+    double min_ms = count ? bits_to_double(__atomic_load_n(&slot->min_bits, __ATOMIC_RELAXED)) : 0.0;
+    double max_ms = bits_to_double(__atomic_load_n(&slot->max_bits, __ATOMIC_RELAXED));
+    
+    switch (slot->type) {
+        case PERF_METRIC_COUNTER:
+            out->data.counter_value = __atomic_load_n(&slot->value, __ATOMIC_RELAXED);
+            break;
+        case PERF_METRIC_GAUGE:
+            out->data.gauge_value = bits_to_double(__atomic_load_n(&slot->value, __ATOMIC_RELAXED));
+            break;
+        case PERF_METRIC_HISTOGRAM:
+            for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                out->data.histogram.buckets[i].threshold_ms = latency_thresholds[i];
+                out->data.histogram.buckets[i].count = __atomic_load_n(&slot->buckets[i], __ATOMIC_RELAXED);
+            }
+            out->data.histogram.total_count = count;
+            out->data.histogram.sum_ms = sum_ms;
+            out->data.histogram.min_ms = min_ms;
+            out->data.histogram.max_ms = max_ms;
+            break;
+        case PERF_METRIC_TIMER:
+            out->data.timer.count = count;
+            out->data.timer.total_ms = sum_ms;
+            out->data.timer.avg_ms = count ? sum_ms / count : 0.0;
+            out->data.timer.min_ms = min_ms;
+            out->data.timer.max_ms = max_ms;
+            break;
+    }
+}
+
 static int get_histogram_bucket(double value_ms) {
     for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
         if (value_ms <= latency_thresholds[i]) {
@@ -66,6 +303,181 @@ static int get_histogram_bucket(double value_ms) {
     return HISTOGRAM_BUCKETS - 1;
 }
 
+/* Log-linear (HDR-style) latency distribution in nanoseconds: values below
+ * PERF_HDR_SUB_COUNT get a bucket each, every power of two above that is split into
+ * PERF_HDR_SUB_COUNT / 2 equal buckets, so a reported percentile (the bucket midpoint)
+ * is within 1/16 of the true value.
+ * Samples land in one of PERF_HDR_STRIPES per-thread stripes that are merged on read.
+ */
+static perf_hdr_t* slot_hdr(perf_slot_t* slot) {
+    perf_hdr_t* hdr = __atomic_load_n(&slot->hdr, __ATOMIC_ACQUIRE);
+    if (hdr) return hdr;
+    
+    /* First sample: losers of the publish race free their copy */
+    perf_hdr_t* fresh = calloc(1, sizeof(perf_hdr_t));
+    if (!fresh) return NULL;
+    if (__atomic_compare_exchange_n(&slot->hdr, &hdr, fresh, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return fresh;
+    free(fresh);
+    return hdr;
+}
+
+static int hdr_index(uint64_t ns) {
+    if (ns >= PERF_HDR_MAX_VALUE) ns = PERF_HDR_MAX_VALUE - 1;
+    if (ns < PERF_HDR_SUB_COUNT) return (int)ns;
+    int shift = 63 - __builtin_clzll(ns) - PERF_HDR_SUB_BITS + 1;
+    return shift * (PERF_HDR_SUB_COUNT / 2) + (int)(ns >> shift);
+}
+
+/* Lowest value of a bucket; *width receives its size */
+static uint64_t hdr_bucket_low(int index, uint64_t* width) {
+    if (index < PERF_HDR_SUB_COUNT) {
+        *width = 1;
+        return (uint64_t)index;
+    }
+    int shift = index / (PERF_HDR_SUB_COUNT / 2) - 1;
+    *width = (uint64_t)1 << shift;
+    return (uint64_t)(index - shift * (PERF_HDR_SUB_COUNT / 2)) << shift;
+}
+
+static int hdr_stripe(void) {
+    static int next_stripe = 0;
+    static __thread int stripe = -1;
+    if (stripe < 0) stripe = __atomic_fetch_add(&next_stripe, 1, __ATOMIC_RELAXED) % PERF_HDR_STRIPES;
+    return stripe;
+}
+
+static void hdr_record(perf_slot_t* slot, double latency_ms) {
+    perf_hdr_t* hdr = slot_hdr(slot);
+    if (!hdr) return;
+    uint64_t ns = (uint64_t)(latency_ms * 1e6 + 0.5);
+    __atomic_fetch_add(&hdr->stripes[hdr_stripe()][hdr_index(ns)], 1, __ATOMIC_RELAXED);
+}
+
+/* All-time counts of a distribution; returns the sample total */
+static uint64_t hdr_merge(const perf_hdr_t* hdr, uint64_t* counts) {
+    uint64_t total = 0;
+    for (int b = 0; b < PERF_HDR_BUCKETS; b++) {
+        uint64_t n = 0;
+        for (int s = 0; s < PERF_HDR_STRIPES; s++) n += __atomic_load_n(&hdr->stripes[s][b], __ATOMIC_RELAXED);
+        counts[b] = n;
+        total += n;
+    }
+    return total;
+}
+
+/* Advance the window ring to the current step, filling any skipped steps with the
+ * totals as they are now (nothing recorded then). Caller holds g_perf.mutex.
+ */
+static void windows_advance_locked(int64_t epoch) {
+    int64_t last = __atomic_load_n(&g_perf.window_epoch, __ATOMIC_RELAXED);
+    if (epoch <= last) return;
+    int64_t from = epoch - last > PERF_WINDOW_SLOTS ? epoch - PERF_WINDOW_SLOTS + 1 : last + 1;
+    
+    uint64_t counts[PERF_HDR_BUCKETS];
+    int count = metric_count_acquire();
+    for (int i = 0; i < count; i++) {
+        perf_hdr_t* hdr = __atomic_load_n(&g_perf.metrics[i].hdr, __ATOMIC_ACQUIRE);
+        if (!hdr) continue;
+        hdr_merge(hdr, counts);
+        for (int64_t e = from; e <= epoch; e++) {
+            uint32_t* ring = hdr->ring[e % PERF_WINDOW_SLOTS];
+            /* Low 32 bits suffice: window deltas are taken modulo 2^32 */
+            for (int b = 0; b < PERF_HDR_BUCKETS; b++) ring[b] = (uint32_t)counts[b];
+        }
+    }
+    __atomic_store_n(&g_perf.window_epoch, epoch, __ATOMIC_RELEASE);
+}
+
+static int64_t current_window_epoch(time_t now) {
+    return (int64_t)now / PERF_WINDOW_STEP_SEC;
+}
+
+/* Recording path: rotate only if nobody else is holding the registry lock */
+static void windows_maybe_advance(time_t now) {
+    int64_t epoch = current_window_epoch(now);
+    if (epoch <= __atomic_load_n(&g_perf.window_epoch, __ATOMIC_ACQUIRE)) return;
+    if (pthread_mutex_trylock(&g_perf.mutex) != 0) return;
+    windows_advance_locked(epoch);
+    pthread_mutex_unlock(&g_perf.mutex);
+}
+
+/* Counts for a window into counts; returns the sample total. Caller holds g_perf.mutex. */
+static uint64_t hdr_window_locked(const perf_hdr_t* hdr, perf_window_t window, uint64_t* counts) {
+    uint64_t total = hdr_merge(hdr, counts);
+    if (window == PERF_WINDOW_ALL) return total;
+    
+    /* The window starts at the oldest step boundary still inside it */
+    int steps = (window == PERF_WINDOW_1M ? 60 : 300) / PERF_WINDOW_STEP_SEC;
+    int64_t base_epoch = __atomic_load_n(&g_perf.window_epoch, __ATOMIC_RELAXED) - steps + 1;
+    const uint32_t* base = hdr->ring[base_epoch % PERF_WINDOW_SLOTS];
+    total = 0;
+    for (int b = 0; b < PERF_HDR_BUCKETS; b++) {
+        counts[b] = (uint32_t)((uint32_t)counts[b] - base[b]);
+        total += counts[b];
+    }
+    return total;
+}
+
+/* Value at a percentile as the midpoint of its bucket, in milliseconds */
+static double hdr_value_at(const uint64_t* counts, uint64_t total, double percentile) {
+    if (total == 0) return 0.0;
+    if (percentile < 0.0) percentile = 0.0;
+    if (percentile > 100.0) percentile = 100.0;
+    
+    uint64_t rank = (uint64_t)ceil(percentile / 100.0 * total);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    int b = 0;
+    for (; b < PERF_HDR_BUCKETS - 1; b++) {
+        seen += counts[b];
+        if (seen >= rank) break;
+    }
+    uint64_t width;
+    uint64_t low = hdr_bucket_low(b, &width);
+    return (low + width / 2.0) / 1e6;
+}
+
+/* Percentiles of one metric's window; -1 if it is not a timer or histogram.
+ * Caller holds g_perf.mutex.
+ */
+static int slot_percentiles_locked(perf_slot_t* slot, perf_window_t window, perf_percentiles_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (slot->type != PERF_METRIC_TIMER && slot->type != PERF_METRIC_HISTOGRAM) return -1;
+    perf_hdr_t* hdr = __atomic_load_n(&slot->hdr, __ATOMIC_ACQUIRE);
+    if (!hdr) return 0;
+    
+    uint64_t counts[PERF_HDR_BUCKETS];
+    windows_advance_locked(current_window_epoch(time(NULL)));
+    out->count = hdr_window_locked(hdr, window, counts);
+    
+    out->p50_ms = hdr_value_at(counts, out->count, 50.0);
+    out->p90_ms = hdr_value_at(counts, out->count, 90.0);
+    out->p99_ms = hdr_value_at(counts, out->count, 99.0);
+    out->p999_ms = hdr_value_at(counts, out->count, 99.9);
+    if (window == PERF_WINDOW_ALL && out->count) {
+        /* Exact extremes beat bucket midpoints at the ends of the distribution */
+        double lo = bits_to_double(__atomic_load_n(&slot->min_bits, __ATOMIC_RELAXED));
+        double hi = bits_to_double(__atomic_load_n(&slot->max_bits, __ATOMIC_RELAXED));
+        double* p[4] = { &out->p50_ms, &out->p90_ms, &out->p99_ms, &out->p999_ms };
+        for (int i = 0; i < 4; i++) {
+            if (*p[i] < lo) *p[i] = lo;
+            if (*p[i] > hi) *p[i] = hi;
+        }
+    }
+    return 0;
+}
+
+static int slot_percentiles(perf_slot_t* slot, perf_window_t window, perf_percentiles_t* out) {
+    pthread_mutex_lock(&g_perf.mutex);
+    int rc = slot_percentiles_locked(slot, window, out);
+    pthread_mutex_unlock(&g_perf.mutex);
+    return rc;
+}
+
+static const char* const window_names[PERF_WINDOW_COUNT] = { "all", "1m", "5m" };
+
+static void* perf_collector_thread(void* arg);
+
 /* Core API Implementation */
 int perf_init(const perf_config_t* config) {
     if (g_perf.initialized) {
@@ -86,41 +498,37 @@ int perf_init(const perf_config_t* config) {
     g_perf.config.history_retention_sec = config ? config->history_retention_sec : 3600;
     g_perf.config.enable_system_metrics = config ? config->enable_system_metrics : 1;
     g_perf.config.enable_detailed_timers = config ? config->enable_detailed_timers : 1;
-    g_perf.config.max_metrics = config ? config->max_metrics : MAX_METRICS;
+    g_perf.config.max_metrics = config && config->max_metrics > 0 ? config->max_metrics : MAX_METRICS;
     g_perf.config.export_file = config && config->export_file ? 
                                strdup(config->export_file) : 
                                strdup("/tmp/parodus2rbus_metrics.json");
     
-    /* Register core metrics */
-    perf_register_metric("rbus.get.count", PERF_METRIC_COUNTER, PERF_CAT_RBUS);
-    perf_register_metric("rbus.get.latency", PERF_METRIC_TIMER, PERF_CAT_RBUS);
-    perf_register_metric("rbus.set.count", PERF_METRIC_COUNTER, PERF_CAT_RBUS);
-    perf_register_metric("rbus.set.latency", PERF_METRIC_TIMER, PERF_CAT_RBUS);
-    perf_register_metric("rbus.subscribe.count", PERF_METRIC_COUNTER, PERF_CAT_RBUS);
-    
-    perf_register_metric("cache.hits", PERF_METRIC_COUNTER, PERF_CAT_CACHE);
-    perf_register_metric("cache.misses", PERF_METRIC_COUNTER, PERF_CAT_CACHE);
-    perf_register_metric("cache.evictions", PERF_METRIC_COUNTER, PERF_CAT_CACHE);
-    perf_register_metric("cache.memory_used", PERF_METRIC_GAUGE, PERF_CAT_CACHE);
-    
-    perf_register_metric("webconfig.transactions", PERF_METRIC_COUNTER, PERF_CAT_WEBCONFIG);
-    perf_register_metric("webconfig.rollbacks", PERF_METRIC_COUNTER, PERF_CAT_WEBCONFIG);
-    perf_register_metric("webconfig.latency", PERF_METRIC_TIMER, PERF_CAT_WEBCONFIG);
-    
-    perf_register_metric("notification.sent", PERF_METRIC_COUNTER, PERF_CAT_NOTIFICATION);
-    perf_register_metric("notification.failed", PERF_METRIC_COUNTER, PERF_CAT_NOTIFICATION);
-    perf_register_metric("notification.latency", PERF_METRIC_TIMER, PERF_CAT_NOTIFICATION);
-    
-    perf_register_metric("protocol.requests", PERF_METRIC_COUNTER, PERF_CAT_PROTOCOL);
-    perf_register_metric("protocol.errors", PERF_METRIC_COUNTER, PERF_CAT_PROTOCOL);
-    perf_register_metric("protocol.latency", PERF_METRIC_TIMER, PERF_CAT_PROTOCOL);
-    
-    perf_register_metric("system.cpu_usage", PERF_METRIC_GAUGE, PERF_CAT_SYSTEM);
-    perf_register_metric("system.memory_used", PERF_METRIC_GAUGE, PERF_CAT_SYSTEM);
-    perf_register_metric("system.active_connections", PERF_METRIC_GAUGE, PERF_CAT_SYSTEM);
+    /* Register core metrics; the registry is usable before initialized is set,
+     * so these land at ids matching the CORE_* enum */
+    for (int i = 0; i < CORE_METRIC_COUNT; i++) {
+        if (register_metric_locked(NULL, core_metrics[i].name, NULL, core_metrics[i].type, core_metrics[i].category) != i) {
+            LOGE("Failed to register core metric: %s", core_metrics[i].name);
+        }
+    }
     
+    g_perf.window_epoch = current_window_epoch(time(NULL));
+    pthread_mutex_init(&g_perf.snapshot_mutex, NULL);
     g_perf.initialized = 1;
     
+    if (g_perf.config.enable_collection && g_perf.config.collection_interval_sec > 0) {
+        pthread_condattr_t cond_attr;
+        pthread_condattr_init(&cond_attr);
+        pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&g_perf.collector_cond, &cond_attr);
+        pthread_condattr_destroy(&cond_attr);
+        if (pthread_create(&g_perf.collector, NULL, perf_collector_thread, NULL) == 0) {
+            g_perf.collector_running = 1;
+        } else {
+            LOGW("Failed to start metrics collector: %s", "exports render on demand");
+            pthread_cond_destroy(&g_perf.collector_cond);
+        }
+    }
+    
     LOGI("Performance monitoring initialized: collection=%d, interval=%d, system_metrics=%d", 
          g_perf.config.enable_collection,
          g_perf.config.collection_interval_sec,
@@ -132,9 +540,23 @@ int perf_init(const perf_config_t* config) {
 void perf_cleanup(void) {
     if (!g_perf.initialized) return;
     
+    if (g_perf.collector_running) {
+        pthread_mutex_lock(&g_perf.mutex);
+        g_perf.collector_stop = 1;
+        pthread_cond_signal(&g_perf.collector_cond);
+        pthread_mutex_unlock(&g_perf.mutex);
+        pthread_join(g_perf.collector, NULL);
+        pthread_cond_destroy(&g_perf.collector_cond);
+    }
+    perf_release_snapshot(g_perf.snapshot);
+    pthread_mutex_destroy(&g_perf.snapshot_mutex);
+    
     pthread_mutex_lock(&g_perf.mutex);
     
     free(g_perf.config.export_file);
+    for (int i = 0; i < g_perf.metric_count; i++) {
+        free(g_perf.metrics[i].hdr);
+    }
     memset(&g_perf, 0, sizeof(g_perf));
     
     pthread_mutex_unlock(&g_perf.mutex);
@@ -143,125 +565,105 @@ void perf_cleanup(void) {
     LOGI("Performance monitoring cleaned up: %s", "shutdown complete");
 }
 
-int perf_register_metric(const char* name, perf_metric_type_t type, perf_category_t category) {
-    if (!g_perf.initialized || !name || g_perf.metric_count >= MAX_METRICS) return -1;
+/* Resolve a metric id, registering it on first use; only registration takes the mutex */
+static perf_metric_id_t metric_id_parts(const char* prefix, const char* name, const char* suffix,
+                                        perf_metric_type_t type, perf_category_t category) {
+    int id = find_metric_index_parts(prefix, name, suffix);
+    if (id >= 0) return id;
     
     pthread_mutex_lock(&g_perf.mutex);
-    
-    /* Check if metric already exists */
-    if (find_metric_index(name) >= 0) {
-        pthread_mutex_unlock(&g_perf.mutex);
-        return 0; /* Already registered */
-    }
-    
-    perf_metric_t* metric = &g_perf.metrics[g_perf.metric_count];
-    strncpy(metric->name, name, sizeof(metric->name) - 1);
-    metric->type = type;
-    metric->category = category;
-    metric->last_updated = time(NULL);
-    
-    /* Initialize type-specific data */
-    switch (type) {
-        case PERF_METRIC_COUNTER:
-            metric->data.counter_value = 0;
-            break;
-        case PERF_METRIC_GAUGE:
-            metric->data.gauge_value = 0.0;
-            break;
-        case PERF_METRIC_HISTOGRAM:
-            memset(&metric->data.histogram, 0, sizeof(metric->data.histogram));
-            metric->data.histogram.min_ms = INFINITY;
-            metric->data.histogram.max_ms = 0.0;
-            break;
-        case PERF_METRIC_TIMER:
-            memset(&metric->data.timer, 0, sizeof(metric->data.timer));
-            metric->data.timer.min_ms = INFINITY;
-            metric->data.timer.max_ms = 0.0;
-            break;
-    }
-    
-    g_perf.metric_count++;
+    id = register_metric_locked(prefix, name, suffix, type, category);
     pthread_mutex_unlock(&g_perf.mutex);
     
-    return 0;
+    return id >= 0 ? id : PERF_INVALID_METRIC;
+}
+
+perf_metric_id_t perf_metric_id(const char* name, perf_metric_type_t type, perf_category_t category) {
+    if (!g_perf.initialized || !name) return PERF_INVALID_METRIC;
+    return metric_id_parts(NULL, name, NULL, type, category);
+}
+
+perf_metric_id_t perf_find_metric_id(const char* name) {
+    if (!g_perf.initialized || !name) return PERF_INVALID_METRIC;
+    int id = find_metric_index(name);
+    return id >= 0 ? id : PERF_INVALID_METRIC;
+}
+
+static int valid_metric_id(perf_metric_id_t id) {
+    return g_perf.initialized && g_perf.config.enable_collection && id >= 0 && id < metric_count_acquire();
+}
+
+void perf_counter_add_id(perf_metric_id_t id, uint64_t increment) {
+    if (!valid_metric_id(id)) return;
+    perf_slot_t* metric = &g_perf.metrics[id];
+    if (metric->type != PERF_METRIC_COUNTER) return;
+    __atomic_fetch_add(&metric->value, increment, __ATOMIC_RELAXED);
+    __atomic_store_n(&metric->last_updated, time(NULL), __ATOMIC_RELAXED);
+}
+
+void perf_gauge_set_id(perf_metric_id_t id, double value) {
+    if (!valid_metric_id(id)) return;
+    perf_slot_t* metric = &g_perf.metrics[id];
+    if (metric->type != PERF_METRIC_GAUGE) return;
+    __atomic_store_n(&metric->value, double_to_bits(value), __ATOMIC_RELAXED);
+    __atomic_store_n(&metric->last_updated, time(NULL), __ATOMIC_RELAXED);
+}
+
+void perf_latency_record_id(perf_metric_id_t id, double latency_ms) {
+    if (!valid_metric_id(id)) return;
+    perf_slot_t* metric = &g_perf.metrics[id];
+    if (metric->type != PERF_METRIC_TIMER && metric->type != PERF_METRIC_HISTOGRAM) return;
+    
+    /* Clock steps can yield negative samples; clamp so the bit-pattern min/max stays ordered */
+    if (!(latency_ms >= 0.0)) latency_ms = 0.0;
+    
+    __atomic_fetch_add(&metric->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&metric->sum_ns, (uint64_t)(latency_ms * 1e6 + 0.5), __ATOMIC_RELAXED);
+    uint64_t bits = double_to_bits(latency_ms);
+    atomic_min_bits(&metric->min_bits, bits);
+    atomic_max_bits(&metric->max_bits, bits);
+    if (metric->type == PERF_METRIC_HISTOGRAM) {
+        __atomic_fetch_add(&metric->buckets[get_histogram_bucket(latency_ms)], 1, __ATOMIC_RELAXED);
+    }
+    /* Close the previous window step before this sample lands in the new one */
+    time_t now = time(NULL);
+    windows_maybe_advance(now);
+    hdr_record(metric, latency_ms);
+    __atomic_store_n(&metric->last_updated, now, __ATOMIC_RELAXED);
+}
+
+/* Name-based API: thin wrappers over the id API */
+int perf_register_metric(const char* name, perf_metric_type_t type, perf_category_t category) {
+    return perf_metric_id(name, type, category) != PERF_INVALID_METRIC ? 0 : -1;
 }
 
 int perf_update_counter(const char* name, uint64_t increment) {
     if (!g_perf.initialized || !name || !g_perf.config.enable_collection) return -1;
     
-    pthread_mutex_lock(&g_perf.mutex);
-    
     int index = find_metric_index(name);
-    if (index < 0 || g_perf.metrics[index].type != PERF_METRIC_COUNTER) {
-        pthread_mutex_unlock(&g_perf.mutex);
-        return -1;
-    }
+    if (index < 0 || g_perf.metrics[index].type != PERF_METRIC_COUNTER) return -1;
     
-    g_perf.metrics[index].data.counter_value += increment;
-    g_perf.metrics[index].last_updated = time(NULL);
-    
-    pthread_mutex_unlock(&g_perf.mutex);
+    perf_counter_add_id(index, increment);
     return 0;
 }
 
 int perf_update_gauge(const char* name, double value) {
     if (!g_perf.initialized || !name || !g_perf.config.enable_collection) return -1;
     
-    pthread_mutex_lock(&g_perf.mutex);
-    
     int index = find_metric_index(name);
-    if (index < 0 || g_perf.metrics[index].type != PERF_METRIC_GAUGE) {
-        pthread_mutex_unlock(&g_perf.mutex);
-        return -1;
-    }
-    
-    g_perf.metrics[index].data.gauge_value = value;
-    g_perf.metrics[index].last_updated = time(NULL);
+    if (index < 0 || g_perf.metrics[index].type != PERF_METRIC_GAUGE) return -1;
     
-    pthread_mutex_unlock(&g_perf.mutex);
+    perf_gauge_set_id(index, value);
     return 0;
 }
 
 int perf_record_latency(const char* name, double latency_ms) {
     if (!g_perf.initialized || !name || !g_perf.config.enable_collection) return -1;
     
-    pthread_mutex_lock(&g_perf.mutex);
-    
     int index = find_metric_index(name);
-    if (index < 0) {
-        pthread_mutex_unlock(&g_perf.mutex);
-        return -1;
-    }
+    if (index < 0) return -1;
     
-    perf_metric_t* metric = &g_perf.metrics[index];
-    metric->last_updated = time(NULL);
-    
-    if (metric->type == PERF_METRIC_TIMER) {
-        metric->data.timer.count++;
-        metric->data.timer.total_ms += latency_ms;
-        metric->data.timer.avg_ms = metric->data.timer.total_ms / metric->data.timer.count;
-        
-        if (latency_ms < metric->data.timer.min_ms) {
-            metric->data.timer.min_ms = latency_ms;
-        }
-        if (latency_ms > metric->data.timer.max_ms) {
-            metric->data.timer.max_ms = latency_ms;
-        }
-    } else if (metric->type == PERF_METRIC_HISTOGRAM) {
-        int bucket = get_histogram_bucket(latency_ms);
-        metric->data.histogram.buckets[bucket].count++;
-        metric->data.histogram.total_count++;
-        metric->data.histogram.sum_ms += latency_ms;
-        
-        if (latency_ms < metric->data.histogram.min_ms) {
-            metric->data.histogram.min_ms = latency_ms;
-        }
-        if (latency_ms > metric->data.histogram.max_ms) {
-            metric->data.histogram.max_ms = latency_ms;
-        }
-    }
-    
-    pthread_mutex_unlock(&g_perf.mutex);
+    perf_latency_record_id(index, latency_ms);
     return 0;
 }
 
@@ -273,8 +675,13 @@ perf_timer_t* perf_timer_start(const char* operation, perf_category_t category)
     if (!timer) return NULL;
     
     strncpy(timer->operation, operation, sizeof(timer->operation) - 1);
+    timer->operation[sizeof(timer->operation) - 1] = '\0';
     timer->category = category;
-    gettimeofday(&timer->start_time, NULL);
+    
+    /* Resolve "<operation>.latency" once, registering it on first use */
+    timer->metric_id = metric_id_parts(NULL, operation, ".latency", PERF_METRIC_TIMER, category);
+    
+    clock_gettime(CLOCK_MONOTONIC, &timer->start_time);
     timer->active = 1;
     
     return timer;
@@ -287,9 +694,7 @@ int perf_timer_stop(perf_timer_t* timer) {
     timer->active = 0;
     
     /* Record the latency */
-    char metric_name[128];
-    snprintf(metric_name, sizeof(metric_name), "%s.latency", timer->operation);
-    perf_record_latency(metric_name, elapsed);
+    perf_latency_record_id(timer->metric_id, elapsed);
     
     free(timer);
     return 0;
@@ -297,12 +702,31 @@ int perf_timer_stop(perf_timer_t* timer) {
 
 double perf_timer_elapsed_ms(const perf_timer_t* timer) {
     if (!timer) return 0.0;
+    return monotonic_elapsed_ms(&timer->start_time);
+}
+
+void perf_scope_begin(perf_scope_t* scope, const char* operation, perf_category_t category) {
+    if (!scope) return;
+    scope->active = 0;
+    scope->metric_id = PERF_INVALID_METRIC;
+    if (!g_perf.initialized || !operation) return;
     
-    struct timeval now;
-    gettimeofday(&now, NULL);
+    scope->metric_id = metric_id_parts(NULL, operation, ".latency", PERF_METRIC_TIMER, category);
+    clock_gettime(CLOCK_MONOTONIC, &scope->start);
+    scope->active = 1;
+}
+
+double perf_scope_elapsed_ms(const perf_scope_t* scope) {
+    if (!scope || !scope->active) return 0.0;
+    return monotonic_elapsed_ms(&scope->start);
+}
+
+double perf_scope_end(perf_scope_t* scope) {
+    if (!scope || !scope->active) return 0.0;
     
-    double elapsed = (now.tv_sec - timer->start_time.tv_sec) * 1000.0 + 
-                    (now.tv_usec - timer->start_time.tv_usec) / 1000.0;
+    double elapsed = monotonic_elapsed_ms(&scope->start);
+    scope->active = 0;
+    perf_latency_record_id(scope->metric_id, elapsed);
     return elapsed;
 }
 
@@ -354,6 +778,7 @@ int perf_collect_system_metrics(perf_system_metrics_t* metrics) {
     return 0;
 }
 
+
 /* Performance summary */
 perf_summary_t* perf_get_summary(void) {
     if (!g_perf.initialized) return NULL;
@@ -363,58 +788,49 @@ perf_summary_t* perf_get_summary(void) {
     
     pthread_mutex_lock(&g_perf.mutex);
     
-    /* Update system metrics if enabled */
+    /* Update system metrics if enabled; the collector keeps them fresh when it runs */
     if (g_perf.config.enable_system_metrics) {
         time_t now = time(NULL);
-        if (now - g_perf.last_system_update > g_perf.config.collection_interval_sec) {
+        if (!g_perf.collector_running && now - g_perf.last_system_update > g_perf.config.collection_interval_sec) {
             perf_collect_system_metrics(&g_perf.system_metrics);
             g_perf.last_system_update = now;
         }
         summary.system = g_perf.system_metrics;
     }
     
-    /* Collect metrics */
-    for (int i = 0; i < g_perf.metric_count; i++) {
-        perf_metric_t* metric = &g_perf.metrics[i];
-        
-        if (strcmp(metric->name, "rbus.get.count") == 0) {
-            summary.rbus_get_count = metric->data.counter_value;
-        } else if (strcmp(metric->name, "rbus.set.count") == 0) {
-            summary.rbus_set_count = metric->data.counter_value;
-        } else if (strcmp(metric->name, "rbus.subscribe.count") == 0) {
-            summary.rbus_subscribe_count = metric->data.counter_value;
-        } else if (strcmp(metric->name, "rbus.get.latency") == 0) {
-            summary.avg_rbus_get_latency_ms = metric->data.timer.avg_ms;
-        } else if (strcmp(metric->name, "rbus.set.latency") == 0) {
-            summary.avg_rbus_set_latency_ms = metric->data.timer.avg_ms;
-        } else if (strcmp(metric->name, "cache.hits") == 0) {
-            summary.cache_hits = metric->data.counter_value;
-        } else if (strcmp(metric->name, "cache.misses") == 0) {
-            summary.cache_misses = metric->data.counter_value;
-        } else if (strcmp(metric->name, "cache.evictions") == 0) {
-            summary.cache_evictions = metric->data.counter_value;
-        } else if (strcmp(metric->name, "cache.memory_used") == 0) {
-            summary.cache_memory_used = (uint64_t)metric->data.gauge_value;
-        } else if (strcmp(metric->name, "webconfig.transactions") == 0) {
-            summary.webconfig_transactions = metric->data.counter_value;
-        } else if (strcmp(metric->name, "webconfig.rollbacks") == 0) {
-            summary.webconfig_rollbacks = metric->data.counter_value;
-        } else if (strcmp(metric->name, "webconfig.latency") == 0) {
-            summary.avg_transaction_latency_ms = metric->data.timer.avg_ms;
-        } else if (strcmp(metric->name, "notification.sent") == 0) {
-            summary.notifications_sent = metric->data.counter_value;
-        } else if (strcmp(metric->name, "notification.failed") == 0) {
-            summary.notification_failures = metric->data.counter_value;
-        } else if (strcmp(metric->name, "notification.latency") == 0) {
-            summary.avg_notification_latency_ms = metric->data.timer.avg_ms;
-        } else if (strcmp(metric->name, "protocol.requests") == 0) {
-            summary.requests_processed = metric->data.counter_value;
-        } else if (strcmp(metric->name, "protocol.errors") == 0) {
-            summary.request_errors = metric->data.counter_value;
-        } else if (strcmp(metric->name, "protocol.latency") == 0) {
-            summary.avg_request_latency_ms = metric->data.timer.avg_ms;
-        }
-    }
+    /* Collect core metrics by id */
+    perf_metric_t m;
+#define CORE_COUNTER(id) (snapshot_metric(&g_perf.metrics[id], &m), m.data.counter_value)
+#define CORE_GAUGE(id) (snapshot_metric(&g_perf.metrics[id], &m), m.data.gauge_value)
+#define CORE_AVG_MS(id) (snapshot_metric(&g_perf.metrics[id], &m), m.data.timer.avg_ms)
+    summary.rbus_get_count = CORE_COUNTER(CORE_RBUS_GET_COUNT);
+    summary.rbus_set_count = CORE_COUNTER(CORE_RBUS_SET_COUNT);
+    summary.rbus_subscribe_count = CORE_COUNTER(CORE_RBUS_SUBSCRIBE_COUNT);
+    summary.rbus_get_coalesced = CORE_COUNTER(CORE_RBUS_GET_COALESCED);
+    summary.rbus_get_negative_hits = CORE_COUNTER(CORE_RBUS_GET_NEGATIVE_HITS);
+    summary.avg_rbus_get_latency_ms = CORE_AVG_MS(CORE_RBUS_GET_LATENCY);
+    summary.avg_rbus_set_latency_ms = CORE_AVG_MS(CORE_RBUS_SET_LATENCY);
+    perf_percentiles_t pct;
+    slot_percentiles_locked(&g_perf.metrics[CORE_RBUS_GET_LATENCY], PERF_WINDOW_5M, &pct);
+    summary.p99_rbus_get_latency_ms = pct.p99_ms;
+    slot_percentiles_locked(&g_perf.metrics[CORE_RBUS_SET_LATENCY], PERF_WINDOW_5M, &pct);
+    summary.p99_rbus_set_latency_ms = pct.p99_ms;
+    summary.cache_hits = CORE_COUNTER(CORE_CACHE_HITS);
+    summary.cache_misses = CORE_COUNTER(CORE_CACHE_MISSES);
+    summary.cache_evictions = CORE_COUNTER(CORE_CACHE_EVICTIONS);
+    summary.cache_memory_used = (uint64_t)CORE_GAUGE(CORE_CACHE_MEMORY_USED);
+    summary.webconfig_transactions = CORE_COUNTER(CORE_WEBCONFIG_TRANSACTIONS);
+    summary.webconfig_rollbacks = CORE_COUNTER(CORE_WEBCONFIG_ROLLBACKS);
+    summary.avg_transaction_latency_ms = CORE_AVG_MS(CORE_WEBCONFIG_LATENCY);
+    summary.notifications_sent = CORE_COUNTER(CORE_NOTIFICATION_SENT);
+    summary.notification_failures = CORE_COUNTER(CORE_NOTIFICATION_FAILED);
+    summary.avg_notification_latency_ms = CORE_AVG_MS(CORE_NOTIFICATION_LATENCY);
+    summary.requests_processed = CORE_COUNTER(CORE_PROTOCOL_REQUESTS);
+    summary.request_errors = CORE_COUNTER(CORE_PROTOCOL_ERRORS);
+    summary.avg_request_latency_ms = CORE_AVG_MS(CORE_PROTOCOL_LATENCY);
+#undef CORE_COUNTER
+#undef CORE_GAUGE
+#undef CORE_AVG_MS
     
     /* Calculate cache hit rate */
     if (summary.cache_hits + summary.cache_misses > 0) {
@@ -432,13 +848,14 @@ perf_summary_t* perf_get_summary(void) {
 char* perf_export_json(void) {
     if (!g_perf.initialized) return NULL;
     
-    pthread_mutex_lock(&g_perf.mutex);
-    
     cJSON* root = cJSON_CreateObject();
     cJSON* metrics_array = cJSON_CreateArray();
     
-    for (int i = 0; i < g_perf.metric_count; i++) {
-        perf_metric_t* metric = &g_perf.metrics[i];
+    int count = metric_count_acquire();
+    for (int i = 0; i < count; i++) {
+        perf_metric_t snapshot;
+        perf_metric_t* metric = &snapshot;
+        snapshot_metric(&g_perf.metrics[i], metric);
         
         cJSON* metric_obj = cJSON_CreateObject();
         cJSON_AddStringToObject(metric_obj, "name", metric->name);
@@ -468,6 +885,22 @@ char* perf_export_json(void) {
                 break;
         }
         
+        if (metric->type == PERF_METRIC_TIMER || metric->type == PERF_METRIC_HISTOGRAM) {
+            cJSON* pct_obj = cJSON_CreateObject();
+            for (int w = 0; w < PERF_WINDOW_COUNT; w++) {
+                perf_percentiles_t pct;
+                slot_percentiles(&g_perf.metrics[i], (perf_window_t)w, &pct);
+                cJSON* win = cJSON_CreateObject();
+                cJSON_AddNumberToObject(win, "count", pct.count);
+                cJSON_AddNumberToObject(win, "p50_ms", pct.p50_ms);
+                cJSON_AddNumberToObject(win, "p90_ms", pct.p90_ms);
+                cJSON_AddNumberToObject(win, "p99_ms", pct.p99_ms);
+                cJSON_AddNumberToObject(win, "p999_ms", pct.p999_ms);
+                cJSON_AddItemToObject(pct_obj, window_names[w], win);
+            }
+            cJSON_AddItemToObject(metric_obj, "percentiles", pct_obj);
+        }
+        
         cJSON_AddItemToArray(metrics_array, metric_obj);
     }
     
@@ -477,69 +910,319 @@ char* perf_export_json(void) {
     char* json_str = cJSON_Print(root);
     cJSON_Delete(root);
     
-    pthread_mutex_unlock(&g_perf.mutex);
-    
     return json_str;
 }
 
+/* Prometheus text exposition. Metric names get a parodus2rbus_ prefix with every
+ * character outside [a-zA-Z0-9_] replaced by '_'; timers and histograms become
+ * millisecond summaries, with the sliding windows in a separate _recent gauge family.
+ */
+static void prometheus_name(char* out, size_t size, const char* name) {
+    snprintf(out, size, "parodus2rbus_%s", name);
+    for (char* c = out + sizeof("parodus2rbus_") - 1; *c; c++) {
+        if (!((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9'))) *c = '_';
+    }
+}
+
+static double quantile_ms(const perf_percentiles_t* pct, int q) {
+    switch (q) {
+        case 0: return pct->p50_ms;
+        case 1: return pct->p90_ms;
+        case 2: return pct->p99_ms;
+        default: return pct->p999_ms;
+    }
+}
+
+char* perf_export_prometheus(void) {
+    if (!g_perf.initialized) return NULL;
+    
+    char* text = NULL;
+    size_t text_len = 0;
+    FILE* out = open_memstream(&text, &text_len);
+    if (!out) return NULL;
+    
+    static const char* const quantiles[4] = { "0.5", "0.9", "0.99", "0.999" };
+    int count = metric_count_acquire();
+    for (int i = 0; i < count; i++) {
+        perf_metric_t metric;
+        snapshot_metric(&g_perf.metrics[i], &metric);
+        char name[96];
+        prometheus_name(name, sizeof(name), metric.name);
+        
+        switch (metric.type) {
+            case PERF_METRIC_COUNTER:
+                fprintf(out, "# TYPE %s_total counter\n%s_total %llu\n", name, name,
+                        (unsigned long long)metric.data.counter_value);
+                break;
+            case PERF_METRIC_GAUGE:
+                fprintf(out, "# TYPE %s gauge\n%s %.17g\n", name, name, metric.data.gauge_value);
+                break;
+            case PERF_METRIC_TIMER:
+            case PERF_METRIC_HISTOGRAM: {
+                uint64_t samples = metric.type == PERF_METRIC_TIMER ? metric.data.timer.count : metric.data.histogram.total_count;
+                double sum_ms = metric.type == PERF_METRIC_TIMER ? metric.data.timer.total_ms : metric.data.histogram.sum_ms;
+                perf_percentiles_t pct[PERF_WINDOW_COUNT];
+                for (int w = 0; w < PERF_WINDOW_COUNT; w++) {
+                    slot_percentiles(&g_perf.metrics[i], (perf_window_t)w, &pct[w]);
+                }
+        
+                fprintf(out, "# TYPE %s_ms summary\n", name);
+                for (int q = 0; q < 4; q++) {
+                    fprintf(out, "%s_ms{quantile=\"%s\"} %.6g\n", name, quantiles[q], quantile_ms(&pct[0], q));
+                }
+                fprintf(out, "%s_ms_sum %.6f\n%s_ms_count %llu\n", name, sum_ms, name, (unsigned long long)samples);
+        
+                fprintf(out, "# TYPE %s_ms_recent gauge\n", name);
+                for (int w = PERF_WINDOW_1M; w < PERF_WINDOW_COUNT; w++) {
+                    for (int q = 0; q < 4; q++) {
+                        fprintf(out, "%s_ms_recent{window=\"%s\",quantile=\"%s\"} %.6g\n", name, window_names[w],
+                                quantiles[q], quantile_ms(&pct[w], q));
+                    }
+                }
+                break;
+            }
+        }
+    }
+    
+    if (fclose(out) != 0) {
+        free(text);
+        return NULL;
+    }
+    return text;
+}
+
+/* Pre-rendered exports */
+void perf_release_snapshot(perf_snapshot_t* snapshot) {
+    if (snapshot && __atomic_sub_fetch(&snapshot->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(snapshot->json);
+        free(snapshot->prometheus);
+        free(snapshot);
+    }
+}
+
+perf_snapshot_t* perf_acquire_snapshot(void) {
+    if (!g_perf.initialized) return NULL;
+    pthread_mutex_lock(&g_perf.snapshot_mutex);
+    perf_snapshot_t* snapshot = g_perf.snapshot;
+    if (snapshot) __atomic_add_fetch(&snapshot->refcount, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_perf.snapshot_mutex);
+    return snapshot;
+}
+
+static int write_file_atomic(const char* filename, const char* data, size_t len) {
+    size_t path_len = strlen(filename) + sizeof(".tmp");
+    char* tmp_path = malloc(path_len);
+    if (!tmp_path) return -1;
+    snprintf(tmp_path, path_len, "%s.tmp", filename);
+    
+    int rc = -1;
+    FILE* fp = fopen(tmp_path, "w");
+    if (fp) {
+        rc = fwrite(data, 1, len, fp) == len ? 0 : -1;
+        if (fclose(fp) != 0) rc = -1;
+        if (rc == 0 && rename(tmp_path, filename) != 0) rc = -1;
+        if (rc != 0) unlink(tmp_path);
+    }
+    free(tmp_path);
+    return rc;
+}
+
+int perf_export_to_file(const char* filename, const char* format) {
+    if (!g_perf.initialized || !filename || !format) return -1;
+    int prometheus = strcmp(format, "prometheus") == 0;
+    if (!prometheus && strcmp(format, "json") != 0) return -1;
+    
+    char* text = prometheus ? perf_export_prometheus() : perf_export_json();
+    if (!text) return -1;
+    int rc = write_file_atomic(filename, text, strlen(text));
+    free(text);
+    return rc;
+}
+
+/* Refresh system metrics and render both exports; nothing here holds g_perf.mutex
+ * for longer than a copy, so recording and summaries never wait on a render
+ */
+static void perf_collect_once(void) {
+    if (g_perf.config.enable_system_metrics) {
+        perf_system_metrics_t system = g_perf.system_metrics;
+        perf_collect_system_metrics(&system);
+        pthread_mutex_lock(&g_perf.mutex);
+        g_perf.system_metrics = system;
+        g_perf.last_system_update = time(NULL);
+        pthread_mutex_unlock(&g_perf.mutex);
+        perf_gauge_set_id(CORE_SYSTEM_CPU_USAGE, system.cpu_usage_percent);
+        perf_gauge_set_id(CORE_SYSTEM_MEMORY_USED, (double)system.memory_used_bytes);
+    }
+    
+    perf_snapshot_t* snapshot = calloc(1, sizeof(perf_snapshot_t));
+    if (!snapshot) return;
+    snapshot->refcount = 1;
+    snapshot->json = perf_export_json();
+    snapshot->prometheus = perf_export_prometheus();
+    if (!snapshot->json || !snapshot->prometheus) {
+        perf_release_snapshot(snapshot);
+        return;
+    }
+    snapshot->json_len = strlen(snapshot->json);
+    snapshot->prometheus_len = strlen(snapshot->prometheus);
+    snapshot->rendered = time(NULL);
+    
+    if (g_perf.config.export_file &&
+        write_file_atomic(g_perf.config.export_file, snapshot->json, snapshot->json_len) != 0) {
+        LOGD("Failed to write metrics snapshot: %s", g_perf.config.export_file);
+    }
+    
+    pthread_mutex_lock(&g_perf.snapshot_mutex);
+    perf_snapshot_t* old = g_perf.snapshot;
+    g_perf.snapshot = snapshot;
+    pthread_mutex_unlock(&g_perf.snapshot_mutex);
+    perf_release_snapshot(old);
+}
+
+static void* perf_collector_thread(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_perf.mutex);
+    while (!g_perf.collector_stop) {
+        pthread_mutex_unlock(&g_perf.mutex);
+        perf_collect_once();
+        pthread_mutex_lock(&g_perf.mutex);
+    
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += g_perf.config.collection_interval_sec;
+        int wait_rc = 0;
+        while (!g_perf.collector_stop && wait_rc != ETIMEDOUT) {
+            wait_rc = pthread_cond_timedwait(&g_perf.collector_cond, &g_perf.mutex, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&g_perf.mutex);
+    return NULL;
+}
+
+/* Statistics and analysis */
+static perf_slot_t* find_latency_slot(const char* timer_name) {
+    if (!g_perf.initialized || !timer_name) return NULL;
+    int index = find_metric_index(timer_name);
+    if (index < 0) return NULL;
+    perf_slot_t* slot = &g_perf.metrics[index];
+    return slot->type == PERF_METRIC_TIMER || slot->type == PERF_METRIC_HISTOGRAM ? slot : NULL;
+}
+
+double perf_calculate_percentile(const char* timer_name, double percentile) {
+    perf_slot_t* slot = find_latency_slot(timer_name);
+    if (!slot) return -1.0;
+    perf_hdr_t* hdr = __atomic_load_n(&slot->hdr, __ATOMIC_ACQUIRE);
+    if (!hdr) return 0.0;
+    
+    uint64_t counts[PERF_HDR_BUCKETS];
+    uint64_t total = hdr_merge(hdr, counts);
+    if (total == 0) return 0.0;
+    double value = hdr_value_at(counts, total, percentile);
+    double lo = bits_to_double(__atomic_load_n(&slot->min_bits, __ATOMIC_RELAXED));
+    double hi = bits_to_double(__atomic_load_n(&slot->max_bits, __ATOMIC_RELAXED));
+    return value < lo ? lo : value > hi ? hi : value;
+}
+
+int perf_get_latency_distribution(const char* timer_name, perf_histogram_bucket_t** buckets, int* count) {
+    if (!buckets || !count) return -1;
+    *buckets = NULL;
+    *count = 0;
+    perf_slot_t* slot = find_latency_slot(timer_name);
+    if (!slot) return -1;
+    perf_hdr_t* hdr = __atomic_load_n(&slot->hdr, __ATOMIC_ACQUIRE);
+    if (!hdr) return 0;
+    
+    uint64_t counts[PERF_HDR_BUCKETS];
+    hdr_merge(hdr, counts);
+    int used = 0;
+    for (int b = 0; b < PERF_HDR_BUCKETS; b++) {
+        if (counts[b]) used++;
+    }
+    if (used == 0) return 0;
+    
+    perf_histogram_bucket_t* out = malloc(used * sizeof(perf_histogram_bucket_t));
+    if (!out) return -1;
+    int n = 0;
+    for (int b = 0; b < PERF_HDR_BUCKETS; b++) {
+        if (!counts[b]) continue;
+        uint64_t width;
+        uint64_t low = hdr_bucket_low(b, &width);
+        out[n].threshold_ms = (low + width) / 1e6;
+        out[n].count = counts[b];
+        n++;
+    }
+    *buckets = out;
+    *count = n;
+    return 0;
+}
+
+int perf_get_percentiles(const char* timer_name, perf_window_t window, perf_percentiles_t* out) {
+    if (!out || window < 0 || window >= PERF_WINDOW_COUNT) return -1;
+    perf_slot_t* slot = find_latency_slot(timer_name);
+    if (!slot) {
+        memset(out, 0, sizeof(*out));
+        return -1;
+    }
+    return slot_percentiles(slot, window, out);
+}
+
 /* Integration hooks */
 void perf_hook_rbus_operation(const char* operation, const char* param, double latency_ms, int success) {
     if (!g_perf.initialized || !operation) return;
     
-    char metric_name[128];
-    snprintf(metric_name, sizeof(metric_name), "rbus.%s.count", operation);
-    perf_increment_counter(metric_name);
-    
-    snprintf(metric_name, sizeof(metric_name), "rbus.%s.latency", operation);
-    perf_record_latency(metric_name, latency_ms);
+    /* Per-operation metrics register on first use */
+    perf_counter_add_id(metric_id_parts("rbus.", operation, ".count", PERF_METRIC_COUNTER, PERF_CAT_RBUS), 1);
+    perf_latency_record_id(metric_id_parts("rbus.", operation, ".latency", PERF_METRIC_TIMER, PERF_CAT_RBUS), latency_ms);
     
     if (!success) {
-        snprintf(metric_name, sizeof(metric_name), "rbus.%s.errors", operation);
-        perf_increment_counter(metric_name);
+        perf_counter_add_id(metric_id_parts("rbus.", operation, ".errors", PERF_METRIC_COUNTER, PERF_CAT_RBUS), 1);
     }
 }
 
+void perf_hook_rbus_get_coalesced(void) {
+    if (!g_perf.initialized) return;
+    
+    perf_counter_add_id(CORE_RBUS_GET_COALESCED, 1);
+}
+
+void perf_hook_rbus_get_negative_hit(void) {
+    if (!g_perf.initialized) return;
+    
+    perf_counter_add_id(CORE_RBUS_GET_NEGATIVE_HITS, 1);
+}
+
 void perf_hook_cache_operation(const char* operation, int hit, double latency_ms) {
     if (!g_perf.initialized) return;
     
-    if (hit) {
-        perf_increment_counter("cache.hits");
-    } else {
-        perf_increment_counter("cache.misses");
-    }
+    perf_counter_add_id(hit ? CORE_CACHE_HITS : CORE_CACHE_MISSES, 1);
 }
 
 void perf_hook_webconfig_transaction(const char* transaction_id, int param_count, double latency_ms, int success) {
     if (!g_perf.initialized) return;
     
-    perf_increment_counter("webconfig.transactions");
-    perf_record_latency("webconfig.latency", latency_ms);
+    perf_counter_add_id(CORE_WEBCONFIG_TRANSACTIONS, 1);
+    perf_latency_record_id(CORE_WEBCONFIG_LATENCY, latency_ms);
     
     if (!success) {
-        perf_increment_counter("webconfig.rollbacks");
+        perf_counter_add_id(CORE_WEBCONFIG_ROLLBACKS, 1);
     }
 }
 
 void perf_hook_notification_sent(const char* type, double latency_ms, int success) {
     if (!g_perf.initialized) return;
     
-    if (success) {
-        perf_increment_counter("notification.sent");
-    } else {
-        perf_increment_counter("notification.failed");
-    }
-    
-    perf_record_latency("notification.latency", latency_ms);
+    perf_counter_add_id(success ? CORE_NOTIFICATION_SENT : CORE_NOTIFICATION_FAILED, 1);
+    perf_latency_record_id(CORE_NOTIFICATION_LATENCY, latency_ms);
 }
 
 void perf_hook_protocol_request(const char* operation, double latency_ms, int success) {
     if (!g_perf.initialized) return;
     
-    perf_increment_counter("protocol.requests");
-    perf_record_latency("protocol.latency", latency_ms);
+    perf_counter_add_id(CORE_PROTOCOL_REQUESTS, 1);
+    perf_latency_record_id(CORE_PROTOCOL_LATENCY, latency_ms);
     
     if (!success) {
-        perf_increment_counter("protocol.errors");
+        perf_counter_add_id(CORE_PROTOCOL_ERRORS, 1);
     }
 }
 
@@ -558,4 +1241,4 @@ int perf_set_gauge(const char* name, double value) {
 
 double perf_get_timestamp_ms(void) {
     return get_current_time_ms();
-}
\ No newline at end of file
+}
@@ -3,7 +3,9 @@
 #include "notification.h"
 #include "webconfig.h"
 #include "performance.h"
+#include "trace.h"
 #include "auth.h"
+#include "config.h"
 #include "log.h"
 #include <string.h>
 #include <stdlib.h>
@@ -92,7 +94,7 @@ operation_type_t parse_operation_type(const char* op_string) {
    return OP_UNKNOWN;
 }
 
-/* Free table row structure */
+/* Free the contents of a table row; the row itself is owned by the caller */
 void free_table_row(table_row_t* row) {
    if (!row) return;
    if (row->params) {
@@ -102,7 +104,8 @@ void free_table_row(table_row_t* row) {
       }
       free(row->params);
    }
-   free(row);
+   row->params = NULL;
+   row->paramCount = 0;
 }
 
 /* Free test-and-set structure */
@@ -114,12 +117,13 @@ void free_test_and_set(test_and_set_t* tas) {
    memset(tas, 0, sizeof(*tas));
 }
 
-/* Free parameter attribute structure */
+/* Free the strings of a parameter attribute structure; callers own the struct itself */
 void free_param_attribute(param_attribute_t* attr) {
    if (!attr) return;
    free(attr->name);
    free(attr->access);
-   free(attr);
+   attr->name = NULL;
+   attr->access = NULL;
 }
 
 cJSON* protocol_build_get_response(const char* id, int status, cJSON* results) {
@@ -154,23 +158,60 @@ cJSON* protocol_build_attributes_response(const char* id, int status, cJSON* att
    return root;
 }
 
+int protocol_pins_add(protocol_pins_t* pins, cache_value_t* value) {
+   if (!pins || !value) return -1;
+   if (pins->count == pins->capacity) {
+      int capacity = pins->capacity ? pins->capacity * 2 : 16;
+      cache_value_t** values = (cache_value_t**)realloc(pins->values, capacity * sizeof(cache_value_t*));
+      if (!values) return -1;
+      pins->values = values;
+      pins->capacity = capacity;
+   }
+   pins->values[pins->count++] = value;
+   return 0;
+}
+
+void protocol_pins_release(protocol_pins_t* pins) {
+   if (!pins) return;
+   for (int i = 0; i < pins->count; i++) cache_release(pins->values[i]);
+   free(pins->values);
+   pins->values = NULL;
+   pins->count = pins->capacity = 0;
+}
+
+/* Add a cached value as "v": borrowed when the caller pins, copied otherwise. Consumes value. */
+static void add_cached_value(cJSON* obj, cache_value_t* value, protocol_pins_t* pins) {
+   int dataType = value->dataType;
+   if (protocol_pins_add(pins, value) == 0) {
+      cJSON_AddItemToObject(obj, "v", cJSON_CreateStringReference(value->data));
+   } else {
+      cJSON_AddStringToObject(obj, "v", value->data);
+      cache_release(value);
+   }
+   cJSON_AddNumberToObject(obj, "t", dataType);
+}
+
 cJSON* protocol_handle_request(cJSON* root) {
+   return protocol_handle_request_pinned(root, NULL);
+}
+
+cJSON* protocol_handle_request_pinned(cJSON* root, protocol_pins_t* pins) {
    if (!root || !cJSON_IsObject(root)) return protocol_build_set_response(NULL, 400, "invalid json");
    
-   perf_timer_t* timer = perf_timer_start("protocol_request", PERF_CAT_PROTOCOL);
+   PERF_SCOPE(timer, "protocol_request", PERF_CAT_PROTOCOL);
    
    cJSON* id = cJSON_GetObjectItem(root, "id");
    cJSON* op = cJSON_GetObjectItem(root, "op");
    if (!cJSON_IsString(op)) {
-      if (timer) {
-         double latency = perf_timer_elapsed_ms(timer);
-         perf_timer_stop(timer);
+      if (timer.active) {
+         double latency = perf_scope_end(&timer);
          perf_hook_protocol_request("invalid", latency, 0);
       }
       return protocol_build_set_response(id ? id->valuestring : NULL, 400, "missing op");
    }
    
    /* Extract authentication context */
+   uint64_t auth_span = TRACE_SPAN_START();
    auth_context_t* auth_context = NULL;
    cJSON* auth_header = cJSON_GetObjectItem(root, "authorization");
    cJSON* session_header = cJSON_GetObjectItem(root, "session_id");
@@ -203,6 +244,7 @@ cJSON* protocol_handle_request(cJSON* root) {
    if (!auth_context) {
       auth_context = auth_authenticate_request(NULL, AUTH_TOKEN_BEARER, client_ip_str, user_agent_str);
    }
+   TRACE_SPAN_END(auth_span, "auth", auth_context ? auth_context->user_id : NULL, auth_context ? 0 : 401);
    
    operation_type_t op_type = parse_operation_type(op->valuestring);
    const char* id_str = id ? id->valuestring : NULL;
@@ -218,16 +260,48 @@ cJSON* protocol_handle_request(cJSON* root) {
             success = 0;
             break;
          }
-         cJSON* results = cJSON_CreateObject();
-         cJSON* entry = NULL; int failures = 0; int idx = 0;
+         /* First pass: ACL-check every name and collect the concrete (non-wildcard)
+          * ones so they can be fetched with a single batched RBUS call */
+         int total = cJSON_GetArraySize(params);
+         int slots = total > 0 ? total : 1;
+         char* allowed = (char*)calloc(slots, sizeof(char));
+         const char** names = (const char**)calloc(slots, sizeof(char*));
+         cache_value_t** values = (cache_value_t**)calloc(slots, sizeof(cache_value_t*));
+         int* rcs = (int*)calloc(slots, sizeof(int));
+         if (!allowed || !names || !values || !rcs) {
+            free(allowed); free(names); free(values); free(rcs);
+            response = protocol_build_set_response(id_str, 500, "out of memory");
+            success = 0;
+            break;
+         }
+         cJSON* entry = NULL; int failures = 0; int idx = 0; int nnames = 0;
          cJSON_ArrayForEach(entry, params) {
             if (cJSON_IsString(entry)) {
                const char* p = entry->valuestring;
-               
                /* Check authorization for this parameter */
                if (!auth_check_acl(p, auth_context)) {
-                  failures++;
                   auth_log_permission_denied(auth_context ? auth_context->user_id : "anonymous", p, "GET");
+               } else {
+                  allowed[idx] = 1;
+                  size_t plen = strlen(p);
+                  if (!(plen > 0 && p[plen-1] == '.')) names[nnames++] = p;
+               }
+            }
+            idx++;
+         }
+         if (nnames > 0) {
+            rbus_adapter_get_typed_bulk_ref(names, nnames, values, rcs);
+         }
+
+         /* Second pass: assemble results in request order */
+         cJSON* results = cJSON_CreateObject();
+         int k = 0; idx = 0;
+         cJSON_ArrayForEach(entry, params) {
+            if (cJSON_IsString(entry)) {
+               const char* p = entry->valuestring;
+               
+               if (!allowed[idx]) {
+                  failures++;
                   cJSON_AddNullToObject(results, p);
                   idx++;
                   continue;
@@ -235,34 +309,28 @@ cJSON* protocol_handle_request(cJSON* root) {
                
                size_t plen = strlen(p);
                if(plen>0 && p[plen-1]=='.') {
-                  /* wildcard expansion */
-                  char** list = NULL; int cnt = 0;
-                  int wrc = rbus_adapter_expand_wildcard(p, &list, &cnt);
+                  /* wildcard expansion: names, values and types from one rbus_getExt */
+                  table_param_t* list = NULL; int cnt = 0;
+                  int wrc = rbus_adapter_get_wildcard(p, &list, &cnt, g_p2r_config.wildcard_cache_fill != 0);
                   if(wrc==0 && cnt>0 && list){
                      for(int i=0;i<cnt;i++){
-                        char* val = NULL; int dtype = 0; int rc = rbus_adapter_get_typed(list[i], &val, &dtype);
-                        if(rc==0 && val){
-                           cJSON* obj = cJSON_CreateObject();
-                           cJSON_AddStringToObject(obj, "v", val);
-                           cJSON_AddNumberToObject(obj, "t", dtype);
-                           cJSON_AddItemToObject(results, list[i], obj);
-                           free(val);
-                        } else { failures++; cJSON_AddNullToObject(results, list[i]); }
-                        free(list[i]);
+                        cJSON* obj = cJSON_CreateObject();
+                        cJSON_AddStringToObject(obj, "v", list[i].value);
+                        cJSON_AddNumberToObject(obj, "t", list[i].dataType);
+                        cJSON_AddItemToObject(results, list[i].name, obj);
                      }
-                     free(list);
+                     rbus_adapter_free_params(list, cnt);
                   } else {
                      /* treat as failure for this wildcard */
                      failures++; cJSON_AddNullToObject(results, p);
                   }
                } else {
-                  char* val = NULL; int dtype = 0; int rc = rbus_adapter_get_typed(p, &val, &dtype);
+                  cache_value_t* val = values[k]; int rc = rcs[k];
+                  values[k++] = NULL;
                   if (rc == 0 && val) {
                      cJSON* obj = cJSON_CreateObject();
-                     cJSON_AddStringToObject(obj, "v", val);
-                     cJSON_AddNumberToObject(obj, "t", dtype);
+                     add_cached_value(obj, val, pins);
                      cJSON_AddItemToObject(results, p, obj);
-                     free(val);
                   } else { 
                      failures++; 
                      /* Use enhanced error mapping for RBUS errors */
@@ -271,6 +339,7 @@ cJSON* protocol_handle_request(cJSON* root) {
                         int rbusErr = -(rc + 100);
                         LOGD("RBUS error %d for parameter %s", rbusErr, p);
                      }
+                     cache_release(val);
                      cJSON_AddNullToObject(results, p); 
                   }
                }
@@ -279,6 +348,7 @@ cJSON* protocol_handle_request(cJSON* root) {
             }
             idx++;
          }
+         free(allowed); free(names); free(values); free(rcs);
          int status = failures ? 207 /* multi-status */ : 200;
          response = protocol_build_get_response(id_str, status, results);
          success = (failures == 0);
@@ -305,9 +375,17 @@ cJSON* protocol_handle_request(cJSON* root) {
             return protocol_build_set_response(id_str, 403, "write permission required");
          }
             
-         /* Get old value for notification */
+         /* Old value for the change notification: from the cache when fresh; RBUS is
+          * only read first when the parameter's changes are notified (or --set-preread always)
+          */
          char* oldValue = NULL;
-         rbus_adapter_get(param->valuestring, &oldValue);
+         if (g_p2r_config.set_preread == P2R_SET_PREREAD_ALWAYS) {
+            rbus_adapter_get(param->valuestring, &oldValue);
+         } else if (notification_param_notify_enabled(param->valuestring) &&
+                    cache_get_parameter(param->valuestring, &oldValue, NULL) != 0 &&
+                    g_p2r_config.set_preread == P2R_SET_PREREAD_AUTO) {
+            rbus_adapter_get(param->valuestring, &oldValue);
+         }
          
          int rc = rbus_adapter_set(param->valuestring, value->valuestring);
          
@@ -375,6 +453,7 @@ cJSON* protocol_handle_request(cJSON* root) {
          if (cJSON_IsString(access)) attr.access = strdup(access->valuestring);
          
          int rc = rbus_adapter_set_attributes(param->valuestring, &attr);
+         if (rc == 0 && cJSON_IsNumber(notify)) notification_set_param_notify(param->valuestring, attr.notify);
          free_param_attribute(&attr);
          return protocol_build_set_response(id_str, map_status(rc), rc == 0 ? "OK" : "set attributes failed");
       }
@@ -601,9 +680,29 @@ cJSON* protocol_handle_request(cJSON* root) {
             return protocol_build_set_response(id_str, 400, "invalid transaction format");
          }
          
+         /* "async": true queues the transaction and answers with its id */
+         if (cJSON_IsTrue(cJSON_GetObjectItem(root, "async"))) {
+            char* tx_id = NULL;
+            uint64_t span = TRACE_SPAN_START();
+            int arc = webconfig_execute_transaction_async(transaction, &tx_id);
+            TRACE_SPAN_END(span, "webconfig_queue", tx_id, arc);
+            webconfig_free_transaction(transaction);
+            if (arc != 0) {
+               return protocol_build_set_response(id_str, arc == -2 ? 409 : 500, "WebConfig transaction not queued");
+            }
+            cJSON* response = cJSON_CreateObject();
+            if (id_str) cJSON_AddStringToObject(response, "id", id_str);
+            cJSON_AddNumberToObject(response, "status", 202);
+            cJSON_AddStringToObject(response, "transaction_id", tx_id);
+            free(tx_id);
+            return response;
+         }
+         
          /* Execute WebConfig transaction */
          webconfig_result_t* result = NULL;
+         uint64_t span = TRACE_SPAN_START();
          int rc = webconfig_execute_transaction(transaction, &result);
+         TRACE_SPAN_END(span, "webconfig", result ? result->transaction_id : NULL, rc);
          
          cJSON* response_obj = NULL;
          if (rc == 0 && result) {
@@ -637,9 +736,8 @@ cJSON* protocol_handle_request(cJSON* root) {
    }
    
    /* Performance monitoring */
-   if (timer) {
-      double latency = perf_timer_elapsed_ms(timer);
-      perf_timer_stop(timer);
+   if (timer.active) {
+      double latency = perf_scope_end(&timer);
       perf_hook_protocol_request(op->valuestring, latency, success);
    }
    
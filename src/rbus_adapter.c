@@ -1,33 +1,227 @@
 #include "rbus_adapter.h"
 #include "cache.h"
+#include "notification.h"
 #include "performance.h"
+#include "event_forwarder.h"
+#include "trace.h"
 #include "log.h"
 #include <rbus.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-
-/* Forward declare weak hooks provided by parodus interface for emitting events as JSON */
-__attribute__((weak)) void p2r_emit_event(const char* name, const char* payload_json);
+#include <pthread.h>
 
 static rbusHandle_t g_handle = NULL;
 static int g_sub_count = 0;
 
+/* Cache a value fetched from RBUS; in coherent mode also subscribe so events keep it fresh.
+ * The cache shares the caller's buffer. Returns 0 if the value was cached.
+ */
+static int cache_store_fetched_value(const char* param, cache_value_t* value) {
+   if (cache_set_parameter_value(param, value) != 0) return -1;
+   /* A new watch is subscribed in the background, which marks the entry coherent */
+   if (cache_coherence_wanted(param) && notification_watch_parameter(param) == 1) {
+      cache_mark_coherent(param);
+   }
+   return 0;
+}
+
+static int cache_store_fetched(const char* param, const char* value, int dataType) {
+   cache_value_t* stored = cache_value_create(value, dataType);
+   if (!stored) return -1;
+   int rc = cache_store_fetched_value(param, stored);
+   cache_release(stored);
+   return rc;
+}
+
+/* Answer a wildcard GET from a complete cached subtree; 0 on hit */
+static int get_wildcard_cached(const char* prefix, table_param_t** list, int* count) {
+   char** keys = NULL;
+   char** values = NULL;
+   int* types = NULL;
+   int n = 0;
+   uint64_t span = TRACE_SPAN_START();
+   int rc = cache_get_subtree(prefix, &keys, &values, &types, &n);
+   TRACE_SPAN_END(span, "cache_subtree", prefix, rc == 0);
+   if (rc != 0) return -1;
+   table_param_t* arr = n > 0 ? (table_param_t*)calloc(n, sizeof(table_param_t)) : NULL;
+   if (n > 0 && !arr) {
+      cache_free_wildcard_results(keys, values, types, n);
+      return -1;
+   }
+   for (int i = 0; i < n; i++) {
+      /* hand the strings over instead of copying them */
+      arr[i].name = keys[i];
+      arr[i].value = values[i];
+      arr[i].dataType = types[i];
+   }
+   free(keys);
+   free(values);
+   free(types);
+   *list = arr; *count = n;
+   return 0;
+}
+
+/* Errors meaning the provider itself is gone or stuck, not that the name is wrong */
+static int provider_lost(rbusError_t rc) {
+   return rc == RBUS_ERROR_DESTINATION_NOT_REACHABLE || rc == RBUS_ERROR_DESTINATION_NOT_FOUND ||
+          rc == RBUS_ERROR_COMPONENT_DOES_NOT_EXIST || rc == RBUS_ERROR_TIMEOUT;
+}
+
+/* Forget the owner's routes so its names are discovered again once it re-registers */
+static void drop_component_routes(int owner, rbusError_t rc) {
+   const char* component = owner >= 0 ? cache_component_name(owner) : NULL;
+   if (!component) return;
+   LOGW("Component %s unreachable (%d), dropping its discovery cache entries", component, rc);
+   cache_invalidate_component_info(component);
+}
+
+/* Remember what a failed single-name call says about the name or its provider */
+static void note_rbus_failure(const char* param, rbusError_t rc) {
+   if (rc == RBUS_ERROR_ELEMENT_DOES_NOT_EXIST || rc == RBUS_ERROR_INVALID_NAMESPACE) cache_component_learn_missing(param);
+   else if (provider_lost(rc)) drop_component_routes(cache_component_lookup(param), rc);
+}
+
+/* One name's discovery answer; returns its owner. Only objects that are plainly not
+ * registered become negative entries; partial paths may still exist below.
+ */
+static int apply_discovery(const char* name, rbusError_t rc, const char* component) {
+   if (rc == RBUS_ERROR_SUCCESS && component && *component) return cache_component_learn(name, component);
+   size_t len = strlen(name);
+   if ((rc == RBUS_ERROR_SUCCESS || rc == RBUS_ERROR_ELEMENT_DOES_NOT_EXIST) && len > 0 && name[len - 1] != '.') {
+      cache_component_learn_missing(name);
+      return CACHE_COMPONENT_MISSING;
+   }
+   return CACHE_COMPONENT_UNKNOWN;
+}
+
+/* A newly discovered component's element list routes all its other objects at once */
+static void load_component_elements(int owner) {
+   if (owner < 0 || !cache_component_claim_elements(owner)) return;
+   const char* component = cache_component_name(owner);
+   int numElements = 0;
+   char** elements = NULL;
+   uint64_t span = TRACE_SPAN_START();
+   rbusError_t rc = rbus_discoverComponentDataElements(g_handle, component, false, &numElements, &elements);
+   TRACE_SPAN_END(span, "rbus_discoverComponentDataElements", component, rc);
+   if (rc != RBUS_ERROR_SUCCESS) {
+      LOGD("rbus_discoverComponentDataElements(%s) failed: %d", component, rc);
+      return;
+   }
+   for (int i = 0; i < numElements; i++) {
+      if (elements[i]) cache_component_learn(elements[i], component);
+      free(elements[i]);
+   }
+   free(elements);
+   LOGD("Discovered %d elements of %s", numElements, component);
+}
+
+/* Owner of each name: a component id or CACHE_COMPONENT_*. Names without a cached route
+ * are discovered in one call; if RBUS rejects the batch, one at a time so the bad name
+ * is identified.
+ */
+static void resolve_components(const char** names, int count, int* owners) {
+   int* pending = (int*)malloc(sizeof(int) * count);
+   const char** pendingNames = (const char**)malloc(sizeof(char*) * count);
+   int numPending = 0;
+   for (int i = 0; i < count; i++) {
+      owners[i] = cache_component_lookup(names[i]);
+      if (owners[i] == CACHE_COMPONENT_UNKNOWN && pending && pendingNames) {
+         pending[numPending] = i;
+         pendingNames[numPending++] = names[i];
+      }
+   }
+
+   if (numPending > 0) {
+      int numComponents = 0;
+      char** components = NULL;
+      uint64_t span = TRACE_SPAN_START();
+      rbusError_t rc = rbus_discoverComponentName(g_handle, numPending, pendingNames, &numComponents, &components);
+      TRACE_SPAN_END(span, "rbus_discoverComponentName", pendingNames[0], rc);
+      if (rc == RBUS_ERROR_SUCCESS && numComponents == numPending) {
+         for (int j = 0; j < numPending; j++) {
+            owners[pending[j]] = apply_discovery(pendingNames[j], rc, components[j]);
+         }
+      } else if (rc != RBUS_ERROR_SUCCESS) {
+         for (int j = 0; j < numPending; j++) {
+            int single = 0;
+            char** component = NULL;
+            span = numPending == 1 ? 0 : TRACE_SPAN_START();
+            rbusError_t one = numPending == 1 ? rc :
+               rbus_discoverComponentName(g_handle, 1, &pendingNames[j], &single, &component);
+            TRACE_SPAN_END(span, "rbus_discoverComponentName", pendingNames[j], one);
+            owners[pending[j]] = apply_discovery(pendingNames[j], one, single == 1 ? component[0] : NULL);
+            for (int k = 0; k < single; k++) free(component[k]);
+            free(component);
+         }
+      }
+      for (int j = 0; j < numComponents; j++) free(components[j]);
+      free(components);
+      for (int j = 0; j < numPending; j++) load_component_elements(owners[pending[j]]);
+   }
+   free(pending);
+   free(pendingNames);
+}
+
+static const char* event_type_name(rbusEventType_t type) {
+   switch (type) {
+      case RBUS_EVENT_OBJECT_CREATED: return "OBJECT_CREATED";
+      case RBUS_EVENT_OBJECT_DELETED: return "OBJECT_DELETED";
+      case RBUS_EVENT_VALUE_CHANGED: return "VALUE_CHANGED";
+      case RBUS_EVENT_GENERAL: return "GENERAL";
+      case RBUS_EVENT_INITIAL_VALUE: return "INITIAL_VALUE";
+      case RBUS_EVENT_INTERVAL: return "INTERVAL";
+      case RBUS_EVENT_DURATION_COMPLETE: return "DURATION_COMPLETE";
+      default: return "UNKNOWN";
+   }
+}
+
+/* Properties copied on the stack; larger events take a heap copy */
+#define EVENT_STACK_PROPERTIES 32
+
+/* Runs on the RBUS callback thread: copy the event for the forwarder and return */
 static void event_cb(rbusHandle_t handle, rbusEvent_t const* event, rbusEventSubscription_t* subscription) {
    (void)handle; (void)subscription;
    if (!event || !event->name) return;
-   char* payloadStr = NULL;
-   if (event->data) {
-      /* Build a simple JSON-like string manually from first property if present */
-      rbusValue_t v = rbusObject_GetValue(event->data, NULL);
-      if (v) {
-         payloadStr = rbusValue_ToString(v, NULL, 0);
+   rbusProperty_t first = event->data ? rbusObject_GetProperties(event->data) : NULL;
+   int total = 0;
+   for (rbusProperty_t prop = first; prop; prop = rbusProperty_GetNext(prop)) total++;
+   
+   const char* stackNames[EVENT_STACK_PROPERTIES];
+   char* stackValues[EVENT_STACK_PROPERTIES];
+   const char** names = stackNames;
+   char** values = stackValues;
+   if (total > EVENT_STACK_PROPERTIES) {
+      names = (const char**)malloc(sizeof(char*) * total);
+      values = (char**)malloc(sizeof(char*) * total);
+      if (!names || !values) {
+         LOGW("Dropping event %s: no memory for %d properties", event->name, total);
+         free(names);
+         free(values);
+         return;
       }
    }
-   if (p2r_emit_event) {
-      p2r_emit_event(event->name, payloadStr ? payloadStr : NULL);
+   int count = 0;
+   for (rbusProperty_t prop = first; prop && count < total; prop = rbusProperty_GetNext(prop)) {
+      rbusValue_t v = rbusProperty_GetValue(prop);
+      names[count] = rbusProperty_GetName(prop);
+      values[count] = v ? rbusValue_ToString(v, NULL, 0) : NULL;
+      count++;
    }
-   if (payloadStr) free(payloadStr);
+   event_forwarder_push(event->name, event_type_name(event->type), count, names, (const char* const*)values);
+   for (int i = 0; i < count; i++) free(values[i]);
+   if (names != stackNames) {
+      free(names);
+      free(values);
+   }
+}
+
+/* Runs on an RBUS thread when a component leaves the bus: its routes are dead */
+static void component_disconnected(rbusHandle_t handle, const char* component) {
+   (void)handle;
+   if (!component) return;
+   LOGD("Component %s disconnected", component);
+   cache_invalidate_component_info(component);
 }
 
 int rbus_adapter_open(const char* component_name) {
@@ -37,6 +231,10 @@ int rbus_adapter_open(const char* component_name) {
       return -1;
    }
    LOGI("RBUS opened as %s", component_name);
+   
+   /* Without it, a departed provider's routes go only once a call to it fails */
+   rc = rbus_registerClientDisconnectHandler(g_handle, component_disconnected);
+   if (rc != RBUS_ERROR_SUCCESS) LOGW("rbus_registerClientDisconnectHandler failed: %d", rc);
    return 0;
 }
 
@@ -50,32 +248,44 @@ void rbus_adapter_close(void) {
 int rbus_adapter_get(const char* param, char** outValue) {
    if (!g_handle || !param || !outValue) return -1;
    
-   perf_timer_t* timer = perf_timer_start("rbus_get", PERF_CAT_RBUS);
+   PERF_SCOPE(timer, "rbus_get", PERF_CAT_RBUS);
    
    /* Try cache first */
    char* cached_value = NULL;
-   if (cache_get_parameter(param, &cached_value, NULL) == 0) {
+   uint64_t span = TRACE_SPAN_START();
+   int cached = cache_get_parameter(param, &cached_value, NULL) == 0;
+   TRACE_SPAN_END(span, "cache_get", param, cached);
+   if (cached) {
       *outValue = cached_value;
       LOGD("Cache hit for parameter: %s", param);
       
-      if (timer) {
-         double latency = perf_timer_elapsed_ms(timer);
-         perf_timer_stop(timer);
+      if (timer.active) {
+         double latency = perf_scope_end(&timer);
          perf_hook_cache_operation("get", 1, latency);
       }
       return 0;
    }
    
+   if (cache_component_lookup(param) == CACHE_COMPONENT_MISSING) {
+      LOGD("Parameter %s was recently reported nonexistent", param);
+      perf_hook_rbus_get_negative_hit();
+      perf_scope_end(&timer);
+      return -2;
+   }
+   
    rbusValue_t value = NULL;
+   span = TRACE_SPAN_START();
    rbusError_t rc = rbus_get(g_handle, param, &value);
+   TRACE_SPAN_END(span, "rbus_get", param, rc);
    
-   double latency = timer ? perf_timer_elapsed_ms(timer) : 0.0;
+   double latency = perf_scope_elapsed_ms(&timer);
    int success = (rc == RBUS_ERROR_SUCCESS);
    
    if (rc != RBUS_ERROR_SUCCESS) {
       LOGW("rbus_get(%s) failed: %d", param, rc);
-      if (timer) {
-         perf_timer_stop(timer);
+      note_rbus_failure(param, rc);
+      if (timer.active) {
+         perf_scope_end(&timer);
          perf_hook_rbus_operation("get", param, latency, 0);
          perf_hook_cache_operation("get", 0, latency);
       }
@@ -84,8 +294,8 @@ int rbus_adapter_get(const char* param, char** outValue) {
    char* str = rbusValue_ToString(value, NULL, 0);
    if (!str) { 
       rbusValue_Release(value); 
-      if (timer) {
-         perf_timer_stop(timer);
+      if (timer.active) {
+         perf_scope_end(&timer);
          perf_hook_rbus_operation("get", param, latency, 0);
       }
       return -3; 
@@ -93,13 +303,13 @@ int rbus_adapter_get(const char* param, char** outValue) {
    *outValue = strdup(str);
    
    /* Cache the result */
-   cache_set_parameter(param, str, 0); /* 0 = WebPA string type */
+   cache_store_fetched(param, str, 0); /* 0 = WebPA string type */
    
    free(str);
    rbusValue_Release(value);
    
-   if (timer) {
-      perf_timer_stop(timer);
+   if (timer.active) {
+      perf_scope_end(&timer);
       perf_hook_rbus_operation("get", param, latency, 1);
       perf_hook_cache_operation("get", 0, latency);
    }
@@ -136,6 +346,170 @@ static int map_rbus_to_webpa_type(rbusValueType_t t) {
    }
 }
 
+/* Inverse of map_rbus_to_webpa_type: load a WebPA string value into val using the
+ * native RBUS type for dataType. Unknown codes (and bytes, which WebPA carries as
+ * base64 text) are sent as strings, as before typed sets existed.
+ */
+static void set_value_from_webpa(rbusValue_t val, const char* value, int dataType) {
+   switch (dataType) {
+      case 3: /* boolean */
+         rbusValue_SetBoolean(val, strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+         break;
+      case 1: /* int */
+         rbusValue_SetInt32(val, (int32_t)strtol(value, NULL, 10));
+         break;
+      case 2: /* uint */
+         rbusValue_SetUInt32(val, (uint32_t)strtoul(value, NULL, 10));
+         break;
+      case 4: /* float/double */
+         rbusValue_SetDouble(val, strtod(value, NULL));
+         break;
+      case 5: /* datetime */
+         if (!rbusValue_SetFromString(val, RBUS_DATETIME, value))
+            rbusValue_SetString(val, value);
+         break;
+      case 7: /* long */
+         rbusValue_SetInt64(val, (int64_t)strtoll(value, NULL, 10));
+         break;
+      case 8: /* ulong */
+         rbusValue_SetUInt64(val, (uint64_t)strtoull(value, NULL, 10));
+         break;
+      default: /* string and others */
+         rbusValue_SetString(val, value);
+         break;
+   }
+}
+
+/* Single-flight reads: while one rbus_get for a name is outstanding, later cache misses
+ * for that name wait for it and copy its result instead of issuing their own. A local
+ * set detaches the name's entry, so later reads fetch afresh and the owner does not
+ * leave the value it read before the set in the cache.
+ */
+#define INFLIGHT_BUCKETS 64
+
+typedef struct inflight {
+   char* name;
+   uint32_t hash;
+   int done;
+   int rc;                 /* rbus_adapter_get_typed result shared with waiters */
+   cache_value_t* value;   /* Fetched value when rc == 0 */
+   int waiters;            /* Last waiter out frees a finished entry */
+   int stale;              /* Detached by a set while the fetch was outstanding */
+   pthread_cond_t cond;
+   struct inflight* next;
+} inflight_t;
+
+static struct {
+   pthread_mutex_t mutex;
+   inflight_t* buckets[INFLIGHT_BUCKETS];
+} g_inflight = { PTHREAD_MUTEX_INITIALIZER, { NULL } };
+
+static uint32_t inflight_hash(const char* name) {
+   uint32_t h = 2166136261u;
+   for (const unsigned char* p = (const unsigned char*)name; *p; p++) h = (h ^ *p) * 16777619u;
+   return h;
+}
+
+static void inflight_free(inflight_t* flight) {
+   if (flight->value) cache_release(flight->value);
+   pthread_cond_destroy(&flight->cond);
+   free(flight->name);
+   free(flight);
+}
+
+/* Callers hold g_inflight.mutex */
+static inflight_t* inflight_find_locked(const char* name, uint32_t hash) {
+   inflight_t* flight = g_inflight.buckets[hash % INFLIGHT_BUCKETS];
+   while (flight && (flight->hash != hash || strcmp(flight->name, name) != 0)) flight = flight->next;
+   return flight;
+}
+
+/* New entry owned by the caller, who must inflight_publish it; NULL if out of memory */
+static inflight_t* inflight_register_locked(const char* name, uint32_t hash) {
+   inflight_t* flight = (inflight_t*)calloc(1, sizeof(inflight_t));
+   if (flight && !(flight->name = strdup(name))) { free(flight); flight = NULL; }
+   if (flight) {
+      inflight_t** bucket = &g_inflight.buckets[hash % INFLIGHT_BUCKETS];
+      flight->hash = hash;
+      pthread_cond_init(&flight->cond, NULL);
+      flight->next = *bucket;
+      *bucket = flight;
+   }
+   return flight;
+}
+
+/* Unlink name's entry after a set; its owner and current waiters still finish with it */
+static void inflight_detach(const char* name) {
+   uint32_t hash = inflight_hash(name);
+   pthread_mutex_lock(&g_inflight.mutex);
+   inflight_t* flight = inflight_find_locked(name, hash);
+   if (flight) {
+      inflight_t** link = &g_inflight.buckets[hash % INFLIGHT_BUCKETS];
+      while (*link != flight) link = &(*link)->next;
+      *link = flight->next;
+      flight->stale = 1;
+   }
+   pthread_mutex_unlock(&g_inflight.mutex);
+}
+
+/* Hand the owner's result to the waiters; the entry takes over the value reference.
+ * Detaching happens before the set's cache invalidation, so when the entry was detached
+ * the owner drops what it cached, which may predate the set.
+ */
+static void inflight_publish(inflight_t* flight, int rc, cache_value_t* value) {
+   pthread_mutex_lock(&g_inflight.mutex);
+   if (!flight->stale) {
+      inflight_t** link = &g_inflight.buckets[flight->hash % INFLIGHT_BUCKETS];
+      while (*link != flight) link = &(*link)->next;
+      *link = flight->next;
+   } else if (rc == 0) {
+      cache_invalidate_parameter(flight->name);
+   }
+   flight->rc = rc;
+   flight->value = value;
+   flight->done = 1;
+   pthread_cond_broadcast(&flight->cond);
+   if (flight->waiters == 0) inflight_free(flight);
+   pthread_mutex_unlock(&g_inflight.mutex);
+}
+
+/* After a successful local set: no read started before it may repopulate the cache */
+static void invalidate_written(const char* param) {
+   inflight_detach(param);
+   cache_invalidate_parameter(param);
+}
+
+/* Fetch one value over RBUS and cache it; the caller owns the returned reference */
+static int fetch_typed(const char* param, cache_value_t** out) {
+   rbusValue_t value = NULL;
+   uint64_t span = TRACE_SPAN_START();
+   rbusError_t rc = rbus_get(g_handle, param, &value);
+   TRACE_SPAN_END(span, "rbus_get", param, rc);
+   if (rc != RBUS_ERROR_SUCCESS) {
+      LOGW("rbus_get(%s) failed: %d", param, rc);
+      note_rbus_failure(param, rc);
+      return -(rc + 100); /* Offset RBUS errors to distinguish from local errors */
+   }
+   rbusValueType_t t = rbusValue_GetType(value);
+   char* str = rbusValue_ToString(value, NULL, 0);
+   rbusValue_Release(value);
+   if (!str) return -3;
+   *out = cache_value_create(str, map_rbus_to_webpa_type(t));
+   free(str);
+   if (!*out) return -3;
+   
+   /* Cache the result with type information */
+   cache_store_fetched_value(param, *out);
+   return 0;
+}
+
+static int copy_fetched(const cache_value_t* value, char** outValue, int* outType) {
+   *outValue = strdup(value->data);
+   if (!*outValue) return -3;
+   *outType = value->dataType;
+   return 0;
+}
+
 int rbus_adapter_get_typed(const char* param, char** outValue, int* outType) {
    if(!outType) return -5;
    if (!g_handle || !param || !outValue) return -1;
@@ -143,67 +517,402 @@ int rbus_adapter_get_typed(const char* param, char** outValue, int* outType) {
    /* Try cache first */
    char* cached_value = NULL;
    int cached_type = 0;
-   if (cache_get_parameter(param, &cached_value, &cached_type) == 0) {
+   uint64_t span = TRACE_SPAN_START();
+   int cached = cache_get_parameter(param, &cached_value, &cached_type) == 0;
+   TRACE_SPAN_END(span, "cache_get", param, cached);
+   if (cached) {
       *outValue = cached_value;
       *outType = cached_type;
       LOGD("Cache hit for typed parameter: %s", param);
       return 0;
    }
    
-   rbusValue_t value = NULL;
-   rbusError_t rc = rbus_get(g_handle, param, &value);
-   if (rc != RBUS_ERROR_SUCCESS) {
-      LOGW("rbus_get(%s) failed: %d", param, rc);
-      return -(rc + 100); /* Offset RBUS errors to distinguish from local errors */
+   /* Known-nonexistent names fail without an IPC round trip */
+   if (cache_component_lookup(param) == CACHE_COMPONENT_MISSING) {
+      perf_hook_rbus_get_negative_hit();
+      return -(RBUS_ERROR_ELEMENT_DOES_NOT_EXIST + 100);
    }
-   rbusValueType_t t = rbusValue_GetType(value);
-   char* str = rbusValue_ToString(value, NULL, 0);
-   if (!str) { rbusValue_Release(value); return -3; }
-   *outValue = strdup(str);
-   *outType = map_rbus_to_webpa_type(t);
    
-   /* Cache the result with type information */
-   cache_set_parameter(param, str, *outType);
+   uint32_t hash = inflight_hash(param);
+   pthread_mutex_lock(&g_inflight.mutex);
+   inflight_t* flight = inflight_find_locked(param, hash);
+   if (flight) {
+      flight->waiters++;
+      while (!flight->done) pthread_cond_wait(&flight->cond, &g_inflight.mutex);
+      int rc = flight->rc == 0 ? copy_fetched(flight->value, outValue, outType) : flight->rc;
+      if (--flight->waiters == 0) inflight_free(flight);
+      pthread_mutex_unlock(&g_inflight.mutex);
+      perf_hook_rbus_get_coalesced();
+      return rc;
+   }
+   flight = inflight_register_locked(param, hash);
+   pthread_mutex_unlock(&g_inflight.mutex);
    
-   free(str);
-   rbusValue_Release(value);
-   return 0;
+   /* Without an entry the read simply goes uncoalesced */
+   cache_value_t* fetched = NULL;
+   int rc = fetch_typed(param, &fetched);
+   if (rc == 0) rc = copy_fetched(fetched, outValue, outType);
+   if (!flight) {
+      if (fetched) cache_release(fetched);
+      return rc;
+   }
+   inflight_publish(flight, fetched ? 0 : rc, fetched);
+   return rc;
+}
+
+/* Values sit marked as grouped once their provider's batch was issued */
+#define OWNER_GROUPED (CACHE_COMPONENT_MISSING - 1)
+
+/* Fetch names (all served by owner) in one rbus_getExt; idx maps them back to the
+ * caller's slots. Returns how many values were fetched.
+ */
+static int get_group(const char** params, const int* idx, const char** names, int n, int owner,
+                     cache_value_t** outValues, int* outRcs) {
+   int fetched = 0;
+   int numProps = 0;
+   rbusProperty_t props = NULL;
+   uint64_t span = TRACE_SPAN_START();
+   rbusError_t rc = rbus_getExt(g_handle, n, names, &numProps, &props);
+   TRACE_SPAN_END(span, "rbus_getExt", names[0], rc);
+   if (rc == RBUS_ERROR_SUCCESS) {
+      int next = 0;
+      for (rbusProperty_t cur = props; cur; cur = rbusProperty_GetNext(cur)) {
+         const char* name = rbusProperty_GetName(cur);
+         if (!name) continue;
+         /* Properties normally come back in request order; search only when they don't */
+         int slot = -1;
+         if (next < n && outRcs[idx[next]] != 0 && strcmp(names[next], name) == 0) {
+            slot = next;
+         } else {
+            for (int j = 0; j < n; j++) {
+               if (outRcs[idx[j]] != 0 && strcmp(names[j], name) == 0) { slot = j; break; }
+            }
+         }
+         if (slot < 0) continue;
+         rbusValue_t value = rbusProperty_GetValue(cur);
+         char* str = value ? rbusValue_ToString(value, NULL, 0) : NULL;
+         cache_value_t* fetchedValue = str ? cache_value_create(str, map_rbus_to_webpa_type(rbusValue_GetType(value))) : NULL;
+         free(str);
+         if (!fetchedValue) { outRcs[idx[slot]] = -3; next = slot + 1; continue; }
+         int i = idx[slot];
+         /* the response and the cache share one buffer */
+         outValues[i] = fetchedValue;
+         outRcs[i] = 0;
+         cache_store_fetched_value(params[i], fetchedValue);
+         fetched++;
+         next = slot + 1;
+      }
+      if (props) rbusProperty_Release(props);
+   } else if (n == 1 || provider_lost(rc)) {
+      /* Retrying would only repeat the same answer (or the same timeout) */
+      LOGD("rbus_getExt of %d names failed: %d", n, rc);
+      if (n == 1) note_rbus_failure(names[0], rc);
+      else drop_component_routes(owner, rc);
+      for (int j = 0; j < n; j++) outRcs[idx[j]] = -(rc + 100);
+   } else {
+      /* A single bad name fails the whole batch; retry one by one for per-name status.
+       * fetch_typed, not rbus_adapter_get_typed: this caller owns the names' inflight entries.
+       */
+      LOGD("rbus_getExt batch of %d failed: %d, retrying individually", n, rc);
+      for (int j = 0; j < n; j++) {
+         int i = idx[j];
+         outRcs[i] = fetch_typed(params[i], &outValues[i]);
+         if (outRcs[i] == 0) fetched++;
+      }
+   }
+   return fetched;
+}
+
+int rbus_adapter_get_typed_bulk_ref(const char** params, int count, cache_value_t** outValues, int* outRcs) {
+   if (!g_handle || !params || count <= 0 || !outValues || !outRcs) return -1;
+
+   PERF_SCOPE(timer, "rbus_get_bulk", PERF_CAT_RBUS);
+
+   int* missIdx = (int*)malloc(sizeof(int) * count);
+   const char** missNames = (const char**)malloc(sizeof(char*) * count);
+   if (!missIdx || !missNames) {
+      free(missIdx); free(missNames);
+      perf_scope_end(&timer);
+      return -4;
+   }
+
+   /* Cache pass: anything not served here goes into one batched RBUS call */
+   int fetched = 0, misses = 0;
+   uint64_t span = TRACE_SPAN_START();
+   for (int i = 0; i < count; i++) {
+      outValues[i] = NULL; outRcs[i] = -2;
+      if (!params[i]) { outRcs[i] = -1; continue; }
+      cache_value_t* cached = cache_acquire(params[i]);
+      if (cached) {
+         outValues[i] = cached;
+         outRcs[i] = 0;
+         fetched++;
+         perf_hook_cache_operation("get", 1, 0.0);
+         continue;
+      }
+      perf_hook_cache_operation("get", 0, 0.0);
+      missIdx[misses] = i;
+      missNames[misses++] = params[i];
+   }
+   TRACE_SPAN_END(span, "cache_lookup", params[0], fetched);
+
+   /* Single-flight: join reads other callers already have in flight and register the
+    * rest, so only the names this caller owns go to RBUS. Every name is registered
+    * before anything is awaited and owned results are published before waiting, so
+    * two bulk reads sharing names cannot wait on each other.
+    */
+   inflight_t** ownFlights = misses > 0 ? (inflight_t**)malloc(sizeof(inflight_t*) * misses) : NULL;
+   inflight_t** joinFlights = misses > 0 ? (inflight_t**)malloc(sizeof(inflight_t*) * misses) : NULL;
+   int* joinIdx = misses > 0 ? (int*)malloc(sizeof(int) * misses) : NULL;
+   int owned = misses, joins = 0;
+   if (ownFlights && joinFlights && joinIdx) {
+      owned = 0;
+      pthread_mutex_lock(&g_inflight.mutex);
+      for (int j = 0; j < misses; j++) {
+         uint32_t hash = inflight_hash(missNames[j]);
+         inflight_t* flight = inflight_find_locked(missNames[j], hash);
+         if (flight) {
+            flight->waiters++;
+            joinFlights[joins] = flight;
+            joinIdx[joins++] = missIdx[j];
+            continue;
+         }
+         /* Without an entry the name is still fetched, just uncoalesced */
+         ownFlights[owned] = inflight_register_locked(missNames[j], hash);
+         missIdx[owned] = missIdx[j];
+         missNames[owned++] = missNames[j];
+      }
+      pthread_mutex_unlock(&g_inflight.mutex);
+   } else {
+      free(ownFlights);
+      ownFlights = NULL;
+   }
+
+   if (owned > 0) {
+      int* owners = (int*)malloc(sizeof(int) * owned);
+      int* groupIdx = (int*)malloc(sizeof(int) * owned);
+      const char** groupNames = (const char**)malloc(sizeof(char*) * owned);
+      if (owners && groupIdx && groupNames) {
+         resolve_components(missNames, owned, owners);
+         /* One rbus_getExt per provider, so a bad or unreachable provider only costs its own names */
+         for (int j = 0; j < owned; j++) {
+            int owner = owners[j];
+            if (owner == OWNER_GROUPED) continue;
+            if (owner == CACHE_COMPONENT_MISSING) {
+               outRcs[missIdx[j]] = -(RBUS_ERROR_ELEMENT_DOES_NOT_EXIST + 100);
+               continue;
+            }
+            int n = 0;
+            for (int k = j; k < owned; k++) {
+               if (owners[k] != owner) continue;
+               groupIdx[n] = missIdx[k];
+               groupNames[n++] = missNames[k];
+               owners[k] = OWNER_GROUPED;
+            }
+            fetched += get_group(params, groupIdx, groupNames, n, owner, outValues, outRcs);
+         }
+      } else {
+         fetched += get_group(params, missIdx, missNames, owned, CACHE_COMPONENT_UNKNOWN, outValues, outRcs);
+      }
+      free(owners);
+      free(groupIdx);
+      free(groupNames);
+   }
+
+   for (int j = 0; ownFlights && j < owned; j++) {
+      int i = missIdx[j];
+      if (!ownFlights[j]) continue;
+      inflight_publish(ownFlights[j], outRcs[i], outRcs[i] == 0 ? cache_value_retain(outValues[i]) : NULL);
+   }
+   if (joins > 0) {
+      pthread_mutex_lock(&g_inflight.mutex);
+      for (int j = 0; j < joins; j++) {
+         inflight_t* flight = joinFlights[j];
+         int i = joinIdx[j];
+         while (!flight->done) pthread_cond_wait(&flight->cond, &g_inflight.mutex);
+         outRcs[i] = flight->rc;
+         if (flight->rc == 0) {
+            outValues[i] = cache_value_retain(flight->value);
+            fetched++;
+         }
+         if (--flight->waiters == 0) inflight_free(flight);
+         perf_hook_rbus_get_coalesced();
+      }
+      pthread_mutex_unlock(&g_inflight.mutex);
+   }
+   free(ownFlights);
+   free(joinFlights);
+   free(joinIdx);
+
+   if (timer.active) {
+      double latency = perf_scope_end(&timer);
+      if (misses > 0) perf_hook_rbus_operation("get_bulk", missNames[0], latency, fetched == count);
+   }
+   free(missIdx);
+   free(missNames);
+   return fetched;
+}
+
+int rbus_adapter_get_typed_bulk(const char** params, int count, char** outValues, int* outTypes, int* outRcs) {
+   if (!params || count <= 0 || !outValues || !outTypes || !outRcs) return -1;
+   cache_value_t** refs = (cache_value_t**)calloc(count, sizeof(cache_value_t*));
+   if (!refs) return -4;
+   int fetched = rbus_adapter_get_typed_bulk_ref(params, count, refs, outRcs);
+   for (int i = 0; i < count; i++) {
+      outValues[i] = NULL; outTypes[i] = 0;
+      if (fetched >= 0 && refs[i]) {
+         outValues[i] = strdup(refs[i]->data);
+         outTypes[i] = refs[i]->dataType;
+         if (!outValues[i]) { outRcs[i] = -3; fetched--; }
+      }
+      cache_release(refs[i]);
+   }
+   free(refs);
+   return fetched;
 }
 
 int rbus_adapter_set(const char* param, const char* value) {
    if (!g_handle || !param || !value) return -1;
    
-   perf_timer_t* timer = perf_timer_start("rbus_set", PERF_CAT_RBUS);
+   PERF_SCOPE(timer, "rbus_set", PERF_CAT_RBUS);
+   
+   if (cache_component_lookup(param) == CACHE_COMPONENT_MISSING) {
+      LOGD("Parameter %s was recently reported nonexistent", param);
+      perf_scope_end(&timer);
+      return -2;
+   }
    
    rbusValue_t val = NULL;
    rbusValue_Init(&val);
    rbusValue_SetString(val, value); /* Initial version: treat all as strings */
+   uint64_t span = TRACE_SPAN_START();
    rbusError_t rc = rbus_set(g_handle, param, val, NULL);
+   TRACE_SPAN_END(span, "rbus_set", param, rc);
    rbusValue_Release(val);
    
-   double latency = timer ? perf_timer_elapsed_ms(timer) : 0.0;
+   double latency = perf_scope_elapsed_ms(&timer);
    int success = (rc == RBUS_ERROR_SUCCESS);
    
    if (rc != RBUS_ERROR_SUCCESS) {
       LOGW("rbus_set(%s) failed: %d", param, rc);
-      if (timer) {
-         perf_timer_stop(timer);
+      note_rbus_failure(param, rc);
+      if (timer.active) {
+         perf_scope_end(&timer);
          perf_hook_rbus_operation("set", param, latency, 0);
       }
       return -2;
    }
    
    /* Invalidate cache for this parameter on successful set */
-   cache_invalidate_parameter(param);
+   invalidate_written(param);
    
-   if (timer) {
-      perf_timer_stop(timer);
+   if (timer.active) {
+      perf_scope_end(&timer);
       perf_hook_rbus_operation("set", param, latency, 1);
    }
    
    return 0;
 }
 
+/* One committed rbus_setMulti for params[members[0..n)]; invalidates them on success */
+static rbusError_t set_group(const table_param_t* params, const int* members, int n) {
+   rbusProperty_t head = NULL;
+   rbusProperty_t tail = NULL;
+   for (int j = 0; j < n; j++) {
+      const table_param_t* p = &params[members[j]];
+      
+      rbusValue_t val = NULL;
+      rbusValue_Init(&val);
+      set_value_from_webpa(val, p->value, p->dataType);
+      
+      rbusProperty_t prop = NULL;
+      rbusProperty_Init(&prop, p->name, val);
+      rbusValue_Release(val); /* property holds its own reference */
+      
+      if (!head) head = prop;
+      else rbusProperty_Append(tail, prop);
+      tail = prop;
+   }
+   
+   rbusSetOptions_t opts = { .commit = true, .sessionId = 0 };
+   uint64_t span = TRACE_SPAN_START();
+   rbusError_t rc = rbus_setMulti(g_handle, n, head, &opts);
+   TRACE_SPAN_END(span, "rbus_setMulti", params[members[0]].name, rc);
+   rbusProperty_Release(head);
+   
+   if (rc != RBUS_ERROR_SUCCESS) {
+      LOGW("rbus_setMulti(%d params, first %s) failed: %d", n, params[members[0]].name, rc);
+      return rc;
+   }
+   for (int j = 0; j < n; j++) invalidate_written(params[members[j]].name);
+   return rc;
+}
+
+int rbus_adapter_set_typed_bulk(const table_param_t* params, int count) {
+   return rbus_adapter_set_typed_bulk_committed(params, count, NULL);
+}
+
+int rbus_adapter_set_typed_bulk_committed(const table_param_t* params, int count, int* committed) {
+   if (committed && count > 0) memset(committed, 0, sizeof(int) * count);
+   if (!g_handle || !params || count <= 0) return -1;
+   
+   PERF_SCOPE(timer, "rbus_set_multi", PERF_CAT_RBUS);
+   
+   int* slots = (int*)malloc(sizeof(int) * count);
+   const char** names = (const char**)malloc(sizeof(char*) * count);
+   int* owners = (int*)malloc(sizeof(int) * count);
+   int* members = (int*)malloc(sizeof(int) * count);
+   int result = (slots && names && owners && members) ? 0 : -4;
+   int n = 0;
+   for (int i = 0; result == 0 && i < count; i++) {
+      if (!params[i].name || !params[i].value) continue;
+      slots[n] = i;
+      names[n++] = params[i].name;
+   }
+   if (result == 0 && n == 0) result = -1;
+   
+   if (result == 0) {
+      resolve_components(names, n, owners);
+      for (int j = 0; j < n; j++) {
+         if (owners[j] != CACHE_COMPONENT_MISSING) continue;
+         /* RBUS would reject the whole batch for it anyway */
+         LOGW("rbus_setMulti skipped: %s was recently reported nonexistent", names[j]);
+         result = -2;
+         break;
+      }
+   }
+   
+   /* One committed rbus_setMulti per provider; RBUS splits a mixed batch the same way */
+   for (int j = 0; j < n && result == 0; j++) {
+      int owner = owners[j];
+      if (owner == OWNER_GROUPED) continue;
+      int m = 0;
+      for (int k = j; k < n; k++) {
+         if (owners[k] != owner) continue;
+         members[m++] = slots[k];
+         owners[k] = OWNER_GROUPED;
+      }
+      rbusError_t rc = set_group(params, members, m);
+      if (rc != RBUS_ERROR_SUCCESS) {
+         if (provider_lost(rc)) drop_component_routes(owner, rc);
+         else if (m == 1) note_rbus_failure(params[members[0]].name, rc);
+         result = -2;
+      } else if (committed) {
+         for (int k = 0; k < m; k++) committed[members[k]] = 1;
+      }
+   }
+   
+   if (timer.active) {
+      double latency = perf_scope_end(&timer);
+      perf_hook_rbus_operation("set_multi", n > 0 ? names[0] : params[0].name, latency, result == 0);
+   }
+   free(slots);
+   free(names);
+   free(owners);
+   free(members);
+   return result;
+}
+
 int rbus_adapter_subscribe(const char* eventName) {
    if (!g_handle || !eventName) return -1;
    rbusError_t rc = rbusEvent_Subscribe(g_handle, eventName, event_cb, NULL, 0);
@@ -234,7 +943,9 @@ int rbus_adapter_expand_wildcard(const char* prefix, char*** list, int* count){
    const char* query = prefix;
    int numProps = 0;
    rbusProperty_t props = NULL; /* head of linked list */
+   uint64_t span = TRACE_SPAN_START();
    rbusError_t rc = rbus_getExt(g_handle, 1, &query, &numProps, &props);
+   TRACE_SPAN_END(span, "rbus_getExt", prefix, rc);
    if(rc != RBUS_ERROR_SUCCESS){
       LOGW("rbus_getExt(%s) failed: %d", prefix, rc);
       return -3;
@@ -259,6 +970,84 @@ int rbus_adapter_expand_wildcard(const char* prefix, char*** list, int* count){
    return 0;
 }
 
+int rbus_adapter_get_wildcard(const char* prefix, table_param_t** list, int* count, bool fillCache){
+   if(!g_handle || !prefix || !list || !count) return -1;
+   *list = NULL; *count = 0;
+   size_t len = strlen(prefix);
+   if(len == 0 || prefix[len-1] != '.') return -2; /* not wildcard */
+
+   if(fillCache && get_wildcard_cached(prefix, list, count) == 0){
+      perf_hook_cache_operation("get_wildcard", 1, 0.0);
+      return 0;
+   }
+
+   PERF_SCOPE(timer, "rbus_get_wildcard", PERF_CAT_RBUS);
+
+   const char* query = prefix;
+   int numProps = 0;
+   rbusProperty_t props = NULL;
+   uint64_t span = TRACE_SPAN_START();
+   rbusError_t rc = rbus_getExt(g_handle, 1, &query, &numProps, &props);
+   TRACE_SPAN_END(span, "rbus_getExt", prefix, rc);
+   double latency = perf_scope_elapsed_ms(&timer);
+   if(rc != RBUS_ERROR_SUCCESS){
+      LOGW("rbus_getExt(%s) failed: %d", prefix, rc);
+      if (timer.active) {
+         perf_scope_end(&timer);
+         perf_hook_rbus_operation("get_wildcard", prefix, latency, 0);
+      }
+      return -3;
+   }
+   int n = 0;
+   for(rbusProperty_t cur = props; cur; cur = rbusProperty_GetNext(cur)) n++;
+   if(n == 0){
+      if(props) rbusProperty_Release(props);
+      if(fillCache) cache_mark_subtree_complete(prefix);
+      if (timer.active) {
+         perf_scope_end(&timer);
+         perf_hook_rbus_operation("get_wildcard", prefix, latency, 1);
+      }
+      return 0;
+   }
+   table_param_t* arr = (table_param_t*)calloc(n, sizeof(table_param_t));
+   if(!arr){
+      rbusProperty_Release(props);
+      perf_scope_end(&timer);
+      return -4;
+   }
+   int i = 0;
+   int allCached = 1;
+   for(rbusProperty_t cur = props; cur; cur = rbusProperty_GetNext(cur)){
+      const char* fullName = rbusProperty_GetName(cur);
+      rbusValue_t value = rbusProperty_GetValue(cur);
+      char* str = value ? rbusValue_ToString(value, NULL, 0) : NULL;
+      arr[i].name = strdup(fullName ? fullName : "");
+      arr[i].value = str ? str : strdup("");
+      arr[i].dataType = value ? map_rbus_to_webpa_type(rbusValue_GetType(value)) : 10;
+      if(fillCache && !(fullName && str && cache_store_fetched(fullName, str, arr[i].dataType) == 0)) allCached = 0;
+      i++;
+   }
+   rbusProperty_Release(props);
+   *list = arr; *count = n;
+   /* every child is now cached, so repeat GETs of this prefix can skip RBUS */
+   if(fillCache && allCached) cache_mark_subtree_complete(prefix);
+
+   if (timer.active) {
+      perf_scope_end(&timer);
+      perf_hook_rbus_operation("get_wildcard", prefix, latency, 1);
+   }
+   return 0;
+}
+
+void rbus_adapter_free_params(table_param_t* list, int count){
+   if(!list) return;
+   for(int i = 0; i < count; i++){
+      free(list[i].name);
+      free(list[i].value);
+   }
+   free(list);
+}
+
 /* Table Operations */
 
 int rbus_adapter_add_table_row(const char* tableName, table_row_t* rowData, char** newRowName) {
@@ -266,52 +1055,57 @@ int rbus_adapter_add_table_row(const char* tableName, table_row_t* rowData, char
    
    /* RBUS table add creates a new row instance */
    uint32_t instNum = 0;
+   uint64_t span = TRACE_SPAN_START();
    rbusError_t rc = rbusTable_addRow(g_handle, tableName, NULL, &instNum);
+   TRACE_SPAN_END(span, "rbusTable_addRow", tableName, rc);
    if (rc != RBUS_ERROR_SUCCESS) {
       LOGW("rbusTable_addRow(%s) failed: %d", tableName, rc);
       return -2;
    }
    
+   /* The table gained a row: cached enumerations of it are stale */
+   char tablePattern[512];
+   snprintf(tablePattern, sizeof(tablePattern), "%s*", tableName);
+   cache_invalidate_wildcard(tablePattern);
+   cache_component_forget_missing(tableName);
+   
    /* Generate the new row name */
    *newRowName = malloc(256);
+   if (!*newRowName) return -3;
    snprintf(*newRowName, 256, "%s%u.", tableName, instNum);
    
-   /* Set parameters in the new row */
-   for (int i = 0; i < rowData->paramCount; i++) {
-      if (rowData->params[i].name && rowData->params[i].value) {
-         char paramPath[512];
-         snprintf(paramPath, sizeof(paramPath), "%s%u.%s", tableName, instNum, rowData->params[i].name);
-         
-         rbusValue_t val = NULL;
-         rbusValue_Init(&val);
-         
-         /* Set value based on data type */
-         switch (rowData->params[i].dataType) {
-            case 3: /* boolean */
-               rbusValue_SetBoolean(val, strcmp(rowData->params[i].value, "true") == 0);
-               break;
-            case 1: /* int */
-               rbusValue_SetInt32(val, atoi(rowData->params[i].value));
-               break;
-            case 2: /* uint */
-               rbusValue_SetUInt32(val, (uint32_t)atoi(rowData->params[i].value));
-               break;
-            case 4: /* double */
-               rbusValue_SetDouble(val, atof(rowData->params[i].value));
-               break;
-            default: /* string */
-               rbusValue_SetString(val, rowData->params[i].value);
-               break;
-         }
-         
-         rbusError_t setRc = rbus_set(g_handle, paramPath, val, NULL);
-         rbusValue_Release(val);
-         
-         if (setRc != RBUS_ERROR_SUCCESS) {
-            LOGW("rbus_set(%s) failed: %d", paramPath, setRc);
-            /* Continue setting other parameters */
-         }
+   /* Set parameters in the new row with a single committed rbus_setMulti */
+   if (rowData->paramCount > 0) {
+      table_param_t* rowParams = calloc(rowData->paramCount, sizeof(table_param_t));
+      char** paths = calloc(rowData->paramCount, sizeof(char*));
+      if (!rowParams || !paths) {
+         free(rowParams);
+         free(paths);
+         free(*newRowName);
+         *newRowName = NULL;
+         return -3;
+      }
+      int toSet = 0;
+      for (int i = 0; i < rowData->paramCount; i++) {
+         if (!rowData->params[i].name || !rowData->params[i].value) continue;
+         size_t len = strlen(tableName) + strlen(rowData->params[i].name) + 16;
+         paths[i] = malloc(len);
+         if (!paths[i]) continue;
+         snprintf(paths[i], len, "%s%u.%s", tableName, instNum, rowData->params[i].name);
+         rowParams[i].name = paths[i];
+         rowParams[i].value = rowData->params[i].value;
+         rowParams[i].dataType = rowData->params[i].dataType;
+         toSet++;
+      }
+      
+      if (toSet > 0 && rbus_adapter_set_typed_bulk(rowParams, rowData->paramCount) != 0) {
+         LOGW("Setting row parameters of %s failed", *newRowName);
+         /* The row exists; report it as before and leave its values to the provider */
       }
+      
+      for (int i = 0; i < rowData->paramCount; i++) free(paths[i]);
+      free(paths);
+      free(rowParams);
    }
    
    return 0;
@@ -322,12 +1116,19 @@ int rbus_adapter_add_table_row(const char* tableName, table_row_t* rowData, char
 int rbus_adapter_delete_table_row(const char* rowName) {
    if (!g_handle || !rowName) return -1;
    
+   uint64_t span = TRACE_SPAN_START();
    rbusError_t rc = rbusTable_removeRow(g_handle, rowName);
+   TRACE_SPAN_END(span, "rbusTable_removeRow", rowName, rc);
    if (rc != RBUS_ERROR_SUCCESS) {
       LOGW("rbusTable_removeRow(%s) failed: %d", rowName, rc);
       return -2;
    }
    
+   /* Drop the row's cached values; this also unmarks the table as complete */
+   char rowPattern[512];
+   snprintf(rowPattern, sizeof(rowPattern), "%s*", rowName);
+   cache_invalidate_wildcard(rowPattern);
+   
    return 0;
 }
 
@@ -389,7 +1190,9 @@ int rbus_adapter_get_attributes(const char* param, param_attribute_t* attr) {
    
    /* Try to get the parameter to check if it exists and is readable */
    rbusValue_t value = NULL;
+   uint64_t span = TRACE_SPAN_START();
    rbusError_t rc = rbus_get(g_handle, param, &value);
+   TRACE_SPAN_END(span, "rbus_get", param, rc);
    if (rc == RBUS_ERROR_SUCCESS) {
       rbusValue_Release(value);
       /* Parameter exists and is readable */
@@ -429,7 +1232,9 @@ int rbus_adapter_set_attributes(const char* param, const param_attribute_t* attr
    
    /* Check if parameter exists */
    rbusValue_t value = NULL;
+   uint64_t span = TRACE_SPAN_START();
    rbusError_t rc = rbus_get(g_handle, param, &value);
+   TRACE_SPAN_END(span, "rbus_get", param, rc);
    if (rc == RBUS_ERROR_SUCCESS) {
       rbusValue_Release(value);
       
@@ -458,7 +1263,9 @@ int rbus_adapter_test_and_set(const test_and_set_t* tas) {
    
    /* Step 1: Get current value */
    rbusValue_t currentValue = NULL;
+   uint64_t span = TRACE_SPAN_START();
    rbusError_t rc = rbus_get(g_handle, tas->param, &currentValue);
+   TRACE_SPAN_END(span, "rbus_get", tas->param, rc);
    if (rc != RBUS_ERROR_SUCCESS) {
       LOGW("TEST_AND_SET: Failed to get current value for %s: %d", tas->param, rc);
       return -(rc + 100); /* Offset RBUS errors by 100 */
@@ -486,23 +1293,11 @@ int rbus_adapter_test_and_set(const test_and_set_t* tas) {
    rbusValue_t newValue = NULL;
    rbusValue_Init(&newValue);
    
-   /* Set value based on data type */
-   switch (tas->dataType) {
-      case 3: /* Boolean */
-         rbusValue_SetBoolean(newValue, (strcmp(tas->newValue, "true") == 0));
-         break;
-      case 1: /* Integer */
-         rbusValue_SetInt32(newValue, atoi(tas->newValue));
-         break;
-      case 2: /* Unsigned integer */
-         rbusValue_SetUInt32(newValue, (uint32_t)atoi(tas->newValue));
-         break;
-      default: /* String (0) and others */
-         rbusValue_SetString(newValue, tas->newValue);
-         break;
-   }
+   set_value_from_webpa(newValue, tas->newValue, tas->dataType);
    
+   span = TRACE_SPAN_START();
    rc = rbus_set(g_handle, tas->param, newValue, NULL);
+   TRACE_SPAN_END(span, "rbus_set", tas->param, rc);
    rbusValue_Release(newValue);
    
    if (rc == RBUS_ERROR_SUCCESS) {
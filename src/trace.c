@@ -0,0 +1,268 @@
+#include "trace.h"
+#include "performance.h"
+#include "log.h"
+#include <cJSON.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TRACE_RING_DEFAULT 256
+
+__thread trace_t* t_trace_current = NULL;
+
+static struct {
+    int enabled;
+    trace_config_t config;
+    uint64_t requests;          /* Requests seen, for 1-in-N sampling */
+    pthread_mutex_t mutex;      /* Guards the ring and the writer position */
+    pthread_cond_t cond;        /* Signalled when a trace is kept or on stop */
+    trace_t** ring;
+    int ring_size;
+    uint64_t kept;              /* Traces ever kept; the newest is at (kept - 1) % ring_size */
+    uint64_t written;           /* Next trace the writer streams out */
+    uint64_t lost;              /* Kept traces overwritten before the writer reached them */
+    FILE* output;
+    pthread_t writer;
+    int writer_running;
+    int stop;
+    perf_metric_id_t kept_id;
+    perf_metric_id_t lost_id;
+} g_trace = { .mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+uint64_t trace_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void copy_bounded(char* dst, size_t size, const char* src) {
+    size_t len = src ? strlen(src) : 0;
+    if (len >= size) len = size - 1;
+    if (len > 0) memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+trace_t* trace_begin(const char* id) {
+    if (!__atomic_load_n(&g_trace.enabled, __ATOMIC_RELAXED)) return NULL;
+
+    int sampled = 0;
+    if (g_trace.config.sample_every > 0) {
+        uint64_t n = __atomic_fetch_add(&g_trace.requests, 1, __ATOMIC_RELAXED);
+        sampled = n % (uint64_t)g_trace.config.sample_every == 0;
+    }
+    /* Without a slow threshold only sampled requests are worth recording */
+    if (!sampled && g_trace.config.slow_ms <= 0) return NULL;
+
+    trace_t* trace = malloc(sizeof(trace_t));
+    if (!trace) return NULL;
+    copy_bounded(trace->id, sizeof(trace->id), id);
+    trace->op[0] = '\0';
+    trace->status = 0;
+    trace->sampled = sampled;
+    trace->span_count = 0;
+    trace->spans_dropped = 0;
+    trace->duration_us = 0;
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    trace->start_wall = (double)wall.tv_sec + (double)(wall.tv_nsec / 1000) / 1000000.0;
+    trace->start_ns = trace_now_ns();
+    return trace;
+}
+
+void trace_set_id(trace_t* trace, const char* id) {
+    if (trace && id) copy_bounded(trace->id, sizeof(trace->id), id);
+}
+
+void trace_set_result(trace_t* trace, const char* op, int status) {
+    if (!trace) return;
+    if (op) copy_bounded(trace->op, sizeof(trace->op), op);
+    trace->status = status;
+}
+
+void trace_span_record(const char* name, const char* detail, uint64_t start_ns, int code) {
+    trace_t* trace = t_trace_current;
+    if (!trace) return;
+    if (trace->span_count >= TRACE_SPANS_MAX) {
+        trace->spans_dropped++;
+        return;
+    }
+    uint64_t now = trace_now_ns();
+    trace_span_t* span = &trace->spans[trace->span_count++];
+    span->name = name;
+    copy_bounded(span->detail, sizeof(span->detail), detail);
+    span->start_us = start_ns > trace->start_ns ? (uint32_t)((start_ns - trace->start_ns) / 1000) : 0;
+    span->duration_us = now > start_ns ? (uint32_t)((now - start_ns) / 1000) : 0;
+    span->code = code;
+}
+
+void trace_finish(trace_t* trace) {
+    if (!trace) return;
+    if (t_trace_current == trace) t_trace_current = NULL;
+
+    uint64_t elapsed = trace_now_ns() - trace->start_ns;
+    trace->duration_us = (uint32_t)(elapsed / 1000);
+    int slow = g_trace.config.slow_ms > 0 && elapsed >= (uint64_t)g_trace.config.slow_ms * 1000000ULL;
+    if (!trace->sampled && !slow) {
+        free(trace);
+        return;
+    }
+
+    pthread_mutex_lock(&g_trace.mutex);
+    if (!g_trace.ring) {
+        /* Finished after trace_cleanup */
+        pthread_mutex_unlock(&g_trace.mutex);
+        free(trace);
+        return;
+    }
+    trace_t** slot = &g_trace.ring[g_trace.kept % (uint64_t)g_trace.ring_size];
+    trace_t* old = *slot;
+    *slot = trace;
+    g_trace.kept++;
+    if (g_trace.writer_running) pthread_cond_signal(&g_trace.cond);
+    pthread_mutex_unlock(&g_trace.mutex);
+    free(old);
+    perf_counter_add_id(g_trace.kept_id, 1);
+}
+
+static cJSON* trace_to_json(const trace_t* trace) {
+    cJSON* obj = cJSON_CreateObject();
+    if (!obj) return NULL;
+    cJSON_AddStringToObject(obj, "id", trace->id);
+    if (trace->op[0]) cJSON_AddStringToObject(obj, "op", trace->op);
+    cJSON_AddNumberToObject(obj, "status", trace->status);
+    cJSON_AddNumberToObject(obj, "ts", trace->start_wall);
+    cJSON_AddNumberToObject(obj, "duration_ms", trace->duration_us / 1000.0);
+    cJSON_AddBoolToObject(obj, "sampled", trace->sampled);
+    if (trace->spans_dropped > 0) cJSON_AddNumberToObject(obj, "spans_dropped", trace->spans_dropped);
+    cJSON* spans = cJSON_AddArrayToObject(obj, "spans");
+    for (int i = 0; i < trace->span_count && spans; i++) {
+        const trace_span_t* span = &trace->spans[i];
+        cJSON* item = cJSON_CreateObject();
+        if (!item) break;
+        cJSON_AddStringToObject(item, "name", span->name);
+        if (span->detail[0]) cJSON_AddStringToObject(item, "detail", span->detail);
+        cJSON_AddNumberToObject(item, "start_ms", span->start_us / 1000.0);
+        cJSON_AddNumberToObject(item, "duration_ms", span->duration_us / 1000.0);
+        cJSON_AddNumberToObject(item, "code", span->code);
+        cJSON_AddItemToArray(spans, item);
+    }
+    return obj;
+}
+
+char* trace_dump_json(void) {
+    cJSON* root = cJSON_CreateObject();
+    if (!root) return NULL;
+    cJSON_AddBoolToObject(root, "enabled", __atomic_load_n(&g_trace.enabled, __ATOMIC_RELAXED));
+    cJSON_AddNumberToObject(root, "sample_every", g_trace.config.sample_every);
+    cJSON_AddNumberToObject(root, "slow_ms", g_trace.config.slow_ms);
+    cJSON* traces = cJSON_AddArrayToObject(root, "traces");
+
+    pthread_mutex_lock(&g_trace.mutex);
+    cJSON_AddNumberToObject(root, "kept", (double)g_trace.kept);
+    uint64_t size = (uint64_t)g_trace.ring_size;
+    uint64_t first = g_trace.kept > size ? g_trace.kept - size : 0;
+    for (uint64_t seq = first; g_trace.ring && seq < g_trace.kept && traces; seq++) {
+        cJSON* item = trace_to_json(g_trace.ring[seq % size]);
+        if (item) cJSON_AddItemToArray(traces, item);
+    }
+    pthread_mutex_unlock(&g_trace.mutex);
+
+    char* out = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return out;
+}
+
+/* Streams kept traces to the output file so the request path never does file I/O */
+static void* trace_writer_thread(void* arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&g_trace.mutex);
+        while (!g_trace.stop && g_trace.written == g_trace.kept) pthread_cond_wait(&g_trace.cond, &g_trace.mutex);
+        if (g_trace.written == g_trace.kept) {
+            pthread_mutex_unlock(&g_trace.mutex);
+            break;
+        }
+        uint64_t size = (uint64_t)g_trace.ring_size;
+        if (g_trace.kept - g_trace.written > size) {
+            uint64_t skipped = g_trace.kept - g_trace.written - size;
+            g_trace.lost += skipped;
+            g_trace.written += skipped;
+            perf_counter_add_id(g_trace.lost_id, skipped);
+        }
+        cJSON* obj = trace_to_json(g_trace.ring[g_trace.written % size]);
+        g_trace.written++;
+        pthread_mutex_unlock(&g_trace.mutex);
+
+        char* line = obj ? cJSON_PrintUnformatted(obj) : NULL;
+        cJSON_Delete(obj);
+        if (line) {
+            fputs(line, g_trace.output);
+            fputc('\n', g_trace.output);
+            fflush(g_trace.output);
+            free(line);
+        }
+    }
+    return NULL;
+}
+
+int trace_init(const trace_config_t* config) {
+    if (!config || g_trace.ring) return -1;
+    if (config->sample_every <= 0 && config->slow_ms <= 0) return 0;
+
+    g_trace.config = *config;
+    g_trace.ring_size = config->ring_size > 0 ? config->ring_size : TRACE_RING_DEFAULT;
+    g_trace.ring = calloc((size_t)g_trace.ring_size, sizeof(trace_t*));
+    if (!g_trace.ring) return -1;
+    g_trace.kept = g_trace.written = g_trace.lost = 0;
+    g_trace.requests = 0;
+    g_trace.stop = 0;
+    g_trace.kept_id = perf_metric_id("trace.kept", PERF_METRIC_COUNTER, PERF_CAT_SYSTEM);
+    g_trace.lost_id = perf_metric_id("trace.stream_lost", PERF_METRIC_COUNTER, PERF_CAT_SYSTEM);
+
+    if (config->output) {
+        g_trace.output = fopen(config->output, "a");
+        if (!g_trace.output) {
+            LOGW("Cannot open trace output %s: %s", config->output, strerror(errno));
+        } else if (pthread_create(&g_trace.writer, NULL, trace_writer_thread, NULL) != 0) {
+            LOGW("Failed to start trace writer: %s", "traces are kept in memory only");
+            fclose(g_trace.output);
+            g_trace.output = NULL;
+        } else {
+            g_trace.writer_running = 1;
+        }
+    }
+
+    __atomic_store_n(&g_trace.enabled, 1, __ATOMIC_RELAXED);
+    LOGI("Tracing enabled: sample_every=%d slow_ms=%d ring=%d output=%s", g_trace.config.sample_every,
+         g_trace.config.slow_ms, g_trace.ring_size, g_trace.output ? config->output : "none");
+    return 0;
+}
+
+void trace_cleanup(void) {
+    if (!g_trace.ring) return;
+    __atomic_store_n(&g_trace.enabled, 0, __ATOMIC_RELAXED);
+
+    if (g_trace.writer_running) {
+        pthread_mutex_lock(&g_trace.mutex);
+        g_trace.stop = 1;
+        pthread_cond_signal(&g_trace.cond);
+        pthread_mutex_unlock(&g_trace.mutex);
+        pthread_join(g_trace.writer, NULL);
+        g_trace.writer_running = 0;
+    }
+    if (g_trace.output) {
+        fclose(g_trace.output);
+        g_trace.output = NULL;
+    }
+    if (g_trace.lost > 0) LOGW("Trace output fell behind: %llu traces not written", (unsigned long long)g_trace.lost);
+
+    pthread_mutex_lock(&g_trace.mutex);
+    for (int i = 0; i < g_trace.ring_size; i++) free(g_trace.ring[i]);
+    free(g_trace.ring);
+    g_trace.ring = NULL;
+    g_trace.ring_size = 0;
+    pthread_mutex_unlock(&g_trace.mutex);
+}
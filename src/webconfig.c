@@ -3,7 +3,12 @@
 #include "cache.h"
 #include "notification.h"
 #include "performance.h"
+#include "dispatcher.h"
 #include "log.h"
+#ifdef WEBCONFIG_BIN_SUPPORT
+#include "arena.h"
+#include "msgpack_lite.h"
+#endif
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -20,16 +25,75 @@ static struct {
     webconfig_stats_t stats;
     pthread_mutex_t mutex;
     webconfig_notification_callback_t notification_callback;
+    dispatcher_t* async_dispatcher;
     int initialized;
 } g_webconfig = {0};
 
-/* Transaction storage (simplified - in production would use persistent storage) */
+/* Pre-image of the parameters a transaction writes, restored if it fails */
+typedef struct {
+    table_param_t* params;
+    int count;
+} webconfig_snapshot_t;
+
+/* Snapshots waiting to be written to backup_directory by the spill thread */
+typedef struct spill_entry {
+    struct spill_entry* next;
+    char* path;
+    char* json;
+} spill_entry_t;
+
+static struct {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    spill_entry_t* head;
+    spill_entry_t* tail;
+    int running;
+    int stop;
+} g_spill = { .mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+/* Transaction table: bounded and indexed by transaction id. Records are linked in
+ * arrival order; when the table is full the oldest finished record is evicted.
+ * Async results stay in their record until taken.
+ */
 #define MAX_ACTIVE_TRANSACTIONS 100
+#define TX_STORE_BUCKETS 128
+#define WEBCONFIG_ASYNC_WORKERS 4
+
+typedef struct tx_record {
+    char* transaction_id;
+    webconfig_status_t status;
+    webconfig_result_t* result;
+    struct tx_record* hash_next;
+    struct tx_record* older;
+    struct tx_record* newer;
+} tx_record_t;
+
 static struct {
-    webconfig_transaction_t* transactions[MAX_ACTIVE_TRANSACTIONS];
-    webconfig_result_t* results[MAX_ACTIVE_TRANSACTIONS];
+    pthread_mutex_t mutex;
+    tx_record_t* buckets[TX_STORE_BUCKETS];
+    tx_record_t* oldest;
+    tx_record_t* newest;
     int count;
-} g_transaction_store = {0};
+} g_transaction_store = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+/* Parameter sets of the transactions currently executing. A transaction waits until
+ * none of its names overlaps one in use, so only transactions touching the same
+ * parameters (or a parent object of them) are serialized.
+ */
+typedef struct tx_lock {
+    const webconfig_transaction_t* transaction;
+    struct tx_lock* next;
+} tx_lock_t;
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t released;
+    tx_lock_t* active;
+} g_tx_locks = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL };
+
+static void async_transaction_job(void* job);
+static void blob_remember(char** names, int count);
 
 /* Utility functions */
 static char* generate_transaction_id(void) {
@@ -58,6 +122,12 @@ static int map_rbus_error_to_webconfig(int rbus_error) {
     }
 }
 
+/* Set one parameter as its declared dataType; rbus_adapter_set would send it as a string */
+static int set_parameter_typed(const webconfig_param_t* param) {
+    table_param_t typed = { .name = param->name, .value = param->value, .dataType = param->dataType };
+    return rbus_adapter_set_typed_bulk(&typed, 1);
+}
+
 /* WebConfig parameter operations */
 static webconfig_param_result_t* execute_parameter_operation(const webconfig_param_t* param) {
     webconfig_param_result_t* result = calloc(1, sizeof(webconfig_param_result_t));
@@ -67,12 +137,12 @@ static webconfig_param_result_t* execute_parameter_operation(const webconfig_par
     result->status = WEBCONFIG_STATUS_FAILURE;
     result->error_code = 500;
     
-    perf_timer_t* timer = perf_timer_start("webconfig_param_op", PERF_CAT_WEBCONFIG);
+    PERF_SCOPE(timer, "webconfig_param_op", PERF_CAT_WEBCONFIG);
     
     int rbus_result = 0;
     switch (param->operation) {
         case WEBCONFIG_SET: {
-            rbus_result = rbus_adapter_set(param->name, param->value);
+            rbus_result = set_parameter_typed(param);
             if (rbus_result == 0) {
                 result->status = WEBCONFIG_STATUS_SUCCESS;
                 result->error_code = 200;
@@ -109,7 +179,7 @@ static webconfig_param_result_t* execute_parameter_operation(const webconfig_par
         
         case WEBCONFIG_REPLACE: {
             /* Same as SET for RBUS */
-            rbus_result = rbus_adapter_set(param->name, param->value);
+            rbus_result = set_parameter_typed(param);
             if (rbus_result == 0) {
                 result->status = WEBCONFIG_STATUS_SUCCESS;
                 result->error_code = 200;
@@ -130,7 +200,7 @@ static webconfig_param_result_t* execute_parameter_operation(const webconfig_par
                 free(existing_value);
             } else {
                 /* Parameter doesn't exist, proceed with SET */
-                rbus_result = rbus_adapter_set(param->name, param->value);
+                rbus_result = set_parameter_typed(param);
                 if (rbus_result == 0) {
                     result->status = WEBCONFIG_STATUS_SUCCESS;
                     result->error_code = 201; /* Created */
@@ -155,9 +225,8 @@ static webconfig_param_result_t* execute_parameter_operation(const webconfig_par
         }
     }
     
-    if (timer) {
-        double latency = perf_timer_elapsed_ms(timer);
-        perf_timer_stop(timer);
+    if (timer.active) {
+        double latency = perf_scope_end(&timer);
         perf_hook_webconfig_transaction("param_op", 1, latency, 
                                       result->status == WEBCONFIG_STATUS_SUCCESS);
     }
@@ -165,6 +234,382 @@ static webconfig_param_result_t* execute_parameter_operation(const webconfig_par
     return result;
 }
 
+/* Transaction table helpers; callers hold g_transaction_store.mutex */
+static unsigned int tx_hash(const char* id) {
+    unsigned int h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)id; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h % TX_STORE_BUCKETS;
+}
+
+static tx_record_t* tx_store_find(const char* id) {
+    for (tx_record_t* rec = g_transaction_store.buckets[tx_hash(id)]; rec; rec = rec->hash_next) {
+        if (strcmp(rec->transaction_id, id) == 0) return rec;
+    }
+    return NULL;
+}
+
+static void tx_store_remove(tx_record_t* rec) {
+    tx_record_t** link = &g_transaction_store.buckets[tx_hash(rec->transaction_id)];
+    while (*link && *link != rec) link = &(*link)->hash_next;
+    if (*link) *link = rec->hash_next;
+    
+    if (rec->older) rec->older->newer = rec->newer;
+    else g_transaction_store.oldest = rec->newer;
+    if (rec->newer) rec->newer->older = rec->older;
+    else g_transaction_store.newest = rec->older;
+    g_transaction_store.count--;
+    
+    webconfig_free_result(rec->result);
+    free(rec->transaction_id);
+    free(rec);
+}
+
+/* Add a pending record for id. Returns NULL if id is already pending or the table
+ * holds only pending transactions.
+ */
+static tx_record_t* tx_store_add(const char* id) {
+    tx_record_t* rec = tx_store_find(id);
+    if (rec) {
+        if (rec->status == WEBCONFIG_STATUS_PENDING) return NULL;
+        tx_store_remove(rec); /* id reused: the new run replaces the old record */
+    }
+    if (g_transaction_store.count >= MAX_ACTIVE_TRANSACTIONS) {
+        tx_record_t* victim = g_transaction_store.oldest;
+        while (victim && victim->status == WEBCONFIG_STATUS_PENDING) victim = victim->newer;
+        if (!victim) return NULL;
+        tx_store_remove(victim);
+    }
+    
+    rec = calloc(1, sizeof(tx_record_t));
+    if (!rec) return NULL;
+    rec->transaction_id = strdup(id);
+    if (!rec->transaction_id) {
+        free(rec);
+        return NULL;
+    }
+    rec->status = WEBCONFIG_STATUS_PENDING;
+    
+    unsigned int bucket = tx_hash(id);
+    rec->hash_next = g_transaction_store.buckets[bucket];
+    g_transaction_store.buckets[bucket] = rec;
+    rec->older = g_transaction_store.newest;
+    if (g_transaction_store.newest) g_transaction_store.newest->newer = rec;
+    else g_transaction_store.oldest = rec;
+    g_transaction_store.newest = rec;
+    g_transaction_store.count++;
+    return rec;
+}
+
+static void tx_store_clear(void) {
+    pthread_mutex_lock(&g_transaction_store.mutex);
+    while (g_transaction_store.oldest) tx_store_remove(g_transaction_store.oldest);
+    pthread_mutex_unlock(&g_transaction_store.mutex);
+}
+
+/* Record the outcome of id; the store takes ownership of result (may be NULL) */
+static void tx_store_finish(const char* id, webconfig_status_t status, webconfig_result_t* result) {
+    pthread_mutex_lock(&g_transaction_store.mutex);
+    tx_record_t* rec = tx_store_find(id);
+    if (rec) {
+        rec->status = status;
+        webconfig_free_result(rec->result);
+        rec->result = result;
+        result = NULL;
+    }
+    pthread_mutex_unlock(&g_transaction_store.mutex);
+    webconfig_free_result(result);
+}
+
+/* Parameter set locking: names overlap when one is a prefix of the other */
+static int tx_overlaps(const webconfig_transaction_t* a, const webconfig_transaction_t* b) {
+    for (int i = 0; i < a->param_count; i++) {
+        const char* na = a->parameters[i].name;
+        if (!na) continue;
+        size_t la = strlen(na);
+        for (int j = 0; j < b->param_count; j++) {
+            const char* nb = b->parameters[j].name;
+            if (!nb) continue;
+            size_t lb = strlen(nb);
+            if (strncmp(na, nb, la < lb ? la : lb) == 0) return 1;
+        }
+    }
+    return 0;
+}
+
+static void tx_lock_acquire(tx_lock_t* lock, const webconfig_transaction_t* transaction) {
+    lock->transaction = transaction;
+    
+    /* All names are taken at once, so waiting transactions cannot deadlock */
+    pthread_mutex_lock(&g_tx_locks.mutex);
+    for (;;) {
+        tx_lock_t* other = g_tx_locks.active;
+        while (other && !tx_overlaps(transaction, other->transaction)) other = other->next;
+        if (!other) break;
+        pthread_cond_wait(&g_tx_locks.released, &g_tx_locks.mutex);
+    }
+    lock->next = g_tx_locks.active;
+    g_tx_locks.active = lock;
+    pthread_mutex_unlock(&g_tx_locks.mutex);
+}
+
+static void tx_lock_release(tx_lock_t* lock) {
+    pthread_mutex_lock(&g_tx_locks.mutex);
+    tx_lock_t** link = &g_tx_locks.active;
+    while (*link && *link != lock) link = &(*link)->next;
+    if (*link) *link = lock->next;
+    pthread_cond_broadcast(&g_tx_locks.released);
+    pthread_mutex_unlock(&g_tx_locks.mutex);
+}
+
+/* Snapshot and spill helpers */
+static int snapshot_capture(const char** names, int count, webconfig_snapshot_t* snap) {
+    snap->params = NULL;
+    snap->count = 0;
+    if (count <= 0) return 0;
+    
+    char** values = calloc(count, sizeof(char*));
+    int* types = calloc(count, sizeof(int));
+    int* rcs = calloc(count, sizeof(int));
+    snap->params = calloc(count, sizeof(table_param_t));
+    if (!values || !types || !rcs || !snap->params) {
+        free(values); free(types); free(rcs);
+        free(snap->params); snap->params = NULL;
+        return -1;
+    }
+    
+    /* Cached values are used as is; the rest come from one rbus_getExt */
+    rbus_adapter_get_typed_bulk(names, count, values, types, rcs);
+    
+    for (int i = 0; i < count; i++) {
+        if (rcs[i] == 0 && values[i]) {
+            snap->params[snap->count].name = strdup(names[i]);
+            snap->params[snap->count].value = values[i];
+            snap->params[snap->count].dataType = types[i];
+            snap->count++;
+        } else {
+            /* Not readable (e.g. the target of an ADD): nothing to restore */
+            free(values[i]);
+        }
+    }
+    free(values); free(types); free(rcs);
+    return 0;
+}
+
+/* Restore only what a failed transaction actually wrote: the pre-images of the
+ * parameters among params[0..done) whose operation succeeded
+ */
+static int snapshot_restore_applied(const webconfig_snapshot_t* snap, const webconfig_param_t* params,
+                                    const webconfig_param_result_t* results, int done) {
+    if (snap->count == 0) return 0;
+    table_param_t* applied = calloc(snap->count, sizeof(table_param_t));
+    if (!applied) return -1;
+    int n = 0;
+    for (int j = 0; j < snap->count; j++) {
+        for (int k = 0; k < done; k++) {
+            if (results[k].status == WEBCONFIG_STATUS_SUCCESS && params[k].operation != WEBCONFIG_GET &&
+                strcmp(params[k].name, snap->params[j].name) == 0) {
+                applied[n++] = snap->params[j];
+                break;
+            }
+        }
+    }
+    int rc = n > 0 ? rbus_adapter_set_typed_bulk(applied, n) : 0;
+    free(applied);
+    return rc;
+}
+
+static void snapshot_free(webconfig_snapshot_t* snap) {
+    rbus_adapter_free_params(snap->params, snap->count);
+    snap->params = NULL;
+    snap->count = 0;
+}
+
+static char* snapshot_to_json(const char* backup_name, const webconfig_snapshot_t* snap) {
+    cJSON* root = cJSON_CreateObject();
+    if (!root) return NULL;
+    
+    cJSON_AddStringToObject(root, "backup_name", backup_name);
+    cJSON_AddNumberToObject(root, "timestamp", time(NULL));
+    cJSON* params = cJSON_AddArrayToObject(root, "parameters");
+    for (int i = 0; params && i < snap->count; i++) {
+        cJSON* param = cJSON_CreateObject();
+        cJSON_AddStringToObject(param, "name", snap->params[i].name);
+        cJSON_AddStringToObject(param, "value", snap->params[i].value);
+        cJSON_AddNumberToObject(param, "dataType", snap->params[i].dataType);
+        cJSON_AddItemToArray(params, param);
+    }
+    
+    char* json = cJSON_Print(root);
+    cJSON_Delete(root);
+    return json;
+}
+
+static void spill_write(const spill_entry_t* entry) {
+    /* Write to a temporary name first so a reader never sees a partial backup */
+    char tmp_path[520];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", entry->path);
+    
+    FILE* fp = fopen(tmp_path, "w");
+    if (!fp) {
+        LOGW("Failed to write backup: %s", tmp_path);
+        return;
+    }
+    int ok = fputs(entry->json, fp) >= 0;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmp_path, entry->path) != 0) {
+        LOGW("Failed to write backup: %s", entry->path);
+        unlink(tmp_path);
+        return;
+    }
+    LOGD("Spilled backup: %s", entry->path);
+}
+
+static void* spill_thread(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_spill.mutex);
+    for (;;) {
+        while (!g_spill.head && !g_spill.stop) {
+            pthread_cond_wait(&g_spill.cond, &g_spill.mutex);
+        }
+        spill_entry_t* entry = g_spill.head;
+        if (!entry) break; /* stopping and drained */
+        g_spill.head = entry->next;
+        if (!g_spill.head) g_spill.tail = NULL;
+        pthread_mutex_unlock(&g_spill.mutex);
+        
+        spill_write(entry);
+        free(entry->path);
+        free(entry->json);
+        free(entry);
+        
+        pthread_mutex_lock(&g_spill.mutex);
+    }
+    pthread_mutex_unlock(&g_spill.mutex);
+    return NULL;
+}
+
+static int spill_start(void) {
+    g_spill.stop = 0;
+    if (pthread_create(&g_spill.thread, NULL, spill_thread, NULL) != 0) {
+        LOGW("Failed to start backup spill thread: %s", "backups stay in memory only");
+        return -1;
+    }
+    g_spill.running = 1;
+    return 0;
+}
+
+static void spill_stop(void) {
+    if (!g_spill.running) return;
+    
+    /* The thread writes whatever is still queued before it exits */
+    pthread_mutex_lock(&g_spill.mutex);
+    g_spill.stop = 1;
+    pthread_cond_signal(&g_spill.cond);
+    pthread_mutex_unlock(&g_spill.mutex);
+    pthread_join(g_spill.thread, NULL);
+    g_spill.running = 0;
+}
+
+/* Queue a copy of the snapshot for writing; never blocks on file I/O */
+static void spill_enqueue(const char* backup_name, const webconfig_snapshot_t* snap) {
+    if (!g_spill.running) return;
+    
+    spill_entry_t* entry = calloc(1, sizeof(spill_entry_t));
+    if (!entry) return;
+    size_t path_len = strlen(g_webconfig.config.backup_directory) + strlen(backup_name) + 16;
+    entry->path = malloc(path_len);
+    entry->json = snapshot_to_json(backup_name, snap);
+    if (!entry->path || !entry->json) {
+        free(entry->path);
+        free(entry->json);
+        free(entry);
+        return;
+    }
+    snprintf(entry->path, path_len, "%s/%s.backup", g_webconfig.config.backup_directory, backup_name);
+    
+    pthread_mutex_lock(&g_spill.mutex);
+    if (g_spill.tail) g_spill.tail->next = entry;
+    else g_spill.head = entry;
+    g_spill.tail = entry;
+    pthread_cond_signal(&g_spill.cond);
+    pthread_mutex_unlock(&g_spill.mutex);
+}
+
+static int is_batched_set(const webconfig_param_t* param) {
+    return param->operation == WEBCONFIG_SET || param->operation == WEBCONFIG_REPLACE;
+}
+
+/* Apply a run of consecutive SET/REPLACE operations with one rbus_setMulti, filling
+ * results[0..count-1]. If a non-atomic batch is rejected, the parameters are retried
+ * one by one so the result still reports which of them failed. If an atomic one is,
+ * the parameters some provider already committed are reported as succeeded, so the
+ * rollback restores them.
+ */
+static void execute_set_batch(const webconfig_param_t* params, int count, int atomic,
+                              webconfig_param_result_t* results) {
+    if (count == 1) {
+        webconfig_param_result_t* single = execute_parameter_operation(&params[0]);
+        if (single) {
+            results[0] = *single;
+            free(single);
+        } else {
+            results[0].status = WEBCONFIG_STATUS_FAILURE;
+            results[0].error_code = 500;
+        }
+        return;
+    }
+    
+    PERF_SCOPE(timer, "webconfig_set_batch", PERF_CAT_WEBCONFIG);
+    
+    int rbus_result = -3;
+    table_param_t* batch = calloc(count, sizeof(table_param_t));
+    int* committed = calloc(count, sizeof(int));
+    if (batch && committed) {
+        for (int i = 0; i < count; i++) {
+            batch[i].name = params[i].name;
+            batch[i].value = params[i].value;
+            batch[i].dataType = params[i].dataType;
+        }
+        rbus_result = rbus_adapter_set_typed_bulk_committed(batch, count, committed);
+    }
+    free(batch);
+    
+    if (rbus_result != 0 && !atomic) {
+        LOGD("Batched set of %d parameters failed (%d), retrying individually", count, rbus_result);
+        for (int i = 0; i < count; i++) {
+            webconfig_param_result_t* single = execute_parameter_operation(&params[i]);
+            if (single) {
+                results[i] = *single;
+                free(single);
+            } else {
+                results[i].status = WEBCONFIG_STATUS_FAILURE;
+                results[i].error_code = 500;
+            }
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            results[i].name = strdup(params[i].name);
+            if (rbus_result == 0 || (committed && committed[i])) {
+                results[i].status = WEBCONFIG_STATUS_SUCCESS;
+                results[i].error_code = 200;
+                notification_send_param_change(params[i].name, "", params[i].value, params[i].dataType, "webconfig");
+            } else {
+                results[i].status = WEBCONFIG_STATUS_FAILURE;
+                results[i].error_code = map_rbus_error_to_webconfig(rbus_result);
+                results[i].error_message = strdup("RBUS operation failed");
+            }
+        }
+    }
+    free(committed);
+    
+    if (timer.active) {
+        double latency = perf_scope_end(&timer);
+        perf_hook_webconfig_transaction("set_batch", count, latency, rbus_result == 0);
+    }
+}
+
 /* Core API Implementation */
 int webconfig_init(const webconfig_config_t* config) {
     if (g_webconfig.initialized) {
@@ -187,18 +632,33 @@ int webconfig_init(const webconfig_config_t* config) {
     g_webconfig.config.backup_directory = config && config->backup_directory ? 
                                          strdup(config->backup_directory) : 
                                          strdup("/tmp/webconfig_backups");
+    g_webconfig.config.spill_backups = config ? config->spill_backups : 0;
+    
+    /* Rollback snapshots live in memory; the directory is only needed to spill them */
+    if (g_webconfig.config.spill_backups) {
+        if (mkdir(g_webconfig.config.backup_directory, 0755) != 0 && errno != EEXIST) {
+            LOGW("Failed to create backup directory: %s", g_webconfig.config.backup_directory);
+        }
+        spill_start();
+    }
     
-    /* Create backup directory if it doesn't exist */
-    if (mkdir(g_webconfig.config.backup_directory, 0755) != 0 && errno != EEXIST) {
-        LOGW("Failed to create backup directory: %s", g_webconfig.config.backup_directory);
+    dispatcher_config_t async_config = {
+        .name = "webconfig_async",
+        .worker_count = WEBCONFIG_ASYNC_WORKERS,
+        .queue_capacity = MAX_ACTIVE_TRANSACTIONS
+    };
+    g_webconfig.async_dispatcher = dispatcher_create(&async_config, async_transaction_job);
+    if (!g_webconfig.async_dispatcher) {
+        LOGW("Failed to start async transaction workers: %s", "async transactions unavailable");
     }
     
     g_webconfig.initialized = 1;
     
-    LOGI("WebConfig initialized: max_size=%d, timeout=%d, rollback=%d", 
+    LOGI("WebConfig initialized: max_size=%d, timeout=%d, rollback=%d, spill=%d", 
          g_webconfig.config.max_transaction_size,
          g_webconfig.config.transaction_timeout,
-         g_webconfig.config.enable_rollback);
+         g_webconfig.config.enable_rollback,
+         g_webconfig.config.spill_backups);
     
     return 0;
 }
@@ -206,13 +666,16 @@ int webconfig_init(const webconfig_config_t* config) {
 void webconfig_cleanup(void) {
     if (!g_webconfig.initialized) return;
     
-    pthread_mutex_lock(&g_webconfig.mutex);
-    
-    /* Clean up active transactions */
-    for (int i = 0; i < g_transaction_store.count; i++) {
-        webconfig_free_transaction(g_transaction_store.transactions[i]);
-        webconfig_free_result(g_transaction_store.results[i]);
+    /* Let queued async transactions finish, then drop every record */
+    if (g_webconfig.async_dispatcher) {
+        dispatcher_destroy(g_webconfig.async_dispatcher);
+        g_webconfig.async_dispatcher = NULL;
     }
+    tx_store_clear();
+    spill_stop();
+    blob_remember(NULL, 0);
+    
+    pthread_mutex_lock(&g_webconfig.mutex);
     
     free(g_webconfig.config.backup_directory);
     memset(&g_webconfig, 0, sizeof(g_webconfig));
@@ -223,19 +686,58 @@ void webconfig_cleanup(void) {
     LOGI("WebConfig cleaned up: %s", "shutdown complete");
 }
 
-int webconfig_execute_transaction(const webconfig_transaction_t* transaction, webconfig_result_t** result) {
-    if (!g_webconfig.initialized || !transaction || !result) return -1;
-    
+/* Set the overall status from the per-parameter outcome, update statistics and
+ * report completion to the callback and performance monitor.
+ */
+static void record_completion(webconfig_result_t* tx_result, int param_count, int success_count,
+                              int failure_count, double transaction_time) {
     pthread_mutex_lock(&g_webconfig.mutex);
     
+    /* Determine overall status */
+    if (failure_count == 0) {
+        tx_result->overall_status = WEBCONFIG_STATUS_SUCCESS;
+        g_webconfig.stats.successful_transactions++;
+    } else if (success_count == 0) {
+        tx_result->overall_status = WEBCONFIG_STATUS_FAILURE;
+        g_webconfig.stats.failed_transactions++;
+    } else {
+        tx_result->overall_status = WEBCONFIG_STATUS_PARTIAL;
+        g_webconfig.stats.partial_transactions++;
+    }
+    
+    tx_result->completion_time = time(NULL);
+    
+    /* Update statistics */
+    g_webconfig.stats.total_transactions++;
+    g_webconfig.stats.total_parameters += param_count;
+    
+    g_webconfig.stats.avg_transaction_time = 
+        (g_webconfig.stats.avg_transaction_time * (g_webconfig.stats.total_transactions - 1) + transaction_time) / 
+        g_webconfig.stats.total_transactions;
+    
+    webconfig_notification_callback_t callback = g_webconfig.notification_callback;
+    pthread_mutex_unlock(&g_webconfig.mutex);
+    
+    /* Send notification */
+    if (callback) {
+        callback(tx_result->transaction_id, tx_result->overall_status, "Transaction completed");
+    }
+    
+    /* Performance monitoring */
+    perf_hook_webconfig_transaction(tx_result->transaction_id, param_count, 
+                                  transaction_time, tx_result->overall_status == WEBCONFIG_STATUS_SUCCESS);
+}
+
+/* Run one transaction. g_webconfig.mutex only guards the statistics; RBUS work runs
+ * under the parameter set lock, so transactions on disjoint parameters proceed in
+ * parallel.
+ */
+static int execute_transaction(const webconfig_transaction_t* transaction, webconfig_result_t** result) {
     double start_time = get_timestamp_ms();
     
     /* Create result structure */
     webconfig_result_t* tx_result = calloc(1, sizeof(webconfig_result_t));
-    if (!tx_result) {
-        pthread_mutex_unlock(&g_webconfig.mutex);
-        return -1;
-    }
+    if (!tx_result) return -1;
     
     tx_result->transaction_id = strdup(transaction->transaction_id);
     tx_result->param_results = calloc(transaction->param_count, sizeof(webconfig_param_result_t));
@@ -246,90 +748,231 @@ int webconfig_execute_transaction(const webconfig_transaction_t* transaction, we
     if (g_webconfig.config.enable_validation) {
         if (webconfig_validate_transaction(transaction) != 0) {
             tx_result->overall_status = WEBCONFIG_STATUS_FAILURE;
-            pthread_mutex_unlock(&g_webconfig.mutex);
             *result = tx_result;
             return -1;
         }
     }
     
-    /* Create backup if rollback is enabled */
-    char backup_name[256];
-    if (g_webconfig.config.enable_rollback) {
-        snprintf(backup_name, sizeof(backup_name), "tx_%s", transaction->transaction_id);
-        webconfig_create_backup(backup_name);
+    /* Wait for running transactions that touch the same parameters */
+    tx_lock_t lock;
+    tx_lock_acquire(&lock, transaction);
+    
+    /* Atomic transactions snapshot the current values of the parameters they write */
+    webconfig_snapshot_t snapshot = {0};
+    int have_snapshot = 0;
+    if (g_webconfig.config.enable_rollback && transaction->atomic) {
+        const char** names = calloc(transaction->param_count, sizeof(char*));
+        int name_count = 0;
+        if (names) {
+            for (int i = 0; i < transaction->param_count; i++) {
+                if (transaction->parameters[i].operation != WEBCONFIG_GET) {
+                    names[name_count++] = transaction->parameters[i].name;
+                }
+            }
+            have_snapshot = snapshot_capture(names, name_count, &snapshot) == 0;
+            free(names);
+        }
+        if (!have_snapshot) {
+            LOGW("Transaction %s: failed to snapshot parameters, rollback unavailable", transaction->transaction_id);
+        } else {
+            char backup_name[256];
+            snprintf(backup_name, sizeof(backup_name), "tx_%s", transaction->transaction_id);
+            spill_enqueue(backup_name, &snapshot);
+        }
     }
     
     /* Execute parameter operations */
     int success_count = 0;
     int failure_count = 0;
     
-    for (int i = 0; i < transaction->param_count; i++) {
-        webconfig_param_result_t* param_result = execute_parameter_operation(&transaction->parameters[i]);
-        if (param_result) {
-            tx_result->param_results[i] = *param_result;
-            free(param_result);
-            
-            if (tx_result->param_results[i].status == WEBCONFIG_STATUS_SUCCESS) {
+    for (int i = 0; i < transaction->param_count; ) {
+        const webconfig_param_t* param = &transaction->parameters[i];
+        
+        /* Consecutive SET/REPLACE operations go to RBUS as one committed batch */
+        int run = 1;
+        if (is_batched_set(param)) {
+            while (i + run < transaction->param_count && is_batched_set(&transaction->parameters[i + run])) {
+                run++;
+            }
+            execute_set_batch(param, run, transaction->atomic, &tx_result->param_results[i]);
+        } else {
+            webconfig_param_result_t* param_result = execute_parameter_operation(param);
+            if (param_result) {
+                tx_result->param_results[i] = *param_result;
+                free(param_result);
+            } else {
+                tx_result->param_results[i].status = WEBCONFIG_STATUS_FAILURE;
+                tx_result->param_results[i].error_code = 500;
+            }
+        }
+        
+        int run_failed = 0;
+        for (int k = i; k < i + run; k++) {
+            if (tx_result->param_results[k].status == WEBCONFIG_STATUS_SUCCESS) {
                 success_count++;
             } else {
                 failure_count++;
-                
-                /* For atomic transactions, stop on first failure */
-                if (transaction->atomic) {
-                    /* Rollback previous operations */
-                    if (g_webconfig.config.enable_rollback) {
-                        webconfig_restore_backup(backup_name);
+                run_failed = 1;
+            }
+        }
+        i += run;
+        
+        /* For atomic transactions, stop on first failure */
+        if (run_failed && transaction->atomic) {
+            /* Rollback previous operations */
+            if (have_snapshot) {
+                if (snapshot_restore_applied(&snapshot, transaction->parameters, tx_result->param_results, i) == 0) {
+                    pthread_mutex_lock(&g_webconfig.mutex);
+                    g_webconfig.stats.rolled_back_transactions++;
+                    pthread_mutex_unlock(&g_webconfig.mutex);
+                    for (int k = 0; k < i; k++) {
+                        webconfig_param_result_t* pr = &tx_result->param_results[k];
+                        if (pr->status != WEBCONFIG_STATUS_SUCCESS) continue;
+                        pr->status = WEBCONFIG_STATUS_FAILURE;
+                        if (!pr->error_message) pr->error_message = strdup("Rolled back");
                     }
-                    tx_result->overall_status = WEBCONFIG_STATUS_FAILURE;
-                    break;
+                    success_count = 0;
+                } else {
+                    LOGE("Transaction %s: rollback failed", transaction->transaction_id);
                 }
             }
-        } else {
-            failure_count++;
-            tx_result->param_results[i].status = WEBCONFIG_STATUS_FAILURE;
-            tx_result->param_results[i].error_code = 500;
+            tx_result->overall_status = WEBCONFIG_STATUS_FAILURE;
+            break;
         }
     }
+    snapshot_free(&snapshot);
+    tx_lock_release(&lock);
     
-    /* Determine overall status */
-    if (failure_count == 0) {
-        tx_result->overall_status = WEBCONFIG_STATUS_SUCCESS;
-        g_webconfig.stats.successful_transactions++;
-    } else if (success_count == 0) {
-        tx_result->overall_status = WEBCONFIG_STATUS_FAILURE;
-        g_webconfig.stats.failed_transactions++;
-    } else {
-        tx_result->overall_status = WEBCONFIG_STATUS_PARTIAL;
-        g_webconfig.stats.partial_transactions++;
-    }
+    record_completion(tx_result, transaction->param_count, success_count, failure_count,
+                      get_timestamp_ms() - start_time);
     
-    tx_result->completion_time = time(NULL);
+    *result = tx_result;
+    return 0;
+}
+
+int webconfig_execute_transaction(const webconfig_transaction_t* transaction, webconfig_result_t** result) {
+    if (!g_webconfig.initialized || !transaction || !result || !transaction->transaction_id) return -1;
     
-    /* Update statistics */
-    g_webconfig.stats.total_transactions++;
-    g_webconfig.stats.total_parameters += transaction->param_count;
+    /* Track the run for status queries; a busy table only skips the bookkeeping */
+    pthread_mutex_lock(&g_transaction_store.mutex);
+    int tracked = tx_store_add(transaction->transaction_id) != NULL;
+    pthread_mutex_unlock(&g_transaction_store.mutex);
     
-    double transaction_time = get_timestamp_ms() - start_time;
-    g_webconfig.stats.avg_transaction_time = 
-        (g_webconfig.stats.avg_transaction_time * (g_webconfig.stats.total_transactions - 1) + transaction_time) / 
-        g_webconfig.stats.total_transactions;
+    int rc = execute_transaction(transaction, result);
     
-    /* Send notification */
-    if (g_webconfig.notification_callback) {
-        g_webconfig.notification_callback(tx_result->transaction_id, tx_result->overall_status, 
-                                        "Transaction completed");
+    if (tracked) {
+        tx_store_finish(transaction->transaction_id,
+                        (rc == 0 && *result) ? (*result)->overall_status : WEBCONFIG_STATUS_FAILURE, NULL);
+    }
+    return rc;
+}
+
+static webconfig_transaction_t* copy_transaction(const webconfig_transaction_t* transaction) {
+    webconfig_transaction_t* copy = calloc(1, sizeof(webconfig_transaction_t));
+    if (!copy) return NULL;
+    
+    copy->transaction_id = strdup(transaction->transaction_id);
+    copy->user_id = transaction->user_id ? strdup(transaction->user_id) : NULL;
+    copy->source = transaction->source ? strdup(transaction->source) : NULL;
+    copy->timestamp = transaction->timestamp;
+    copy->atomic = transaction->atomic;
+    copy->param_count = transaction->param_count;
+    if (transaction->param_count > 0) {
+        copy->parameters = calloc(transaction->param_count, sizeof(webconfig_param_t));
+        if (!copy->parameters) {
+            copy->param_count = 0;
+            webconfig_free_transaction(copy);
+            return NULL;
+        }
+        for (int i = 0; i < transaction->param_count; i++) {
+            copy->parameters[i] = transaction->parameters[i];
+            copy->parameters[i].name = transaction->parameters[i].name ? strdup(transaction->parameters[i].name) : NULL;
+            copy->parameters[i].value = transaction->parameters[i].value ? strdup(transaction->parameters[i].value) : NULL;
+        }
+    }
+    return copy;
+}
+
+static void async_transaction_job(void* job) {
+    webconfig_transaction_t* transaction = job;
+    webconfig_result_t* result = NULL;
+    
+    int rc = execute_transaction(transaction, &result);
+    webconfig_status_t status = (rc == 0 && result) ? result->overall_status : WEBCONFIG_STATUS_FAILURE;
+    if (rc != 0) {
+        /* Rejected before running (validation); execute_transaction did not report it */
+        pthread_mutex_lock(&g_webconfig.mutex);
+        webconfig_notification_callback_t callback = g_webconfig.notification_callback;
+        pthread_mutex_unlock(&g_webconfig.mutex);
+        if (callback) callback(transaction->transaction_id, status, "Transaction rejected");
     }
+    tx_store_finish(transaction->transaction_id, status, result);
+    webconfig_free_transaction(transaction);
+}
+
+int webconfig_execute_transaction_async(const webconfig_transaction_t* transaction, char** transaction_id) {
+    if (!g_webconfig.initialized || !transaction || !transaction->transaction_id || !transaction_id) return -1;
+    if (!g_webconfig.async_dispatcher) return -1;
     
-    /* Performance monitoring */
-    perf_hook_webconfig_transaction(tx_result->transaction_id, transaction->param_count, 
-                                  transaction_time, tx_result->overall_status == WEBCONFIG_STATUS_SUCCESS);
+    webconfig_transaction_t* copy = copy_transaction(transaction);
+    if (!copy || !copy->transaction_id) {
+        webconfig_free_transaction(copy);
+        return -1;
+    }
+    *transaction_id = strdup(copy->transaction_id);
+    if (!*transaction_id) {
+        webconfig_free_transaction(copy);
+        return -1;
+    }
     
-    pthread_mutex_unlock(&g_webconfig.mutex);
+    pthread_mutex_lock(&g_transaction_store.mutex);
+    tx_record_t* rec = tx_store_add(copy->transaction_id);
+    pthread_mutex_unlock(&g_transaction_store.mutex);
+    if (!rec) {
+        LOGW("Async transaction %s rejected: duplicate id or too many pending", copy->transaction_id);
+        webconfig_free_transaction(copy);
+        free(*transaction_id);
+        *transaction_id = NULL;
+        return -2;
+    }
     
-    *result = tx_result;
+    if (dispatcher_submit(g_webconfig.async_dispatcher, copy) != 0) {
+        tx_store_finish(copy->transaction_id, WEBCONFIG_STATUS_FAILURE, NULL);
+        webconfig_free_transaction(copy);
+        free(*transaction_id);
+        *transaction_id = NULL;
+        return -1;
+    }
     return 0;
 }
 
+int webconfig_get_transaction_status(const char* transaction_id, webconfig_status_t* status) {
+    if (!transaction_id || !status) return -1;
+    
+    pthread_mutex_lock(&g_transaction_store.mutex);
+    tx_record_t* rec = tx_store_find(transaction_id);
+    if (rec) *status = rec->status;
+    pthread_mutex_unlock(&g_transaction_store.mutex);
+    return rec ? 0 : -1;
+}
+
+int webconfig_take_transaction_result(const char* transaction_id, webconfig_result_t** result) {
+    if (!transaction_id || !result) return -1;
+    
+    int rc = -1;
+    pthread_mutex_lock(&g_transaction_store.mutex);
+    tx_record_t* rec = tx_store_find(transaction_id);
+    if (rec && rec->status == WEBCONFIG_STATUS_PENDING) {
+        rc = -2;
+    } else if (rec && rec->result) {
+        *result = rec->result;
+        rec->result = NULL;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&g_transaction_store.mutex);
+    return rc;
+}
+
 int webconfig_bulk_set(const webconfig_param_t* params, int count, int atomic, webconfig_result_t** result) {
     if (!params || count <= 0 || !result) return -1;
     
@@ -358,19 +1001,31 @@ int webconfig_bulk_get(const char** param_names, int count, webconfig_param_t**
     *results = calloc(count, sizeof(webconfig_param_t));
     if (!*results) return -1;
     
+    char** values = calloc(count, sizeof(char*));
+    int* types = calloc(count, sizeof(int));
+    int* rcs = calloc(count, sizeof(int));
+    if (!values || !types || !rcs) {
+        free(values); free(types); free(rcs);
+        free(*results); *results = NULL;
+        return -1;
+    }
+    
+    /* One batched RBUS round trip for everything not already cached */
+    rbus_adapter_get_typed_bulk(param_names, count, values, types, rcs);
+    
     int success_count = 0;
     for (int i = 0; i < count; i++) {
-        char* value = NULL;
-        int dataType = 0;
-        
-        if (rbus_adapter_get_typed(param_names[i], &value, &dataType) == 0) {
+        if (rcs[i] == 0 && values[i]) {
             (*results)[success_count].name = strdup(param_names[i]);
-            (*results)[success_count].value = value;
-            (*results)[success_count].dataType = dataType;
+            (*results)[success_count].value = values[i];
+            (*results)[success_count].dataType = types[i];
             (*results)[success_count].operation = WEBCONFIG_GET;
             success_count++;
+        } else if (values[i]) {
+            free(values[i]);
         }
     }
+    free(values); free(types); free(rcs);
     
     *result_count = success_count;
     return 0;
@@ -407,27 +1062,16 @@ int webconfig_validate_transaction(const webconfig_transaction_t* transaction) {
     return 0;
 }
 
-int webconfig_create_backup(const char* backup_name) {
-    if (!backup_name || !g_webconfig.initialized) return -1;
-    
-    /* In a real implementation, this would save current parameter values */
-    /* For now, just create a placeholder backup file */
-    char backup_path[512];
-    snprintf(backup_path, sizeof(backup_path), "%s/%s.backup", 
-             g_webconfig.config.backup_directory, backup_name);
+int webconfig_create_backup(const char* backup_name, const char** param_names, int count) {
+    if (!backup_name || !param_names || count <= 0 || !g_webconfig.initialized) return -1;
+    if (!g_spill.running) return -1;
     
-    FILE* fp = fopen(backup_path, "w");
-    if (!fp) return -1;
+    webconfig_snapshot_t snapshot;
+    if (snapshot_capture(param_names, count, &snapshot) != 0) return -1;
+    spill_enqueue(backup_name, &snapshot);
+    snapshot_free(&snapshot);
     
-    fprintf(fp, "{\n");
-    fprintf(fp, "  \"backup_name\": \"%s\",\n", backup_name);
-    fprintf(fp, "  \"timestamp\": %ld,\n", time(NULL));
-    fprintf(fp, "  \"parameters\": []\n");
-    fprintf(fp, "}\n");
-    
-    fclose(fp);
-    
-    LOGI("Created backup: %s", backup_path);
+    LOGI("Queued backup %s: %d parameters", backup_name, count);
     return 0;
 }
 
@@ -438,18 +1082,539 @@ int webconfig_restore_backup(const char* backup_name) {
     snprintf(backup_path, sizeof(backup_path), "%s/%s.backup", 
              g_webconfig.config.backup_directory, backup_name);
     
-    if (access(backup_path, F_OK) != 0) {
+    FILE* fp = fopen(backup_path, "r");
+    if (!fp) {
         LOGW("Backup file not found: %s", backup_path);
         return -1;
     }
+    char* data = NULL;
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0) size = ftell(fp);
+    if (size > 0 && fseek(fp, 0, SEEK_SET) == 0 && (data = malloc(size + 1)) != NULL) {
+        size = (long)fread(data, 1, size, fp);
+        data[size] = '\0';
+    }
+    fclose(fp);
+    if (!data) return -1;
+    
+    cJSON* root = cJSON_Parse(data);
+    free(data);
+    cJSON* params = root ? cJSON_GetObjectItem(root, "parameters") : NULL;
+    if (!cJSON_IsArray(params)) {
+        LOGW("Invalid backup file: %s", backup_path);
+        cJSON_Delete(root);
+        return -1;
+    }
+    
+    int count = cJSON_GetArraySize(params);
+    table_param_t* list = calloc(count > 0 ? count : 1, sizeof(table_param_t));
+    int n = 0;
+    cJSON* param = NULL;
+    cJSON_ArrayForEach(param, params) {
+        cJSON* name = cJSON_GetObjectItem(param, "name");
+        cJSON* value = cJSON_GetObjectItem(param, "value");
+        cJSON* dataType = cJSON_GetObjectItem(param, "dataType");
+        if (!list || !cJSON_IsString(name) || !cJSON_IsString(value)) continue;
+        list[n].name = name->valuestring;
+        list[n].value = value->valuestring;
+        list[n].dataType = cJSON_IsNumber(dataType) ? dataType->valueint : 0;
+        n++;
+    }
+    
+    int rc = list ? 0 : -1;
+    if (list && n > 0) rc = rbus_adapter_set_typed_bulk(list, n);
+    free(list);
+    cJSON_Delete(root);
+    
+    if (rc != 0) {
+        LOGW("Failed to restore backup %s: %d", backup_path, rc);
+        return -1;
+    }
     
-    /* In a real implementation, this would restore saved parameter values */
-    LOGI("Restored backup: %s", backup_path);
+    LOGI("Restored backup: %s (%d parameters)", backup_path, n);
+    pthread_mutex_lock(&g_webconfig.mutex);
     g_webconfig.stats.rolled_back_transactions++;
+    pthread_mutex_unlock(&g_webconfig.mutex);
+    
+    return 0;
+}
+
+/* Configuration blobs
+ *
+ * A blob is a document of parameter values applied as sets. JSON blobs use the
+ * transaction format and run through webconfig_execute_transaction. With
+ * WEBCONFIG_BIN_SUPPORT, MessagePack blobs ({"transaction_id", "atomic",
+ * "parameters": [{"name", "value", "dataType"}, ...]}) are decoded in place and
+ * applied in chunks of BLOB_CHUNK_PARAMS, each one rbus_setMulti, so memory stays
+ * bounded by a chunk rather than the blob size.
+ */
+
+/* Parameters of the most recently applied blob, which export reports (g_webconfig.mutex) */
+static struct {
+    char** names;
+    int count;
+} g_last_blob = {0};
+
+static void blob_remember(char** names, int count) {
+    pthread_mutex_lock(&g_webconfig.mutex);
+    char** old = g_last_blob.names;
+    int old_count = g_last_blob.count;
+    g_last_blob.names = names;
+    g_last_blob.count = count;
+    pthread_mutex_unlock(&g_webconfig.mutex);
+    
+    for (int i = 0; i < old_count; i++) free(old[i]);
+    free(old);
+}
+
+static int apply_json_blob(const char* blob_data, size_t blob_size, webconfig_result_t** result) {
+    char* json = strndup(blob_data, blob_size);
+    if (!json) return -1;
+    webconfig_transaction_t* transaction = webconfig_transaction_from_json(json);
+    free(json);
+    if (!transaction) return -1;
+    
+    int rc = webconfig_execute_transaction(transaction, result);
+    if (rc == 0 && *result && (*result)->overall_status != WEBCONFIG_STATUS_FAILURE) {
+        char** names = calloc(transaction->param_count > 0 ? transaction->param_count : 1, sizeof(char*));
+        int count = 0;
+        for (int i = 0; names && i < transaction->param_count; i++) {
+            if (transaction->parameters[i].name && transaction->parameters[i].operation != WEBCONFIG_GET) {
+                names[count++] = strdup(transaction->parameters[i].name);
+            }
+        }
+        if (names) blob_remember(names, count);
+    }
+    webconfig_free_transaction(transaction);
+    return rc;
+}
+
+#ifdef WEBCONFIG_BIN_SUPPORT
+
+/* Write back every pre-image in snap (a blob's undo log holds only written parameters) */
+static int snapshot_restore(const webconfig_snapshot_t* snap) {
+    if (snap->count == 0) return 0;
+    return rbus_adapter_set_typed_bulk(snap->params, snap->count);
+}
+
+/* Of the pre-images from index from on, drop those of parameters not among the
+ * first count of written, e.g. the part of a chunk RBUS rejected
+ */
+static void snapshot_keep_written(webconfig_snapshot_t* snap, int from, const table_param_t* written, int count) {
+    int kept = from;
+    for (int i = from; i < snap->count; i++) {
+        int found = 0;
+        for (int k = 0; k < count && !found; k++) found = strcmp(written[k].name, snap->params[i].name) == 0;
+        if (found) {
+            snap->params[kept++] = snap->params[i];
+        } else {
+            free(snap->params[i].name);
+            free(snap->params[i].value);
+        }
+    }
+    snap->count = kept;
+}
+
+#define BLOB_CHUNK_PARAMS 64
+
+typedef struct {
+    int atomic;
+    int rollback;
+    table_param_t chunk[BLOB_CHUNK_PARAMS];
+    int chunk_count;
+    arena_t* scratch;               /* Strings of the current chunk; reset on flush */
+    webconfig_snapshot_t undo;      /* Pre-images of the chunks applied so far (atomic only) */
+    int undo_cap;
+    webconfig_param_result_t* failures;
+    int failure_count;
+    int failure_cap;
+    char** names;                   /* Applied parameters, kept for export */
+    int name_count;
+    int name_cap;
+    int applied;
+    int aborted;
+} blob_apply_t;
+
+static int blob_grow(void** array, int* cap, int need, size_t elem_size) {
+    if (need <= *cap) return 0;
+    int new_cap = *cap ? *cap * 2 : 64;
+    while (new_cap < need) new_cap *= 2;
+    void* grown = realloc(*array, (size_t)new_cap * elem_size);
+    if (!grown) return -1;
+    *array = grown;
+    *cap = new_cap;
+    return 0;
+}
+
+static void blob_add_failure(blob_apply_t* ctx, const char* name, int error_code, const char* message) {
+    if (blob_grow((void**)&ctx->failures, &ctx->failure_cap, ctx->failure_count + 1,
+                  sizeof(webconfig_param_result_t)) != 0) return;
+    webconfig_param_result_t* pr = &ctx->failures[ctx->failure_count++];
+    pr->name = strdup(name);
+    pr->status = WEBCONFIG_STATUS_FAILURE;
+    pr->error_code = error_code;
+    pr->error_message = strdup(message);
+}
+
+static void blob_applied(blob_apply_t* ctx, const table_param_t* param) {
+    notification_send_param_change(param->name, "", param->value, param->dataType, "webconfig");
+    ctx->applied++;
+    if (blob_grow((void**)&ctx->names, &ctx->name_cap, ctx->name_count + 1, sizeof(char*)) == 0) {
+        ctx->names[ctx->name_count++] = strdup(param->name);
+    }
+}
+
+static void blob_flush(blob_apply_t* ctx) {
+    int count = ctx->chunk_count;
+    if (count == 0 || ctx->aborted) return;
+    
+    int undo_mark = ctx->undo.count;
+    if (ctx->rollback) {
+        const char* names[BLOB_CHUNK_PARAMS];
+        for (int i = 0; i < count; i++) names[i] = ctx->chunk[i].name;
+        webconfig_snapshot_t snap;
+        if (snapshot_capture(names, count, &snap) == 0 &&
+            blob_grow((void**)&ctx->undo.params, &ctx->undo_cap, ctx->undo.count + snap.count,
+                      sizeof(table_param_t)) == 0) {
+            memcpy(&ctx->undo.params[ctx->undo.count], snap.params, snap.count * sizeof(table_param_t));
+            ctx->undo.count += snap.count;
+            free(snap.params);
+        } else {
+            snapshot_free(&snap);
+            LOGW("Config blob: failed to snapshot %d parameters, rollback incomplete", count);
+        }
+    }
+    
+    int committed[BLOB_CHUNK_PARAMS];
+    int rc = rbus_adapter_set_typed_bulk_committed(ctx->chunk, count, committed);
+    if (rc == 0) {
+        for (int i = 0; i < count; i++) blob_applied(ctx, &ctx->chunk[i]);
+    } else if (!ctx->atomic) {
+        /* Find out which parameters were rejected */
+        for (int i = 0; i < count; i++) {
+            int prc = rbus_adapter_set_typed_bulk(&ctx->chunk[i], 1);
+            if (prc == 0) blob_applied(ctx, &ctx->chunk[i]);
+            else blob_add_failure(ctx, ctx->chunk[i].name, map_rbus_error_to_webconfig(prc), "RBUS operation failed");
+        }
+    } else {
+        /* Providers committed before the rejected one stay written and are rolled back */
+        table_param_t written[BLOB_CHUNK_PARAMS];
+        int written_count = 0;
+        for (int i = 0; i < count; i++) {
+            if (committed[i]) {
+                blob_applied(ctx, &ctx->chunk[i]);
+                written[written_count++] = ctx->chunk[i];
+            } else {
+                blob_add_failure(ctx, ctx->chunk[i].name, map_rbus_error_to_webconfig(rc), "RBUS operation failed");
+            }
+        }
+        snapshot_keep_written(&ctx->undo, undo_mark, written, written_count);
+        ctx->aborted = 1;
+    }
+    
+    ctx->chunk_count = 0;
+    arena_reset(ctx->scratch);
+}
+
+static char* blob_strdup(blob_apply_t* ctx, const char* s, size_t len) {
+    char* copy = arena_alloc(ctx->scratch, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/* Decode one {"name", "value", "dataType"} entry into the current chunk */
+static int blob_read_param(mp_reader_t* r, blob_apply_t* ctx) {
+    mp_obj_t obj;
+    if (mp_read(r, &obj) != 0 || obj.type != MP_MAP) return -1;
+    
+    mp_obj_t name = { .type = MP_NIL };
+    mp_obj_t value = { .type = MP_NIL };
+    int have_value = 0;
+    int dataType = -1;
+    for (uint32_t i = 0; i < obj.v.count; i++) {
+        mp_obj_t key;
+        if (mp_read(r, &key) != 0) return -1;
+        if (mp_str_eq(&key, "name")) {
+            if (mp_read(r, &name) != 0) return -1;
+        } else if (mp_str_eq(&key, "value")) {
+            const uint8_t* start = r->p;
+            if (mp_read(r, &value) != 0) return -1;
+            if (value.type == MP_ARRAY || value.type == MP_MAP) {
+                r->p = start;
+                if (mp_skip(r) != 0) return -1;
+            }
+            have_value = 1;
+        } else if (mp_str_eq(&key, "dataType")) {
+            mp_obj_t dt;
+            if (mp_read(r, &dt) != 0) return -1;
+            if (dt.type == MP_UINT) dataType = (int)dt.v.u;
+        } else if (mp_skip(r) != 0) {
+            return -1;
+        }
+    }
+    if (name.type != MP_STR || name.v.str.len == 0) return 0; /* nothing to apply */
+    
+    table_param_t* param = &ctx->chunk[ctx->chunk_count];
+    param->name = blob_strdup(ctx, name.v.str.ptr, name.v.str.len);
+    if (!param->name) return -1;
+    
+    char num[32];
+    switch (have_value ? value.type : MP_NIL) {
+        case MP_STR:
+            param->value = blob_strdup(ctx, value.v.str.ptr, value.v.str.len);
+            if (dataType < 0) dataType = 0;
+            break;
+        case MP_BOOL:
+            param->value = blob_strdup(ctx, value.v.b ? "true" : "false", value.v.b ? 4 : 5);
+            if (dataType < 0) dataType = 3;
+            break;
+        case MP_INT:
+            snprintf(num, sizeof(num), "%lld", (long long)value.v.i);
+            param->value = blob_strdup(ctx, num, strlen(num));
+            if (dataType < 0) dataType = value.v.i < INT32_MIN || value.v.i > INT32_MAX ? 7 : 1;
+            break;
+        case MP_UINT:
+            snprintf(num, sizeof(num), "%llu", (unsigned long long)value.v.u);
+            param->value = blob_strdup(ctx, num, strlen(num));
+            /* Past INT32_MAX a 32-bit int target would truncate it: send long (7), or
+             * ulong (8) once it no longer fits in 32 bits at all
+             */
+            if (dataType < 0) dataType = value.v.u > UINT32_MAX ? 8 : value.v.u > INT32_MAX ? 7 : 2;
+            break;
+        case MP_FLOAT:
+            snprintf(num, sizeof(num), "%.17g", value.v.f);
+            param->value = blob_strdup(ctx, num, strlen(num));
+            if (dataType < 0) dataType = 4;
+            break;
+        default:
+            blob_add_failure(ctx, param->name, 400, have_value ? "Unsupported value type" : "Missing value");
+            if (ctx->atomic) ctx->aborted = 1;
+            return 0;
+    }
+    if (!param->value) return -1;
+    param->dataType = dataType;
     
+    if (++ctx->chunk_count == BLOB_CHUNK_PARAMS) blob_flush(ctx);
+    return 0;
+}
+
+static int blob_read_parameters(mp_reader_t* r, blob_apply_t* ctx) {
+    mp_obj_t list;
+    if (mp_read(r, &list) != 0 || list.type != MP_ARRAY) return -1;
+    for (uint32_t i = 0; i < list.v.count && !ctx->aborted; i++) {
+        if (blob_read_param(r, ctx) != 0) return -1;
+    }
+    if (!ctx->aborted) blob_flush(ctx);
     return 0;
 }
 
+static int apply_msgpack_blob(const char* blob_data, size_t blob_size, webconfig_result_t** result) {
+    double start_time = get_timestamp_ms();
+    mp_reader_t r;
+    mp_obj_t top;
+    mp_obj_t key;
+    
+    /* First pass: pick up the top-level options, wherever "parameters" sits */
+    char* transaction_id = NULL;
+    int atomic = 0;
+    mp_reader_init(&r, blob_data, blob_size);
+    if (mp_read(&r, &top) != 0 || top.type != MP_MAP) return -1;
+    for (uint32_t i = 0; i < top.v.count; i++) {
+        if (mp_read(&r, &key) != 0) break;
+        if (mp_str_eq(&key, "atomic")) {
+            mp_obj_t v;
+            if (mp_read(&r, &v) != 0) break;
+            atomic = v.type == MP_BOOL && v.v.b;
+        } else if (mp_str_eq(&key, "transaction_id")) {
+            mp_obj_t v;
+            if (mp_read(&r, &v) != 0) break;
+            if (v.type == MP_STR && !transaction_id) transaction_id = strndup(v.v.str.ptr, v.v.str.len);
+        } else if (mp_skip(&r) != 0) {
+            break;
+        }
+    }
+    if (r.error) {
+        free(transaction_id);
+        LOGW("Malformed config blob: %zu bytes", blob_size);
+        return -1;
+    }
+    if (!transaction_id) transaction_id = generate_transaction_id();
+    
+    webconfig_result_t* tx_result = calloc(1, sizeof(webconfig_result_t));
+    blob_apply_t* ctx = calloc(1, sizeof(blob_apply_t));
+    if (ctx) ctx->scratch = arena_acquire();
+    if (!transaction_id || !tx_result || !ctx || !ctx->scratch) {
+        if (ctx) arena_release(ctx->scratch);
+        free(ctx);
+        free(tx_result);
+        free(transaction_id);
+        return -1;
+    }
+    ctx->atomic = atomic;
+    ctx->rollback = atomic && g_webconfig.config.enable_rollback;
+    
+    /* Blob contents are not known up front, so it runs exclusively: the empty
+     * name is a prefix of every parameter.
+     */
+    webconfig_param_t everything = { .name = (char*)"" };
+    webconfig_transaction_t exclusive = { .transaction_id = transaction_id, .parameters = &everything, .param_count = 1 };
+    tx_lock_t lock;
+    tx_lock_acquire(&lock, &exclusive);
+    
+    /* Second pass: stream the parameters */
+    mp_reader_init(&r, blob_data, blob_size);
+    mp_read(&r, &top);
+    int malformed = 0;
+    for (uint32_t i = 0; i < top.v.count && !ctx->aborted; i++) {
+        if (mp_read(&r, &key) != 0) { malformed = 1; break; }
+        int rc = mp_str_eq(&key, "parameters") ? blob_read_parameters(&r, ctx) : mp_skip(&r);
+        if (rc != 0) { malformed = 1; break; }
+    }
+    if (malformed) {
+        LOGW("Config blob %s: malformed after %d parameters", transaction_id, ctx->applied);
+        blob_add_failure(ctx, "parameters", 400, "Malformed config blob");
+        if (ctx->atomic) ctx->aborted = 1;
+        else if (ctx->chunk_count > 0) {
+            /* Entries decoded before the damage are still applied */
+            blob_flush(ctx);
+        }
+    }
+    
+    if (ctx->aborted && ctx->rollback) {
+        if (snapshot_restore(&ctx->undo) == 0) {
+            pthread_mutex_lock(&g_webconfig.mutex);
+            g_webconfig.stats.rolled_back_transactions++;
+            pthread_mutex_unlock(&g_webconfig.mutex);
+            ctx->applied = 0;
+        } else {
+            LOGE("Config blob %s: rollback failed", transaction_id);
+        }
+    }
+    tx_lock_release(&lock);
+    
+    int total = ctx->applied + ctx->failure_count;
+    LOGI("Config blob %s: %d applied, %d failed%s", transaction_id, ctx->applied, ctx->failure_count,
+         ctx->aborted ? " (aborted)" : "");
+    
+    if (!ctx->aborted && ctx->applied > 0) {
+        blob_remember(ctx->names, ctx->name_count);
+    } else {
+        for (int i = 0; i < ctx->name_count; i++) free(ctx->names[i]);
+        free(ctx->names);
+    }
+    
+    tx_result->transaction_id = transaction_id;
+    tx_result->param_results = ctx->failures;
+    tx_result->result_count = ctx->failure_count;
+    record_completion(tx_result, total, ctx->applied, ctx->failure_count, get_timestamp_ms() - start_time);
+    
+    snapshot_free(&ctx->undo);
+    arena_release(ctx->scratch);
+    free(ctx);
+    
+    *result = tx_result;
+    return 0;
+}
+#endif /* WEBCONFIG_BIN_SUPPORT */
+
+int webconfig_apply_config_blob(const char* blob_data, size_t blob_size, webconfig_result_t** result) {
+    if (!g_webconfig.initialized || !blob_data || blob_size == 0 || !result) return -1;
+    *result = NULL;
+    
+    size_t i = 0;
+    while (i < blob_size && (blob_data[i] == ' ' || blob_data[i] == '\t' ||
+                             blob_data[i] == '\r' || blob_data[i] == '\n')) i++;
+    if (i < blob_size && blob_data[i] == '{') {
+        return apply_json_blob(blob_data, blob_size, result);
+    }
+    
+#ifdef WEBCONFIG_BIN_SUPPORT
+    /* MessagePack documents start with a map header */
+    unsigned char first = (unsigned char)blob_data[0];
+    if ((first & 0xf0) == 0x80 || first == 0xde || first == 0xdf) {
+        return apply_msgpack_blob(blob_data, blob_size, result);
+    }
+#endif
+    
+    LOGW("Unsupported config blob format: %zu bytes", blob_size);
+    return -1;
+}
+
+int webconfig_export_config_blob(char** blob_data, size_t* blob_size) {
+    if (!g_webconfig.initialized || !blob_data || !blob_size) return -1;
+    *blob_data = NULL;
+    *blob_size = 0;
+    
+    /* Copy the names so RBUS is not called under the mutex */
+    pthread_mutex_lock(&g_webconfig.mutex);
+    int count = g_last_blob.count;
+    const char** names = calloc(count > 0 ? count : 1, sizeof(char*));
+    for (int i = 0; names && i < count; i++) names[i] = strdup(g_last_blob.names[i]);
+    pthread_mutex_unlock(&g_webconfig.mutex);
+    
+    char** values = calloc(count > 0 ? count : 1, sizeof(char*));
+    int* types = calloc(count > 0 ? count : 1, sizeof(int));
+    int* rcs = calloc(count > 0 ? count : 1, sizeof(int));
+    int rc = -1;
+    if (names && values && types && rcs) {
+        if (count > 0) rbus_adapter_get_typed_bulk(names, count, values, types, rcs);
+        int readable = 0;
+        for (int i = 0; i < count; i++) readable += rcs[i] == 0 && values[i];
+        
+#ifdef WEBCONFIG_BIN_SUPPORT
+        mp_writer_t w = {0};
+        mp_write_map(&w, 1);
+        mp_write_cstr(&w, "parameters");
+        mp_write_array(&w, readable);
+        for (int i = 0; i < count; i++) {
+            if (rcs[i] != 0 || !values[i]) continue;
+            mp_write_map(&w, 3);
+            mp_write_cstr(&w, "name");
+            mp_write_cstr(&w, names[i]);
+            mp_write_cstr(&w, "value");
+            mp_write_cstr(&w, values[i]);
+            mp_write_cstr(&w, "dataType");
+            mp_write_int(&w, types[i]);
+        }
+        if (!w.failed) {
+            *blob_data = (char*)w.data;
+            *blob_size = w.len;
+            rc = 0;
+        } else {
+            free(w.data);
+        }
+#else
+        cJSON* root = cJSON_CreateObject();
+        cJSON* params = root ? cJSON_AddArrayToObject(root, "parameters") : NULL;
+        for (int i = 0; params && i < count; i++) {
+            if (rcs[i] != 0 || !values[i]) continue;
+            cJSON* param = cJSON_CreateObject();
+            cJSON_AddStringToObject(param, "name", names[i]);
+            cJSON_AddStringToObject(param, "value", values[i]);
+            cJSON_AddNumberToObject(param, "dataType", types[i]);
+            cJSON_AddItemToArray(params, param);
+        }
+        char* json = root ? cJSON_PrintUnformatted(root) : NULL;
+        cJSON_Delete(root);
+        if (json) {
+            *blob_data = json;
+            *blob_size = strlen(json);
+            rc = 0;
+        }
+        (void)readable;
+#endif
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (names) free((char*)names[i]);
+        if (values) free(values[i]);
+    }
+    free(names); free(values); free(types); free(rcs);
+    return rc;
+}
+
 webconfig_stats_t* webconfig_get_stats(void) {
     if (!g_webconfig.initialized) return NULL;
     return &g_webconfig.stats;
@@ -466,7 +1631,9 @@ void webconfig_reset_stats(void) {
 int webconfig_set_notification_callback(webconfig_notification_callback_t callback) {
     if (!g_webconfig.initialized) return -1;
     
+    pthread_mutex_lock(&g_webconfig.mutex);
     g_webconfig.notification_callback = callback;
+    pthread_mutex_unlock(&g_webconfig.mutex);
     return 0;
 }
 